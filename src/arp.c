@@ -13,6 +13,7 @@
 #include <xil_types.h>
 #include <xil_assert.h>
 #include <xil_io.h>
+#include <xil_printf.h>
 
 #include "eth_mac.h"
 #include "if.h"
@@ -124,6 +125,21 @@ u8 uARPMessageValidateReply(struct sIFObject *pIFObjectPtr){
 }
 
 
+/*
+ * Per-interface ARP request template. Consecutive requests on an interface
+ * only differ in the target protocol address, so the frame is built once and
+ * only those four bytes are patched before it is sent.
+ */
+struct sArpRequestTemplate {
+  u8 uValid;
+  u8 arrIFAddrMac[6];
+  u8 arrIFAddrIP[4];
+  u16 uFrame[ARP_MSG_TOTAL_LEN / 2];    /* network byte order, unswapped */
+};
+
+static struct sArpRequestTemplate ArpRequestTemplate[NUM_ETHERNET_INTERFACES];
+
+
 /* ARP Response */
 u8 uARPBuildMessage(struct sIFObject *pIFObjectPtr, typeARPMessage tARPMsgType, u32 uTargetIP){
   u8 *pTxBuffer = NULL;
@@ -137,13 +153,16 @@ u8 uARPBuildMessage(struct sIFObject *pIFObjectPtr, typeARPMessage tARPMsgType,
   pTxBuffer = pIFObjectPtr->pUserTxBufferPtr;
   pRxBuffer = pIFObjectPtr->pUserRxBufferPtr;
 
-  uSize = pIFObjectPtr->uUserTxBufferSize;
+  uSize = ARP_MSG_TOTAL_LEN;
+  if (uSize > pIFObjectPtr->uUserTxBufferSize){
+    return ARP_RETURN_FAIL;
+  }
 
   if ((tARPMsgType != ARP_OPCODE_REPLY) && (tARPMsgType != ARP_OPCODE_REQUEST)){
     return ARP_RETURN_FAIL;
   }
 
-  /* zero the buffer, saves us from having to explicitly set zero valued bytes */
+  /* zero the frame, saves us from having to explicitly set zero valued bytes */
   memset(pTxBuffer, 0, uSize);
 
   /*****  ethernet frame stuff  *****/ 
@@ -204,7 +223,7 @@ u8 uARPBuildMessage(struct sIFObject *pIFObjectPtr, typeARPMessage tARPMsgType,
   /* pad to 64 byites */
   /* simply increase total length by following amount - these bytes already zero due to earlier memset */
   /* in our case, arp packets are fixed length (14 + 28 = 42) */
-  pIFObjectPtr->uMsgSize = ETH_FRAME_TOTAL_LEN + ARP_FRAME_TOTAL_LEN + 24;
+  pIFObjectPtr->uMsgSize = ARP_MSG_TOTAL_LEN;
 
   log_printf(LOG_SELECT_ARP, LOG_LEVEL_TRACE, "ARP  packet:\r\n");
   for (uIndex = 0; uIndex < pIFObjectPtr->uMsgSize; uIndex++){
@@ -217,11 +236,32 @@ u8 uARPBuildMessage(struct sIFObject *pIFObjectPtr, typeARPMessage tARPMsgType,
 
 
 
+/*
+ * Per-interface neighbour state, see arp.h. The table is small and searched
+ * linearly - it only holds the peers which talk to us and the ones asked for.
+ */
+struct sArpNeighbourState {
+  struct sArpNeighbour Table[ARP_NEIGH_TABLE_SIZE];
+  u8 uAnnounceCount;      /* gratuitous arp announcements still to send */
+  u8 uAnnounceTimer;
+};
+
+static struct sArpNeighbourState ArpNeighbours[NUM_ETHERNET_INTERFACES];
+
+static int ArpTransmitRequest(struct sIFObject *pIFObjectPtr, u32 uTargetIP);
+static struct sArpNeighbour *ArpNeighbourLookup(u8 uId, u32 uIPAddr);
+static struct sArpNeighbour *ArpNeighbourAlloc(u8 uId);
+static void ArpNeighbourProgram(u8 uId, struct sArpNeighbour *pEntry);
+static u8 ArpNeighbourOnLink(struct sIFObject *pIFObjectPtr, u32 uIPAddr);
+
+
 //=================================================================================
 //  ArpRequestHandler
 //--------------------------------------------------------------------------------
-//  This method constucts ARP requests to populate the ARP caches in the fabric
-//  Ethernet interfaces.
+//  This method runs the neighbour table of an interface and is called every
+//  100ms. It sends the outstanding gratuitous arp announcements, ages resolved
+//  entries and (re)sends the arp requests of unresolved or stale entries. At most
+//  ARP_NEIGH_TX_PER_TICK requests are sent per call.
 //
 //  Parameter       Dir   Description
 //  ---------       ---   -----------
@@ -231,52 +271,498 @@ u8 uARPBuildMessage(struct sIFObject *pIFObjectPtr, typeARPMessage tARPMsgType,
 //  ------
 //  None
 //=================================================================================
-/* NOTE: FIXME? this implementation is limited to class C /24 networks since it only cycles
-   through arp requests for IP's .1 to .254 (i.e. the last octet) */
 void ArpRequestHandler(struct sIFObject *pIFObjectPtr)
 {
-  u32 RequestIP;
+  struct sArpNeighbourState *pState;
+  struct sArpNeighbour *pEntry;
+  u8 uTxBudget = ARP_NEIGH_TX_PER_TICK;
+  u16 uInterval;
+  u8 id;
+  u8 i;
+
+  if (NULL == pIFObjectPtr->pUserTxBufferPtr){
+    Xil_AssertVoidAlways();
+  }
+
+  id = pIFObjectPtr->uIFEthernetId;
+  if (id >= NUM_ETHERNET_INTERFACES){
+    return;
+  }
+
+  if ((pIFObjectPtr->uIFEnableArpRequests != ARP_REQUESTS_ENABLE) || (0 == pIFObjectPtr->uIFAddrIP)){
+    return;
+  }
+
+  pState = &ArpNeighbours[id];
+
+  /* announce our (new) address - RFC 5227 section 2.3 */
+  if (pState->uAnnounceCount){
+    if (0 == pState->uAnnounceTimer){
+      log_printf(LOG_SELECT_ARP, LOG_LEVEL_DEBUG, "ARP  [%02x] gratuitous arp for 0x%08x\r\n", id, pIFObjectPtr->uIFAddrIP);
+      ArpTransmitRequest(pIFObjectPtr, pIFObjectPtr->uIFAddrIP);
+      uTxBudget--;
+      pState->uAnnounceCount--;
+      pState->uAnnounceTimer = ARP_GRATUITOUS_INTERVAL_TICKS;
+    } else {
+      pState->uAnnounceTimer--;
+    }
+  }
+
+  for (i = 0; i < ARP_NEIGH_TABLE_SIZE; i++){
+    pEntry = &(pState->Table[i]);
+
+    if (ARP_NEIGH_STATE_FREE == pEntry->uState){
+      continue;
+    }
+
+    if (pEntry->uTimer < 0xffff){
+      pEntry->uTimer++;
+    }
+
+    if (ARP_NEIGH_STATE_REACHABLE == pEntry->uState){
+      if (pEntry->uTimer < ARP_NEIGH_REACHABLE_TICKS){
+        continue;
+      }
+      /* aged out - refresh it straight away */
+      pEntry->uState = ARP_NEIGH_STATE_STALE;
+      pEntry->uRetries = 0;
+      pEntry->uTimer = ARP_NEIGH_RETRY_TICKS;
+    }
+
+    /* incomplete or stale */
+    uInterval = (pEntry->uRetries < ARP_NEIGH_MAX_RETRIES) ? ARP_NEIGH_RETRY_TICKS : ARP_NEIGH_PINNED_RETRY_TICKS;
+    if (pEntry->uTimer < uInterval){
+      continue;
+    }
+
+    if ((pEntry->uRetries >= ARP_NEIGH_MAX_RETRIES) && ((pEntry->uFlags & ARP_NEIGH_FLAG_PINNED) == 0)){
+      log_printf(LOG_SELECT_ARP, LOG_LEVEL_INFO, "ARP  [%02x] no reply from 0x%08x - entry removed\r\n", id, pEntry->uIPAddr);
+      pEntry->uState = ARP_NEIGH_STATE_FREE;
+      continue;
+    }
+
+    if (0 == uTxBudget){
+      continue;   /* still due - picked up on the next tick */
+    }
+
+    log_printf(LOG_SELECT_ARP, LOG_LEVEL_DEBUG, "ARP  [%02x] resolve 0x%08x (try %d)\r\n", id, pEntry->uIPAddr, pEntry->uRetries);
+    ArpTransmitRequest(pIFObjectPtr, pEntry->uIPAddr);
+    uTxBudget--;
+
+    if (pEntry->uRetries < ARP_NEIGH_MAX_RETRIES){
+      pEntry->uRetries++;
+    }
+    pEntry->uTimer = 0;
+  }
+}
+
+
+//=================================================================================
+//  ArpNeighbourLearn
+//--------------------------------------------------------------------------------
+//  This method updates the neighbour table (and the fabric arp cache) with the
+//  sender addresses of the arp packet in the receive buffer. The packet must
+//  already have been validated by uARPMessageValidateReply().
+//
+//  Parameter       Dir   Description
+//  ---------       ---   -----------
+//  pIFObjectPtr    IN    handle to IF state object
+//  uCreate         IN    add the sender if not in the table yet, else only
+//                        refresh an existing entry (RFC 826 merge)
+//
+//  Return
+//  ------
+//  ARP_RETURN_OK if the sender was learnt, ARP_RETURN_IGNORE if not applicable,
+//  ARP_RETURN_FAIL if the table is full
+//=================================================================================
+u8 ArpNeighbourLearn(struct sIFObject *pIFObjectPtr, u8 uCreate){
+  struct sArpNeighbour *pEntry;
+  u8 *pRxBuffer;
+  u32 uIPAddr;
+  u8 id;
+
+  SANE_ARP(pIFObjectPtr);
+
+  id = pIFObjectPtr->uIFEthernetId;
+  if (id >= NUM_ETHERNET_INTERFACES){
+    return ARP_RETURN_FAIL;
+  }
+
+  pRxBuffer = pIFObjectPtr->pUserRxBufferPtr;
+
+  uIPAddr = ((u32) pRxBuffer[ARP_FRAME_BASE + ARP_SRC_PROTO_ADDR_OFFSET] << 24) |
+    ((u32) pRxBuffer[ARP_FRAME_BASE + ARP_SRC_PROTO_ADDR_OFFSET + 1] << 16) |
+    ((u32) pRxBuffer[ARP_FRAME_BASE + ARP_SRC_PROTO_ADDR_OFFSET + 2] << 8) |
+    ((u32) pRxBuffer[ARP_FRAME_BASE + ARP_SRC_PROTO_ADDR_OFFSET + 3]);
+
+  /* skips probes (sender 0.0.0.0), our own address and off-link senders */
+  if (ArpNeighbourOnLink(pIFObjectPtr, uIPAddr) == 0){
+    return ARP_RETURN_IGNORE;
+  }
+
+  pEntry = ArpNeighbourLookup(id, uIPAddr);
+  if (NULL == pEntry){
+    if (0 == uCreate){
+      return ARP_RETURN_IGNORE;
+    }
+
+    pEntry = ArpNeighbourAlloc(id);
+    if (NULL == pEntry){
+      log_printf(LOG_SELECT_ARP, LOG_LEVEL_ERROR, "ARP  [%02x] neighbour table full\r\n", id);
+      return ARP_RETURN_FAIL;
+    }
+    pEntry->uIPAddr = uIPAddr;
+    pEntry->uFlags = 0;
+  }
+
+  memcpy(pEntry->arrMac, pRxBuffer + ARP_FRAME_BASE + ARP_SRC_HW_ADDR_OFFSET, 6);
+  pEntry->uState = ARP_NEIGH_STATE_REACHABLE;
+  pEntry->uRetries = 0;
+  pEntry->uTimer = 0;
+
+  ArpNeighbourProgram(id, pEntry);
+
+  return ARP_RETURN_OK;
+}
+
+
+//=================================================================================
+//  ArpNeighbourResolve
+//--------------------------------------------------------------------------------
+//  This method adds an on-link peer to the neighbour table. The arp request is
+//  sent on the next ArpRequestHandler() tick, i.e. within 100ms.
+//
+//  Parameter       Dir   Description
+//  ---------       ---   -----------
+//  pIFObjectPtr    IN    handle to IF state object
+//  uIPAddr         IN    address to resolve
+//  uFlags          IN    ARP_NEIGH_FLAG_* to set on the entry
+//
+//  Return
+//  ------
+//  ARP_RETURN_OK on success, ARP_RETURN_INVALID if the address is not on-link,
+//  ARP_RETURN_FAIL if the table is full
+//=================================================================================
+u8 ArpNeighbourResolve(struct sIFObject *pIFObjectPtr, u32 uIPAddr, u8 uFlags){
+  struct sArpNeighbour *pEntry;
+  u8 id;
+
+  SANE_ARP(pIFObjectPtr);
+
+  id = pIFObjectPtr->uIFEthernetId;
+  if (id >= NUM_ETHERNET_INTERFACES){
+    return ARP_RETURN_FAIL;
+  }
+
+  if (ArpNeighbourOnLink(pIFObjectPtr, uIPAddr) == 0){
+    return ARP_RETURN_INVALID;
+  }
+
+  pEntry = ArpNeighbourLookup(id, uIPAddr);
+  if (pEntry != NULL){
+    pEntry->uFlags |= uFlags;
+    return ARP_RETURN_OK;
+  }
+
+  pEntry = ArpNeighbourAlloc(id);
+  if (NULL == pEntry){
+    return ARP_RETURN_FAIL;
+  }
+
+  pEntry->uIPAddr = uIPAddr;
+  memset(pEntry->arrMac, 0, 6);
+  pEntry->uState = ARP_NEIGH_STATE_INCOMPLETE;
+  pEntry->uFlags = uFlags;
+  pEntry->uRetries = 0;
+  pEntry->uTimer = ARP_NEIGH_RETRY_TICKS;   /* due immediately */
+
+  return ARP_RETURN_OK;
+}
+
+
+//=================================================================================
+//  ArpNeighbourForget
+//--------------------------------------------------------------------------------
+//  This method removes a peer from the neighbour table. The fabric arp cache
+//  entry is left as is.
+//
+//  Parameter       Dir   Description
+//  ---------       ---   -----------
+//  pIFObjectPtr    IN    handle to IF state object
+//  uIPAddr         IN    address to remove
+//
+//  Return
+//  ------
+//  ARP_RETURN_OK if removed, ARP_RETURN_IGNORE if not in the table
+//=================================================================================
+u8 ArpNeighbourForget(struct sIFObject *pIFObjectPtr, u32 uIPAddr){
+  struct sArpNeighbour *pEntry;
+
+  SANE_ARP(pIFObjectPtr);
+
+  if (pIFObjectPtr->uIFEthernetId >= NUM_ETHERNET_INTERFACES){
+    return ARP_RETURN_FAIL;
+  }
+
+  pEntry = ArpNeighbourLookup(pIFObjectPtr->uIFEthernetId, uIPAddr);
+  if (NULL == pEntry){
+    return ARP_RETURN_IGNORE;
+  }
+
+  pEntry->uState = ARP_NEIGH_STATE_FREE;
+
+  return ARP_RETURN_OK;
+}
+
+
+//=================================================================================
+//  ArpNeighbourConfigure
+//--------------------------------------------------------------------------------
+//  This method (re)starts the neighbour table once the interface has an address:
+//  the table is flushed, the gateway is resolved and kept resolved and our
+//  address is announced with gratuitous arp.
+//
+//  Parameter       Dir   Description
+//  ---------       ---   -----------
+//  pIFObjectPtr    IN    handle to IF state object
+//  uGatewayIPAddr  IN    gateway address of the lease (0 if none)
+//
+//  Return
+//  ------
+//  None
+//=================================================================================
+void ArpNeighbourConfigure(struct sIFObject *pIFObjectPtr, u32 uGatewayIPAddr){
+  u8 id;
+
+  id = pIFObjectPtr->uIFEthernetId;
+  if (id >= NUM_ETHERNET_INTERFACES){
+    return;
+  }
+
+  ArpNeighbourFlush(pIFObjectPtr);
+
+  if (uGatewayIPAddr != 0){
+    if (ArpNeighbourResolve(pIFObjectPtr, uGatewayIPAddr, ARP_NEIGH_FLAG_PINNED) != ARP_RETURN_OK){
+      log_printf(LOG_SELECT_ARP, LOG_LEVEL_WARN, "ARP  [%02x] gateway 0x%08x not on-link\r\n", id, uGatewayIPAddr);
+    }
+  }
+
+  ArpNeighbours[id].uAnnounceCount = ARP_GRATUITOUS_COUNT;
+  ArpNeighbours[id].uAnnounceTimer = 0;
+}
+
+
+//=================================================================================
+//  ArpNeighbourFlush
+//--------------------------------------------------------------------------------
+//  This method clears the neighbour table of an interface, e.g. on link down.
+//
+//  Parameter       Dir   Description
+//  ---------       ---   -----------
+//  pIFObjectPtr    IN    handle to IF state object
+//
+//  Return
+//  ------
+//  None
+//=================================================================================
+void ArpNeighbourFlush(struct sIFObject *pIFObjectPtr){
+  u8 id;
+
+  id = pIFObjectPtr->uIFEthernetId;
+  if (id >= NUM_ETHERNET_INTERFACES){
+    return;
+  }
+
+  memset(&ArpNeighbours[id], 0, sizeof(struct sArpNeighbourState));
+}
+
+
+const struct sArpNeighbour *ArpNeighbourGetTable(u8 uId){
+  if (uId >= NUM_ETHERNET_INTERFACES){
+    return NULL;
+  }
+
+  return ArpNeighbours[uId].Table;
+}
+
+
+u8 ArpNeighbourCount(u8 uId){
+  u8 i;
+  u8 n = 0;
+
+  if (uId >= NUM_ETHERNET_INTERFACES){
+    return 0;
+  }
+
+  for (i = 0; i < ARP_NEIGH_TABLE_SIZE; i++){
+    if (ArpNeighbours[uId].Table[i].uState != ARP_NEIGH_STATE_FREE){
+      n++;
+    }
+  }
+
+  return n;
+}
+
+
+void ArpNeighbourPrint(u8 uId){
+  static const char * const state_names[] = {
+    [ARP_NEIGH_STATE_FREE]        = "free",
+    [ARP_NEIGH_STATE_INCOMPLETE]  = "incomplete",
+    [ARP_NEIGH_STATE_REACHABLE]   = "reachable",
+    [ARP_NEIGH_STATE_STALE]       = "stale"
+  };
+  const struct sArpNeighbour *e;
+  u8 i;
+
+  if (uId >= NUM_ETHERNET_INTERFACES){
+    return;
+  }
+
+  xil_printf("[%02x] %d/%d neighbours\r\n", uId, ArpNeighbourCount(uId), ARP_NEIGH_TABLE_SIZE);
+
+  for (i = 0; i < ARP_NEIGH_TABLE_SIZE; i++){
+    e = &(ArpNeighbours[uId].Table[i]);
+    if (ARP_NEIGH_STATE_FREE == e->uState){
+      continue;
+    }
+    xil_printf("  %d.%d.%d.%d  %02x:%02x:%02x:%02x:%02x:%02x  %-10s %s age %ds\r\n",
+        (e->uIPAddr >> 24) & 0xff, (e->uIPAddr >> 16) & 0xff, (e->uIPAddr >> 8) & 0xff, e->uIPAddr & 0xff,
+        e->arrMac[0], e->arrMac[1], e->arrMac[2], e->arrMac[3], e->arrMac[4], e->arrMac[5],
+        state_names[e->uState], (e->uFlags & ARP_NEIGH_FLAG_PINNED) ? "pinned" : "      ", e->uTimer / 10);
+  }
+}
+
+
+/* send a broadcast arp request for uTargetIP from the interface's request template */
+static int ArpTransmitRequest(struct sIFObject *pIFObjectPtr, u32 uTargetIP){
+  struct sArpRequestTemplate *pTemplate;
   int iStatus;
   u16 *pBuffer;
+  u8 *pFrame;
   u32 size, i;
   u8 id;
 
   pBuffer = (u16 *) pIFObjectPtr->pUserTxBufferPtr;
-  if (NULL == pBuffer){
-    Xil_AssertVoidAlways();
+  id = pIFObjectPtr->uIFEthernetId;
+  pTemplate = &ArpRequestTemplate[id];
+  pFrame = (u8 *) pTemplate->uFrame;
+
+  if ((pTemplate->uValid == 0) ||
+      memcmp(pTemplate->arrIFAddrMac, pIFObjectPtr->arrIFAddrMac, 6) ||
+      memcmp(pTemplate->arrIFAddrIP, pIFObjectPtr->arrIFAddrIP, 4)){
+    /* build the arp request template */
+    pTemplate->uValid = 0;
+    if (uARPBuildMessage(pIFObjectPtr, ARP_OPCODE_REQUEST, uTargetIP) != ARP_RETURN_OK){
+      pIFObjectPtr->uIFCounter[TX_ETH_ARP_ERR]++;
+      return XST_FAILURE;
+    }
+    memcpy(pFrame, pBuffer, ARP_MSG_TOTAL_LEN);
+    memcpy(pTemplate->arrIFAddrMac, pIFObjectPtr->arrIFAddrMac, 6);
+    memcpy(pTemplate->arrIFAddrIP, pIFObjectPtr->arrIFAddrIP, 4);
+    pTemplate->uValid = 1;
   }
 
-  if (pIFObjectPtr->uIFEnableArpRequests == ARP_REQUESTS_ENABLE){
-    RequestIP = pIFObjectPtr->uIFEthernetSubnet | pIFObjectPtr->uIFCurrentArpRequest;
-    /* build the arp request */
-    log_printf(LOG_SELECT_ARP, LOG_LEVEL_DEBUG, "build : 0x%08x ", RequestIP);
-    uARPBuildMessage(pIFObjectPtr, ARP_OPCODE_REQUEST, RequestIP);
+  /* only the target protocol address changes between requests */
+  pFrame[ARP_FRAME_BASE + ARP_TGT_PROTO_ADDR_OFFSET]     = ((uTargetIP >> 24) & 0xff);
+  pFrame[ARP_FRAME_BASE + ARP_TGT_PROTO_ADDR_OFFSET + 1] = ((uTargetIP >> 16) & 0xff);
+  pFrame[ARP_FRAME_BASE + ARP_TGT_PROTO_ADDR_OFFSET + 2] = ((uTargetIP >>  8) & 0xff);
+  pFrame[ARP_FRAME_BASE + ARP_TGT_PROTO_ADDR_OFFSET + 3] = ( uTargetIP        & 0xff);
+  pIFObjectPtr->uMsgSize = ARP_MSG_TOTAL_LEN;
+
+  size = (u32) (pIFObjectPtr->uMsgSize >> 1);    /* bytes to 16-bit words */
+  for (i = 0; i < size; i++){
+    pBuffer[i] = Xil_EndianSwap16(pTemplate->uFrame[i]);
+  }
+
+  size = size >> 1;   /*  32-bit words */
+  iStatus = TransmitHostPacket(id, (u32 *) pBuffer, size);
+  if (iStatus == XST_SUCCESS){
+    pIFObjectPtr->uIFCounter[TX_ETH_ARP_REQ_OK]++;
+  } else {
+    log_printf(LOG_SELECT_ARP, LOG_LEVEL_ERROR, "ARP  [%02x] FAILED to send ARP REQUEST to target with IP 0x%08x\r\n", id, uTargetIP);
+    pIFObjectPtr->uIFCounter[TX_ETH_ARP_ERR]++;
+  }
+
+  return iStatus;
+}
 
-    size = (u32) (pIFObjectPtr->uMsgSize >> 1);    /* bytes to 16-bit words */
 
-    log_printf(LOG_SELECT_ARP, LOG_LEVEL_DEBUG, "swap: %d ", size);
-    for (i = 0; i < size; i++){
-      pBuffer[i] = Xil_EndianSwap16(pBuffer[i]);
+static struct sArpNeighbour *ArpNeighbourLookup(u8 uId, u32 uIPAddr){
+  struct sArpNeighbour *pTable = ArpNeighbours[uId].Table;
+  u8 i;
+
+  for (i = 0; i < ARP_NEIGH_TABLE_SIZE; i++){
+    if ((pTable[i].uState != ARP_NEIGH_STATE_FREE) && (pTable[i].uIPAddr == uIPAddr)){
+      return &pTable[i];
     }
+  }
 
-    id = pIFObjectPtr->uIFEthernetId;
+  return NULL;
+}
 
-    size = size >> 1;   /*  32-bit words */
-    log_printf(LOG_SELECT_ARP, LOG_LEVEL_DEBUG, "send: %d iface: %d ", size, id);
-    iStatus = TransmitHostPacket(id, (u32 *) pBuffer, size);
-    if (iStatus == XST_SUCCESS){
-      pIFObjectPtr->uTxEthArpRequestOk++;
-    } else {
-      log_printf(LOG_SELECT_ARP, LOG_LEVEL_ERROR, "ARP  [%02x] FAILED to send ARP REQUEST to target with IP 0x%08x\r\n", id, RequestIP);
-      pIFObjectPtr->uTxEthArpErr++;
+
+/* returns a free entry, else evicts the unpinned entry least likely to be needed */
+static struct sArpNeighbour *ArpNeighbourAlloc(u8 uId){
+  struct sArpNeighbour *pTable = ArpNeighbours[uId].Table;
+  struct sArpNeighbour *pVictim = NULL;
+  u8 i;
+
+  for (i = 0; i < ARP_NEIGH_TABLE_SIZE; i++){
+    if (ARP_NEIGH_STATE_FREE == pTable[i].uState){
+      return &pTable[i];
+    }
+  }
+
+  for (i = 0; i < ARP_NEIGH_TABLE_SIZE; i++){
+    if (pTable[i].uFlags & ARP_NEIGH_FLAG_PINNED){
+      continue;
     }
 
-    log_printf(LOG_SELECT_ARP, LOG_LEVEL_DEBUG, "done\r\n");
-    /* cycle through IP's from .1 to .254 */
-    if (pIFObjectPtr->uIFCurrentArpRequest == 254){
-      pIFObjectPtr->uIFCurrentArpRequest = 1;
-    } else {
-      pIFObjectPtr->uIFCurrentArpRequest++;
+    if (NULL == pVictim){
+      pVictim = &pTable[i];
+    } else if ((pVictim->uState == ARP_NEIGH_STATE_REACHABLE) && (pTable[i].uState != ARP_NEIGH_STATE_REACHABLE)){
+      pVictim = &pTable[i];   /* prefer unresolved / stale entries */
+    } else if (((pVictim->uState == ARP_NEIGH_STATE_REACHABLE) == (pTable[i].uState == ARP_NEIGH_STATE_REACHABLE)) &&
+        (pTable[i].uTimer > pVictim->uTimer)){
+      pVictim = &pTable[i];   /* then the oldest */
     }
   }
+
+  if (pVictim != NULL){
+    pVictim->uState = ARP_NEIGH_STATE_FREE;
+  }
+
+  return pVictim;
+}
+
+
+static void ArpNeighbourProgram(u8 uId, struct sArpNeighbour *pEntry){
+  u32 u;
+  u32 l;
+
+  u = ((u32) pEntry->arrMac[0] << 8) | pEntry->arrMac[1];
+  l = ((u32) pEntry->arrMac[2] << 24) | ((u32) pEntry->arrMac[3] << 16) | ((u32) pEntry->arrMac[4] << 8) | pEntry->arrMac[5];
+
+  log_printf(LOG_SELECT_ARP, LOG_LEVEL_INFO, "ARP  [%02x] ENTRY - IP#: %03d MAC: %04x.%04x.%04x\r\n", uId, (pEntry->uIPAddr & 0xff), (u & 0xffff), ((l >> 16) & 0xffff), (l & 0xffff));
+
+  /* the fabric arp cache is indexed by the last octet of the address */
+  ProgramARPCacheEntry(uId, (pEntry->uIPAddr & 0xff), u, l);
+}
+
+
+static u8 ArpNeighbourOnLink(struct sIFObject *pIFObjectPtr, u32 uIPAddr){
+  if ((0 == pIFObjectPtr->uIFAddrIP) || (0 == uIPAddr) || (uIPAddr == pIFObjectPtr->uIFAddrIP)){
+    return 0;
+  }
+
+  if ((uIPAddr & pIFObjectPtr->uIFAddrMask) != pIFObjectPtr->uIFEthernetSubnet){
+    return 0;
+  }
+
+  /* subnet network and broadcast addresses */
+  if ((uIPAddr == pIFObjectPtr->uIFEthernetSubnet) || ((uIPAddr | pIFObjectPtr->uIFAddrMask) == 0xffffffff)){
+    return 0;
+  }
+
+  return 1;
 }
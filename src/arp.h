@@ -13,6 +13,7 @@
 #ifndef _ARP_H_
 #define _ARP_H_
 
+#include <xil_types.h>
 #include <xstatus.h>
 
 #include "eth.h"
@@ -79,16 +80,62 @@ extern "C" {
 
 #define ARP_FRAME_TOTAL_LEN           (ARP_TGT_PROTO_ADDR_OFFSET + ARP_TGT_PROTO_ADDR_LEN)
 
+/* arp messages are fixed length (14 + 28 = 42) and padded to 64 bytes */
+#define ARP_MSG_TOTAL_LEN             (ETH_FRAME_TOTAL_LEN + ARP_FRAME_TOTAL_LEN + 24)
+
 typedef enum {ARP_OPCODE_REQUEST=1,
               ARP_OPCODE_REPLY
 } typeARPMessage;
 
+/*
+ * Neighbour table - one per interface. Entries are learnt from received arp
+ * traffic or added on demand (gateway, ARP_NEIGHBOUR_CONTROL opcode) and every
+ * resolved entry is programmed into the fabric arp cache. Note that the fabric
+ * arp cache is indexed by the last octet of the ip address.
+ */
+#define ARP_NEIGH_TABLE_SIZE          32
+
+#define ARP_NEIGH_STATE_FREE          0
+#define ARP_NEIGH_STATE_INCOMPLETE    1   /* request sent, awaiting reply */
+#define ARP_NEIGH_STATE_REACHABLE     2
+#define ARP_NEIGH_STATE_STALE         3   /* aged out, refresh request sent */
+
+#define ARP_NEIGH_FLAG_PINNED         0x1 /* never evicted, retried until resolved */
+
+/* timing in ArpRequestHandler ticks i.e. 100ms */
+#define ARP_NEIGH_REACHABLE_TICKS     3000  /* 5 minutes */
+#define ARP_NEIGH_RETRY_TICKS         10
+#define ARP_NEIGH_PINNED_RETRY_TICKS  100
+#define ARP_NEIGH_MAX_RETRIES         3
+#define ARP_NEIGH_TX_PER_TICK         4     /* rate limit of requests per interface */
+
+#define ARP_GRATUITOUS_COUNT          2     /* RFC 5227 ANNOUNCE_NUM */
+#define ARP_GRATUITOUS_INTERVAL_TICKS 20    /* RFC 5227 ANNOUNCE_INTERVAL */
+
+struct sArpNeighbour {
+  u32 uIPAddr;
+  u8 arrMac[6];
+  u8 uState;
+  u8 uFlags;
+  u8 uRetries;
+  u16 uTimer;     /* ticks spent in the current state */
+};
+
 struct sIFObject;
 
 u8 uARPMessageValidateReply(struct sIFObject *pIFObjectPtr);
 u8 uARPBuildMessage(struct sIFObject *pIFObjectPtr, typeARPMessage tARPMsgType, u32 uTargetIP);
 void ArpRequestHandler(struct sIFObject *pIFObjectPtr);
 
+u8 ArpNeighbourLearn(struct sIFObject *pIFObjectPtr, u8 uCreate);
+u8 ArpNeighbourResolve(struct sIFObject *pIFObjectPtr, u32 uIPAddr, u8 uFlags);
+u8 ArpNeighbourForget(struct sIFObject *pIFObjectPtr, u32 uIPAddr);
+void ArpNeighbourConfigure(struct sIFObject *pIFObjectPtr, u32 uGatewayIPAddr);
+void ArpNeighbourFlush(struct sIFObject *pIFObjectPtr);
+const struct sArpNeighbour *ArpNeighbourGetTable(u8 uId);
+u8 ArpNeighbourCount(u8 uId);
+void ArpNeighbourPrint(u8 uId);
+
 #ifdef __cplusplus
 }
 #endif
@@ -20,6 +20,9 @@
 #include "memtest.h"
 #include "mezz.h"
 #include "fanctrl.h"
+#include "perfmon.h"
+#include "memmon.h"
+#include "arp.h"
 
 #define LINE_BYTES_MAX 20
 
@@ -58,7 +61,9 @@ typedef enum {
   CMD_INDEX_WHOAMI,
   CMD_INDEX_UNAME,
   CMD_INDEX_UPTIME,
+  CMD_INDEX_TOP,
   CMD_INDEX_DUMP,
+  CMD_INDEX_MEM,
   CMD_INDEX_IF_MAP,
   CMD_INDEX_IGMP,
 #ifndef PRUNE_CODEBASE_DIAGNOSTICS
@@ -67,6 +72,7 @@ typedef enum {
   CMD_INDEX_WB_READ,
   CMD_INDEX_ARP_REQ,
   CMD_INDEX_ARP_PROC,
+  CMD_INDEX_ARP_TABLE,
   CMD_INDEX_MEMTEST,
   CMD_INDEX_CLR_LINK_MON,
   CMD_INDEX_FAN_RUNTIME,
@@ -90,7 +96,9 @@ static const char * const cli_cmd_map[] = {
   [CMD_INDEX_WHOAMI]      = "whoami",
   [CMD_INDEX_UNAME]       = "uname",
   [CMD_INDEX_UPTIME]      = "uptime",
+  [CMD_INDEX_TOP]         = "top",
   [CMD_INDEX_DUMP]        = "dump",
+  [CMD_INDEX_MEM]         = "mem",
   [CMD_INDEX_IF_MAP]      = "if-map",
   [CMD_INDEX_IGMP]        = "igmp",
 #ifndef PRUNE_CODEBASE_DIAGNOSTICS
@@ -99,6 +107,7 @@ static const char * const cli_cmd_map[] = {
   [CMD_INDEX_WB_READ]     = "wb-read",
   [CMD_INDEX_ARP_REQ]     = "arp-req",
   [CMD_INDEX_ARP_PROC]    = "arp-proc",
+  [CMD_INDEX_ARP_TABLE]   = "arp-table",
   [CMD_INDEX_MEMTEST]     = "memtest",
   [CMD_INDEX_CLR_LINK_MON]= "clr-link-mon-count",
   [CMD_INDEX_FAN_RUNTIME] = "fan-runtime",
@@ -121,7 +130,9 @@ static const char * const cli_cmd_options[][12] = {
  [CMD_INDEX_WHOAMI]       = { NULL },
  [CMD_INDEX_UNAME]        = { NULL },
  [CMD_INDEX_UPTIME]       = { NULL },
+ [CMD_INDEX_TOP]          = { NULL },
  [CMD_INDEX_DUMP]         = {"stack",   "heap", /*, "text"*/ NULL},
+ [CMD_INDEX_MEM]          = { NULL },
  [CMD_INDEX_IF_MAP]       = { NULL },
  [CMD_INDEX_IGMP]         = { NULL },
 #ifndef PRUNE_CODEBASE_DIAGNOSTICS
@@ -130,6 +141,7 @@ static const char * const cli_cmd_options[][12] = {
  [CMD_INDEX_WB_READ]      = {CLI_KEYWORD_HEX, NULL },
  [CMD_INDEX_ARP_REQ]      = {"off",     "on",     "stat"},    /* order of "off" (index 0) and "on" (index 1) are important */
  [CMD_INDEX_ARP_PROC]     = {"off",     "on",     "stat"},    /* order of "off" (index 0) and "on" (index 1) are important */
+ [CMD_INDEX_ARP_TABLE]    = { NULL },
  [CMD_INDEX_MEMTEST]      = { NULL },
  [CMD_INDEX_CLR_LINK_MON] = { NULL },
  [CMD_INDEX_FAN_RUNTIME]  = {"lf",      "lm",     "lb",   "rb",   "fpga",   NULL },  /* order is important - corresponds to fan page number */
@@ -150,7 +162,9 @@ static int cli_stats_exe(struct cli *_cli);
 static int cli_whoami_exe(struct cli *_cli);
 static int cli_uname_exe(struct cli *_cli);
 static int cli_uptime_exe(struct cli *_cli);
+static int cli_top_exe(struct cli *_cli);
 static int cli_dump_exe(struct cli *_cli);
+static int cli_mem_exe(struct cli *_cli);
 static int cli_if_map_exe(struct cli *_cli);
 static int cli_igmp_exe(struct cli *_cli);
 #ifndef PRUNE_CODEBASE_DIAGNOSTICS
@@ -159,6 +173,7 @@ static int cli_peek_exe(struct cli *_cli);
 static int cli_wb_read_exe(struct cli *_cli);
 static int cli_arp_req_exe(struct cli *_cli);
 static int cli_arp_proc_exe(struct cli *_cli);
+static int cli_arp_table_exe(struct cli *_cli);
 static int cli_memtest_exe(struct cli *_cli);
 static int cli_clr_link_mon_exe(struct cli *_cli);
 static int cli_fan_runtime_exe(struct cli *_cli);
@@ -178,7 +193,9 @@ static const cmd_callback cli_cmd_callback[] = {
  [CMD_INDEX_WHOAMI]       = cli_whoami_exe,
  [CMD_INDEX_UNAME]        = cli_uname_exe,
  [CMD_INDEX_UPTIME]       = cli_uptime_exe,
+ [CMD_INDEX_TOP]          = cli_top_exe,
  [CMD_INDEX_DUMP]         = cli_dump_exe,
+ [CMD_INDEX_MEM]          = cli_mem_exe,
  [CMD_INDEX_IF_MAP]       = cli_if_map_exe,
  [CMD_INDEX_IGMP]         = cli_igmp_exe,
 #ifndef PRUNE_CODEBASE_DIAGNOSTICS
@@ -187,6 +204,7 @@ static const cmd_callback cli_cmd_callback[] = {
  [CMD_INDEX_WB_READ]      = cli_wb_read_exe,
  [CMD_INDEX_ARP_REQ]      = cli_arp_req_exe,
  [CMD_INDEX_ARP_PROC]     = cli_arp_proc_exe,
+ [CMD_INDEX_ARP_TABLE]    = cli_arp_table_exe,
  [CMD_INDEX_MEMTEST]      = cli_memtest_exe,
  [CMD_INDEX_CLR_LINK_MON] = cli_clr_link_mon_exe,
  [CMD_INDEX_FAN_RUNTIME]  = cli_fan_runtime_exe,
@@ -833,6 +851,13 @@ static int cli_get_config_exe(struct cli *_cli){
 #endif
   log_printf(LOG_SELECT_GENERAL, LOG_LEVEL_INFO, "prune code: %s\r\n", str_prune);
 
+#ifdef PROFILER
+  const char *str_prof = "yes";
+#else
+  const char *str_prof = "no";
+#endif
+  log_printf(LOG_SELECT_GENERAL, LOG_LEVEL_INFO, "pc profiler: %s\r\n", str_prof);
+
   return 0;
 }
 
@@ -905,6 +930,18 @@ static int cli_uptime_exe(struct cli *_cli){
   return 0;
 }
 
+static int cli_top_exe(struct cli *_cli){
+  perfmon_print_top();
+
+  return 0;
+}
+
+static int cli_mem_exe(struct cli *_cli){
+  memmon_print_usage();
+
+  return 0;
+}
+
 static int cli_help_exe(struct cli *_cli){
   cli_print_help();
   return 0;
@@ -1155,6 +1192,20 @@ static int cli_arp_proc_exe(struct cli *_cli){
 }
 
 
+static int cli_arp_table_exe(struct cli *_cli){
+  u8 logical_link;
+  u8 n;
+
+  n = get_num_interfaces();
+
+  for (logical_link = 0; logical_link < n; logical_link++){
+    ArpNeighbourPrint(get_physical_interface_id(logical_link));
+  }
+
+  return 0;
+}
+
+
 static int cli_memtest_exe(struct cli *_cli){
 
   vRunMemoryTest();
@@ -49,7 +49,9 @@ extern "C" {
 volatile u32 uWriteBoardShadowRegs[NUM_REGISTERS];
 
 // Single transmit buffer
-#define TX_BUFFER_MAX 256
+//#define TX_BUFFER_MAX 256
+#define TX_BUFFER_MAX 2254  /* Sized as the receive buffer below so that the jumbo
+                               big read response (BIG_READ_WISHBONE_JUMBO) fits. */
 volatile u32 uTransmitBuffer[TX_BUFFER_MAX];
 
 // Single receive buffer
@@ -117,9 +119,6 @@ volatile u16 GlobalDHCPMonitorTimeout;   /* TODO: hide/wrap this global var in a
 volatile u16 uQSFPBootloaderVersionMajor;
 volatile u16 uQSFPBootloaderVersionMinor;
 
-volatile u32 uPreviousAsyncSdramRead;
-volatile u16 uPreviousSequenceNumber;
-
 //volatile u8 uADC32RF45X2MezzanineLocation;
 //volatile u8 uADC32RF45X2MezzaninePresent;
 volatile u8 uADC32RF45X2UpdateStatusEnable;
@@ -213,6 +212,7 @@ volatile u16 uADC32RF45X2BootloaderVersionMinor;
 
 #define BOARD_REG       0x1
 #define DSP_REG         0x2
+#define WISHBONE_REG    0x3
 
 #define ARP_RESPONSE      0x2
 #define ARP_REQUEST       0x1
@@ -291,7 +291,24 @@ volatile u16 uADC32RF45X2BootloaderVersionMinor;
 #define GET_MICROBLAZE_UPTIME       0x0065
 #define FPGA_FANCONTROLLER_UPDATE   0x0067
 #define GET_FPGA_FANCONTROLLER_LUT  0x0069
-#define HIGHEST_DEFINED_COMMAND     0x0069
+#define GET_IF_COUNTERS             0x006B
+#define GET_CPU_LOAD_STATS          0x006D
+#define PROFILER_CONTROL            0x006F
+#define GET_MEMORY_USAGE            0x0071
+#define ARP_NEIGHBOUR_CONTROL       0x0073
+#define ARP_CACHE_UPLOAD            0x0075
+#define IGMP_CONTROL                0x0077
+#define MULTICAST_RANGE_CONTROL     0x0079
+#define BIG_READ_WISHBONE_JUMBO     0x007B
+#define BIG_WRITE_WISHBONE_JUMBO    0x007D
+#define STREAM_READ_WISHBONE        0x007F
+#define SCATTER_READ_WISHBONE       0x0081
+#define SCATTER_WRITE_WISHBONE      0x0083
+#define READ_MODIFY_WRITE_REG       0x0085
+#define POLL_WISHBONE               0x0087
+#define WATCH_REGISTER_CONTROL      0x0089
+#define TELEMETRY_CONTROL           0x008B
+#define HIGHEST_DEFINED_COMMAND     0x008B
 
 
 // ETHERNET TYPE CODES
@@ -312,9 +329,20 @@ volatile u16 uADC32RF45X2BootloaderVersionMinor;
 #define IGMP_ALL_ROUTERS_IP_ADDRESS 0xE0000002  // 224.0.0.2
 #define IGMP_ALL_SYSTEMS_IP_ADDRESS 0xE0000001  // 224.0.0.1
 #define IGMP_QUERY          0x11
+#define IGMP_V1_MEMBERSHIP_REPORT 0x12
 #define IGMP_MEMBERSHIP_REPORT    0x16
 #define IGMP_LEAVE_REPORT     0x17
 
+// IGMPv3 (RFC 3376) membership reports
+#define IGMP_V3_ALL_ROUTERS_IP_ADDRESS  0xE0000016  // 224.0.0.22
+#define IGMP_V3_MEMBERSHIP_REPORT       0x22
+#define IGMP_V3_MODE_IS_EXCLUDE         0x02
+#define IGMP_V3_CHANGE_TO_INCLUDE_MODE  0x03
+#define IGMP_V3_CHANGE_TO_EXCLUDE_MODE  0x04
+/* group records per report: (1024 bytes - 46 header bytes) / 8 bytes per record, rounded down - keeps
+ * the reports well inside a standard 1500 byte MTU although the transmit buffer allows for more */
+#define IGMP_V3_RECORDS_PER_REPORT      120
+
 #define IGMP_STATE_NOT_JOINED   0x1
 #define IGMP_STATE_JOINED_GROUP   0x2
 #define IGMP_STATE_LEAVING      0x3
@@ -502,6 +530,25 @@ typedef struct sIGMPHeader {
   u16 uPadding[9];
 } sIGMPHeaderT;
 
+typedef struct sIGMPv3ReportHeader {
+  u8 uReserved;
+  u8 uType;
+  u16 uChecksum;
+
+  u16 uReserved2;
+  u16 uNumRecords;
+} sIGMPv3ReportHeaderT;
+
+/* group record without any source addresses */
+typedef struct sIGMPv3GroupRecord {
+  u8 uAuxDataLength;
+  u8 uRecordType;
+  u16 uNumSources;
+
+  u16 uGroupAddressHigh;
+  u16 uGroupAddressLow;
+} sIGMPv3GroupRecordT;
+
 typedef struct sUDPHeader {
   u16  uSourcePort;
   u16  uDestinationPort;
@@ -549,6 +596,9 @@ typedef struct sDHCPHeader {
 #define CMD_STATUS_ERROR_GENERAL           1
 #define CMD_STATUS_ERROR_IF_OUT_OF_RANGE   2
 #define CMD_STATUS_ERROR_IF_NOT_PRESENT    3
+#define CMD_STATUS_ERROR_BUS               4   /* wishbone / axi bus error, e.g. address out of range */
+#define CMD_STATUS_ERROR_LENGTH            5   /* requested transfer too large or request truncated */
+#define CMD_STATUS_ERROR_TIMEOUT           6   /* condition not met in time */
 
 typedef struct sCommandHeader {
     u16  uCommandType;
@@ -1083,7 +1133,12 @@ typedef struct sGetDHCPTuningDebugResp {
   u16 uInitTime;
   u16 uRetryTime;
   u16 uStatus;
-  u16 uPadding[6];
+  /* timing of the receiving interface's dhcp, in 100ms ticks */
+  u16 uBindTime;          /* first DISCOVER / REQUEST to ACK for the last lease */
+  u16 uBindTimeMax;       /* worst case since power up */
+  u16 uBindTxCount;       /* messages sent to obtain the last lease */
+  u16 uBackoffTimeout;    /* current (randomized) retry timeout */
+  u16 uPadding[2];
 } sGetDHCPTuningDebugRespT;
 
 typedef struct sLogDataEntry{
@@ -1259,6 +1314,328 @@ typedef struct sADCMezzanineResetAndProgramResp {
   u16				uPadding[6];
 } sADCMezzanineResetAndProgramRespT;
 
+/*
+ * Interface counters are returned one interface per response since all of
+ * them do not fit into a single transmit buffer. Setting uLatch takes a new
+ * snapshot of all the interfaces at once (optionally clearing the live
+ * counters), subsequent requests with uLatch=0 read the other interfaces from
+ * the same snapshot. Each counter is 64 bits wide, sent most significant
+ * half-word first, in the tCounter index order (see if.h).
+ */
+#define IF_COUNTERS_RESP_MAX    64
+
+typedef struct sGetIFCountersReq {
+  sCommandHeaderT Header;
+  u16 uId;                /* physical interface id */
+  u16 uLatch;             /* 1 = take a new snapshot of all interfaces */
+  u16 uResetOnRead;       /* 1 = clear live counters when latching */
+} sGetIFCountersReqT;
+
+typedef struct sGetIFCountersResp {
+  sCommandHeaderT Header;
+  u16 uId;
+  u16 uStatus;
+  u16 uLinkStatus;
+  u16 uSnapshotUptimeHigh;  /* microblaze uptime (seconds) when snapshot was latched */
+  u16 uSnapshotUptimeLow;
+  u16 uNumCounters;
+  u16 uCounters[IF_COUNTERS_RESP_MAX * 4];
+  u16 uPadding[3];
+} sGetIFCountersRespT;
+
+/*
+ * Main loop utilisation statistics over the last completed window (see
+ * perfmon.h). Percentages are scaled by 100 i.e. 1234 = 12.34%. Each task
+ * entry is four half-words: load, runs in window, worst-case run time in us
+ * (high, low), in tPerfTask order.
+ */
+#define CPU_LOAD_TASKS_RESP_MAX   16
+
+typedef struct sGetCpuLoadStatsReq {
+  sCommandHeaderT Header;
+  u16 uResetMaxEver;      /* 1 = clear the worst-case loop time since boot */
+} sGetCpuLoadStatsReqT;
+
+typedef struct sGetCpuLoadStatsResp {
+  sCommandHeaderT Header;
+  u16 uLoadPercent;
+  u16 uWindowMs;
+  u16 uLoopCountHigh;
+  u16 uLoopCountLow;
+  u16 uIdleLoopCountHigh;
+  u16 uIdleLoopCountLow;
+  u16 uLoopAvgUsHigh;
+  u16 uLoopAvgUsLow;
+  u16 uLoopMaxUsHigh;
+  u16 uLoopMaxUsLow;
+  u16 uLoopMaxEverUsHigh;
+  u16 uLoopMaxEverUsLow;
+  u16 uNumTasks;
+  u16 uTasks[CPU_LOAD_TASKS_RESP_MAX * 4];
+  u16 uPadding[4];
+} sGetCpuLoadStatsRespT;
+
+/*
+ * Statistical pc-sampling profiler (see prof.h). Only functional when built
+ * with PROFILER, otherwise uStatus is CMD_STATUS_ERROR_GENERAL. A fetch
+ * returns up to PROFILER_BUCKETS_RESP_MAX histogram buckets starting at
+ * uOffset - bucket i counts the samples in the address range
+ * [i << uBucketShift, (i + 1) << uBucketShift).
+ */
+#define PROFILER_ACTION_STOP    0
+#define PROFILER_ACTION_START   1   /* clears the histogram first */
+#define PROFILER_ACTION_FETCH   2
+#define PROFILER_ACTION_CLEAR   3
+
+#define PROFILER_BUCKETS_RESP_MAX   256
+
+typedef struct sProfilerControlReq {
+  sCommandHeaderT Header;
+  u16 uAction;
+  u16 uOffset;            /* first bucket to return on fetch */
+} sProfilerControlReqT;
+
+typedef struct sProfilerControlResp {
+  sCommandHeaderT Header;
+  u16 uAction;
+  u16 uStatus;
+  u16 uRunning;
+  u16 uBucketShift;
+  u16 uNumBucketsTotal;
+  u16 uSampleRateHz;
+  u16 uTotalSamplesHigh;
+  u16 uTotalSamplesLow;
+  u16 uOutOfRangeHigh;    /* samples which fell outside of the histogram */
+  u16 uOutOfRangeLow;
+  u16 uOffset;
+  u16 uNumBuckets;        /* number of valid entries in uBuckets */
+  u16 uBuckets[PROFILER_BUCKETS_RESP_MAX];
+  u16 uPadding[1];
+} sProfilerControlRespT;
+
+/*
+ * BRAM usage report (see memmon.h). All values are in bytes. The high-water
+ * marks are the deepest stack and heap usage seen since boot.
+ */
+typedef struct sGetMemoryUsageReq {
+  sCommandHeaderT Header;
+} sGetMemoryUsageReqT;
+
+typedef struct sGetMemoryUsageResp {
+  sCommandHeaderT Header;
+  u16 uTextSizeHigh;
+  u16 uTextSizeLow;
+  u16 uRodataSizeHigh;
+  u16 uRodataSizeLow;
+  u16 uDataSizeHigh;
+  u16 uDataSizeLow;
+  u16 uBssSizeHigh;
+  u16 uBssSizeLow;
+  u16 uHeapSizeHigh;
+  u16 uHeapSizeLow;
+  u16 uHeapHighWaterHigh;
+  u16 uHeapHighWaterLow;
+  u16 uStackSizeHigh;
+  u16 uStackSizeLow;
+  u16 uStackHighWaterHigh;
+  u16 uStackHighWaterLow;
+  u16 uBramFreeHigh;
+  u16 uBramFreeLow;
+  u16 uPadding[3];
+} sGetMemoryUsageRespT;
+
+/*
+ * Arp neighbour table of an interface (see arp.h). Resolve adds a pinned peer
+ * which is resolved within 100ms and kept resolved, forget removes a peer.
+ * Every response carries the table after the action, each entry being eight
+ * half-words: ip (high, low), mac (high, mid, low), state, flags and the time
+ * spent in the current state in 100ms ticks.
+ */
+#define ARP_NEIGH_ACTION_QUERY      0
+#define ARP_NEIGH_ACTION_RESOLVE    1
+#define ARP_NEIGH_ACTION_FORGET     2
+
+#define ARP_NEIGH_ENTRIES_RESP_MAX  32
+
+typedef struct sArpNeighbourControlReq {
+  sCommandHeaderT Header;
+  u16 uId;
+  u16 uAction;
+  u16 uIPAddrHigh;        /* resolve and forget only */
+  u16 uIPAddrLow;
+} sArpNeighbourControlReqT;
+
+typedef struct sArpNeighbourControlResp {
+  sCommandHeaderT Header;
+  u16 uId;
+  u16 uAction;
+  u16 uStatus;
+  u16 uNumEntries;        /* number of valid entries in uEntries */
+  u16 uEntries[ARP_NEIGH_ENTRIES_RESP_MAX * 8];
+  u16 uPadding[1];
+} sArpNeighbourControlRespT;
+
+/*
+ * Bulk upload of fabric arp cache entries. Each entry is four half-words: the
+ * cache index (last octet of the ip address) and the mac address (high, mid,
+ * low). A whole cache needs a jumbo frame. With ARP_CACHE_UPLOAD_FLAG_READBACK
+ * every entry is read back after programming: uNumMismatches counts the
+ * entries which differ and the digest is a Fletcher-32 (mod 65535, sum1 in the
+ * low half) over the read back mac half-words in request order.
+ */
+#define ARP_CACHE_UPLOAD_ENTRIES_MAX    256
+#define ARP_CACHE_UPLOAD_FLAG_READBACK  0x1
+
+typedef struct sArpCacheUploadReq {
+  sCommandHeaderT Header;
+  u16 uId;
+  u16 uFlags;
+  u16 uNumEntries;
+  u16 uEntries[ARP_CACHE_UPLOAD_ENTRIES_MAX * 4];
+} sArpCacheUploadReqT;
+
+typedef struct sArpCacheUploadResp {
+  sCommandHeaderT Header;
+  u16 uId;
+  u16 uStatus;
+  u16 uNumProgrammed;
+  u16 uNumMismatches;
+  u16 uDigestHigh;
+  u16 uDigestLow;
+  u16 uPadding[3];
+} sArpCacheUploadRespT;
+
+/*
+ * IGMP settings and join timing of an interface. Configure selects the report
+ * version (2 or 3) and the number of IGMPv2 reports sent per 100ms tick while
+ * a group range is announced. The join timings are in microseconds from the
+ * join request to the first report and to the last report of the range being
+ * sent, zero until the first join has been announced.
+ */
+#define IGMP_CTRL_ACTION_QUERY      0
+#define IGMP_CTRL_ACTION_CONFIGURE  1
+
+typedef struct sIGMPControlReq {
+  sCommandHeaderT Header;
+  u16 uId;
+  u16 uAction;
+  u16 uVersion;           /* configure only */
+  u16 uReportsPerTick;    /* configure only */
+} sIGMPControlReqT;
+
+typedef struct sIGMPControlResp {
+  sCommandHeaderT Header;
+  u16 uId;
+  u16 uAction;
+  u16 uStatus;
+  u16 uVersion;
+  u16 uReportsPerTick;
+  u16 uState;
+  u16 uFilterAddrHigh;    /* fabric multicast filter covering all the joined ranges */
+  u16 uFilterAddrLow;
+  u16 uFilterMaskHigh;
+  u16 uFilterMaskLow;
+  u16 uJoinToFirstReportHigh;
+  u16 uJoinToFirstReportLow;
+  u16 uJoinToAnnouncedHigh;
+  u16 uJoinToAnnouncedLow;
+  u16 uPadding[3];
+} sIGMPControlRespT;
+
+/*
+ * Join or leave one of an interface's multicast group ranges, independently of
+ * the others, or query the range table. An interface id of 0xff selects the
+ * interface the command was received on. Each table entry is five half-words:
+ * base address (high, low), mask (high, low) and state (0 free, 1 joining,
+ * 2 joined, 3 leaving). The fabric filter is the single address and mask
+ * programmed to cover all the ranges.
+ */
+#define MC_RANGE_ACTION_QUERY   0
+#define MC_RANGE_ACTION_JOIN    1
+#define MC_RANGE_ACTION_LEAVE   2
+
+#define MC_RANGE_ENTRIES_RESP_MAX   8
+
+typedef struct sMulticastRangeControlReq {
+  sCommandHeaderT Header;
+  u16 uId;
+  u16 uAction;
+  u16 uBaseAddrHigh;      /* join and leave only */
+  u16 uBaseAddrLow;
+  u16 uMaskHigh;
+  u16 uMaskLow;
+} sMulticastRangeControlReqT;
+
+typedef struct sMulticastRangeControlResp {
+  sCommandHeaderT Header;
+  u16 uId;
+  u16 uAction;
+  u16 uStatus;
+  u16 uNumRanges;         /* number of entries in use */
+  u16 uFilterAddrHigh;
+  u16 uFilterAddrLow;
+  u16 uFilterMaskHigh;
+  u16 uFilterMaskLow;
+  u16 uRanges[MC_RANGE_ENTRIES_RESP_MAX * 5];
+  u16 uPadding[1];
+} sMulticastRangeControlRespT;
+
+/*
+ * Periodic telemetry push. Once started, a report is sent every uIntervalMs to
+ * the destination (unicast or multicast, ip 0 / port 0 = the client starting
+ * it) on the interface the start was received on. A report has the command
+ * type TELEMETRY_CONTROL + 1, uAction TELEMETRY_ACTION_REPORT and a sequence
+ * number counting reports, followed by uContentMask and then the selected
+ * sections in bit order:
+ *   UPTIME    uptime in seconds (high, low)
+ *   LINK      bitmap of interfaces present, bitmap of interfaces with link up
+ *   COUNTERS  per interface present: id, number of counters, then the low 32
+ *             bits of each counter (high, low) in the tCounter order (see if.h)
+ *   SENSORS   the uSensorData and uStatusBits fields of GET_SENSOR_DATA
+ * and padding to a 64-bit boundary.
+ */
+#define TELEMETRY_ACTION_QUERY    0
+#define TELEMETRY_ACTION_START    1
+#define TELEMETRY_ACTION_STOP     2
+#define TELEMETRY_ACTION_REPORT   3
+
+#define TELEMETRY_CONTENT_UPTIME    0x1
+#define TELEMETRY_CONTENT_LINK      0x2
+#define TELEMETRY_CONTENT_COUNTERS  0x4
+#define TELEMETRY_CONTENT_SENSORS   0x8   /* i2c reads - adds a few ms to each report */
+#define TELEMETRY_CONTENT_ALL       0xF
+
+#define TELEMETRY_INTERVAL_MIN_MS   100
+/* the sensor i2c reads block the main loop, keep them well apart */
+#define TELEMETRY_SENSORS_INTERVAL_MIN_MS   1000
+
+typedef struct sTelemetryControlReq {
+  sCommandHeaderT Header;
+  u16 uAction;
+  u16 uIntervalMs;        /* start only - at least TELEMETRY_SENSORS_INTERVAL_MIN_MS with sensors, at most PERF_INTERVAL_MAX_MS */
+  u16 uContentMask;       /* start only - TELEMETRY_CONTENT_* */
+  u16 uDestIPHigh;        /* start only */
+  u16 uDestIPLow;
+  u16 uDestPort;
+} sTelemetryControlReqT;
+
+typedef struct sTelemetryControlResp {
+  sCommandHeaderT Header;
+  u16 uAction;
+  u16 uStatus;
+  u16 uRunning;
+  u16 uId;                /* interface the reports are sent on */
+  u16 uIntervalMs;
+  u16 uContentMask;
+  u16 uDestIPHigh;
+  u16 uDestIPLow;
+  u16 uDestPort;
+  u16 uReportsSentHigh;
+  u16 uReportsSentLow;
+  u16 uReportsDropped;
+  u16 uPadding;
+} sTelemetryControlRespT;
+
 // I2C BUS DEFINES
 #define MB_I2C_BUS_ID       0x0
 #define MEZZANINE_0_I2C_BUS_ID    0x1
@@ -267,6 +267,286 @@ typedef struct sBigReadWishboneResp {
     u16       uReadData[994];
 } sBigReadWishboneRespT;
 
+/* Jumbo frame variants of the big read / write. These are variable length -
+ * only the words requested are carried, so they also suit small transfers.
+ * The response to the largest read (plus eth, ip and udp headers and
+ * padding to a 64-bit boundary) fits a 9000 byte MTU. */
+#ifdef WISHBONE_LEGACY_MAP
+#define BIG_WB_JUMBO_MAX_WORDS  498     /* 32-bit words - 2kB cpu transmit buffer in the legacy map */
+#else
+#define BIG_WB_JUMBO_MAX_WORDS  2238    /* 32-bit words, i.e. 4476 16-bit words */
+#endif
+
+typedef struct sBigReadWishboneJumboReq {
+  sCommandHeaderT Header;
+    u16       uStartAddressHigh;
+    u16       uStartAddressLow;
+    u16       uNumberOfReads;     /* 32-bit words, up to BIG_WB_JUMBO_MAX_WORDS */
+} sBigReadWishboneJumboReqT;
+
+typedef struct sBigReadWishboneJumboResp {
+  sCommandHeaderT Header;
+    u16       uStartAddressHigh;
+    u16       uStartAddressLow;
+    u16       uNumberOfReads;
+    u16       uStatus;            /* set according to CMD_STATUS_* macros */
+    u16       uReadData[(2 * BIG_WB_JUMBO_MAX_WORDS) + 3];  /* only (uNumberOfReads x 2) words plus
+                                                               padding to a 64-bit boundary are sent */
+} sBigReadWishboneJumboRespT;
+
+typedef struct sBigWriteWishboneJumboReq {
+  sCommandHeaderT Header;
+    u16       uStartAddressHigh;
+    u16       uStartAddressLow;
+    u16       uNumberOfWrites;    /* 32-bit words, up to BIG_WB_JUMBO_MAX_WORDS */
+    u16       uWriteData[2 * BIG_WB_JUMBO_MAX_WORDS];   /* only (uNumberOfWrites x 2) words need be sent */
+} sBigWriteWishboneJumboReqT;
+
+typedef struct sBigWriteWishboneJumboResp {
+  sCommandHeaderT Header;
+    u16       uStartAddressHigh;
+    u16       uStartAddressLow;
+    u16       uNumberOfWritesDone;
+    u16       uStatus;            /* set according to CMD_STATUS_* macros */
+    u16       uPadding[5];
+} sBigWriteWishboneJumboRespT;
+
+/* Scatter-gather wishbone read / write of a list of unrelated addresses, each
+ * with its own bus error flag. Variable length, as for the jumbo variants. */
+#ifdef WISHBONE_LEGACY_MAP
+#define SCATTER_WB_MAX_ENTRIES  320     /* 2kB cpu transmit buffer in the legacy map */
+#else
+#define SCATTER_WB_MAX_ENTRIES  1024
+#endif
+
+typedef struct sScatterReadWishboneReq {
+  sCommandHeaderT Header;
+    u16       uNumberOfReads;     /* up to SCATTER_WB_MAX_ENTRIES */
+    u16       uAddress[2 * SCATTER_WB_MAX_ENTRIES];   /* address high, low - only (uNumberOfReads x 2)
+                                                         words need be sent */
+} sScatterReadWishboneReqT;
+
+typedef struct sScatterReadWishboneResp {
+  sCommandHeaderT Header;
+    u16       uNumberOfReads;
+    u16       uStatus;            /* CMD_STATUS_ERROR_BUS if any entry had a bus error */
+    u16       uNumberOfErrors;
+    u16       uReadData[(3 * SCATTER_WB_MAX_ENTRIES) + 3];  /* bus error flag, data high, data low per
+                                                               entry - only (uNumberOfReads x 3) words plus
+                                                               padding to a 64-bit boundary are sent */
+} sScatterReadWishboneRespT;
+
+typedef struct sScatterWriteWishboneReq {
+  sCommandHeaderT Header;
+    u16       uNumberOfWrites;    /* up to SCATTER_WB_MAX_ENTRIES */
+    u16       uWriteData[4 * SCATTER_WB_MAX_ENTRIES]; /* address high, low, data high, low - only
+                                                         (uNumberOfWrites x 4) words need be sent */
+} sScatterWriteWishboneReqT;
+
+typedef struct sScatterWriteWishboneResp {
+  sCommandHeaderT Header;
+    u16       uNumberOfWrites;
+    u16       uStatus;            /* CMD_STATUS_ERROR_BUS if any entry had a bus error */
+    u16       uNumberOfErrors;
+    u16       uErrorFlags[SCATTER_WB_MAX_ENTRIES + 3];  /* bus error flag per entry - only uNumberOfWrites
+                                                           words plus padding to a 64-bit boundary
+                                                           are sent */
+} sScatterWriteWishboneRespT;
+
+/* Read-modify-write of a single board, dsp or wishbone register, done within
+ * one command so that no other request can interleave. Board registers are
+ * modified from their shadow copy since they do not read back what was written. */
+#define RMW_OP_MASKED   0     /* new = (old & ~mask) | (value & mask) */
+#define RMW_OP_SET      1     /* new = old | mask */
+#define RMW_OP_CLEAR    2     /* new = old & ~mask */
+#define RMW_OP_TOGGLE   3     /* new = old ^ mask */
+
+typedef struct sReadModifyWriteRegReq {
+  sCommandHeaderT Header;
+    u16       uRegSpace;          /* BOARD_REG, DSP_REG or WISHBONE_REG */
+    u16       uOperation;         /* RMW_OP_* */
+    u16       uRegAddressHigh;
+    u16       uRegAddressLow;
+    u16       uValueHigh;         /* only used by RMW_OP_MASKED */
+    u16       uValueLow;
+    u16       uMaskHigh;
+    u16       uMaskLow;
+} sReadModifyWriteRegReqT;
+
+typedef struct sReadModifyWriteRegResp {
+  sCommandHeaderT Header;
+    u16       uRegSpace;
+    u16       uOperation;
+    u16       uRegAddressHigh;
+    u16       uRegAddressLow;
+    u16       uOldValueHigh;
+    u16       uOldValueLow;
+    u16       uNewValueHigh;
+    u16       uNewValueLow;
+    u16       uStatus;            /* set according to CMD_STATUS_* macros */
+} sReadModifyWriteRegRespT;
+
+/* Poll a wishbone register until (value & mask) == expected or the timeout
+ * expires. The polling is done from the main loop and the single response is
+ * only sent once the poll completes. */
+typedef struct sPollWishboneReq {
+  sCommandHeaderT Header;
+    u16       uAddressHigh;
+    u16       uAddressLow;
+    u16       uMaskHigh;
+    u16       uMaskLow;
+    u16       uExpectedHigh;
+    u16       uExpectedLow;
+    u16       uIntervalUs;        /* time between reads, 0 = every pass of the main loop */
+    u16       uTimeoutMs;         /* 0 = read once, at most PERF_INTERVAL_MAX_MS */
+} sPollWishboneReqT;
+
+typedef struct sPollWishboneResp {
+  sCommandHeaderT Header;
+    u16       uAddressHigh;
+    u16       uAddressLow;
+    u16       uStatus;            /* CMD_STATUS_ERROR_TIMEOUT if the condition was not met */
+    u16       uConditionMet;
+    u16       uValueHigh;         /* last value read */
+    u16       uValueLow;
+    u16       uElapsedUsHigh;
+    u16       uElapsedUsLow;
+    u16       uIterationsHigh;    /* number of reads */
+    u16       uIterationsLow;
+    u16       uPadding[3];
+} sPollWishboneRespT;
+
+/* Register watch list. Up to WATCH_ENTRIES_MAX board, dsp or wishbone registers
+ * are sampled from the main loop and a notification (WATCH_REGISTER_CONTROL + 1,
+ * uAction = WATCH_ACTION_NOTIFY, header sequence number counting notifications)
+ * is sent to the destination whenever a masked value changes, at most once per
+ * entry per its minimum interval. The destination defaults to the client which
+ * added the first entry; another one must be on-link or a multicast group. */
+#define WATCH_ENTRIES_MAX     16
+
+#define WATCH_ACTION_STATUS   0
+#define WATCH_ACTION_ADD      1
+#define WATCH_ACTION_REMOVE   2     /* entry uIndex */
+#define WATCH_ACTION_CLEAR    3
+#define WATCH_ACTION_DEST     4     /* set the destination, ip 0 = this client */
+#define WATCH_ACTION_NOTIFY   5
+
+typedef struct sWatchRegisterControlReq {
+  sCommandHeaderT Header;
+    u16       uAction;            /* WATCH_ACTION_* */
+    u16       uIndex;
+    u16       uRegSpace;          /* BOARD_REG, DSP_REG or WISHBONE_REG */
+    u16       uRegAddressHigh;
+    u16       uRegAddressLow;
+    u16       uMaskHigh;
+    u16       uMaskLow;
+    u16       uMinIntervalMs;     /* minimum time between notifications of this entry,
+                                     at most PERF_INTERVAL_MAX_MS */
+    u16       uDestIPHigh;
+    u16       uDestIPLow;
+    u16       uDestPort;
+} sWatchRegisterControlReqT;
+
+typedef struct sWatchEntryResp {
+    u16       uRegSpace;          /* 0 = entry free */
+    u16       uRegAddressHigh;
+    u16       uRegAddressLow;
+    u16       uMaskHigh;
+    u16       uMaskLow;
+    u16       uMinIntervalMs;
+    u16       uValueHigh;         /* last value notified (or sampled when added) */
+    u16       uValueLow;
+} sWatchEntryRespT;
+
+typedef struct sWatchRegisterControlResp {
+  sCommandHeaderT Header;
+    u16       uAction;
+    u16       uStatus;            /* set according to CMD_STATUS_* macros */
+    u16       uIndex;             /* entry added */
+    u16       uNumEntries;
+    u16       uDestIPHigh;
+    u16       uDestIPLow;
+    u16       uDestPort;
+    u16       uNotificationsSentHigh;
+    u16       uNotificationsSentLow;
+    u16       uNotificationsDropped;
+    sWatchEntryRespT Entries[WATCH_ENTRIES_MAX];
+    u16       uPadding[3];
+} sWatchRegisterControlRespT;
+
+typedef struct sWatchNotifyEntry {
+    u16       uIndex;
+    u16       uRegAddressHigh;
+    u16       uRegAddressLow;
+    u16       uValueHigh;
+    u16       uValueLow;
+} sWatchNotifyEntryT;
+
+typedef struct sWatchNotify {
+  sCommandHeaderT Header;         /* sequence number counts notifications */
+    u16       uAction;            /* WATCH_ACTION_NOTIFY */
+    u16       uNumEntries;
+    sWatchNotifyEntryT Entries[WATCH_ENTRIES_MAX];
+    u16       uPadding[4];        /* only uNumEntries entries plus padding to a 64-bit boundary are sent */
+} sWatchNotifyT;
+
+/* Streamed wishbone region read. A START request is acknowledged and the region
+ * is then sent as a numbered sequence of DATA frames (same opcode response,
+ * uAction = STREAM_ACTION_DATA) at wire pace or with the requested frame gap.
+ * The host requests lost frames again with a NACK carrying their sequence
+ * numbers. STATUS and ABORT act on the current stream. */
+#define STREAM_ACTION_STATUS  0
+#define STREAM_ACTION_START   1
+#define STREAM_ACTION_NACK    2
+#define STREAM_ACTION_ABORT   3
+#define STREAM_ACTION_DATA    4
+
+#define STREAM_NACK_MAX             32
+#define STREAM_WORDS_PER_FRAME_MAX  (BIG_WB_JUMBO_MAX_WORDS - 4)  /* data frame header is 8 bytes
+                                                                     longer than the jumbo read's */
+
+typedef struct sStreamReadWishboneReq {
+  sCommandHeaderT Header;
+    u16       uAction;            /* STREAM_ACTION_* */
+    u16       uStreamId;          /* chosen by the host, echoed in every frame */
+    u16       uStartAddressHigh;
+    u16       uStartAddressLow;
+    u16       uLengthHigh;        /* 32-bit words to read */
+    u16       uLengthLow;
+    u16       uStride;            /* bytes between words read, 0 = 4 i.e. contiguous */
+    u16       uWordsPerFrame;     /* 0 = STREAM_WORDS_PER_FRAME_MAX */
+    u16       uFrameGapUs;        /* minimum time between frames, 0 = wire pace */
+    u16       uNumNacks;
+    u16       uNackSeq[STREAM_NACK_MAX];  /* only uNumNacks entries need be sent */
+} sStreamReadWishboneReqT;
+
+typedef struct sStreamReadWishboneResp {
+  sCommandHeaderT Header;
+    u16       uAction;
+    u16       uStreamId;
+    u16       uStatus;            /* set according to CMD_STATUS_* macros */
+    u16       uActive;
+    u16       uTotalFrames;
+    u16       uNextFrame;
+    u16       uWordsPerFrame;
+    u16       uRetransmitPending;
+    u16       uFramesRetransmitted;
+} sStreamReadWishboneRespT;
+
+typedef struct sStreamReadWishboneDataResp {
+  sCommandHeaderT Header;         /* sequence number of the START request */
+    u16       uAction;            /* STREAM_ACTION_DATA */
+    u16       uStreamId;
+    u16       uFrameSeq;
+    u16       uTotalFrames;
+    u16       uStatus;            /* CMD_STATUS_ERROR_BUS if a bus error occurred reading this frame */
+    u16       uAddressHigh;       /* address of the first word in this frame */
+    u16       uAddressLow;
+    u16       uNumberOfReads;     /* 32-bit words in this frame */
+    u16       uReadData[(2 * STREAM_WORDS_PER_FRAME_MAX) + 3];  /* only (uNumberOfReads x 2) words plus
+                                                                   padding to a 64-bit boundary are sent */
+} sStreamReadWishboneDataRespT;
+
 // packet structure for NACK response
 typedef struct sInvalidOpcodeResp {
   sCommandHeaderT Header;
@@ -42,14 +42,22 @@ static typeDHCPState rebind_dhcp_state(struct sIFObject *pIFObjectPtr);
 static u8 uDHCPBuildMessage(struct sIFObject *pIFObjectPtr, typeDHCPMessage tDHCPMsgType, typeDHCPMessageFlags tDHCPMsgFlags);
 static typeDHCPMessage tDHCPProcessMsg(struct sIFObject *pIFObjectPtr);
 
+static u8 uDHCPIndexOptions(struct sIFObject *pIFObjectPtr, u16 uOptionIndex, u16 uOptionLimit);
+static u32 uDHCPOptionU32(u8 *pBuffer, u16 uOffset);
+
 static u8 uDHCPWait(struct sIFObject *pIFObjectPtr);
 static u32 uDHCPRandomNumber(u32 uSeed);
+static u32 uDHCPRandomRange(struct sIFObject *pIFObjectPtr, u32 uRange);
+static void vDHCPNextBackoff(struct sIFObject *pIFObjectPtr, u8 uGrow);
 
 static void vDHCPAuxClearFlag(u8 *pFlagRegister, typeDHCPRegisterFlags tBitPosition);
 static void vDHCPAuxSetFlag(u8 *pFlagRegister, typeDHCPRegisterFlags tBitPosition);
 static typeDHCPFlagStatus tDHCPAuxTestFlag(u8 *pFlagRegister, typeDHCPRegisterFlags tBitPosition);
 
 /* some global declarations */
+/* xorshift32 state used to randomize the retry timing, see vDHCPSetRandomSeed() */
+static u32 uDHCPRandomState = 0;
+
 static dhcp_state_func_ptr dhcp_state_table[] = {
   [INIT]      = init_dhcp_state,
   [RANDOMIZE] = randomize_dhcp_state,
@@ -71,6 +79,27 @@ static const char *dhcp_msg_string_lookup[] = {
   [DHCPINFORM]    = "INFORM"
 };
 
+/* option codes and minimum value lengths of the indexed options */
+static const u8 dhcp_option_index_codes[DHCP_OPT_IDX_MAX] = {
+  [DHCP_OPT_IDX_MSG_TYPE]   = 53,
+  [DHCP_OPT_IDX_SUBNET]     = 1,
+  [DHCP_OPT_IDX_ROUTER]     = 3,
+  [DHCP_OPT_IDX_LEASE_TIME] = 51,
+  [DHCP_OPT_IDX_T1]         = 58,
+  [DHCP_OPT_IDX_T2]         = 59,
+  [DHCP_OPT_IDX_SERVER_ID]  = 54
+};
+
+static const u8 dhcp_option_index_min_len[DHCP_OPT_IDX_MAX] = {
+  [DHCP_OPT_IDX_MSG_TYPE]   = 1,
+  [DHCP_OPT_IDX_SUBNET]     = 4,
+  [DHCP_OPT_IDX_ROUTER]     = 4,
+  [DHCP_OPT_IDX_LEASE_TIME] = 4,
+  [DHCP_OPT_IDX_T1]         = 4,
+  [DHCP_OPT_IDX_T2]         = 4,
+  [DHCP_OPT_IDX_SERVER_ID]  = 4
+};
+
 /*********** Sanity Checks ***************/
 #ifdef DO_SANITY_CHECKS
 #define SANE_DHCP(IFobject) if (SanityCheckDHCP(IFobject)) { return DHCP_RETURN_FAIL; }
@@ -195,6 +224,14 @@ u8 uDHCPInit(struct sIFObject *pIFObjectPtr){
   pDHCPObjectPtr->uDHCPSMRetryInterval = DHCP_SM_INTERVAL;
   pDHCPObjectPtr->uDHCPSMInitWait = DHCP_SM_WAIT;
 
+  pDHCPObjectPtr->uDHCPBackoffTimeout = DHCP_SM_INTERVAL;
+  pDHCPObjectPtr->uDHCPBackoffExp = 0;
+  pDHCPObjectPtr->uDHCPAttemptStartTick = 0;
+  pDHCPObjectPtr->uDHCPAttemptTxCount = 0;
+  pDHCPObjectPtr->uDHCPBindTime = 0;
+  pDHCPObjectPtr->uDHCPBindTimeMax = 0;
+  pDHCPObjectPtr->uDHCPBindTxCount = 0;
+
   pDHCPObjectPtr->uDHCPT1 = 0;
   pDHCPObjectPtr->uDHCPT2 = 0;
   pDHCPObjectPtr->uDHCPLeaseTime = 0;
@@ -214,6 +251,10 @@ u8 uDHCPInit(struct sIFObject *pIFObjectPtr){
     pDHCPObjectPtr->arrDHCPHostName[uLoopIndex] = '\0';
   }
 
+  for (uLoopIndex = 0; uLoopIndex < DHCP_OPT_IDX_MAX; uLoopIndex++){
+    pDHCPObjectPtr->arrDHCPOptionOffset[uLoopIndex] = 0;
+  }
+
   pDHCPObjectPtr->callbackOnLeaseAcqd = NULL;
   pDHCPObjectPtr->pLeaseDataPtr = NULL;
   pDHCPObjectPtr->callbackOnMsgBuilt = NULL;
@@ -247,6 +288,7 @@ u8 uDHCPMessageValidate(struct sIFObject *pIFObjectPtr){
   u8 uIPLen;
   u8 uIndex;
   u8 *pUserBufferPtr;
+  u16 uUDPEnd;
   //u16 uCheckTemp = 0;
   //u8 uPseudoHdr[12] = {0};
   //u16 uUDPLength = 0;
@@ -269,6 +311,17 @@ u8 uDHCPMessageValidate(struct sIFObject *pIFObjectPtr){
     return DHCP_RETURN_INVALID;
   }
 
+  /* the options may not run past the end of the udp payload or the rx buffer */
+  uUDPEnd = ((u16) pUserBufferPtr[uIPLen + UDP_FRAME_BASE + UDP_ULEN_OFFSET] << 8) | pUserBufferPtr[uIPLen + UDP_FRAME_BASE + UDP_ULEN_OFFSET + 1];
+  uUDPEnd = uUDPEnd + uIPLen + UDP_FRAME_BASE;
+  if (uUDPEnd > pIFObjectPtr->uUserRxBufferSize){
+    uUDPEnd = pIFObjectPtr->uUserRxBufferSize;
+  }
+
+  if (uUDPEnd < (uIPLen + DHCP_OPTIONS_BASE + 4)){
+    return DHCP_RETURN_INVALID;
+  }
+
   if (memcmp(pUserBufferPtr + uIPLen + DHCP_OPTIONS_BASE, arrDHCPCookie, 4) != 0){                 /*dhcp magic cookie?*/
     return DHCP_RETURN_INVALID;
   }
@@ -291,6 +344,12 @@ u8 uDHCPMessageValidate(struct sIFObject *pIFObjectPtr){
     return DHCP_RETURN_INVALID;
   }
 
+  /* only our own replies get this far - walk and index the options once, past
+   * the magic cookie, rejecting malformed option areas here */
+  if (uDHCPIndexOptions(pIFObjectPtr, uIPLen + DHCP_OPTIONS_BASE + 4, uUDPEnd) != DHCP_RETURN_OK){
+    return DHCP_RETURN_INVALID;
+  }
+
 #if 0 /* NOW HANDLED BY LOWER LAYER */
   /* IP checksum validation*/
   RetVal = uChecksum16Calc(pUserBufferPtr, IP_FRAME_BASE, UDP_FRAME_BASE + uIPLen - 1, &uCheckTemp, 0, 0);
@@ -614,6 +673,46 @@ u8 uDHCPSetRequestCachedIP(struct sIFObject *pIFObjectPtr, u32 uCachedIP){
 }
 
 
+//=================================================================================
+//  uDHCPRequestHeldLease
+//---------------------------------------------------------------------------------
+//  This method restarts and enables the state machine by requesting the last
+//  lease obtained (RFC 2131 INIT-REBOOT) straight away, i.e. without the init
+//  wait. It is used to confirm a lease still held when a link comes back up.
+//  Should the request go unanswered or be nak'ed, the state machine carries on
+//  as it does for a cached IP.
+//
+//  Parameter       Dir   Description
+//  ---------       ---   -----------
+//  pIFObjectPtr    IN    handle to IF state object
+//
+//  Return
+//  ------
+//  DHCP_RETURN_OK or DHCP_RETURN_FAIL if no lease has been obtained before
+//=================================================================================
+u8 uDHCPRequestHeldLease(struct sIFObject *pIFObjectPtr){
+  struct sDHCPObject *pDHCPObjectPtr;
+
+  SANE_DHCP(pIFObjectPtr);
+
+  pDHCPObjectPtr = &(pIFObjectPtr->DHCPContextState);
+
+  if ((pDHCPObjectPtr->arrDHCPAddrYIPCached[0] | pDHCPObjectPtr->arrDHCPAddrYIPCached[1] |
+        pDHCPObjectPtr->arrDHCPAddrYIPCached[2] | pDHCPObjectPtr->arrDHCPAddrYIPCached[3]) == 0){
+    return DHCP_RETURN_FAIL;
+  }
+
+  vDHCPAuxSetFlag(&(pDHCPObjectPtr->uDHCPRegisterFlags), flagDHCP_SM_USE_CACHED_IP);
+  vDHCPAuxSetFlag(&(pDHCPObjectPtr->uDHCPRegisterFlags), flagDHCP_SM_STATE_MACHINE_EN);
+
+  /* run the init state and send the request now rather than on the following ticks */
+  pDHCPObjectPtr->tDHCPCurrentState = init_dhcp_state(pIFObjectPtr);
+  pDHCPObjectPtr->uDHCPRandomWait = 0;
+  pDHCPObjectPtr->tDHCPCurrentState = randomize_dhcp_state(pIFObjectPtr);
+
+  return DHCP_RETURN_OK;
+}
+
 //=================================================================================
 //  uDHCPGetBoundStatus
 //---------------------------------------------------------------------------------
@@ -881,6 +980,8 @@ static typeDHCPState init_dhcp_state(struct sIFObject *pIFObjectPtr){
   pDHCPObjectPtr->uDHCPInternalTimer = 0;
   pDHCPObjectPtr->uDHCPTimeout = 0;
   pDHCPObjectPtr->uDHCPRebootReqs = 0;
+  pDHCPObjectPtr->uDHCPBackoffExp = 0;
+  pDHCPObjectPtr->uDHCPAttemptTxCount = 0;
 
 #if 0
   pDHCPObjectPtr->uDHCPRandomWait = pDHCPObjectPtr->uDHCPRandomWaitCached;     /* wait a prerequisite amount of time before dhcp'ing. This is done
@@ -888,7 +989,10 @@ static typeDHCPState init_dhcp_state(struct sIFObject *pIFObjectPtr){
 #endif
 
   /* FIXME NOTE: removed "mac hashing randomized wait" */
-  pDHCPObjectPtr->uDHCPRandomWait = 0; 
+  /* stagger the first DISCOVER across this board's interfaces and, by way of
+   * the board seeded random share, across the boards in a rack */
+  pDHCPObjectPtr->uDHCPRandomWait = (pIFObjectPtr->uIFEthernetId * DHCP_SM_STAGGER) +
+    uDHCPRandomRange(pIFObjectPtr, DHCP_SM_STAGGER_WINDOW);
 
   if (tDHCPAuxTestFlag(&(pDHCPObjectPtr->uDHCPRegisterFlags), flagDHCP_SM_INIT_WAIT_EN) == statusSET){
     pDHCPObjectPtr->uDHCPRandomWait += pDHCPObjectPtr->uDHCPSMInitWait; /* add an extra fixed offset to the dhcp init waiting time */
@@ -959,6 +1063,10 @@ static typeDHCPState randomize_dhcp_state(struct sIFObject *pIFObjectPtr){
 
       pDHCPObjectPtr->uDHCPRebootReqs++;
       pDHCPObjectPtr->uDHCPTimeout = 0;       /* reset timeout counter  */
+      /* the INIT-REBOOT requests are bounded by DHCP_REBOOTING_REQS_MAX so only
+       * randomize these, don't grow the timeout - else the fallback to DISCOVER
+       * takes too long */
+      vDHCPNextBackoff(pIFObjectPtr, 0);
       return REQUEST;   /* skip DHCPDiscover message */
     } else {
       if (uDHCPBuildMessage(pIFObjectPtr, DHCPDISCOVER, (1<<flagDHCP_MSG_DHCP_VENDID | 1<<flagDHCP_MSG_DHCP_RESET_SEC | 1<<flagDHCP_MSG_DHCP_NEW_XID))){
@@ -971,6 +1079,7 @@ static typeDHCPState randomize_dhcp_state(struct sIFObject *pIFObjectPtr){
       /* progress to the next state even on failure in order for timeout to catch the error */
       /* this prevents us getting stuck in this state */
       pDHCPObjectPtr->uDHCPTimeout = 0;       /* reset timeout counter  */
+      vDHCPNextBackoff(pIFObjectPtr, 1);
       return SELECT;
     }
   }
@@ -1019,7 +1128,7 @@ static typeDHCPState select_dhcp_state(struct sIFObject *pIFObjectPtr){
 
   /* Give up "selecting" after a N seconds, where N is user selected.
      Go back to the previous state in order to resend DISCOVER packet. */
-  if (pDHCPObjectPtr->uDHCPTimeout >= pDHCPObjectPtr->uDHCPSMRetryInterval){
+  if (pDHCPObjectPtr->uDHCPTimeout >= pDHCPObjectPtr->uDHCPBackoffTimeout){
     pDHCPObjectPtr->uDHCPRandomWait = 0;    /* set to zero -> don't wait in RANDOMIZE state, send DISCOVER immediately */
     return RANDOMIZE;
   }
@@ -1128,6 +1237,18 @@ static typeDHCPState request_dhcp_state(struct sIFObject *pIFObjectPtr){
       }
       vDHCPAuxSetFlag(&(pDHCPObjectPtr->uDHCPRegisterFlags), flagDHCP_SM_LEASE_OBTAINED);
 
+      /* record how long this lease took to obtain */
+      pDHCPObjectPtr->uDHCPBindTime = pDHCPObjectPtr->uDHCPCurrentClkTick - pDHCPObjectPtr->uDHCPAttemptStartTick;
+      if (pDHCPObjectPtr->uDHCPBindTime > pDHCPObjectPtr->uDHCPBindTimeMax){
+        pDHCPObjectPtr->uDHCPBindTimeMax = pDHCPObjectPtr->uDHCPBindTime;
+      }
+      pDHCPObjectPtr->uDHCPBindTxCount = pDHCPObjectPtr->uDHCPAttemptTxCount;
+      pDHCPObjectPtr->uDHCPAttemptTxCount = 0;
+      pDHCPObjectPtr->uDHCPBackoffExp = 0;
+
+      log_printf(LOG_SELECT_DHCP, LOG_LEVEL_INFO, "DHCP [%02x] Bound after %d ms and %d tx\r\n",
+          pIFObjectPtr->uIFEthernetId, pDHCPObjectPtr->uDHCPBindTime * POLL_INTERVAL, pDHCPObjectPtr->uDHCPBindTxCount);
+
       /* invoke a callback once the lease is acquired */
       if (pDHCPObjectPtr->callbackOnLeaseAcqd != NULL){
         (*(pDHCPObjectPtr->callbackOnLeaseAcqd))(pIFObjectPtr, pDHCPObjectPtr->pLeaseDataPtr);
@@ -1148,7 +1269,7 @@ static typeDHCPState request_dhcp_state(struct sIFObject *pIFObjectPtr){
 
   /* Give up "requesting" after a N seconds, where N is user selected.
      Go back to the previous state in order to resend DISCOVER packet. */
-  if (pDHCPObjectPtr->uDHCPTimeout >= pDHCPObjectPtr->uDHCPSMRetryInterval){
+  if (pDHCPObjectPtr->uDHCPTimeout >= pDHCPObjectPtr->uDHCPBackoffTimeout){
     pDHCPObjectPtr->uDHCPRandomWait = 0;    /* set to zero -> don't wait in RANDOMIZE state, send DISCOVER immediately */
     return RANDOMIZE;
   }
@@ -1201,6 +1322,8 @@ static typeDHCPState bound_dhcp_state(struct sIFObject *pIFObjectPtr){
       pDHCPObjectPtr->uDHCPRandomWait = 0;
       pDHCPObjectPtr->uDHCPRetries = 0;
       pDHCPObjectPtr->uDHCPInitUnboundTimer = 0;
+      pDHCPObjectPtr->uDHCPBackoffExp = 0;
+      pDHCPObjectPtr->uDHCPAttemptTxCount = 0;
       return RANDOMIZE;
     }
   }
@@ -1315,6 +1438,8 @@ static typeDHCPState rebind_dhcp_state(struct sIFObject *pIFObjectPtr){
       pDHCPObjectPtr->uDHCPRandomWait = 0;
       pDHCPObjectPtr->uDHCPRetries = 0;
       pDHCPObjectPtr->uDHCPInitUnboundTimer = 0;
+      pDHCPObjectPtr->uDHCPBackoffExp = 0;
+      pDHCPObjectPtr->uDHCPAttemptTxCount = 0;
     }
     return RANDOMIZE;
   }
@@ -1617,10 +1742,7 @@ static u8 uDHCPBuildMessage(struct sIFObject *pIFObjectPtr, typeDHCPMessage tDHC
 //  typeDHCPMessage (enumerated type)
 //=================================================================================
 static typeDHCPMessage tDHCPProcessMsg(struct sIFObject *pIFObjectPtr){
-  u16 uOptionIndex = 0;
-  u16 uOptionEnd = 0;
-  u8 uOption = 0;
-  u8 uTmpIndex = 0;
+  u16 *pOffset;
 
   u8 uIPLen = 0;
   u8 *pBuffer;
@@ -1687,65 +1809,36 @@ static typeDHCPMessage tDHCPProcessMsg(struct sIFObject *pIFObjectPtr){
   /* get mac address of the "next-hop" server/router which sent us this packet */
   memcpy(pDHCPObjectPtr->arrDHCPNextHopMacCached, pBuffer + ETH_SRC_OFFSET, 6);
 
-  /* add 4 to jump past dhcp magic cookie in data buffer */
-  uOptionIndex = uIPLen + DHCP_OPTIONS_BASE + 4;
+  /* the options were indexed (and checked for overruns) in uDHCPMessageValidate() */
+  pOffset = pDHCPObjectPtr->arrDHCPOptionOffset;
 
-  /* TODO: FIXME here we need to constantly check for buffer overruns */
-
-  while(uOptionEnd == 0){
-    uOption = pBuffer[uOptionIndex];
-
-    switch(uOption){
-      case 53:        /* message type */
-        tDHCPMsgType = (typeDHCPMessage) pBuffer[uOptionIndex + 2];
-        uOptionIndex = uOptionIndex + 3; 
-        break;
-
-      case 1:         /* subnet mask */
-        memcpy(pDHCPObjectPtr->arrDHCPAddrSubnetMask, pBuffer + uOptionIndex + 2, 4);
-        uOptionIndex = uOptionIndex + pBuffer[uOptionIndex + 1] + 2;
-        break;
-
-      case 3:         /* router */
-        memcpy(pDHCPObjectPtr->arrDHCPAddrRoute, pBuffer + uOptionIndex + 2, 4);
-        uOptionIndex = uOptionIndex + pBuffer[uOptionIndex + 1] + 2;
-        break;
+  if (pOffset[DHCP_OPT_IDX_MSG_TYPE]){
+    tDHCPMsgType = (typeDHCPMessage) pBuffer[pOffset[DHCP_OPT_IDX_MSG_TYPE]];
+  }
 
-      case 51:        //lease time
-        for (uTmpIndex = 0; uTmpIndex < 4; uTmpIndex++){
-          pDHCPObjectPtr->uDHCPLeaseTime = (pDHCPObjectPtr->uDHCPLeaseTime << 8) + pBuffer[uOptionIndex + 2 + uTmpIndex];
-        }
-        uOptionIndex = uOptionIndex + pBuffer[uOptionIndex + 1] + 2;
-        break;
+  if (pOffset[DHCP_OPT_IDX_SUBNET]){
+    memcpy(pDHCPObjectPtr->arrDHCPAddrSubnetMask, pBuffer + pOffset[DHCP_OPT_IDX_SUBNET], 4);
+  }
 
-      case 58:        //Renewal (T1) Time Value
-        for (uTmpIndex = 0; uTmpIndex < 4; uTmpIndex++){
-          pDHCPObjectPtr->uDHCPT1 = (pDHCPObjectPtr->uDHCPT1 << 8) + pBuffer[uOptionIndex + 2 + uTmpIndex];
-        }
-        uOptionIndex = uOptionIndex + pBuffer[uOptionIndex + 1] + 2;
-        break;
+  if (pOffset[DHCP_OPT_IDX_ROUTER]){
+    memcpy(pDHCPObjectPtr->arrDHCPAddrRoute, pBuffer + pOffset[DHCP_OPT_IDX_ROUTER], 4);
+  }
 
-      case 59:        //Rebinding (T2) Time Value
-        for (uTmpIndex = 0; uTmpIndex < 4; uTmpIndex++){
-          pDHCPObjectPtr->uDHCPT2 = (pDHCPObjectPtr->uDHCPT2 << 8) + pBuffer[uOptionIndex + 2 + uTmpIndex];
-        }
-        uOptionIndex = uOptionIndex + pBuffer[uOptionIndex + 1] + 2;
-        break;
+  if (pOffset[DHCP_OPT_IDX_LEASE_TIME]){
+    pDHCPObjectPtr->uDHCPLeaseTime = uDHCPOptionU32(pBuffer, pOffset[DHCP_OPT_IDX_LEASE_TIME]);
+  }
 
-        /* get the server addr - retrieved from the Server ID dhcp option included in DHCPOFFER (see rfc 2132, par 9.7) */
-      case 54:        //Server ID
-        memcpy(pDHCPObjectPtr->arrDHCPAddrServerCached, pBuffer + uOptionIndex + 2, 4);
-        uOptionIndex = uOptionIndex + pBuffer[uOptionIndex + 1] + 2;
-        break;
+  if (pOffset[DHCP_OPT_IDX_T1]){      /* Renewal (T1) Time Value */
+    pDHCPObjectPtr->uDHCPT1 = uDHCPOptionU32(pBuffer, pOffset[DHCP_OPT_IDX_T1]);
+  }
 
-      case 255:       //end option
-        uOptionEnd = 1;
-        break;
+  if (pOffset[DHCP_OPT_IDX_T2]){      /* Rebinding (T2) Time Value */
+    pDHCPObjectPtr->uDHCPT2 = uDHCPOptionU32(pBuffer, pOffset[DHCP_OPT_IDX_T2]);
+  }
 
-      default:
-        uOptionIndex = uOptionIndex + pBuffer[uOptionIndex + 1] + 2;
-        break;
-    }
+  /* get the server addr - retrieved from the Server ID dhcp option included in DHCPOFFER (see rfc 2132, par 9.7) */
+  if (pOffset[DHCP_OPT_IDX_SERVER_ID]){
+    memcpy(pDHCPObjectPtr->arrDHCPAddrServerCached, pBuffer + pOffset[DHCP_OPT_IDX_SERVER_ID], 4);
   }
 
   if (DHCPNAK != tDHCPMsgType){
@@ -1762,6 +1855,106 @@ static typeDHCPMessage tDHCPProcessMsg(struct sIFObject *pIFObjectPtr){
 
 /**********  Some auxiliary functions **********/
 
+//=================================================================================
+//  uDHCPIndexOptions
+//---------------------------------------------------------------------------------
+//  This method walks the options area of a received message once and records the
+//  value offset of each of the options listed in dhcp_option_index_codes[], so
+//  that they can be looked up directly when the message is processed. The first
+//  instance of an option is used. Options too short to hold their value are
+//  treated as absent.
+//
+//  Parameter       Dir   Description
+//  ---------       ---   -----------
+//  pIFObjectPtr    IN    handle to IF state object
+//  uOptionIndex    IN    offset of the first option (past the magic cookie)
+//  uOptionLimit    IN    offset one past the last valid byte of the message
+//
+//  Return
+//  ------
+//  DHCP_RETURN_OK, or DHCP_RETURN_INVALID if an option runs past uOptionLimit,
+//  the end option is missing or the message type is missing / unknown
+//=================================================================================
+static u8 uDHCPIndexOptions(struct sIFObject *pIFObjectPtr, u16 uOptionIndex, u16 uOptionLimit){
+  struct sDHCPObject *pDHCPObjectPtr;
+  u8 *pBuffer;
+  u8 uOption;
+  u8 uLength;
+  u8 uSlot;
+  u8 uMsgType;
+
+  pDHCPObjectPtr = &(pIFObjectPtr->DHCPContextState);
+  pBuffer = pIFObjectPtr->pUserRxBufferPtr;
+
+  for (uSlot = 0; uSlot < DHCP_OPT_IDX_MAX; uSlot++){
+    pDHCPObjectPtr->arrDHCPOptionOffset[uSlot] = 0;
+  }
+
+  while (uOptionIndex < uOptionLimit){
+    uOption = pBuffer[uOptionIndex];
+
+    if (uOption == 0){          /* pad option */
+      uOptionIndex++;
+      continue;
+    }
+
+    if (uOption == 255){        /* end option */
+      if (pDHCPObjectPtr->arrDHCPOptionOffset[DHCP_OPT_IDX_MSG_TYPE] == 0){
+        return DHCP_RETURN_INVALID;
+      }
+
+      uMsgType = pBuffer[pDHCPObjectPtr->arrDHCPOptionOffset[DHCP_OPT_IDX_MSG_TYPE]];
+      if ((uMsgType < DHCPDISCOVER) || (uMsgType > DHCPINFORM)){
+        return DHCP_RETURN_INVALID;
+      }
+
+      return DHCP_RETURN_OK;
+    }
+
+    if ((uOptionIndex + 2) > uOptionLimit){
+      return DHCP_RETURN_INVALID;
+    }
+
+    uLength = pBuffer[uOptionIndex + 1];
+    if ((uOptionIndex + 2 + uLength) > uOptionLimit){
+      return DHCP_RETURN_INVALID;
+    }
+
+    for (uSlot = 0; uSlot < DHCP_OPT_IDX_MAX; uSlot++){
+      if (dhcp_option_index_codes[uSlot] == uOption){
+        if ((pDHCPObjectPtr->arrDHCPOptionOffset[uSlot] == 0) && (uLength >= dhcp_option_index_min_len[uSlot])){
+          pDHCPObjectPtr->arrDHCPOptionOffset[uSlot] = uOptionIndex + 2;
+        }
+        break;
+      }
+    }
+
+    uOptionIndex = uOptionIndex + 2 + uLength;
+  }
+
+  /* ran off the end without seeing the end option */
+  return DHCP_RETURN_INVALID;
+}
+
+//=================================================================================
+//  uDHCPOptionU32
+//---------------------------------------------------------------------------------
+//  This method reads a 32-bit big endian option value.
+//
+//  Parameter       Dir   Description
+//  ---------       ---   -----------
+//  pBuffer         IN    rx buffer
+//  uOffset         IN    offset of the option value
+//
+//  Return
+//  ------
+//  the option value
+//=================================================================================
+static u32 uDHCPOptionU32(u8 *pBuffer, u16 uOffset){
+  return ((u32) pBuffer[uOffset] << 24) | ((u32) pBuffer[uOffset + 1] << 16) |
+    ((u32) pBuffer[uOffset + 2] << 8) | ((u32) pBuffer[uOffset + 3]);
+}
+
 //=================================================================================
 //  uDHCPWait
 //---------------------------------------------------------------------------------
@@ -1822,6 +2015,111 @@ static u32 uDHCPRandomNumber(u32 uSeed){
   return uPRN;
 }
 
+//=================================================================================
+//  vDHCPSetRandomSeed
+//---------------------------------------------------------------------------------
+//  This method seeds the generator used to randomize the retry timing. All the
+//  interfaces on a board share the generator, so seed it once with a value
+//  unique to the board.
+//
+//  Parameter       Dir   Description
+//  ---------       ---   -----------
+//  uSeed           IN    board unique seed value
+//
+//  Return
+//  ------
+//  None
+//=================================================================================
+void vDHCPSetRandomSeed(u32 uSeed){
+  /* the xorshift generator below must never be seeded with zero */
+  uDHCPRandomState = (uSeed != 0) ? uSeed : DHCP_MAGIC;
+}
+
+//=================================================================================
+//  uDHCPRandomRange
+//---------------------------------------------------------------------------------
+//  This method returns a pseudo random number in the range [0, uRange) from a
+//  xorshift32 generator. If the generator has not been seeded, it is seeded from
+//  the interface mac address.
+//
+//  Parameter       Dir   Description
+//  ---------       ---   -----------
+//  pIFObjectPtr    IN    handle to IF state object
+//  uRange          IN    upper bound (exclusive) of the returned value
+//
+//  Return
+//  ------
+//  A pseudo random number, 0 if uRange is 0
+//=================================================================================
+static u32 uDHCPRandomRange(struct sIFObject *pIFObjectPtr, u32 uRange){
+  if (uDHCPRandomState == 0){
+    vDHCPSetRandomSeed(((u32) pIFObjectPtr->arrIFAddrMac[2] << 24) | ((u32) pIFObjectPtr->arrIFAddrMac[3] << 16) |
+        ((u32) pIFObjectPtr->arrIFAddrMac[4] << 8) | ((u32) pIFObjectPtr->arrIFAddrMac[5]));
+  }
+
+  uDHCPRandomState ^= uDHCPRandomState << 13;
+  uDHCPRandomState ^= uDHCPRandomState >> 17;
+  uDHCPRandomState ^= uDHCPRandomState << 5;
+
+  if (uRange == 0){
+    return 0;
+  }
+
+  return uDHCPRandomState % uRange;
+}
+
+//=================================================================================
+//  vDHCPNextBackoff
+//---------------------------------------------------------------------------------
+//  This method is called each time a DISCOVER or REQUEST is sent from the
+//  RANDOMIZE state. It sets the timeout to wait for the reply - the retry
+//  interval doubled once per previous DISCOVER, capped at DHCP_SM_BACKOFF_MAX and
+//  randomized by up to +/- DHCP_SM_JITTER. It also keeps track of the attempt
+//  timing for the bind latency statistics.
+//
+//  Parameter       Dir   Description
+//  ---------       ---   -----------
+//  pIFObjectPtr    IN    handle to IF state object
+//  uGrow           IN    1 to double the timeout for the next retry, 0 to keep it
+//
+//  Return
+//  ------
+//  None
+//=================================================================================
+static void vDHCPNextBackoff(struct sIFObject *pIFObjectPtr, u8 uGrow){
+  struct sDHCPObject *pDHCPObjectPtr;
+  u32 uTimeout;
+  u32 uJitter;
+  u8 uIndex;
+
+  pDHCPObjectPtr = &(pIFObjectPtr->DHCPContextState);
+
+  if (pDHCPObjectPtr->uDHCPAttemptTxCount == 0){
+    pDHCPObjectPtr->uDHCPAttemptStartTick = pDHCPObjectPtr->uDHCPCurrentClkTick;
+  }
+  if (pDHCPObjectPtr->uDHCPAttemptTxCount < UINT16_MAX){
+    pDHCPObjectPtr->uDHCPAttemptTxCount++;
+  }
+
+  uTimeout = pDHCPObjectPtr->uDHCPSMRetryInterval;
+  for (uIndex = 0; (uIndex < pDHCPObjectPtr->uDHCPBackoffExp) && (uTimeout < DHCP_SM_BACKOFF_MAX); uIndex++){
+    uTimeout = uTimeout << 1;
+  }
+  if (uTimeout > DHCP_SM_BACKOFF_MAX){
+    uTimeout = DHCP_SM_BACKOFF_MAX;
+  }
+
+  /* keep the jitter to less than half the timeout for short retry intervals */
+  uJitter = (uTimeout / 2) < DHCP_SM_JITTER ? (uTimeout / 2) : DHCP_SM_JITTER;
+  uTimeout = uTimeout - uJitter + uDHCPRandomRange(pIFObjectPtr, (2 * uJitter) + 1);
+
+  pDHCPObjectPtr->uDHCPBackoffTimeout = uTimeout;
+
+  if (uGrow && (pDHCPObjectPtr->uDHCPBackoffExp < DHCP_SM_BACKOFF_EXP_MAX)){
+    pDHCPObjectPtr->uDHCPBackoffExp++;
+  }
+}
+
 //=================================================================================
 //  vDHCPAuxClearBitFlag
 //---------------------------------------------------------------------------------
@@ -104,6 +104,22 @@ extern "C" {
                                 /* -> times by POLL_INTERVAL to get milli-seconds value */
                                 /* NOTE: must be smaller than DHCP_SM_INTERVAL */
 
+/* Retransmission backoff (RFC2131 sec 4.1) - the select / request timeout starts
+ * at uDHCPSMRetryInterval and doubles on every DISCOVER sent, up to
+ * DHCP_SM_BACKOFF_MAX. Each timeout is then randomized by +/- DHCP_SM_JITTER so
+ * that boards powered up together drift apart. The ceiling is kept well below
+ * the 64s suggested by the RFC so that a few attempts still fit within the
+ * default link monitor timeout (45s, see main.c). All values in POLL_INTERVAL ticks. */
+#define DHCP_SM_BACKOFF_MAX     160   /* 16s */
+#define DHCP_SM_JITTER          10    /* +/- 1s */
+#define DHCP_SM_BACKOFF_EXP_MAX 8
+
+/* The first DISCOVER of each interface is delayed by DHCP_SM_STAGGER times the
+ * interface id plus a random share of DHCP_SM_STAGGER_WINDOW. The first term
+ * keeps a board's own interfaces apart, the second spreads the boards in a rack. */
+#define DHCP_SM_STAGGER         3     /* 300ms */
+#define DHCP_SM_STAGGER_WINDOW  20    /* 2s */
+
 /* 14 [eth] + 20 [ip] + 8 [udp] + 236 [bootp] + 312 [min dhcp option length - rfc 2131, pg. 10] */
 #define DHCP_MIN_BUFFER_SIZE  590  /*FIXME*/
 #define HOST_NAME_MAX_SIZE    16    /* allows for hostname size of 15 characters plus '\0' */
@@ -145,6 +161,18 @@ typedef enum {DHCPDISCOVER=1,
               DHCPERROR = 0xff    /* custom addition to return errors */
 } typeDHCPMessage;
 
+/* the options looked up in a received message - their offsets are indexed in a
+ * single pass when the message is validated, see uDHCPIndexOptions() */
+typedef enum {DHCP_OPT_IDX_MSG_TYPE = 0,
+              DHCP_OPT_IDX_SUBNET,
+              DHCP_OPT_IDX_ROUTER,
+              DHCP_OPT_IDX_LEASE_TIME,
+              DHCP_OPT_IDX_T1,
+              DHCP_OPT_IDX_T2,
+              DHCP_OPT_IDX_SERVER_ID,
+              DHCP_OPT_IDX_MAX      /* keep last */
+} typeDHCPOptionIndex;
+
 typedef enum {flagDHCP_SM_AUTO_REDISCOVER=0,
               flagDHCP_SM_LEASE_OBTAINED,
               flagDHCP_SM_GOT_MESSAGE,
@@ -263,6 +291,16 @@ struct sDHCPObject{
   u32 uDHCPSMRetryInterval;   /* time between dhcp retries */
   u32 uDHCPSMInitWait;        /* time to wait before sending out first dhcp discover packet */
 
+  u32 uDHCPBackoffTimeout;    /* current select / request timeout, grows with each DISCOVER sent */
+  u8  uDHCPBackoffExp;        /* number of times the backoff has been doubled */
+
+  /* timing of the lease acquisition - all in POLL_INTERVAL ticks */
+  u32 uDHCPAttemptStartTick;  /* uDHCPCurrentClkTick when the first DISCOVER / REQUEST was sent */
+  u16 uDHCPAttemptTxCount;    /* DISCOVER / REQUEST messages sent during the current attempt */
+  u32 uDHCPBindTime;          /* first DISCOVER / REQUEST to ACK for the last lease obtained */
+  u32 uDHCPBindTimeMax;       /* worst case of the above since power up */
+  u16 uDHCPBindTxCount;       /* messages it took to obtain the last lease */
+
   u32 uDHCPT1;
   u32 uDHCPT2;
   u32 uDHCPLeaseTime;
@@ -278,6 +316,10 @@ struct sDHCPObject{
   u8  arrDHCPHostName[HOST_NAME_MAX_SIZE];        /* array which holds the host name */
 
   u8  uDHCPRegisterFlags;         /* Register which holds DHCP status flags */
+
+  /* offsets into the rx buffer of the indexed option values of the last valid
+   * message, 0 if the option was not present */
+  u16 arrDHCPOptionOffset[DHCP_OPT_IDX_MAX];
 };
 
 
@@ -314,6 +356,9 @@ u8 uDHCPSetRetryInterval(struct sIFObject *pIFObjectPtr, u32 uRetryInterval);
  */
 u8 uDHCPSetRequestCachedIP(struct sIFObject *pIFObjectPtr, u32 uCachedIP);
 
+/* request the last lease obtained immediately, e.g. on link up */
+u8 uDHCPRequestHeldLease(struct sIFObject *pIFObjectPtr);
+
 #if 0
 /*TODO*/u8 uDHCPSetAutoRediscoverEnable(struct sDHCPObject *pDHCPObjectPtr, u8 uEnable);
 #endif
@@ -342,6 +387,10 @@ u8 uDHCPGetBoundStatus(struct sIFObject *pIFObjectPtr);
 
 u32 uDHCPGetInitUnboundTime(struct sIFObject *pIFObjectPtr);
 
+/* seed the generator used to randomize the dhcp retry timing - call once at
+ * startup with a board unique value (serial number, fpga dna) */
+void vDHCPSetRandomSeed(u32 uSeed);
+
 /* event-driven callbacks */
 
 /* register a callback to be invoked once the DHCP message successfully built */
@@ -16,9 +16,15 @@
 #include "diagnostics.h"
 #include "id.h"
 #include "register.h"
+#include "perfmon.h"
+#include "arp.h"
 
 /*-------- Network diagnostics --------*/
 
+/* xil_printf has no 64-bit support so only the lower 32 bits are printed here -
+ * the full width counters can be read with the GET_IF_COUNTERS opcode */
+#define IF_CNT(c) ((u32) (pIFObj->uIFCounter[(c)] & 0xffffffff))
+
 //=================================================================================
 //  PrintInterfaceCounters
 //---------------------------------------------------------------------------------
@@ -39,8 +45,7 @@ void PrintInterfaceCounters(struct sIFObject *pIFObj){
     return;
   }
 
-  pIFObj->uTxTotal = pIFObj->uTxEthArpReplyOk + pIFObj->uTxEthArpRequestOk + pIFObj->uTxEthLldpOk +
-    pIFObj->uTxIpIcmpReplyOk + pIFObj->uTxIpIgmpOk + pIFObj->uTxUdpDhcpOk + pIFObj->uTxUdpCtrlOk;
+  IFCounterUpdateTxTotal(pIFObj);
 
   for (i = 0; i < 60; i++){
     log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, "-");
@@ -51,57 +56,75 @@ void PrintInterfaceCounters(struct sIFObject *pIFObj){
       pIFObj->uIFLinkStatus == LINK_UP ? "UP" : "DOWN",
       pIFObj->stringIFAddrIP,
       pIFObj->stringIFAddrNetmask);
-  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Rx%1s%-13s%11d%2s", "","Total:",         pIFObj->uRxTotal,           "|");
-  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Tx%1s%-13s%11d%2s", "","Total:",         pIFObj->uTxTotal,           "\r\n");
-  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Rx%2s%-12s%11d%2s", "", "ETH Unknown:",  pIFObj->uRxEthUnknown,      "|");
+  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, "        Link up to restored: %uus%s\r\n", perfmon_cycles_to_us(pIFObj->uIFLinkUpToRestored),
+      pIFObj->uIFRecoveryPending ? " (recovery pending)" : "");
+  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Rx%1s%-13s%11d%2s", "","Total:",         IF_CNT(RX_TOTAL),           "|");
+  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Tx%1s%-13s%11d%2s", "","Total:",         IF_CNT(TX_TOTAL),           "\r\n");
+  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Rx%2s%-12s%11d%2s", "", "ETH Unknown:",  IF_CNT(RX_ETH_UNKNOWN),      "|");
   log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Tx%2sARP\r\n", "");
-  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Rx%2s%-12s%11d%2s", "", "ARP:",          pIFObj->uRxEthArp,          "|");
-  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Tx%3s%-11s%11d%2s", "", "Reply:",        pIFObj->uTxEthArpReplyOk,   "\r\n");
-  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Rx%3s%-11s%11d%2s", "", "Reply:",        pIFObj->uRxArpReply,        "|");
-  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Tx%3s%-11s%11d%2s", "", "Request:",      pIFObj->uTxEthArpRequestOk, "\r\n");
-  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Rx%3s%-11s%11d%2s", "", "Request:",      pIFObj->uRxArpRequest,      "|");
-  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Tx%3s%-11s%11d%2s", "", "Err:",          pIFObj->uTxEthArpErr,       "\r\n");
-  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Rx%3s%-11s%11d%2s", "", "Conflict:",     pIFObj->uRxArpConflict,     "|");
+  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Rx%2s%-12s%11d%2s", "", "ARP:",          IF_CNT(RX_ETH_ARP),          "|");
+  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Tx%3s%-11s%11d%2s", "", "Reply:",        IF_CNT(TX_ETH_ARP_REPLY_OK),   "\r\n");
+  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Rx%3s%-11s%11d%2s", "", "Reply:",        IF_CNT(RX_ARP_REPLY),        "|");
+  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Tx%3s%-11s%11d%2s", "", "Request:",      IF_CNT(TX_ETH_ARP_REQ_OK), "\r\n");
+  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Rx%3s%-11s%11d%2s", "", "Request:",      IF_CNT(RX_ARP_REQUEST),      "|");
+  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Tx%3s%-11s%11d%2s", "", "Err:",          IF_CNT(TX_ETH_ARP_ERR),       "\r\n");
+  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Rx%3s%-11s%11d%2s", "", "Conflict:",     IF_CNT(RX_ARP_CONFLICT),     "|");
   log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Tx%2sLLDP\r\n", "");
-  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Rx%3s%-11s%11d%2s", "", "Invalid:",      pIFObj->uRxArpInvalid,      "|");
-  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Tx%3s%-11s%11d%2s", "", "Ok:",           pIFObj->uTxEthLldpOk,       "\r\n");
-  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Rx%2s%-12s%11d%2s", "", "IP:",           pIFObj->uRxEthIp,           "|");
-  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Tx%3s%-11s%11d%2s", "", "Err:",          pIFObj->uTxEthLldpErr,      "\r\n");
-  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Rx%3s%-11s%11d%2s", "", "Chksm Err:",    pIFObj->uRxIpChecksumErrors,"|");
+  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Rx%3s%-11s%11d%2s", "", "Invalid:",      IF_CNT(RX_ARP_INVALID),      "|");
+  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Tx%3s%-11s%11d%2s", "", "Ok:",           IF_CNT(TX_ETH_LLDP_OK),       "\r\n");
+  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Rx%2s%-12s%11d%2s", "", "IP:",           IF_CNT(RX_ETH_IP),           "|");
+  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Tx%3s%-11s%11d%2s", "", "Err:",          IF_CNT(TX_ETH_LLDP_ERR),      "\r\n");
+  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Rx%3s%-11s%11d%2s", "", "Chksm Err:",    IF_CNT(RX_IP_CHK_ERR),"|");
   log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Tx%2sICMP\r\n", "");
-  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Rx%3s%-11s%11d%2s", "", "Unknown:",      pIFObj->uRxIpUnknown,       "|");
-  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Tx%3s%-11s%11d%2s", "", "Reply:",        pIFObj->uTxIpIcmpReplyOk,   "\r\n");
-  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Rx%3s%-11s%11d%2s", "", "ICMP:",         pIFObj->uRxIpIcmp,          "|");
-  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Tx%3s%-11s%11d%2s", "", "Err:",          pIFObj->uTxIpIcmpReplyErr,  "\r\n");
-  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Rx%4s%-10s%11d%2s", "", "Invalid:",      pIFObj->uRxIcmpInvalid,     "|");
+  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Rx%3s%-11s%11d%2s", "", "Unknown:",      IF_CNT(RX_IP_UNKNOWN),       "|");
+  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Tx%3s%-11s%11d%2s", "", "Reply:",        IF_CNT(TX_IP_ICMP_REPLY_OK),   "\r\n");
+  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Rx%3s%-11s%11d%2s", "", "ICMP:",         IF_CNT(RX_IP_ICMP),          "|");
+  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Tx%3s%-11s%11d%2s", "", "Err:",          IF_CNT(TX_IP_ICMP_REPLY_ERR),  "\r\n");
+  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Rx%4s%-10s%11d%2s", "", "Invalid:",      IF_CNT(RX_ICMP_INVALID),     "|");
   log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Tx%2sIGMP\r\n", "");
-  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Rx%3s%-11s%11d%2s", "", "UDP:",          pIFObj->uRxIpUdp,           "|");
-  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Tx%3s%-11s%11d%2s", "", "Ok:",           pIFObj->uTxIpIgmpOk,        "\r\n");
-  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Rx%4s%-10s%11d%2s", "", "Unknown:",      pIFObj->uRxUdpUnknown,      "|");
-  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Tx%3s%-11s%11d%2s", "", "Err:",          pIFObj->uTxIpIgmpErr,       "\r\n");
-  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Rx%4s%-10s%11d%2s", "", "CTRL:",         pIFObj->uRxUdpCtrl,         "|");
+  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Rx%3s%-11s%11d%2s", "", "UDP:",          IF_CNT(RX_IP_UDP),           "|");
+  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Tx%3s%-11s%11d%2s", "", "Ok:",           IF_CNT(TX_IP_IGMP_OK),        "\r\n");
+  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Rx%4s%-10s%11d%2s", "", "Unknown:",      IF_CNT(RX_UDP_UNKNOWN),      "|");
+  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Tx%3s%-11s%11d%2s", "", "Err:",          IF_CNT(TX_IP_IGMP_ERR),       "\r\n");
+  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Rx%4s%-10s%11d%2s", "", "CTRL:",         IF_CNT(RX_UDP_CTRL),         "|");
   log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Tx%2sDHCP\r\n", "");
-  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Rx%4s%-10s%11d%2s", "", "DHCP:",         pIFObj->uRxUdpDhcp,         "|");
-  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Tx%3s%-11s%11d%2s", "", "Ok:",           pIFObj->uTxUdpDhcpOk,       "\r\n");
-  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Rx%5s%-9s%11d%2s", "", "Invalid:",       pIFObj->uRxDhcpInvalid,     "|");
-  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Tx%3s%-11s%11d%2s", "", "Err:",          pIFObj->uTxUdpDhcpErr,      "\r\n");
-  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Rx%5s%-9s%11d%2s", "", "Unknown:",       pIFObj->uRxDhcpUnknown,     "|");
+  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Rx%4s%-10s%11d%2s", "", "DHCP:",         IF_CNT(RX_UDP_DHCP),         "|");
+  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Tx%3s%-11s%11d%2s", "", "Ok:",           IF_CNT(TX_UDP_DHCP_OK),       "\r\n");
+  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Rx%5s%-9s%11d%2s", "", "Invalid:",       IF_CNT(RX_DHCP_INVALID),     "|");
+  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Tx%3s%-11s%11d%2s", "", "Err:",          IF_CNT(TX_UDP_DHCP_ERR),      "\r\n");
+  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Rx%5s%-9s%11d%2s", "", "Unknown:",       IF_CNT(RX_DHCP_UNKNOWN),     "|");
   log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Tx%2sCTRL\r\n", "");
-  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " RX%3s%-11s%11d%2s", "", "IGMP:",         pIFObj->uRxIpIgmp,          "|");
-  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Tx%3s%-11s%11d%2s", "", "Ok:",           pIFObj->uTxUdpCtrlOk,       "\r\n");
-  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Rx%4s%-10s%11d%2s", "", "Dropped:",      pIFObj->uRxIpIgmpDropped,   "|");
+  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " RX%3s%-11s%11d%2s", "", "IGMP:",         IF_CNT(RX_IP_IGMP),          "|");
+  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Tx%3s%-11s%11d%2s", "", "Ok:",           IF_CNT(TX_UDP_CTRL_OK),       "\r\n");
+  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Rx%4s%-10s%11d%2s", "", "Dropped:",      IF_CNT(RX_IP_IGMP_DROPPED),   "|");
+  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Tx%3s%-11s%11d%2s", "", "Cached:",       IF_CNT(TX_UDP_CTRL_CACHED),   "\r\n");
+  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Rx%4s%-10s%11d%2s", "", "Query:",        IF_CNT(RX_IGMP_QUERY),       "|");
+  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Tx%2s%-12s%11d%2s", "", "IGMP Supp:",    IF_CNT(TX_IGMP_SUPPRESSED),   "\r\n");
+  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Rx%4s%-10s%11d%2s", "", "Invalid:",      IF_CNT(RX_IGMP_INVALID),     "|");
+  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, "\r\n");
+  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " RX%3s%-11s%11d%2s", "", "PIM:",          IF_CNT(RX_IP_PIM),           "|");
+  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, "\r\n");
+  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Rx%4s%-10s%11d%2s", "", "Dropped:",      IF_CNT(RX_IP_PIM_DROPPED),    "|");
+  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, "\r\n");
+  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " RX%3s%-11s%11d%2s", "", "TCP:",          IF_CNT(RX_IP_TCP),           "|");
+  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, "\r\n");
+  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Rx%4s%-10s%11d%2s", "", "Dropped:",      IF_CNT(RX_IP_TCP_DROPPED),    "|");
+  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, "\r\n");
+  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Rx%2s%-12s%11d%2s", "", "LLDP:",         IF_CNT(RX_ETH_LLDP),         "|");
+  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, "\r\n");
+  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Rx%3s%-11s%11d%2s", "", "Dropped:",      IF_CNT(RX_ETH_LLDP_DROPPED),  "|");
   log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, "\r\n");
-  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " RX%3s%-11s%11d%2s", "", "PIM:",          pIFObj->uRxIpPim,           "|");
+  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Rx%2s%-23s%2s", "", "Early Drop",                                "|");
   log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, "\r\n");
-  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Rx%4s%-10s%11d%2s", "", "Dropped:",      pIFObj->uRxIpPimDropped,    "|");
+  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Rx%3s%-11s%11d%2s", "", "ETH Unkn:",     IF_CNT(RX_EARLY_DROP_ETH_UNKNOWN), "|");
   log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, "\r\n");
-  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " RX%3s%-11s%11d%2s", "", "TCP:",          pIFObj->uRxIpTcp,           "|");
+  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Rx%3s%-11s%11d%2s", "", "LLDP:",         IF_CNT(RX_EARLY_DROP_LLDP),   "|");
   log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, "\r\n");
-  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Rx%4s%-10s%11d%2s", "", "Dropped:",      pIFObj->uRxIpTcpDropped,    "|");
+  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Rx%3s%-11s%11d%2s", "", "IP Unhndl:",    IF_CNT(RX_EARLY_DROP_IP_UNHANDLED), "|");
   log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, "\r\n");
-  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Rx%2s%-12s%11d%2s", "", "LLDP:",         pIFObj->uRxEthLldp,         "|");
+  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Rx%3s%-11s%11d%2s", "", "UDP Unkn:",     IF_CNT(RX_EARLY_DROP_UDP_UNKNOWN), "|");
   log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, "\r\n");
-  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Rx%3s%-11s%11d%2s", "", "Dropped:",      pIFObj->uRxEthLldpDropped,  "|");
+  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, " Rx%3s%-11s%11d%2s", "", "DHCP Srv:",     IF_CNT(RX_EARLY_DROP_DHCP_SERVER), "|");
   log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, "\r\n");
 
   for (i = 0; i < 60; i++){
@@ -224,7 +247,7 @@ void print_interface_internals(u8 physical_interface_id){
   log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, "uIFEthernetId u%u\r\n", ifptr->uIFEthernetId);
   log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, "uIFEthernetSubnet x%08x\r\n", ifptr->uIFEthernetSubnet);
   log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, "uIFEnableArpRequests u%u\r\n", ifptr->uIFEnableArpRequests);
-  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, "uIFCurrentArpRequest u%u\r\n", ifptr->uIFCurrentArpRequest);
+  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, "arp neighbours u%u\r\n", ArpNeighbourCount(ifptr->uIFEthernetId));
   log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, "uIFValidPacketRx u%u\r\n", ifptr->uIFValidPacketRx);
 
   log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, "\r\n");
@@ -275,6 +298,12 @@ void print_dhcp_internals(u8 physical_interface_id){
   log_printf(LOG_SELECT_DHCP, LOG_LEVEL_INFO, "uDHCPRandomWaitCached u%u\r\n", dhcpptr->uDHCPRandomWaitCached);
   log_printf(LOG_SELECT_DHCP, LOG_LEVEL_INFO, "uDHCPSMRetryInterval u%u\r\n", dhcpptr->uDHCPSMRetryInterval);
   log_printf(LOG_SELECT_DHCP, LOG_LEVEL_INFO, "uDHCPSMInitWait u%u\r\n", dhcpptr->uDHCPSMInitWait);
+  log_printf(LOG_SELECT_DHCP, LOG_LEVEL_INFO, "uDHCPBackoffTimeout u%u\r\n", dhcpptr->uDHCPBackoffTimeout);
+  log_printf(LOG_SELECT_DHCP, LOG_LEVEL_INFO, "uDHCPBackoffExp u%u\r\n", dhcpptr->uDHCPBackoffExp);
+  log_printf(LOG_SELECT_DHCP, LOG_LEVEL_INFO, "uDHCPAttemptTxCount u%u\r\n", dhcpptr->uDHCPAttemptTxCount);
+  log_printf(LOG_SELECT_DHCP, LOG_LEVEL_INFO, "uDHCPBindTime u%u\r\n", dhcpptr->uDHCPBindTime);
+  log_printf(LOG_SELECT_DHCP, LOG_LEVEL_INFO, "uDHCPBindTimeMax u%u\r\n", dhcpptr->uDHCPBindTimeMax);
+  log_printf(LOG_SELECT_DHCP, LOG_LEVEL_INFO, "uDHCPBindTxCount u%u\r\n", dhcpptr->uDHCPBindTxCount);
   log_printf(LOG_SELECT_DHCP, LOG_LEVEL_INFO, "uDHCPT1 u%u\r\n", dhcpptr->uDHCPT1);
   log_printf(LOG_SELECT_DHCP, LOG_LEVEL_INFO, "uDHCPT2 u%u\r\n", dhcpptr->uDHCPT2);
   log_printf(LOG_SELECT_DHCP, LOG_LEVEL_INFO, "uDHCPLeaseTime u%u\r\n", dhcpptr->uDHCPLeaseTime);
@@ -42,6 +42,9 @@ static u32 eth_mac_wb_offset[] = {
  * static u32 priv_GetAddressOffset(uId);
  */
 #define priv_GetAddressOffset(uId)   eth_mac_wb_offset[uId]
+
+static void priv_ReadHostPacketWords(u8 uId, volatile u32 *puReceivePacket, u32 uNumWords, u32 uFirstWord, u32 uLastWord);
+
 //=================================================================================
 //  GetAddressOffset
 //--------------------------------------------------------------------------------
@@ -310,6 +313,60 @@ void ProgramARPCacheEntry(u8 uId, u32 uIPAddressLower8Bits, u32 uMACAddressUpper
 
 }
 
+//=================================================================================
+//  ProgramARPCacheEntries
+//--------------------------------------------------------------------------------
+//  This method is used to program a list of entries in the ARP cache in one pass.
+//  Each entry is four half-words: lower 8 bits of the IP address (the cache
+//  index) followed by the MAC address (upper, middle and lower 16 bits).
+//
+//  Parameter Dir   Description
+//  --------- ---   -----------
+//  uId           IN  ID of ETH MAC want to program ARP cache for
+//  pEntries      IN  Packed list of entries
+//  uNumEntries   IN  Number of entries in the list
+//
+//  Return
+//  ------
+//  None
+//=================================================================================
+void ProgramARPCacheEntries(u8 uId, const u16 *pEntries, u32 uNumEntries)
+{
+  u32 uBaseAddress = XPAR_AXI_SLAVE_WISHBONE_CLASSIC_MASTER_0_BASEADDR + priv_GetAddressOffset(uId) + ETH_MAC_ARP_CACHE_LOW_ADDRESS;
+  u32 uAddress;
+
+  while (uNumEntries--){
+    uAddress = uBaseAddress + (4 * (2 * (pEntries[0] & 0xFF)));
+    Xil_Out16(uAddress, pEntries[1]);
+    Xil_Out32(uAddress + 4, ((u32) pEntries[2] << 16) | pEntries[3]);
+    pEntries += 4;
+  }
+}
+
+//=================================================================================
+//  ReadARPCacheEntry
+//--------------------------------------------------------------------------------
+//  This method is used to read back an entry in the ARP cache.
+//
+//  Parameter Dir   Description
+//  --------- ---   -----------
+//  uId           IN  ID of ETH MAC want to read ARP cache of
+//  uIPAddressLower8Bits  IN  Lower 8 bits of destination IP address to index into table
+//  pMACAddressUpper16Bits  OUT Upper 16 bits of MAC address
+//  pMACAddressLower32Bits  OUT Lower 32 bits of MAC address
+//
+//  Return
+//  ------
+//  None
+//=================================================================================
+void ReadARPCacheEntry(u8 uId, u32 uIPAddressLower8Bits, u32 *pMACAddressUpper16Bits, u32 *pMACAddressLower32Bits)
+{
+  u32 uAddress = XPAR_AXI_SLAVE_WISHBONE_CLASSIC_MASTER_0_BASEADDR + priv_GetAddressOffset(uId) + ETH_MAC_ARP_CACHE_LOW_ADDRESS + (4 * (2 * uIPAddressLower8Bits));
+
+  *pMACAddressUpper16Bits = Xil_In16(uAddress);
+  *pMACAddressLower32Bits = Xil_In32(uAddress + 4);
+}
+
 //=================================================================================
 //  GetHostTransmitBufferLevel
 //--------------------------------------------------------------------------------
@@ -564,12 +621,35 @@ int TransmitHostPacket(u8 uId, volatile u32 *puTransmitPacket, u32 uNumWords)
 //=================================================================================
 int ReadHostPacket(u8 uId, volatile u32 *puReceivePacket, u32 uNumWords)
 {
-  unsigned int uIndex = 0x0;
-  u32 uAddressOffset = priv_GetAddressOffset(uId);
-  u32 pktlen = 0, padlen = 0;
-  //u32 uReg;
-  u8 *t;
+  int iStatus;
+
+  iStatus = ReadHostPacketHeader(uId, puReceivePacket, uNumWords);
+  if (iStatus != XST_SUCCESS)
+    return iStatus;
 
+  return ReadHostPacketRemainder(uId, puReceivePacket, uNumWords);
+}
+
+//=================================================================================
+//  ReadHostPacketHeader
+//--------------------------------------------------------------------------------
+//  This method is used to read only the first ETH_MAC_RX_HEADER_WORDS words of a
+//  received packet, enough for the eth, ip and udp (or arp) headers. The packet
+//  stays in the receive buffer: either read the rest of it with
+//  ReadHostPacketRemainder or drop it with AckHostPacketReceive.
+//
+//  Parameter Dir   Description
+//  --------- ---   -----------
+//  uId       IN  ID of ETH MAC that want to read a packet from
+//  puReceivePacket OUT Pointer to location where to store received packet
+//  uNumWords   IN  Number of 32-bit words in the packet
+//
+//  Return
+//  ------
+//  XST_SUCCESS if successful
+//=================================================================================
+int ReadHostPacketHeader(u8 uId, volatile u32 *puReceivePacket, u32 uNumWords)
+{
   // GT 31/03/2017 NEED TO CHECK THAT DON'T OVERFLOW ReceivePacket ARRAY
   //if (uNumWords > GetHostReceiveBufferLevel(uId))
   //{
@@ -585,37 +665,34 @@ int ReadHostPacket(u8 uId, volatile u32 *puReceivePacket, u32 uNumWords)
 
   //log_printf(LOG_SELECT_BUFF, LOG_LEVEL_DEBUG, "%02x: rd %d words\n", uId, uNumWords);
 
-  for (uIndex = 0x0; uIndex < uNumWords; uIndex++)
-  {
-    puReceivePacket[uIndex] = Xil_In32(XPAR_AXI_SLAVE_WISHBONE_CLASSIC_MASTER_0_BASEADDR + uAddressOffset + ETH_MAC_CPU_RECEIVE_BUFFER_LOW_ADDRESS + (4*uIndex));
-    //uReg = Xil_In32(XPAR_AXI_SLAVE_WISHBONE_CLASSIC_MASTER_0_BASEADDR + uAddressOffset + ETH_MAC_CPU_RECEIVE_BUFFER_LOW_ADDRESS + (4*uIndex));
-    //puReceivePacket[uIndex] = ((uReg & 0xFFFF) << 16) | ((uReg >> 16) & 0xFFFF);
+  priv_ReadHostPacketWords(uId, puReceivePacket, uNumWords, 0, (uNumWords < ETH_MAC_RX_HEADER_WORDS) ? uNumWords : ETH_MAC_RX_HEADER_WORDS);
 
-    if (LOG_LEVEL_TRACE == get_log_level()){  /* only do all this if we're going
-                                                 to print it anyway  */
-      /* possibly a big performance hit when tracing receive buffer */
-      if (uIndex == 0){
-        log_printf(LOG_SELECT_BUFF, LOG_LEVEL_TRACE, "\r\nRX%02d %d 32bit words\r\n", uId, uNumWords); /* size - num 32-bit words */
-        log_printf(LOG_SELECT_BUFF, LOG_LEVEL_TRACE, "RX%02d[@x%x]", uId, uAddressOffset);    /* do once for index 0 -
-                                                                                                 id and wb-addr-offset -
-                                                                                                 useful to trace all the
-                                                                                                 id-to-addr mappings in
-                                                                                                 the netw stack */
-      }
+  return XST_SUCCESS;
+}
 
-      /* formatting */
-      if ((uIndex == 0) || ((uIndex % 8) == 0)){
-        log_printf(LOG_SELECT_BUFF, LOG_LEVEL_TRACE, "\r\n");
-      } else {
-        log_printf(LOG_SELECT_BUFF, LOG_LEVEL_TRACE, "");
-      }
+//=================================================================================
+//  ReadHostPacketRemainder
+//--------------------------------------------------------------------------------
+//  This method is used to read the rest of a packet after ReadHostPacketHeader
+//  and to acknowledge it.
+//
+//  Parameter Dir   Description
+//  --------- ---   -----------
+//  uId       IN  ID of ETH MAC that want to read a packet from
+//  puReceivePacket OUT Pointer to location where to store received packet
+//  uNumWords   IN  Number of 32-bit words in the packet
+//
+//  Return
+//  ------
+//  XST_SUCCESS if successful
+//=================================================================================
+int ReadHostPacketRemainder(u8 uId, volatile u32 *puReceivePacket, u32 uNumWords)
+{
+  u32 pktlen = 0, padlen = 0;
 
-      t = (u8 *) &(puReceivePacket[uIndex]);
-      log_printf(LOG_SELECT_BUFF, LOG_LEVEL_TRACE, "%02x%02x%02x%02x ",t[1],t[0],t[3],t[2]);    /* NOTE - these are half
-                                                                                                   word swapped - see
-                                                                                                   indices - for easier
-                                                                                                   reading on console */
-    }
+  if (uNumWords > ETH_MAC_RX_HEADER_WORDS)
+  {
+    priv_ReadHostPacketWords(uId, puReceivePacket, uNumWords, ETH_MAC_RX_HEADER_WORDS, uNumWords);
   }
 
   if (LOG_LEVEL_TRACE == get_log_level()){  /* only do all this if we're going
@@ -655,3 +732,61 @@ int ReadHostPacket(u8 uId, volatile u32 *puReceivePacket, u32 uNumWords)
 
   return XST_SUCCESS;
 }
+
+//=================================================================================
+//  priv_ReadHostPacketWords
+//--------------------------------------------------------------------------------
+//  This method is used to read part of a received packet from the receive buffer.
+//
+//  Parameter Dir   Description
+//  --------- ---   -----------
+//  uId       IN  ID of ETH MAC that want to read a packet from
+//  puReceivePacket OUT Pointer to location where to store received packet
+//  uNumWords   IN  Number of 32-bit words in the packet
+//  uFirstWord  IN  First word to read
+//  uLastWord   IN  Word after the last one to read
+//
+//  Return
+//  ------
+//  None
+//=================================================================================
+static void priv_ReadHostPacketWords(u8 uId, volatile u32 *puReceivePacket, u32 uNumWords, u32 uFirstWord, u32 uLastWord)
+{
+  unsigned int uIndex = 0x0;
+  u32 uAddressOffset = priv_GetAddressOffset(uId);
+  u8 *t;
+
+  for (uIndex = uFirstWord; uIndex < uLastWord; uIndex++)
+  {
+    puReceivePacket[uIndex] = Xil_In32(XPAR_AXI_SLAVE_WISHBONE_CLASSIC_MASTER_0_BASEADDR + uAddressOffset + ETH_MAC_CPU_RECEIVE_BUFFER_LOW_ADDRESS + (4*uIndex));
+    //uReg = Xil_In32(XPAR_AXI_SLAVE_WISHBONE_CLASSIC_MASTER_0_BASEADDR + uAddressOffset + ETH_MAC_CPU_RECEIVE_BUFFER_LOW_ADDRESS + (4*uIndex));
+    //puReceivePacket[uIndex] = ((uReg & 0xFFFF) << 16) | ((uReg >> 16) & 0xFFFF);
+
+    if (LOG_LEVEL_TRACE == get_log_level()){  /* only do all this if we're going
+                                                 to print it anyway  */
+      /* possibly a big performance hit when tracing receive buffer */
+      if (uIndex == 0){
+        log_printf(LOG_SELECT_BUFF, LOG_LEVEL_TRACE, "\r\nRX%02d %d 32bit words\r\n", uId, uNumWords); /* size - num 32-bit words */
+        log_printf(LOG_SELECT_BUFF, LOG_LEVEL_TRACE, "RX%02d[@x%x]", uId, uAddressOffset);    /* do once for index 0 -
+                                                                                                 id and wb-addr-offset -
+                                                                                                 useful to trace all the
+                                                                                                 id-to-addr mappings in
+                                                                                                 the netw stack */
+      }
+
+      /* formatting */
+      if ((uIndex == 0) || ((uIndex % 8) == 0)){
+        log_printf(LOG_SELECT_BUFF, LOG_LEVEL_TRACE, "\r\n");
+      } else {
+        log_printf(LOG_SELECT_BUFF, LOG_LEVEL_TRACE, "");
+      }
+
+      t = (u8 *) &(puReceivePacket[uIndex]);
+      log_printf(LOG_SELECT_BUFF, LOG_LEVEL_TRACE, "%02x%02x%02x%02x ",t[1],t[0],t[3],t[2]);    /* NOTE - these are half
+                                                                                                   word swapped - see
+                                                                                                   indices - for easier
+                                                                                                   reading on console */
+    }
+  }
+
+}
@@ -98,6 +98,10 @@ extern "C" {
 
 #endif
 
+/* words read by ReadHostPacketHeader - eth, ip and udp headers (ip header without
+   options) or the eth and arp headers */
+#define ETH_MAC_RX_HEADER_WORDS   12
+
 #ifdef REDUCED_CLK_ARCH
 /* for 39.0625MHz clock... */
 #define ETH_MAC_HOST_PACKET_TRANSMIT_TIMEOUT      250
@@ -116,12 +120,16 @@ void SetFabricSourcePortAddress(u8 uId, u16 uPortAddress);
 void SetMultiCastIPAddress(u8 uId, u32 uMultiCastIPAddress, u32 uMultiCastIPAddressMask);
 void EnableFabricInterface(u8 uId, u8 uEnable);
 void ProgramARPCacheEntry(u8 uId, u32 uIPAddressLower8Bits, u32 uMACAddressUpper16Bits, u32 uMACAddressLower32Bits);
+void ProgramARPCacheEntries(u8 uId, const u16 *pEntries, u32 uNumEntries);
+void ReadARPCacheEntry(u8 uId, u32 uIPAddressLower8Bits, u32 *pMACAddressUpper16Bits, u32 *pMACAddressLower32Bits);
 u32 GetHostTransmitBufferLevel(u8 uId);
 u32 GetHostReceiveBufferLevel(u8 uId);
 void SetHostTransmitBufferLevel(u8 uId, u16 uBufferLevel);
 void AckHostPacketReceive(u8 uId);
 int TransmitHostPacket(u8 uId, volatile u32 *puTransmitPacket, u32 uNumWords);  // GT 31/03/2017 INSTRUCT COMPILER BUFFER IS VOLATILE
 int ReadHostPacket(u8 uId, volatile u32 *puReceivePacket, u32 uNumWords); // GT 31/03/2017 INSTRUCT COMPILER BUFFER IS VOLATILE
+int ReadHostPacketHeader(u8 uId, volatile u32 *puReceivePacket, u32 uNumWords);
+int ReadHostPacketRemainder(u8 uId, volatile u32 *puReceivePacket, u32 uNumWords);
 
 #ifdef __cplusplus
 }
@@ -46,6 +46,15 @@
 #include "fanctrl.h"
 #include "error.h"
 #include "mezz.h"
+#include "perfmon.h"
+#include "prof.h"
+#include "memmon.h"
+#include "arp.h"
+#include "stream.h"
+#include "poll.h"
+#include "watch.h"
+#include "telemetry.h"
+#include "session.h"
 
 extern u8 uQSFPUpdateStatusEnable;
 
@@ -54,10 +63,13 @@ extern u8 uQSFPUpdateStatusEnable;
 //--------------------------------------------------------------------------------
 //  This method calculates the IPv4 header checksum.
 //
+//  The halfwords are summed a 32-bit word at a time (four words per iteration)
+//  into a 32-bit accumulator and the carries are folded in once at the end.
+//
 //  Parameter Dir   Description
 //  --------- ---   -----------
 //  uChecksum IN    Initial checksum value
-//  uLength   IN    Number of bytes
+//  uLength   IN    Number of 16-bit words
 //  pHeaderPtr  IN    Packet header pointer
 //
 //  Return
@@ -66,22 +78,41 @@ extern u8 uQSFPUpdateStatusEnable;
 //=================================================================================
 u32 CalculateIPChecksum(u32 uChecksum, u32 uLength, u16 *pHeaderPtr)
 {
-  u32 k;
-  u32 l;
+  u32 *pWordPtr;
+  u32 w0, w1, w2, w3;
 
-  //l = uLength - (uLength & 0x01u);
-  l = uLength;
+  /* fold the initial value so that the accumulator cannot overflow below */
+  uChecksum = (uChecksum & 0xFFFF) + (uChecksum >> 16);
 
-  for (k = 0; k != l; ++k)
+  if ((uLength != 0) && (((u32) pHeaderPtr) & 0x2))
+  {
     uChecksum += (u32) *pHeaderPtr++;
+    uLength--;
+  }
+
+  pWordPtr = (u32 *) pHeaderPtr;
 
-  //uChecksum = (uChecksum & 0x0FFFFu) + (uChecksum >> 16);
+  while (uLength >= 8)
+  {
+    w0 = pWordPtr[0];
+    w1 = pWordPtr[1];
+    w2 = pWordPtr[2];
+    w3 = pWordPtr[3];
+    uChecksum += (w0 >> 16) + (w0 & 0xFFFF) + (w1 >> 16) + (w1 & 0xFFFF);
+    uChecksum += (w2 >> 16) + (w2 & 0xFFFF) + (w3 >> 16) + (w3 & 0xFFFF);
+    pWordPtr += 4;
+    uLength -= 8;
+  }
 
-  //if ((uLength & 0x01u) != 0)
-  //  uChecksum += (u32) pHeaderPtr[1];
+  while (uLength >= 2)
+  {
+    w0 = *pWordPtr++;
+    uChecksum += (w0 >> 16) + (w0 & 0xFFFF);
+    uLength -= 2;
+  }
 
-  //uChecksum = (uChecksum & 0x0FFFFu) + (uChecksum >> 16);
-  //uChecksum = (uChecksum & 0x0FFFFu) + (uChecksum >> 16);
+  if (uLength != 0)
+    uChecksum += (u32) *((u16 *) pWordPtr);
 
   while (uChecksum>>16)
   {
@@ -308,6 +339,19 @@ static int GetDHCPMonitorTimeout(u8 * pCommand, u32 uCommandLength, u8 * uRespon
 static int GetMicroblazeUptime(u8 * pCommand, u32 uCommandLength, u8 * uResponsePacketPtr, u32 * uResponseLength);
 static int FPGAFanControllerUpdateHandler(u8 * pCommand, u32 uCommandLength, u8 * uResponsePacketPtr, u32 * uResponseLength);
 static int GetFPGAFanControllerLUTHandler(u8 * pCommand, u32 uCommandLength, u8 * uResponsePacketPtr, u32 * uResponseLength);
+static int GetIFCountersHandler(u8 * pCommand, u32 uCommandLength, u8 * uResponsePacketPtr, u32 * uResponseLength);
+static int GetCpuLoadStatsHandler(u8 * pCommand, u32 uCommandLength, u8 * uResponsePacketPtr, u32 * uResponseLength);
+static int ProfilerControlHandler(u8 * pCommand, u32 uCommandLength, u8 * uResponsePacketPtr, u32 * uResponseLength);
+static int GetMemoryUsageHandler(u8 * pCommand, u32 uCommandLength, u8 * uResponsePacketPtr, u32 * uResponseLength);
+static int ArpNeighbourControlHandler(u8 * pCommand, u32 uCommandLength, u8 * uResponsePacketPtr, u32 * uResponseLength);
+static int ArpCacheUploadHandler(u8 * pCommand, u32 uCommandLength, u8 * uResponsePacketPtr, u32 * uResponseLength);
+static int IGMPControlHandler(u8 * pCommand, u32 uCommandLength, u8 * uResponsePacketPtr, u32 * uResponseLength);
+static int MulticastRangeControlHandler(u8 uId, u8 * pCommand, u32 uCommandLength, u8 * uResponsePacketPtr, u32 * uResponseLength);
+static int StreamReadWishboneHandler(u8 uId, u8 * pCommand, u32 uCommandLength, u8 * uResponsePacketPtr, u32 * uResponseLength);
+static int ReadModifyWriteRegHandler(u8 * pCommand, u32 uCommandLength, u8 * uResponsePacketPtr, u32 * uResponseLength);
+static int PollWishboneHandler(u8 uId, u8 * pCommand, u32 uCommandLength, u8 * uResponsePacketPtr, u32 * uResponseLength);
+static int WatchRegisterControlHandler(u8 uId, u8 * pCommand, u32 uCommandLength, u8 * uResponsePacketPtr, u32 * uResponseLength);
+static int TelemetryControlHandler(u8 uId, u8 * pCommand, u32 uCommandLength, u8 * uResponsePacketPtr, u32 * uResponseLength);
 
 //=================================================================================
 //  CommandSorter
@@ -393,6 +437,14 @@ int CommandSorter(u8 uId, u8 * pCommand, u32 uCommandLength, u8 * uResponsePacke
       return(BigReadWishboneCommandHandler(pCommand, uCommandLength, uResponsePacketPtr, uResponseLength));
     else if (Command->uCommandType == BIG_WRITE_WISHBONE)
       return(BigWriteWishboneCommandHandler(pCommand, uCommandLength, uResponsePacketPtr, uResponseLength));
+    else if (Command->uCommandType == BIG_READ_WISHBONE_JUMBO)
+      return(BigReadWishboneJumboCommandHandler(pCommand, uCommandLength, uResponsePacketPtr, uResponseLength));
+    else if (Command->uCommandType == BIG_WRITE_WISHBONE_JUMBO)
+      return(BigWriteWishboneJumboCommandHandler(pCommand, uCommandLength, uResponsePacketPtr, uResponseLength));
+    else if (Command->uCommandType == SCATTER_READ_WISHBONE)
+      return(ScatterReadWishboneCommandHandler(pCommand, uCommandLength, uResponsePacketPtr, uResponseLength));
+    else if (Command->uCommandType == SCATTER_WRITE_WISHBONE)
+      return(ScatterWriteWishboneCommandHandler(pCommand, uCommandLength, uResponsePacketPtr, uResponseLength));
     else if (Command->uCommandType == SDRAM_PROGRAM_OVER_WISHBONE)
       return(SDRAMProgramOverWishboneCommandHandler(uId, pCommand, uCommandLength, uResponsePacketPtr, uResponseLength));
     else if (Command->uCommandType == SET_DHCP_TUNING_DEBUG)
@@ -419,6 +471,32 @@ int CommandSorter(u8 uId, u8 * pCommand, u32 uCommandLength, u8 * uResponsePacke
       return(FPGAFanControllerUpdateHandler(pCommand, uCommandLength, uResponsePacketPtr, uResponseLength));
     else if (Command->uCommandType == GET_FPGA_FANCONTROLLER_LUT)
       return(GetFPGAFanControllerLUTHandler(pCommand, uCommandLength, uResponsePacketPtr, uResponseLength));
+    else if (Command->uCommandType == GET_IF_COUNTERS)
+      return(GetIFCountersHandler(pCommand, uCommandLength, uResponsePacketPtr, uResponseLength));
+    else if (Command->uCommandType == GET_CPU_LOAD_STATS)
+      return(GetCpuLoadStatsHandler(pCommand, uCommandLength, uResponsePacketPtr, uResponseLength));
+    else if (Command->uCommandType == PROFILER_CONTROL)
+      return(ProfilerControlHandler(pCommand, uCommandLength, uResponsePacketPtr, uResponseLength));
+    else if (Command->uCommandType == GET_MEMORY_USAGE)
+      return(GetMemoryUsageHandler(pCommand, uCommandLength, uResponsePacketPtr, uResponseLength));
+    else if (Command->uCommandType == ARP_NEIGHBOUR_CONTROL)
+      return(ArpNeighbourControlHandler(pCommand, uCommandLength, uResponsePacketPtr, uResponseLength));
+    else if (Command->uCommandType == ARP_CACHE_UPLOAD)
+      return(ArpCacheUploadHandler(pCommand, uCommandLength, uResponsePacketPtr, uResponseLength));
+    else if (Command->uCommandType == IGMP_CONTROL)
+      return(IGMPControlHandler(pCommand, uCommandLength, uResponsePacketPtr, uResponseLength));
+    else if (Command->uCommandType == MULTICAST_RANGE_CONTROL)
+      return(MulticastRangeControlHandler(uId, pCommand, uCommandLength, uResponsePacketPtr, uResponseLength));
+    else if (Command->uCommandType == STREAM_READ_WISHBONE)
+      return(StreamReadWishboneHandler(uId, pCommand, uCommandLength, uResponsePacketPtr, uResponseLength));
+    else if (Command->uCommandType == READ_MODIFY_WRITE_REG)
+      return(ReadModifyWriteRegHandler(pCommand, uCommandLength, uResponsePacketPtr, uResponseLength));
+    else if (Command->uCommandType == POLL_WISHBONE)
+      return(PollWishboneHandler(uId, pCommand, uCommandLength, uResponsePacketPtr, uResponseLength));
+    else if (Command->uCommandType == WATCH_REGISTER_CONTROL)
+      return(WatchRegisterControlHandler(uId, pCommand, uCommandLength, uResponsePacketPtr, uResponseLength));
+    else if (Command->uCommandType == TELEMETRY_CONTROL)
+      return(TelemetryControlHandler(uId, pCommand, uCommandLength, uResponsePacketPtr, uResponseLength));
     else{
       log_printf(LOG_SELECT_GENERAL, LOG_LEVEL_INFO, "Invalid Opcode Detected!\r\n");
       return(InvalidOpcodeHandler(pCommand, uCommandLength, uResponsePacketPtr, uResponseLength));
@@ -487,10 +565,41 @@ int CheckCommandPacket(u8 * pCommand, u32 uCommandLength)
   return XST_SUCCESS;
 }
 
+/*
+ * Per-interface control response header template. The Ethernet, IPv4 and UDP
+ * headers of a response only depend on the client and on our own addresses, so
+ * they are built once per client and only the lengths, identification and
+ * checksums are patched for each response. The partial sums exclude the
+ * patched fields and are folded to 16 bits.
+ */
+#define RESP_HEADER_HALFWORDS   ((sizeof(sEthernetHeaderT) + sizeof(sIPV4HeaderT) + sizeof(sUDPHeaderT)) / 2)
+
+struct sRespHeaderTemplate {
+  u8 uValid;
+  u16 uClientMacHigh;
+  u16 uClientMacMid;
+  u16 uClientMacLow;
+  u32 uClientIPAddr;
+  u32 uClientUDPPort;
+  u32 uSourceIPAddr;
+  u16 uSourceMacHigh;
+  u16 uSourceMacMid;
+  u16 uSourceMacLow;
+  u32 uIPPartialSum;      /* IP header with zero length, identification and checksum */
+  u32 uUDPPartialSum;     /* pseudo header and UDP header without the lengths */
+  u16 uHeader[RESP_HEADER_HALFWORDS];
+};
+
+static struct sRespHeaderTemplate RespHeaderTemplate[NUM_ETHERNET_INTERFACES];
+
+static void BuildResponseHeaderTemplate(u8 uId, struct sIFObject *pIF, struct sRespHeaderTemplate *pTemplate);
+
 //=================================================================================
 //  CreateResponsePacket
 //--------------------------------------------------------------------------------
 //  This method creates the Ethernet, IP and UDP headers for the response packet.
+//  The headers are copied from the interface's template (rebuilt when the client
+//  or our addresses change) and only the per-response fields are filled in.
 //
 //  Parameter Dir   Description
 //  --------- ---   -----------
@@ -505,64 +614,274 @@ int CheckCommandPacket(u8 * pCommand, u32 uCommandLength)
 void CreateResponsePacket(u8 uId, u8 * uResponsePacketPtr, u32 uResponseLength)
 {
   struct sIFObject *pIF;
-  struct sEthernetHeader *EthernetHeader = (struct sEthernetHeader *) uResponsePacketPtr;
+  struct sRespHeaderTemplate *pTemplate;
+  u16 *pHeader = (u16 *) uResponsePacketPtr;
   u8 * uIPResponseHeader = uResponsePacketPtr + sizeof(sEthernetHeaderT);
   struct sIPV4Header *IPHeader = (struct sIPV4Header *) uIPResponseHeader;
   u8 * uUdpResponseHeader = uIPResponseHeader + sizeof(sIPV4HeaderT);
   struct sUDPHeader * UdpHeader = (struct sUDPHeader *) uUdpResponseHeader;
   u32 uChecksum;
-  u32 uIPHeaderLength = sizeof(sIPV4HeaderT);
   u32 uUdpLength = uResponseLength + sizeof(sUDPHeaderT);
+  u8 uIndex;
+
+  if (uId >= NUM_ETHERNET_INTERFACES){
+    return;
+  }
 
   pIF = lookup_if_handle_by_id(uId);
+  pTemplate = &RespHeaderTemplate[uId];
+
+  if ((pTemplate->uValid == 0) ||
+      (pTemplate->uClientMacHigh != uResponseMacHigh) ||
+      (pTemplate->uClientMacMid != uResponseMacMid) ||
+      (pTemplate->uClientMacLow != uResponseMacLow) ||
+      (pTemplate->uClientIPAddr != uResponseIPAddr) ||
+      (pTemplate->uClientUDPPort != uResponseUDPPort) ||
+      (pTemplate->uSourceIPAddr != pIF->uIFAddrIP) ||
+      (pTemplate->uSourceMacHigh != uEthernetFabricMacHigh[uId]) ||
+      (pTemplate->uSourceMacMid != uEthernetFabricMacMid[uId]) ||
+      (pTemplate->uSourceMacLow != uEthernetFabricMacLow[uId])){
+    BuildResponseHeaderTemplate(uId, pIF, pTemplate);
+  }
 
-  EthernetHeader->uDestMacHigh = uResponseMacHigh;
-  EthernetHeader->uDestMacMid = uResponseMacMid;
-  EthernetHeader->uDestMacLow = uResponseMacLow;
+  for (uIndex = 0; uIndex < RESP_HEADER_HALFWORDS; uIndex++){
+    pHeader[uIndex] = pTemplate->uHeader[uIndex];
+  }
 
-  EthernetHeader->uSourceMacHigh = uEthernetFabricMacHigh[uId];
-  EthernetHeader->uSourceMacMid = uEthernetFabricMacMid[uId];
-  EthernetHeader->uSourceMacLow = uEthernetFabricMacLow[uId];
+  IPHeader->uTotalLength = uResponseLength + sizeof(sIPV4HeaderT) + sizeof(sUDPHeaderT);
+  IPHeader->uIdentification = uIPIdentification[uId]++;
+
+  uChecksum = pTemplate->uIPPartialSum + IPHeader->uTotalLength + IPHeader->uIdentification;
+  uChecksum = CalculateIPChecksum(uChecksum, 0, (u16 *) IPHeader);
+  IPHeader->uChecksum = ~uChecksum;
+
+  UdpHeader->uTotalLength = uUdpLength;
+
+  /* the udp length appears in both the pseudo header and the udp header */
+  uChecksum = pTemplate->uUDPPartialSum + (uUdpLength & 0x0FFFFu) + (uUdpLength & 0x0FFFFu);
+  uChecksum = CalculateIPChecksum(uChecksum, (uUdpLength / 2) - (sizeof(sUDPHeaderT) / 2),
+      (u16 *) (uUdpResponseHeader + sizeof(sUDPHeaderT)));
+  UdpHeader->uChecksum = ~uChecksum;
+}
+
+
+//=================================================================================
+//  SaveResponseClient
+//--------------------------------------------------------------------------------
+//  This method saves the client of the control request currently being handled
+//  so that a response can be sent to it later, outside of the control task.
+//
+//  Parameter Dir   Description
+//  --------- ---   -----------
+//  pClient         OUT Client details
+//
+//  Return
+//  ------
+//  None
+//=================================================================================
+void SaveResponseClient(struct sResponseClient *pClient)
+{
+  pClient->uMacHigh = uResponseMacHigh;
+  pClient->uMacMid = uResponseMacMid;
+  pClient->uMacLow = uResponseMacLow;
+  pClient->uIPAddr = uResponseIPAddr;
+  pClient->uUDPPort = uResponseUDPPort;
+}
+
+
+//=================================================================================
+//  SendResponseToClient
+//--------------------------------------------------------------------------------
+//  This method sends a deferred or unsolicited control response. The payload
+//  must already be in the transmit buffer after the eth, ip and udp headers and
+//  the whole frame must be a multiple of 64 bits.
+//
+//  Parameter Dir   Description
+//  --------- ---   -----------
+//  uId             IN  Interface to send the response on
+//  pClient         IN  Client saved with SaveResponseClient
+//  uResponseLength     IN  Length of payload of response packet
+//
+//  Return
+//  ------
+//  XST_SUCCESS if successful
+//=================================================================================
+int SendResponseToClient(u8 uId, const struct sResponseClient *pClient, u32 uResponseLength)
+{
+  uResponseMacHigh = pClient->uMacHigh;
+  uResponseMacMid = pClient->uMacMid;
+  uResponseMacLow = pClient->uMacLow;
+  uResponseIPAddr = pClient->uIPAddr;
+  uResponseUDPPort = pClient->uUDPPort;
+
+  CreateResponsePacket(uId, (u8 *) uTransmitBuffer, uResponseLength);
+
+  uResponseLength = uResponseLength + sizeof(sEthernetHeaderT) + sizeof(sIPV4HeaderT) + sizeof(sUDPHeaderT);
+
+  return TransmitHostPacket(uId, &uTransmitBuffer[0], uResponseLength >> 2);
+}
+
+
+//=================================================================================
+//  PadResponse
+//--------------------------------------------------------------------------------
+//  This method zero pads a response payload so that the whole frame (eth, ip and
+//  udp headers included) ends on a 64-bit boundary and is at least the minimum
+//  frame size.
+//
+//  Parameter Dir   Description
+//  --------- ---   -----------
+//  pResponse       IN/OUT  Start of the response payload
+//  uResponseLength     IN  Length of the payload before padding
+//
+//  Return
+//  ------
+//  Length of the padded payload
+//=================================================================================
+u32 PadResponse(u8 *pResponse, u32 uResponseLength)
+{
+  const u32 uHeaderLength = sizeof(sEthernetHeaderT) + sizeof(sIPV4HeaderT) + sizeof(sUDPHeaderT);
+
+  while (((uResponseLength + uHeaderLength) % 8) || ((uResponseLength + uHeaderLength) < 64)){
+    pResponse[uResponseLength++] = 0;
+  }
+
+  return uResponseLength;
+}
+
+
+//=================================================================================
+//  ResolveResponseClient
+//--------------------------------------------------------------------------------
+//  This method fills in the mac address of a client which did not send the
+//  request being handled, i.e. a configured destination. A multicast group maps
+//  straight onto its mac address, any other address is looked up in the arp
+//  neighbour table of the interface (and resolved if it is not there yet).
+//
+//  Parameter Dir   Description
+//  --------- ---   -----------
+//  uId             IN  Interface the client is reached on
+//  pClient         IN/OUT  Client with the ip address set, mac address filled in
+//
+//  Return
+//  ------
+//  ARP_RETURN_OK if the mac address is known, ARP_RETURN_REQUEST if it is being
+//  resolved, ARP_RETURN_INVALID if the address is not on-link
+//=================================================================================
+u8 ResolveResponseClient(u8 uId, struct sResponseClient *pClient)
+{
+  const struct sArpNeighbour *pTable;
+  struct sIFObject *pIF;
+  u8 uIndex;
+  u8 uRet;
+
+  /* RFC 1112 - low 23 bits of the group address */
+  if ((pClient->uIPAddr & 0xF0000000) == 0xE0000000){
+    pClient->uMacHigh = 0x0100;
+    pClient->uMacMid = 0x5E00 | ((pClient->uIPAddr >> 16) & 0x7F);
+    pClient->uMacLow = pClient->uIPAddr & 0xFFFF;
+    return ARP_RETURN_OK;
+  }
+
+  pTable = ArpNeighbourGetTable(uId);
+  pIF = lookup_if_handle_by_id(uId);
+  if ((NULL == pTable) || (NULL == pIF)){
+    return ARP_RETURN_FAIL;
+  }
+
+  for (uIndex = 0; uIndex < ARP_NEIGH_TABLE_SIZE; uIndex++){
+    if ((pTable[uIndex].uIPAddr == pClient->uIPAddr) &&
+        ((pTable[uIndex].uState == ARP_NEIGH_STATE_REACHABLE) || (pTable[uIndex].uState == ARP_NEIGH_STATE_STALE))){
+      pClient->uMacHigh = (pTable[uIndex].arrMac[0] << 8) | pTable[uIndex].arrMac[1];
+      pClient->uMacMid = (pTable[uIndex].arrMac[2] << 8) | pTable[uIndex].arrMac[3];
+      pClient->uMacLow = (pTable[uIndex].arrMac[4] << 8) | pTable[uIndex].arrMac[5];
+      return ARP_RETURN_OK;
+    }
+  }
+
+  /* not learnt yet, or evicted since - (re)request it */
+  uRet = ArpNeighbourResolve(pIF, pClient->uIPAddr, 0);
+
+  return (ARP_RETURN_OK == uRet) ? ARP_RETURN_REQUEST : uRet;
+}
+
+
+//=================================================================================
+//  BuildResponseHeaderTemplate
+//--------------------------------------------------------------------------------
+//  This method builds the control response header template for the current
+//  client (uResponseMac*, uResponseIPAddr, uResponseUDPPort) on an interface.
+//
+//  Parameter Dir   Description
+//  --------- ---   -----------
+//  uId         IN  ID of selected Ethernet interface
+//  pIF         IN  Handle to the interface object
+//  pTemplate   OUT Template to build
+//
+//  Return
+//  ------
+//  None
+//=================================================================================
+static void BuildResponseHeaderTemplate(u8 uId, struct sIFObject *pIF, struct sRespHeaderTemplate *pTemplate)
+{
+  u8 * uHeader = (u8 *) pTemplate->uHeader;
+  struct sEthernetHeader *EthernetHeader = (struct sEthernetHeader *) uHeader;
+  struct sIPV4Header *IPHeader = (struct sIPV4Header *) (uHeader + sizeof(sEthernetHeaderT));
+  struct sUDPHeader * UdpHeader = (struct sUDPHeader *) (uHeader + sizeof(sEthernetHeaderT) + sizeof(sIPV4HeaderT));
+  u32 uChecksum;
+
+  pTemplate->uClientMacHigh = uResponseMacHigh;
+  pTemplate->uClientMacMid = uResponseMacMid;
+  pTemplate->uClientMacLow = uResponseMacLow;
+  pTemplate->uClientIPAddr = uResponseIPAddr;
+  pTemplate->uClientUDPPort = uResponseUDPPort;
+  pTemplate->uSourceIPAddr = pIF->uIFAddrIP;
+  pTemplate->uSourceMacHigh = uEthernetFabricMacHigh[uId];
+  pTemplate->uSourceMacMid = uEthernetFabricMacMid[uId];
+  pTemplate->uSourceMacLow = uEthernetFabricMacLow[uId];
+
+  EthernetHeader->uDestMacHigh = pTemplate->uClientMacHigh;
+  EthernetHeader->uDestMacMid = pTemplate->uClientMacMid;
+  EthernetHeader->uDestMacLow = pTemplate->uClientMacLow;
+
+  EthernetHeader->uSourceMacHigh = pTemplate->uSourceMacHigh;
+  EthernetHeader->uSourceMacMid = pTemplate->uSourceMacMid;
+  EthernetHeader->uSourceMacLow = pTemplate->uSourceMacLow;
 
   EthernetHeader->uEthernetType = ETHERNET_TYPE_IPV4;
 
   IPHeader->uVersion = 0x40 | sizeof(sIPV4HeaderT) / 4;
 
   IPHeader->uTypeOfService = 0;
-  IPHeader->uTotalLength = uResponseLength + sizeof(sIPV4HeaderT) + sizeof(sUDPHeaderT);
-  //IPHeader->uTotalLength = uResponseLength + sizeof(sIPV4HeaderT) + sizeof(sUDPHeaderT) - 4;
+  IPHeader->uTotalLength = 0;       /* patched per response */
 
   IPHeader->uFlagsFragment = 0x4000;
-  IPHeader->uIdentification = uIPIdentification[uId]++;
+  IPHeader->uIdentification = 0;    /* patched per response */
 
   IPHeader->uChecksum = 0;
 
   IPHeader->uProtocol = IP_PROTOCOL_UDP;
   IPHeader->uTimeToLive = 0x80;
 
-  IPHeader->uSourceIPHigh = (pIF->uIFAddrIP >> 16) & 0xFFFF;
-  IPHeader->uSourceIPLow = pIF->uIFAddrIP & 0xFFFF;
-  IPHeader->uDestinationIPHigh = (uResponseIPAddr >> 16) & 0xFFFF;
-  IPHeader->uDestinationIPLow = uResponseIPAddr & 0xFFFF;
+  IPHeader->uSourceIPHigh = (pTemplate->uSourceIPAddr >> 16) & 0xFFFF;
+  IPHeader->uSourceIPLow = pTemplate->uSourceIPAddr & 0xFFFF;
+  IPHeader->uDestinationIPHigh = (pTemplate->uClientIPAddr >> 16) & 0xFFFF;
+  IPHeader->uDestinationIPLow = pTemplate->uClientIPAddr & 0xFFFF;
 
-  uChecksum = CalculateIPChecksum(0, uIPHeaderLength / 2, (u16 *) IPHeader);
-  IPHeader->uChecksum = ~uChecksum;
+  pTemplate->uIPPartialSum = CalculateIPChecksum(0, sizeof(sIPV4HeaderT) / 2, (u16 *) IPHeader);
 
-  UdpHeader->uTotalLength = uResponseLength + sizeof(sUDPHeaderT);
-  //UdpHeader->uTotalLength = uResponseLength + sizeof(sUDPHeaderT) - 4;
+  UdpHeader->uTotalLength = 0;      /* patched per response */
   UdpHeader->uChecksum = 0;
   UdpHeader->uSourcePort = ETHERNET_CONTROL_PORT_ADDRESS;
-  UdpHeader->uDestinationPort = uResponseUDPPort;
-
-  uChecksum = (IPHeader->uProtocol & 0x0FFu) + ((IPHeader->uTotalLength - uIPHeaderLength)
-      & 0x0FFFFu);
+  UdpHeader->uDestinationPort = pTemplate->uClientUDPPort;
 
+  uChecksum = (IPHeader->uProtocol & 0x0FFu);
   uChecksum += IPHeader->uSourceIPHigh + IPHeader->uSourceIPLow;
   uChecksum += IPHeader->uDestinationIPHigh + IPHeader->uDestinationIPLow;
 
-  uChecksum = CalculateIPChecksum(uChecksum, uUdpLength / 2, (u16 *) UdpHeader);
-  UdpHeader->uChecksum = ~uChecksum;
+  pTemplate->uUDPPartialSum = CalculateIPChecksum(uChecksum, sizeof(sUDPHeaderT) / 2, (u16 *) UdpHeader);
 
+  pTemplate->uValid = 1;
 }
 
 //=================================================================================
@@ -987,11 +1306,16 @@ int SdramReconfigureCommandHandler(u8 uId, u8 * pCommand, u32 uCommandLength, u8
   u8 num_links;
   u8 link;
   u32 uContinuityData;
+  struct sCtrlSession *pSession;
   /* u32 uMuxSelect = 0; */
 
   if (uCommandLength < sizeof(sSdramReconfigureReqT))
     return XST_FAILURE;
 
+  // Shares the flash bus - leave it alone while a flash block is being erased
+  if (session_flash_busy())
+    return XST_FAILURE;
+
   if (Command->uDoSdramAsyncRead == 0)
   {
     log_printf(LOG_SELECT_GENERAL, LOG_LEVEL_INFO, "OUT: %x CLR SDR: %x FIN: %x ABT: %x RBT: %x\r\n", Command->uOutputMode, Command->uClearSdram, Command->uFinishedWritingToSdram, Command->uAboutToBootFromSdram, Command->uDoReboot);
@@ -1091,18 +1415,23 @@ int SdramReconfigureCommandHandler(u8 uId, u8 * pCommand, u32 uCommandLength, u8
 
   if (Command->uDoSdramAsyncRead == 1)
   {
-    if (uPreviousSequenceNumber == Command->Header.uSequenceNumber)
+    /* a retransmission must not advance the sdram read address again */
+    pSession = session_current();
+    if (pSession == NULL)
+    {
+      uReg = ReadSdramWord();
+    }
+    else if (pSession->uAsyncSdramReadSeq == Command->Header.uSequenceNumber)
     {
-      uReg = uPreviousAsyncSdramRead;
+      uReg = pSession->uAsyncSdramReadData;
     }
     else
     {
       uReg = ReadSdramWord();
-      uPreviousAsyncSdramRead = uReg;
+      pSession->uAsyncSdramReadData = uReg;
+      pSession->uAsyncSdramReadSeq = Command->Header.uSequenceNumber;
     }
 
-    uPreviousSequenceNumber = Command->Header.uSequenceNumber;
-
 #ifdef DEBUG_PRINT
     //log_printf(LOG_SELECT_GENERAL, LOG_LEVEL_INFO, "READ DATA: %x\r\n", uReg);
 #endif
@@ -1179,6 +1508,10 @@ int ReadFlashWordsCommandHandler(u8 * pCommand, u32 uCommandLength, u8 * uRespon
   if (uCommandLength < sizeof(sReadFlashWordsReqT))
     return XST_FAILURE;
 
+  // The flash returns status rather than data while a block is being erased
+  if (session_flash_busy())
+    return XST_FAILURE;
+
   // Execute the command
   //log_printf(LOG_SELECT_GENERAL, LOG_LEVEL_INFO, "NUM WRDS: %x\r\n", Command->uNumWords);
   for (uIndex = 0; uIndex < Command->uNumWords; uIndex++)
@@ -1232,6 +1565,9 @@ int ProgramFlashWordsCommandHandler(u8 * pCommand, u32 uCommandLength, u8 * uRes
   if (uCommandLength < sizeof(sProgramFlashWordsReqT))
     return XST_FAILURE;
 
+  if (session_flash_busy())
+    return XST_FAILURE;
+
   if (Command->uDoBufferedProgramming == 1)
   {
     iStatus = ProgramBuffer(uAddress, Command->uWriteWords, Command->uTotalNumWords, Command->uNumWords, Command->uStartProgram, Command->uFinishProgram);
@@ -1274,7 +1610,10 @@ int ProgramFlashWordsCommandHandler(u8 * pCommand, u32 uCommandLength, u8 * uRes
 //=================================================================================
 //  EraseFlashBlockCommandHandler
 //--------------------------------------------------------------------------------
-//  This method executes the ERASE_FLASH_BLOCK command.
+//  This method executes the ERASE_FLASH_BLOCK command. The erase is only
+//  started here and completes in the background, so no response is sent now
+//  (zero response length) - it is sent by the session task once the erase is
+//  done. An erase requested while another client's erase is in progress fails.
 //
 //  Parameter Dir   Description
 //  --------- ---   -----------
@@ -1291,6 +1630,7 @@ int EraseFlashBlockCommandHandler(u8 * pCommand, u32 uCommandLength, u8 * uRespo
 {
   sEraseFlashBlockReqT *Command = (sEraseFlashBlockReqT *) pCommand;
   sEraseFlashBlockRespT *Response = (sEraseFlashBlockRespT *) uResponsePacketPtr;
+  struct sCtrlSession *pSession;
   int iStatus;
   u8 uPaddingIndex;
   u32 uBlockAddress = (Command->uBlockAddressHigh << 16) | Command->uBlockAddressLow;
@@ -1301,7 +1641,20 @@ int EraseFlashBlockCommandHandler(u8 * pCommand, u32 uCommandLength, u8 * uRespo
   log_printf(LOG_SELECT_GENERAL, LOG_LEVEL_INFO, "BLK ADDR: %x\r\n", uBlockAddress);
 
   // Execute the command
-  iStatus = EraseBlock(uBlockAddress);
+  pSession = session_current();
+  if (pSession == NULL)
+  {
+    iStatus = (session_flash_busy() ? XST_FAILURE : EraseBlock(uBlockAddress));
+  }
+  else
+  {
+    if (session_flash_erase(pSession, Command->Header.uSequenceNumber, uCommandLength, uBlockAddress) == SESSION_RETURN_DEFERRED)
+    {
+      *uResponseLength = 0;
+      return XST_SUCCESS;
+    }
+    iStatus = XST_FAILURE;
+  }
 
   for (uPaddingIndex = 0; uPaddingIndex < 6; uPaddingIndex++)
     Response->uPadding[uPaddingIndex] = 0;
@@ -1945,9 +2298,7 @@ int ConfigureMulticastCommandHandler(u8 uId, u8 * pCommand, u32 uCommandLength,
     log_printf(LOG_SELECT_CTRL, LOG_LEVEL_INFO, "CTRL [%02d] setting fabric multicast registers - ID: %d MC IP: %08x MC MASK: %08x\r\n",
         uId, if_to_configure, uFabricMultiCastIPAddress, uFabricMultiCastIPAddressMask);
 
-    // Execute the command
-    SetMultiCastIPAddress(if_to_configure, uFabricMultiCastIPAddress, uFabricMultiCastIPAddressMask);
-
+    // Execute the command - the igmp layer programs the fabric multicast filter
     if (XST_FAILURE == uIGMPJoinGroup(if_to_configure, uFabricMultiCastIPAddress, uFabricMultiCastIPAddressMask)){
       log_printf(LOG_SELECT_CTRL, LOG_LEVEL_ERROR, "CTRL [%02d] Failed to join multicast group\r\n", uId);
       Response->uStatus = CMD_STATUS_ERROR_GENERAL;
@@ -2131,12 +2482,35 @@ void ArpHandler(u8 uId, u8 uType, u8 *pReceivedArp, u8 *pTransmitBuffer, u32 * u
 }
 #endif
 
+/*
+ * Per-interface IGMP packet template. Only the destination (MAC and IP), the
+ * identification, the message type and the group address differ between IGMP
+ * messages sent on an interface, so the rest of the frame is built once.
+ */
+#define IGMP_PACKET_HALFWORDS   ((sizeof(sEthernetHeaderT) + sizeof(sIPV4HeaderT) + sizeof(sIPV4HeaderOptionsT) + sizeof(sIGMPHeaderT)) / 2)
+
+struct sIGMPPacketTemplate {
+  u8 uValid;
+  u32 uSourceIPAddr;
+  u16 uSourceMacHigh;
+  u16 uSourceMacMid;
+  u16 uSourceMacLow;
+  u32 uIPPartialSum;      /* IP header with zero identification, destination and checksum */
+  u16 uPacket[IGMP_PACKET_HALFWORDS];
+};
+
+static struct sIGMPPacketTemplate IGMPPacketTemplate[NUM_ETHERNET_INTERFACES];
+
+static void BuildIGMPPacketTemplate(u8 uId, struct sIFObject *pIF, struct sIGMPPacketTemplate *pTemplate);
+static struct sIGMPPacketTemplate *GetIGMPPacketTemplate(u8 uId);
+
 //=================================================================================
 //  CreateIGMPPacket
 //--------------------------------------------------------------------------------
 //  This method is used to create the two types of IGMP messages to the router/switch.
 //  Instead of handling query messages, membership reports packets are generated
-//  every 60 seconds.
+//  every 60 seconds. The packet is copied from the interface's template and only
+//  the per-message fields and checksums are filled in.
 //
 //  Parameter Dir   Description
 //  --------- ---   -----------
@@ -2152,151 +2526,333 @@ void ArpHandler(u8 uId, u8 uType, u8 *pReceivedArp, u8 *pTransmitBuffer, u32 * u
 //=================================================================================
 void CreateIGMPPacket(u8 uId, u8 *pTransmitBuffer, u32 * uResponseLength, u8 uMessageType, u32 uGroupAddress)
 {
+  u16 *pPacket = (u16 *) pTransmitBuffer;
   struct sEthernetHeader *EthernetHeader = (struct sEthernetHeader *) pTransmitBuffer;
   u8 * uIPV4Header = pTransmitBuffer + sizeof(sEthernetHeaderT);
   struct sIPV4Header *IPHeader = (struct sIPV4Header *) uIPV4Header;
-  u8 * uIPV4HeaderOptions = uIPV4Header + sizeof(sIPV4HeaderT); 
-  struct sIPV4HeaderOptions *IPHeaderOptions = (struct sIPV4HeaderOptions *) uIPV4HeaderOptions;
-  u8 * uIGMPHeader = uIPV4HeaderOptions + sizeof(sIPV4HeaderOptionsT);
+  u8 * uIGMPHeader = uIPV4Header + sizeof(sIPV4HeaderT) + sizeof(sIPV4HeaderOptionsT);
   struct sIGMPHeader * IGMPHeader = (struct sIGMPHeader *) uIGMPHeader;
-  struct sIFObject *pIF;
+  struct sIGMPPacketTemplate *pTemplate;
 
   u8 uIndex;
   u32 uChecksum;
-  u32 uIPHeaderLength = sizeof(sIPV4HeaderT) + sizeof(sIPV4HeaderOptionsT);
-  u32 uIGMPHeaderLength = sizeof(sIGMPHeaderT);
-
   u32 uTempGroupAddress;
 
-  pIF = lookup_if_handle_by_id(uId);
-
-  if (uMessageType == IGMP_MEMBERSHIP_REPORT)
-    uTempGroupAddress = uGroupAddress;
-  else
-    uTempGroupAddress = IGMP_ALL_ROUTERS_IP_ADDRESS;
-
-  uTempGroupAddress = uTempGroupAddress & IGMP_IP_MASK;
-
-  EthernetHeader->uDestMacHigh = IGMP_MAC_ADDRESS_HIGH;
-  EthernetHeader->uDestMacMid = ((uTempGroupAddress >> 16) & 0xFFFF) | IGMP_MAC_ADDRESS_MID;
-  EthernetHeader->uDestMacLow = (uTempGroupAddress & 0xFFFF);
-
-  EthernetHeader->uSourceMacHigh = uEthernetFabricMacHigh[uId];
-  EthernetHeader->uSourceMacMid = uEthernetFabricMacMid[uId];
-  EthernetHeader->uSourceMacLow = uEthernetFabricMacLow[uId];
-
-  EthernetHeader->uEthernetType = ETHERNET_TYPE_IPV4;
-
-  IPHeader->uVersion = 0x40 | (sizeof(sIPV4HeaderT) + sizeof(sIPV4HeaderOptionsT)) / 4;
-
-  IPHeader->uTypeOfService = 0;
-  IPHeader->uTotalLength = sizeof(sIPV4HeaderT) + sizeof(sIPV4HeaderOptionsT) + sizeof(sIGMPHeaderT) - 18;  /* minus the padding bytes = 9 x 2 */
-  /* RFC 894 - Frame Format - */
-  /* par.2 padding bytes not part of IP packet ie IP Total Length */
-
-  IPHeader->uFlagsFragment = 0x4000;
-  IPHeader->uIdentification = uIPIdentification[uId]++;
-
-  IPHeader->uChecksum = 0;
+  if (uId >= NUM_ETHERNET_INTERFACES){
+    * uResponseLength = 0;
+    return;
+  }
 
-  IPHeader->uProtocol = IP_PROTOCOL_IGMP;
-  IPHeader->uTimeToLive = 0x01; // IGMP TTL = 1
+  pTemplate = GetIGMPPacketTemplate(uId);
 
-  IPHeader->uSourceIPHigh = ((pIF->uIFAddrIP >> 16) & 0xFFFF);
-  IPHeader->uSourceIPLow = (pIF->uIFAddrIP & 0xFFFF);
+  for (uIndex = 0; uIndex < IGMP_PACKET_HALFWORDS; uIndex++){
+    pPacket[uIndex] = pTemplate->uPacket[uIndex];
+  }
 
   if (uMessageType == IGMP_MEMBERSHIP_REPORT)
     uTempGroupAddress = uGroupAddress;
   else
     uTempGroupAddress = IGMP_ALL_ROUTERS_IP_ADDRESS;
 
+  EthernetHeader->uDestMacMid = (((uTempGroupAddress & IGMP_IP_MASK) >> 16) & 0xFFFF) | IGMP_MAC_ADDRESS_MID;
+  EthernetHeader->uDestMacLow = ((uTempGroupAddress & IGMP_IP_MASK) & 0xFFFF);
+
+  IPHeader->uIdentification = uIPIdentification[uId]++;
   IPHeader->uDestinationIPHigh = ((uTempGroupAddress >> 16) & 0xFFFF);
   IPHeader->uDestinationIPLow = (uTempGroupAddress & 0xFFFF);
 
-  /* RFC 2236 - last par on pg. 23: "The IGMPv2 spec requires the presence of the IP Router Alert option
-     [RFC 2113] in all packets described in this memo." */
-
-  /* Router Alert Option - RFC 2113 */
-  IPHeaderOptions->uOptionsHigh = 0x9404;  /* Copied flag = 1; Option class = 0; Option Number = 20; Length = 4; */
-  IPHeaderOptions->uOptionsLow = 0;  /* Router shall examine packet */
-
-  uChecksum = CalculateIPChecksum(0, (uIPHeaderLength + 1) / 2, (u16 *) IPHeader);
+  uChecksum = pTemplate->uIPPartialSum + IPHeader->uIdentification;
+  uChecksum += IPHeader->uDestinationIPHigh + IPHeader->uDestinationIPLow;
+  uChecksum = CalculateIPChecksum(uChecksum, 0, (u16 *) IPHeader);
   IPHeader->uChecksum = ~uChecksum;
 
   IGMPHeader->uType = uMessageType;
-  IGMPHeader->uMaximumResponseTime = 0x0;
-  IGMPHeader->uChecksum = 0x0;
-
   IGMPHeader->uGroupAddressHigh = ((uGroupAddress >> 16) & 0xFFFF);
   IGMPHeader->uGroupAddressLow = (uGroupAddress & 0xFFFF);
 
-  for (uIndex = 0; uIndex < 9; uIndex++)
-    IGMPHeader->uPadding[uIndex] = 0x0;
-
-  uChecksum = CalculateIPChecksum(0, (uIGMPHeaderLength + 1) / 2, (u16 *) IGMPHeader);
+  /* the rest of the igmp message (max response time, checksum, padding) is zero */
+  uChecksum = *((u16 *) IGMPHeader) + IGMPHeader->uGroupAddressHigh + IGMPHeader->uGroupAddressLow;
+  uChecksum = CalculateIPChecksum(uChecksum, 0, (u16 *) IGMPHeader);
   IGMPHeader->uChecksum = ~uChecksum;
 
   * uResponseLength = sizeof(sIGMPHeaderT) + sizeof(sIPV4HeaderOptionsT) + sizeof(sIPV4HeaderT) + sizeof(sEthernetHeaderT);
 }
 
+
 //=================================================================================
-//  DebugLoopbackTestCommandHandler
+//  CreateIGMPv3ReportPacket
 //--------------------------------------------------------------------------------
-//  This method executes the DEBUG_LOOPBACK_TEST command.
+//  This method creates an IGMPv3 membership report (RFC 3376) carrying one group
+//  record, without sources, for each of uNumRecords consecutive group addresses.
+//  The ethernet and ip headers are copied from the interface's IGMP template.
 //
 //  Parameter Dir   Description
 //  --------- ---   -----------
-//  pCommand        IN  Pointer to command header
-//  uCommandLength      IN  Length of command
-//  uResponsePacketPtr    IN  Pointer to where response packet must be constructed
-//  uResponseLength     OUT Length of payload of response packet
+//  uId         IN  Selected Ethernet interface
+//  pTransmitBuffer   OUT Location of transmit buffer (to create IGMP packet)
+//  uResponseLength   OUT Length of IGMP packet, zero on error
+//  uRecordType     IN  Group record type of all the records
+//  uGroupAddress   IN  Address of the first group
+//  uNumRecords     IN  Number of groups (1 to IGMP_V3_RECORDS_PER_REPORT)
 //
 //  Return
 //  ------
-//  XST_SUCCESS if successful
+//  None
 //=================================================================================
-int DebugLoopbackTestCommandHandler(u8 * pCommand, u32 uCommandLength, u8 * uResponsePacketPtr, u32 * uResponseLength)
+void CreateIGMPv3ReportPacket(u8 uId, u8 *pTransmitBuffer, u32 * uResponseLength, u8 uRecordType, u32 uGroupAddress, u32 uNumRecords)
 {
-  sDebugLoopbackTestReqT *Command = (sDebugLoopbackTestReqT *) pCommand;
-  sDebugLoopbackTestRespT *Response = (sDebugLoopbackTestRespT *) uResponsePacketPtr;
-  int iStatus;
-  unsigned uTimeout = 0x0;
-
-  struct sEthernetHeader *EthernetHeader = (struct sEthernetHeader *) uLoopbackTransmitBuffer;
-  u8 * uIPResponseHeader = (u8 *) uLoopbackTransmitBuffer + sizeof(sEthernetHeaderT);
-  struct sIPV4Header *IPHeader = (struct sIPV4Header *) uIPResponseHeader;
-  u8 * uUdpResponseHeader = uIPResponseHeader + sizeof(sIPV4HeaderT);
-  struct sUDPHeader * UdpHeader = (struct sUDPHeader *) uUdpResponseHeader;
-  u8 * uDebugLoopbackTestReq = uUdpResponseHeader + sizeof(sUDPHeaderT);
-  struct sDebugLoopbackTestReq * DebugLoopbackTestReq =  (struct sDebugLoopbackTestReq *) uDebugLoopbackTestReq;
-
-  u8 * uDebugLoopbackTestReqResult =  (u8 *) uLoopbackReceiveBuffer + sizeof(sEthernetHeaderT) + sizeof(sIPV4HeaderT) + sizeof(sUDPHeaderT);
-  struct sDebugLoopbackTestReq * DebugLoopbackTestReqResult =  (struct sDebugLoopbackTestReq *) uDebugLoopbackTestReqResult;
+  u16 *pPacket = (u16 *) pTransmitBuffer;
+  struct sEthernetHeader *EthernetHeader = (struct sEthernetHeader *) pTransmitBuffer;
+  u8 * uIPV4Header = pTransmitBuffer + sizeof(sEthernetHeaderT);
+  struct sIPV4Header *IPHeader = (struct sIPV4Header *) uIPV4Header;
+  u8 * uIGMPHeader = uIPV4Header + sizeof(sIPV4HeaderT) + sizeof(sIPV4HeaderOptionsT);
+  struct sIGMPv3ReportHeader *ReportHeader = (struct sIGMPv3ReportHeader *) uIGMPHeader;
+  struct sIGMPv3GroupRecord *Record = (struct sIGMPv3GroupRecord *) (uIGMPHeader + sizeof(sIGMPv3ReportHeaderT));
+  struct sIGMPPacketTemplate *pTemplate;
 
+  u32 uIndex;
   u32 uChecksum;
-  u32 uIPHeaderLength = sizeof(sIPV4HeaderT);
-  u32 uUdpLength = sizeof(sDebugLoopbackTestReqT) + sizeof(sUDPHeaderT);
-  u8 uIndex;
-  u32 uTransmitNumWords = ((sizeof(sDebugLoopbackTestReqT) + sizeof(sUDPHeaderT) + sizeof(sIPV4HeaderT) + sizeof(sEthernetHeaderT)) >> 2);
-  u32 uReceivedNumWords;
-  struct sIFObject *pIF;
-
-  if (uCommandLength < sizeof(sDebugLoopbackTestReqT))
-    return XST_FAILURE;
+  u32 uIGMPLength;
+  u32 uFrameLength;
 
-  pIF = lookup_if_handle_by_id(Command->uId);
+  if ((uId >= NUM_ETHERNET_INTERFACES) || (uNumRecords == 0) || (uNumRecords > IGMP_V3_RECORDS_PER_REPORT)){
+    * uResponseLength = 0;
+    return;
+  }
 
-  // Create a packet to send to Ethernet I/F being tested
+  pTemplate = GetIGMPPacketTemplate(uId);
 
-  EthernetHeader->uDestMacHigh = 0xFFFF;
-  EthernetHeader->uDestMacMid = 0xFFFF;
-  EthernetHeader->uDestMacLow = 0xFFFF;
+  /* ethernet and ip header (including the router alert option) */
+  for (uIndex = 0; uIndex < ((sizeof(sEthernetHeaderT) + sizeof(sIPV4HeaderT) + sizeof(sIPV4HeaderOptionsT)) / 2); uIndex++){
+    pPacket[uIndex] = pTemplate->uPacket[uIndex];
+  }
 
-  EthernetHeader->uSourceMacHigh = 0x0000;
-  EthernetHeader->uSourceMacMid = 0x0000;
-  EthernetHeader->uSourceMacLow = 0x0000;
+  uIGMPLength = sizeof(sIGMPv3ReportHeaderT) + (uNumRecords * sizeof(sIGMPv3GroupRecordT));
 
-  EthernetHeader->uEthernetType = ETHERNET_TYPE_IPV4;
+  EthernetHeader->uDestMacMid = (((IGMP_V3_ALL_ROUTERS_IP_ADDRESS & IGMP_IP_MASK) >> 16) & 0xFFFF) | IGMP_MAC_ADDRESS_MID;
+  EthernetHeader->uDestMacLow = ((IGMP_V3_ALL_ROUTERS_IP_ADDRESS & IGMP_IP_MASK) & 0xFFFF);
+
+  IPHeader->uTotalLength = sizeof(sIPV4HeaderT) + sizeof(sIPV4HeaderOptionsT) + uIGMPLength;
+  IPHeader->uIdentification = uIPIdentification[uId]++;
+  IPHeader->uDestinationIPHigh = ((IGMP_V3_ALL_ROUTERS_IP_ADDRESS >> 16) & 0xFFFF);
+  IPHeader->uDestinationIPLow = (IGMP_V3_ALL_ROUTERS_IP_ADDRESS & 0xFFFF);
+  IPHeader->uChecksum = 0;
+
+  uChecksum = CalculateIPChecksum(0, (sizeof(sIPV4HeaderT) + sizeof(sIPV4HeaderOptionsT)) / 2, (u16 *) IPHeader);
+  IPHeader->uChecksum = ~uChecksum;
+
+  ReportHeader->uReserved = 0;
+  ReportHeader->uType = IGMP_V3_MEMBERSHIP_REPORT;
+  ReportHeader->uChecksum = 0;
+  ReportHeader->uReserved2 = 0;
+  ReportHeader->uNumRecords = uNumRecords;
+
+  for (uIndex = 0; uIndex < uNumRecords; uIndex++){
+    Record[uIndex].uAuxDataLength = 0;
+    Record[uIndex].uRecordType = uRecordType;
+    Record[uIndex].uNumSources = 0;
+    Record[uIndex].uGroupAddressHigh = ((uGroupAddress >> 16) & 0xFFFF);
+    Record[uIndex].uGroupAddressLow = (uGroupAddress & 0xFFFF);
+    uGroupAddress++;
+  }
+
+  uChecksum = CalculateIPChecksum(0, uIGMPLength / 2, (u16 *) ReportHeader);
+  ReportHeader->uChecksum = ~uChecksum;
+
+  /* pad to the minimum frame size and a multiple of 64 bits, the padding is not part of the ip packet */
+  uFrameLength = sizeof(sEthernetHeaderT) + sizeof(sIPV4HeaderT) + sizeof(sIPV4HeaderOptionsT) + uIGMPLength;
+  uIndex = uFrameLength / 2;
+
+  if (uFrameLength < (IGMP_PACKET_HALFWORDS * 2)){
+    uFrameLength = IGMP_PACKET_HALFWORDS * 2;
+  }
+  uFrameLength = (uFrameLength + 7) & ~0x7;
+
+  for (; uIndex < (uFrameLength / 2); uIndex++){
+    pPacket[uIndex] = 0;
+  }
+
+  * uResponseLength = uFrameLength;
+}
+
+
+//=================================================================================
+//  GetIGMPPacketTemplate
+//--------------------------------------------------------------------------------
+//  This method returns the IGMP packet template of an interface, rebuilding it
+//  if the interface's ip or mac address changed since it was built.
+//
+//  Parameter Dir   Description
+//  --------- ---   -----------
+//  uId         IN  ID of selected Ethernet interface
+//
+//  Return
+//  ------
+//  Pointer to the template
+//=================================================================================
+static struct sIGMPPacketTemplate *GetIGMPPacketTemplate(u8 uId)
+{
+  struct sIGMPPacketTemplate *pTemplate = &IGMPPacketTemplate[uId];
+  struct sIFObject *pIF;
+
+  pIF = lookup_if_handle_by_id(uId);
+
+  if ((pTemplate->uValid == 0) ||
+      (pTemplate->uSourceIPAddr != pIF->uIFAddrIP) ||
+      (pTemplate->uSourceMacHigh != uEthernetFabricMacHigh[uId]) ||
+      (pTemplate->uSourceMacMid != uEthernetFabricMacMid[uId]) ||
+      (pTemplate->uSourceMacLow != uEthernetFabricMacLow[uId])){
+    BuildIGMPPacketTemplate(uId, pIF, pTemplate);
+  }
+
+  return pTemplate;
+}
+
+
+//=================================================================================
+//  BuildIGMPPacketTemplate
+//--------------------------------------------------------------------------------
+//  This method builds the IGMP packet template for an interface.
+//
+//  Parameter Dir   Description
+//  --------- ---   -----------
+//  uId         IN  ID of selected Ethernet interface
+//  pIF         IN  Handle to the interface object
+//  pTemplate   OUT Template to build
+//
+//  Return
+//  ------
+//  None
+//=================================================================================
+static void BuildIGMPPacketTemplate(u8 uId, struct sIFObject *pIF, struct sIGMPPacketTemplate *pTemplate)
+{
+  u8 * uPacket = (u8 *) pTemplate->uPacket;
+  struct sEthernetHeader *EthernetHeader = (struct sEthernetHeader *) uPacket;
+  u8 * uIPV4Header = uPacket + sizeof(sEthernetHeaderT);
+  struct sIPV4Header *IPHeader = (struct sIPV4Header *) uIPV4Header;
+  u8 * uIPV4HeaderOptions = uIPV4Header + sizeof(sIPV4HeaderT);
+  struct sIPV4HeaderOptions *IPHeaderOptions = (struct sIPV4HeaderOptions *) uIPV4HeaderOptions;
+  u8 * uIGMPHeader = uIPV4HeaderOptions + sizeof(sIPV4HeaderOptionsT);
+  struct sIGMPHeader * IGMPHeader = (struct sIGMPHeader *) uIGMPHeader;
+
+  u8 uIndex;
+  u32 uIPHeaderLength = sizeof(sIPV4HeaderT) + sizeof(sIPV4HeaderOptionsT);
+
+  pTemplate->uSourceIPAddr = pIF->uIFAddrIP;
+  pTemplate->uSourceMacHigh = uEthernetFabricMacHigh[uId];
+  pTemplate->uSourceMacMid = uEthernetFabricMacMid[uId];
+  pTemplate->uSourceMacLow = uEthernetFabricMacLow[uId];
+
+  EthernetHeader->uDestMacHigh = IGMP_MAC_ADDRESS_HIGH;
+  EthernetHeader->uDestMacMid = 0;    /* patched per message */
+  EthernetHeader->uDestMacLow = 0;
+
+  EthernetHeader->uSourceMacHigh = pTemplate->uSourceMacHigh;
+  EthernetHeader->uSourceMacMid = pTemplate->uSourceMacMid;
+  EthernetHeader->uSourceMacLow = pTemplate->uSourceMacLow;
+
+  EthernetHeader->uEthernetType = ETHERNET_TYPE_IPV4;
+
+  IPHeader->uVersion = 0x40 | (sizeof(sIPV4HeaderT) + sizeof(sIPV4HeaderOptionsT)) / 4;
+
+  IPHeader->uTypeOfService = 0;
+  IPHeader->uTotalLength = sizeof(sIPV4HeaderT) + sizeof(sIPV4HeaderOptionsT) + sizeof(sIGMPHeaderT) - 18;  /* minus the padding bytes = 9 x 2 */
+  /* RFC 894 - Frame Format - */
+  /* par.2 padding bytes not part of IP packet ie IP Total Length */
+
+  IPHeader->uFlagsFragment = 0x4000;
+  IPHeader->uIdentification = 0;      /* patched per message */
+
+  IPHeader->uChecksum = 0;
+
+  IPHeader->uProtocol = IP_PROTOCOL_IGMP;
+  IPHeader->uTimeToLive = 0x01; // IGMP TTL = 1
+
+  IPHeader->uSourceIPHigh = ((pTemplate->uSourceIPAddr >> 16) & 0xFFFF);
+  IPHeader->uSourceIPLow = (pTemplate->uSourceIPAddr & 0xFFFF);
+
+  IPHeader->uDestinationIPHigh = 0;   /* patched per message */
+  IPHeader->uDestinationIPLow = 0;
+
+  /* RFC 2236 - last par on pg. 23: "The IGMPv2 spec requires the presence of the IP Router Alert option
+     [RFC 2113] in all packets described in this memo." */
+
+  /* Router Alert Option - RFC 2113 */
+  IPHeaderOptions->uOptionsHigh = 0x9404;  /* Copied flag = 1; Option class = 0; Option Number = 20; Length = 4; */
+  IPHeaderOptions->uOptionsLow = 0;  /* Router shall examine packet */
+
+  pTemplate->uIPPartialSum = CalculateIPChecksum(0, (uIPHeaderLength + 1) / 2, (u16 *) IPHeader);
+
+  IGMPHeader->uType = 0;
+  IGMPHeader->uMaximumResponseTime = 0x0;
+  IGMPHeader->uChecksum = 0x0;
+  IGMPHeader->uGroupAddressHigh = 0;
+  IGMPHeader->uGroupAddressLow = 0;
+
+  for (uIndex = 0; uIndex < 9; uIndex++)
+    IGMPHeader->uPadding[uIndex] = 0x0;
+
+  pTemplate->uValid = 1;
+}
+
+//=================================================================================
+//  DebugLoopbackTestCommandHandler
+//--------------------------------------------------------------------------------
+//  This method executes the DEBUG_LOOPBACK_TEST command.
+//
+//  Parameter Dir   Description
+//  --------- ---   -----------
+//  pCommand        IN  Pointer to command header
+//  uCommandLength      IN  Length of command
+//  uResponsePacketPtr    IN  Pointer to where response packet must be constructed
+//  uResponseLength     OUT Length of payload of response packet
+//
+//  Return
+//  ------
+//  XST_SUCCESS if successful
+//=================================================================================
+int DebugLoopbackTestCommandHandler(u8 * pCommand, u32 uCommandLength, u8 * uResponsePacketPtr, u32 * uResponseLength)
+{
+  sDebugLoopbackTestReqT *Command = (sDebugLoopbackTestReqT *) pCommand;
+  sDebugLoopbackTestRespT *Response = (sDebugLoopbackTestRespT *) uResponsePacketPtr;
+  int iStatus;
+  unsigned uTimeout = 0x0;
+
+  struct sEthernetHeader *EthernetHeader = (struct sEthernetHeader *) uLoopbackTransmitBuffer;
+  u8 * uIPResponseHeader = (u8 *) uLoopbackTransmitBuffer + sizeof(sEthernetHeaderT);
+  struct sIPV4Header *IPHeader = (struct sIPV4Header *) uIPResponseHeader;
+  u8 * uUdpResponseHeader = uIPResponseHeader + sizeof(sIPV4HeaderT);
+  struct sUDPHeader * UdpHeader = (struct sUDPHeader *) uUdpResponseHeader;
+  u8 * uDebugLoopbackTestReq = uUdpResponseHeader + sizeof(sUDPHeaderT);
+  struct sDebugLoopbackTestReq * DebugLoopbackTestReq =  (struct sDebugLoopbackTestReq *) uDebugLoopbackTestReq;
+
+  u8 * uDebugLoopbackTestReqResult =  (u8 *) uLoopbackReceiveBuffer + sizeof(sEthernetHeaderT) + sizeof(sIPV4HeaderT) + sizeof(sUDPHeaderT);
+  struct sDebugLoopbackTestReq * DebugLoopbackTestReqResult =  (struct sDebugLoopbackTestReq *) uDebugLoopbackTestReqResult;
+
+  u32 uChecksum;
+  u32 uIPHeaderLength = sizeof(sIPV4HeaderT);
+  u32 uUdpLength = sizeof(sDebugLoopbackTestReqT) + sizeof(sUDPHeaderT);
+  u8 uIndex;
+  u32 uTransmitNumWords = ((sizeof(sDebugLoopbackTestReqT) + sizeof(sUDPHeaderT) + sizeof(sIPV4HeaderT) + sizeof(sEthernetHeaderT)) >> 2);
+  u32 uReceivedNumWords;
+  struct sIFObject *pIF;
+
+  if (uCommandLength < sizeof(sDebugLoopbackTestReqT))
+    return XST_FAILURE;
+
+  pIF = lookup_if_handle_by_id(Command->uId);
+
+  // Create a packet to send to Ethernet I/F being tested
+
+  EthernetHeader->uDestMacHigh = 0xFFFF;
+  EthernetHeader->uDestMacMid = 0xFFFF;
+  EthernetHeader->uDestMacLow = 0xFFFF;
+
+  EthernetHeader->uSourceMacHigh = 0x0000;
+  EthernetHeader->uSourceMacMid = 0x0000;
+  EthernetHeader->uSourceMacLow = 0x0000;
+
+  EthernetHeader->uEthernetType = ETHERNET_TYPE_IPV4;
 
   IPHeader->uVersion = 0x40 | sizeof(sIPV4HeaderT) / 4;
 
@@ -2641,10 +3197,9 @@ int SDRAMProgramOverWishboneCommandHandler(u8 uId, u8 * pCommand, u32 uCommandLe
   u8 link;
   static struct sIFObject *iface;
 
-  /* State variables */
-  /* static u8 uCurrentProgrammingId; */      /* the interface Id we are currently receiving sdram data on */
-  static u32 uChunkIdCached = 0;        /* the last chunk that has been successfully programmed */
-  static u32 uChunkSizeBytesCached = 0;      /* cache the chunk length which is obtained from chunk 0 */
+  /* the programming state (last chunk programmed, chunk size) is kept in the
+     session of the client which sent chunk 0 */
+  struct sCtrlSession *pSession;
 
   sSDRAMProgramOverWishboneReqT *Command = (sSDRAMProgramOverWishboneReqT *) pCommand;
   sSDRAMProgramOverWishboneRespT *Response = (sSDRAMProgramOverWishboneRespT *) uResponsePacketPtr;
@@ -2662,9 +3217,22 @@ int SDRAMProgramOverWishboneCommandHandler(u8 uId, u8 * pCommand, u32 uCommandLe
     return XST_FAILURE;
   }
 
+  /* only the client which sent chunk 0 may carry on programming - or repeat
+     its last chunk once done, in case the response to it was lost */
+  pSession = session_current();
+  if (Command->uChunkNum == 0x0){
+    if (session_flash_busy() || (session_sdram_claim(pSession) != SESSION_RETURN_OK)){
+      log_printf(LOG_SELECT_GENERAL, LOG_LEVEL_WARN, "SDRAM PROGRAM[%02x] Busy - programming by another client in progress.\r\n" , uId);
+      return XST_FAILURE;
+    }
+  } else if ((session_sdram_owner(pSession) == 0) && ((pSession == NULL) || (Command->uChunkNum != pSession->uSdramChunkId))){
+    log_printf(LOG_SELECT_GENERAL, LOG_LEVEL_WARN, "SDRAM PROGRAM[%02x] Chunk %d from a client which did not start programming.\r\n" , uId, Command->uChunkNum);
+    return XST_FAILURE;
+  }
+
   /* check that the chunk size matches the previously cached size set by chunk 0 */
-  if ((Command->uChunkNum != 0) && ((uCommandLength - 8) != uChunkSizeBytesCached)){
-    log_printf(LOG_SELECT_GENERAL, LOG_LEVEL_ERROR, "SDRAM PROGRAM[%02x] Chunk size mismatch - %d expected but %d received.\r\n" , uId, uChunkSizeBytesCached, uCommandLength - 8);
+  if ((Command->uChunkNum != 0) && ((uCommandLength - 8) != pSession->uSdramChunkSizeBytes)){
+    log_printf(LOG_SELECT_GENERAL, LOG_LEVEL_ERROR, "SDRAM PROGRAM[%02x] Chunk size mismatch - %d expected but %d received.\r\n" , uId, pSession->uSdramChunkSizeBytes, uCommandLength - 8);
     return XST_FAILURE;
   }
 
@@ -2676,13 +3244,13 @@ int SDRAMProgramOverWishboneCommandHandler(u8 uId, u8 * pCommand, u32 uCommandLe
     /* only print warnings during programming */
     set_log_level(LOG_LEVEL_WARN);
 
-    uChunkSizeBytesCached = uCommandLength - 8;
+    pSession->uSdramChunkSizeBytes = uCommandLength - 8;
 
     /***************************************************************************
      *  console output needs to be minimal and short - function speed is NB here
      **************************************************************************/
 
-    log_printf(LOG_SELECT_GENERAL, LOG_LEVEL_ALWAYS, "SDRAM PROGRAM[%02x] Chunk 0 - chunk size: %d bytes.\r\n" , uId, uChunkSizeBytesCached);
+    log_printf(LOG_SELECT_GENERAL, LOG_LEVEL_ALWAYS, "SDRAM PROGRAM[%02x] Chunk 0 - chunk size: %d bytes.\r\n" , uId, pSession->uSdramChunkSizeBytes);
 
     /* unsubscribe from all igmp groups when programming starts */
     num_links = get_num_interfaces();
@@ -2693,7 +3261,7 @@ int SDRAMProgramOverWishboneCommandHandler(u8 uId, u8 * pCommand, u32 uCommandLe
       }
     }
 
-    uChunkIdCached = 0;
+    pSession->uSdramChunkId = 0;
     ClearSdram();
     SetOutputMode(0x1, 0x1);
     /* Enable SDRAM Programming via Wishbone Bus */
@@ -2711,9 +3279,9 @@ int SDRAMProgramOverWishboneCommandHandler(u8 uId, u8 * pCommand, u32 uCommandLe
      */
     iface->uIFEnableArpProcessing = ARP_PROCESSING_ENABLE;
 
-  } else if (Command->uChunkNum == (uChunkIdCached + 1)){
+  } else if (Command->uChunkNum == (pSession->uSdramChunkId + 1)){
     /* log_printf(LOG_SELECT_GENERAL, LOG_LEVEL_TRACE, "chunk %d: about to write to sdram\r\n", Command->uChunkNum); */  /* this adds lots of overhead */
-    for (uChunkByteIndex = 0; uChunkByteIndex < (uChunkSizeBytesCached / 2) /*16bit words*/; uChunkByteIndex = uChunkByteIndex + 2){
+    for (uChunkByteIndex = 0; uChunkByteIndex < (pSession->uSdramChunkSizeBytes / 2) /*16bit words*/; uChunkByteIndex = uChunkByteIndex + 2){
       uTemp = (Command->uBitstreamChunk[uChunkByteIndex] << 16 & 0xFFFF0000) | (Command->uBitstreamChunk[uChunkByteIndex + 1] & 0x0000FFFF);
 
       /* Write the 32-bit data word via the Wishbone Bus */
@@ -2733,6 +3301,8 @@ int SDRAMProgramOverWishboneCommandHandler(u8 uId, u8 * pCommand, u32 uCommandLe
       /* restore log-level cached at start of programming */
       restore_log_level();
 
+      session_sdram_release(pSession);
+
       SetOutputMode(0x2, 0x1);
       FinishedWritingToSdram();
 
@@ -2743,11 +3313,11 @@ int SDRAMProgramOverWishboneCommandHandler(u8 uId, u8 * pCommand, u32 uCommandLe
       /* Clear the Control Register Bits */
       Xil_Out32(XPAR_AXI_SLAVE_WISHBONE_CLASSIC_MASTER_0_BASEADDR + FLASH_SDRAM_SPI_ICAPE_ADDR + FLASH_SDRAM_WB_PROGRAM_CTL_REG_ADDRESS, 0x0);
     }
-    uChunkIdCached = Command->uChunkNum;
+    pSession->uSdramChunkId = Command->uChunkNum;
 
     uRetVal = XST_SUCCESS;
 
-  } else if (Command->uChunkNum == uChunkIdCached){
+  } else if (Command->uChunkNum == pSession->uSdramChunkId){
     uRetVal = XST_SUCCESS;
     log_printf(LOG_SELECT_GENERAL, LOG_LEVEL_WARN, "SDRAM PROGRAM[%02x] Chunk %d: already received\r\n", uId, Command->uChunkNum);
   } else {
@@ -2841,6 +3411,8 @@ int GetDHCPTuningDebugCommandHandler(u8 uId, u8 * pCommand, u32 uCommandLength,
   u16 data[4] = {0};
   u16 rom[8];
   u8 uPaddingIndex;
+  struct sIFObject *pIFObj;
+  struct sDHCPObject *pDHCPObj;
 
   sGetDHCPTuningDebugReqT *Command = (sGetDHCPTuningDebugReqT *) pCommand;
   sGetDHCPTuningDebugRespT *Response = (sGetDHCPTuningDebugRespT *) uResponsePacketPtr;
@@ -2884,7 +3456,22 @@ int GetDHCPTuningDebugCommandHandler(u8 uId, u8 * pCommand, u32 uCommandLength,
   Response->Header.uCommandType = Command->Header.uCommandType + 1;
   Response->Header.uSequenceNumber = Command->Header.uSequenceNumber;
 
-  for (uPaddingIndex = 0; uPaddingIndex < 6; uPaddingIndex++){
+  /* report the timing of the interface this request arrived on */
+  pIFObj = lookup_if_handle_by_id(uId);
+  if (pIFObj != NULL){
+    pDHCPObj = &(pIFObj->DHCPContextState);
+    Response->uBindTime = (pDHCPObj->uDHCPBindTime > 0xffff) ? 0xffff : (u16) pDHCPObj->uDHCPBindTime;
+    Response->uBindTimeMax = (pDHCPObj->uDHCPBindTimeMax > 0xffff) ? 0xffff : (u16) pDHCPObj->uDHCPBindTimeMax;
+    Response->uBindTxCount = pDHCPObj->uDHCPBindTxCount;
+    Response->uBackoffTimeout = (u16) pDHCPObj->uDHCPBackoffTimeout;
+  } else {
+    Response->uBindTime = 0;
+    Response->uBindTimeMax = 0;
+    Response->uBindTxCount = 0;
+    Response->uBackoffTimeout = 0;
+  }
+
+  for (uPaddingIndex = 0; uPaddingIndex < 2; uPaddingIndex++){
     Response->uPadding[uPaddingIndex] = 0;
   }
 
@@ -3255,9 +3842,7 @@ static int MulticastLeaveGroup(u8 uId, u8 * pCommand, u32 uCommandLength, u8 * u
       if_to_leave = Command->uLinkId;   /*i.e. the user requested uId in the packet fields */
     }
 
-    log_printf(LOG_SELECT_CTRL, LOG_LEVEL_INFO, "CTRL [%02d] clearing fabric multicast registers for if-%d\r\n", uId, if_to_leave);
-    SetMultiCastIPAddress(if_to_leave, 0xffffffff, 0xffffffff);   /* clear the fabric multicast registers */
-
+    /* the igmp layer clears the fabric multicast registers along with its cached filter */
     if (XST_FAILURE == uIGMPLeaveGroup(if_to_leave)){
       log_printf(LOG_SELECT_CTRL, LOG_LEVEL_ERROR, "CTRL [%02d] Failed to leave multicast group on if-%d\r\n", uId, if_to_leave);
       Response->uSuccess = 0;   /* error */
@@ -3474,6 +4059,1092 @@ static int GetFPGAFanControllerLUTHandler(u8 * pCommand, u32 uCommandLength, u8
 }
 
 
+/* counter snapshot of all the interfaces - latched by the GET_IF_COUNTERS command */
+static u64 uIFCounterSnapshot[NUM_ETHERNET_INTERFACES][IF_COUNTER_MAX];
+static u8 uIFCounterSnapshotLinkStatus[NUM_ETHERNET_INTERFACES];
+static u32 uIFCounterSnapshotUptime = 0;
+
+//=================================================================================
+//  GetIFCountersHandler
+//--------------------------------------------------------------------------------
+//  This method executes the GET_IF_COUNTERS command. If requested, all the
+//  interface counters are latched (and optionally cleared) at the same instant
+//  before the counters of the requested interface are returned.
+//
+//  Parameter Dir   Description
+//  --------- ---   -----------
+//  pCommand        IN  Pointer to command header
+//  uCommandLength      IN  Length of command
+//  uResponsePacketPtr    IN  Pointer to where response packet must be constructed
+//  uResponseLength     OUT Length of payload of response packet
+//
+//  Return
+//  ------
+//  XST_SUCCESS if successful
+//=================================================================================
+static int GetIFCountersHandler(u8 * pCommand, u32 uCommandLength, u8 * uResponsePacketPtr, u32 * uResponseLength){
+  sGetIFCountersReqT *Command = (sGetIFCountersReqT *) pCommand;
+  sGetIFCountersRespT *Response = (sGetIFCountersRespT *) uResponsePacketPtr;
+  struct sIFObject *pIF;
+  u64 uCount;
+  u16 uWord;
+  u8 uIndex;
+  u8 uCounter;
+  u8 status;
+
+  if (uCommandLength < sizeof(sGetIFCountersReqT)){
+    return XST_FAILURE;
+  }
+
+  Response->Header.uCommandType = Command->Header.uCommandType + 1;
+  Response->Header.uSequenceNumber = Command->Header.uSequenceNumber;
+  Response->uId = Command->uId;
+  Response->uLinkStatus = LINK_DOWN;
+  Response->uNumCounters = 0;
+
+  for (uWord = 0; uWord < (IF_COUNTERS_RESP_MAX * 4); uWord++){
+    Response->uCounters[uWord] = 0;
+  }
+
+  for (uWord = 0; uWord < 3; uWord++){
+    Response->uPadding[uWord] = 0;
+  }
+
+  *uResponseLength = sizeof(sGetIFCountersRespT);
+
+  if (Command->uLatch){
+    uIFCounterSnapshotUptime = get_microblaze_uptime_seconds();
+
+    for (uIndex = 0; uIndex < NUM_ETHERNET_INTERFACES; uIndex++){
+      if (IF_ID_PRESENT == check_interface_valid_quietly(uIndex)){
+        pIF = lookup_if_handle_by_id(uIndex);
+        uIFCounterSnapshotLinkStatus[uIndex] = pIF->uIFLinkStatus;
+        IFCountersSnapshot(pIF, uIFCounterSnapshot[uIndex], Command->uResetOnRead ? 1 : 0);
+      } else {
+        uIFCounterSnapshotLinkStatus[uIndex] = LINK_DOWN;
+        for (uCounter = 0; uCounter < IF_COUNTER_MAX; uCounter++){
+          uIFCounterSnapshot[uIndex][uCounter] = 0;
+        }
+      }
+    }
+  }
+
+  Response->uSnapshotUptimeHigh = (uIFCounterSnapshotUptime >> 16) & 0xffff;
+  Response->uSnapshotUptimeLow = uIFCounterSnapshotUptime & 0xffff;
+
+  status = check_interface_valid_quietly(Command->uId);
+  if (IF_ID_PRESENT != status){
+    if (IF_ID_INVALID_RANGE == status){
+      Response->uStatus = CMD_STATUS_ERROR_IF_OUT_OF_RANGE;
+    } else {
+      Response->uStatus = CMD_STATUS_ERROR_IF_NOT_PRESENT;
+    }
+    return XST_SUCCESS;   /* error signalled via the uStatus field */
+  }
+
+  Response->uLinkStatus = uIFCounterSnapshotLinkStatus[Command->uId];
+  Response->uNumCounters = (IF_COUNTER_MAX < IF_COUNTERS_RESP_MAX) ? IF_COUNTER_MAX : IF_COUNTERS_RESP_MAX;
+
+  for (uIndex = 0; uIndex < Response->uNumCounters; uIndex++){
+    uCount = uIFCounterSnapshot[Command->uId][uIndex];
+    Response->uCounters[(uIndex * 4)]     = (uCount >> 48) & 0xffff;
+    Response->uCounters[(uIndex * 4) + 1] = (uCount >> 32) & 0xffff;
+    Response->uCounters[(uIndex * 4) + 2] = (uCount >> 16) & 0xffff;
+    Response->uCounters[(uIndex * 4) + 3] = uCount & 0xffff;
+  }
+
+  Response->uStatus = CMD_STATUS_SUCCESS;
+
+  return XST_SUCCESS;
+}
+
+
+//=================================================================================
+//  GetCpuLoadStatsHandler
+//--------------------------------------------------------------------------------
+//  This method executes the GET_CPU_LOAD_STATS command. It returns the main loop
+//  utilisation measured over the last completed perfmon window.
+//
+//  Parameter Dir   Description
+//  --------- ---   -----------
+//  pCommand        IN  Pointer to command header
+//  uCommandLength      IN  Length of command
+//  uResponsePacketPtr    IN  Pointer to where response packet must be constructed
+//  uResponseLength     OUT Length of payload of response packet
+//
+//  Return
+//  ------
+//  XST_SUCCESS if successful
+//=================================================================================
+static int GetCpuLoadStatsHandler(u8 * pCommand, u32 uCommandLength, u8 * uResponsePacketPtr, u32 * uResponseLength){
+  sGetCpuLoadStatsReqT *Command = (sGetCpuLoadStatsReqT *) pCommand;
+  sGetCpuLoadStatsRespT *Response = (sGetCpuLoadStatsRespT *) uResponsePacketPtr;
+  const struct sPerfStats *pStats;
+  u32 uValue;
+  u8 uIndex;
+
+  if (uCommandLength < sizeof(sGetCpuLoadStatsReqT)){
+    return XST_FAILURE;
+  }
+
+  Response->Header.uCommandType = Command->Header.uCommandType + 1;
+  Response->Header.uSequenceNumber = Command->Header.uSequenceNumber;
+
+  pStats = perfmon_get_stats();
+
+  Response->uLoadPercent = perfmon_cycles_to_percent_x100(pStats->uBusyCycles, pStats->uWindowCycles);
+  Response->uWindowMs = perfmon_cycles_to_us(pStats->uWindowCycles) / 1000;
+
+  Response->uLoopCountHigh = (pStats->uLoopCount >> 16) & 0xffff;
+  Response->uLoopCountLow = pStats->uLoopCount & 0xffff;
+  Response->uIdleLoopCountHigh = (pStats->uIdleLoopCount >> 16) & 0xffff;
+  Response->uIdleLoopCountLow = pStats->uIdleLoopCount & 0xffff;
+
+  uValue = (pStats->uLoopCount != 0) ? (perfmon_cycles_to_us(pStats->uWindowCycles) / pStats->uLoopCount) : 0;
+  Response->uLoopAvgUsHigh = (uValue >> 16) & 0xffff;
+  Response->uLoopAvgUsLow = uValue & 0xffff;
+
+  uValue = perfmon_cycles_to_us(pStats->uLoopMaxCycles);
+  Response->uLoopMaxUsHigh = (uValue >> 16) & 0xffff;
+  Response->uLoopMaxUsLow = uValue & 0xffff;
+
+  uValue = perfmon_cycles_to_us(perfmon_get_loop_max_ever_cycles());
+  Response->uLoopMaxEverUsHigh = (uValue >> 16) & 0xffff;
+  Response->uLoopMaxEverUsLow = uValue & 0xffff;
+
+  Response->uNumTasks = (PERF_TASK_MAX < CPU_LOAD_TASKS_RESP_MAX) ? PERF_TASK_MAX : CPU_LOAD_TASKS_RESP_MAX;
+
+  for (uIndex = 0; uIndex < CPU_LOAD_TASKS_RESP_MAX; uIndex++){
+    if (uIndex < Response->uNumTasks){
+      uValue = perfmon_cycles_to_us(pStats->uTaskMaxCycles[uIndex]);
+      Response->uTasks[(uIndex * 4)]     = perfmon_cycles_to_percent_x100(pStats->uTaskCycles[uIndex], pStats->uWindowCycles);
+      Response->uTasks[(uIndex * 4) + 1] = (pStats->uTaskRuns[uIndex] > 0xffff) ? 0xffff : pStats->uTaskRuns[uIndex];
+      Response->uTasks[(uIndex * 4) + 2] = (uValue >> 16) & 0xffff;
+      Response->uTasks[(uIndex * 4) + 3] = uValue & 0xffff;
+    } else {
+      Response->uTasks[(uIndex * 4)]     = 0;
+      Response->uTasks[(uIndex * 4) + 1] = 0;
+      Response->uTasks[(uIndex * 4) + 2] = 0;
+      Response->uTasks[(uIndex * 4) + 3] = 0;
+    }
+  }
+
+  for (uIndex = 0; uIndex < 4; uIndex++){
+    Response->uPadding[uIndex] = 0;
+  }
+
+  /* clear after reading so that the response reflects the value up to now */
+  if (Command->uResetMaxEver){
+    perfmon_reset_max_ever();
+  }
+
+  *uResponseLength = sizeof(sGetCpuLoadStatsRespT);
+
+  return XST_SUCCESS;
+}
+
+
+//=================================================================================
+//  ProfilerControlHandler
+//--------------------------------------------------------------------------------
+//  This method executes the PROFILER_CONTROL command. It starts, stops or clears
+//  the pc-sampling profiler, or returns a slice of the sample histogram.
+//
+//  Parameter Dir   Description
+//  --------- ---   -----------
+//  pCommand        IN  Pointer to command header
+//  uCommandLength      IN  Length of command
+//  uResponsePacketPtr    IN  Pointer to where response packet must be constructed
+//  uResponseLength     OUT Length of payload of response packet
+//
+//  Return
+//  ------
+//  XST_SUCCESS if successful
+//=================================================================================
+static int ProfilerControlHandler(u8 * pCommand, u32 uCommandLength, u8 * uResponsePacketPtr, u32 * uResponseLength){
+  sProfilerControlReqT *Command = (sProfilerControlReqT *) pCommand;
+  sProfilerControlRespT *Response = (sProfilerControlRespT *) uResponsePacketPtr;
+  u32 uValue;
+  u16 uIndex;
+  u16 uNumBuckets = 0;
+  int iRet = PROF_RETURN_OK;
+
+  if (uCommandLength < sizeof(sProfilerControlReqT)){
+    return XST_FAILURE;
+  }
+
+  Response->Header.uCommandType = Command->Header.uCommandType + 1;
+  Response->Header.uSequenceNumber = Command->Header.uSequenceNumber;
+
+  Response->uAction = Command->uAction;
+  Response->uOffset = Command->uOffset;
+
+  if (prof_is_supported()){
+    switch (Command->uAction){
+      case PROFILER_ACTION_STOP:
+        iRet = prof_stop();
+        break;
+
+      case PROFILER_ACTION_START:
+        iRet = prof_start();
+        break;
+
+      case PROFILER_ACTION_CLEAR:
+        prof_clear();
+        break;
+
+      case PROFILER_ACTION_FETCH:
+        if (Command->uOffset < PROF_NUM_BUCKETS){
+          uNumBuckets = PROF_NUM_BUCKETS - Command->uOffset;
+          if (uNumBuckets > PROFILER_BUCKETS_RESP_MAX){
+            uNumBuckets = PROFILER_BUCKETS_RESP_MAX;
+          }
+        } else {
+          iRet = PROF_RETURN_FAIL;
+        }
+        break;
+
+      default:
+        iRet = PROF_RETURN_FAIL;
+        break;
+    }
+    Response->uStatus = (PROF_RETURN_OK == iRet) ? CMD_STATUS_SUCCESS : CMD_STATUS_ERROR_GENERAL;
+  } else {
+    Response->uStatus = CMD_STATUS_ERROR_GENERAL;
+  }
+
+  Response->uRunning = prof_is_running();
+  Response->uBucketShift = PROF_BUCKET_SHIFT;
+  Response->uNumBucketsTotal = PROF_NUM_BUCKETS;
+  Response->uSampleRateHz = PROF_SAMPLE_RATE_HZ;
+
+  uValue = prof_get_total_samples();
+  Response->uTotalSamplesHigh = (uValue >> 16) & 0xffff;
+  Response->uTotalSamplesLow = uValue & 0xffff;
+
+  uValue = prof_get_out_of_range_samples();
+  Response->uOutOfRangeHigh = (uValue >> 16) & 0xffff;
+  Response->uOutOfRangeLow = uValue & 0xffff;
+
+  Response->uNumBuckets = uNumBuckets;
+
+  for (uIndex = 0; uIndex < PROFILER_BUCKETS_RESP_MAX; uIndex++){
+    if (uIndex < uNumBuckets){
+      Response->uBuckets[uIndex] = prof_get_bucket(Command->uOffset + uIndex);
+    } else {
+      Response->uBuckets[uIndex] = 0;
+    }
+  }
+
+  Response->uPadding[0] = 0;
+
+  *uResponseLength = sizeof(sProfilerControlRespT);
+
+  return XST_SUCCESS;
+}
+
+
+//=================================================================================
+//  GetMemoryUsageHandler
+//--------------------------------------------------------------------------------
+//  This method executes the GET_MEMORY_USAGE command. It returns the section
+//  sizes of the running image and the stack and heap high-water marks.
+//
+//  Parameter Dir   Description
+//  --------- ---   -----------
+//  pCommand        IN  Pointer to command header
+//  uCommandLength      IN  Length of command
+//  uResponsePacketPtr    IN  Pointer to where response packet must be constructed
+//  uResponseLength     OUT Length of payload of response packet
+//
+//  Return
+//  ------
+//  XST_SUCCESS if successful
+//=================================================================================
+static int GetMemoryUsageHandler(u8 * pCommand, u32 uCommandLength, u8 * uResponsePacketPtr, u32 * uResponseLength){
+  sGetMemoryUsageReqT *Command = (sGetMemoryUsageReqT *) pCommand;
+  sGetMemoryUsageRespT *Response = (sGetMemoryUsageRespT *) uResponsePacketPtr;
+  struct sMemUsage Usage;
+
+  if (uCommandLength < sizeof(sGetMemoryUsageReqT)){
+    return XST_FAILURE;
+  }
+
+  Response->Header.uCommandType = Command->Header.uCommandType + 1;
+  Response->Header.uSequenceNumber = Command->Header.uSequenceNumber;
+
+  memmon_get_usage(&Usage);
+
+  Response->uTextSizeHigh = (Usage.uTextSize >> 16) & 0xffff;
+  Response->uTextSizeLow = Usage.uTextSize & 0xffff;
+  Response->uRodataSizeHigh = (Usage.uRodataSize >> 16) & 0xffff;
+  Response->uRodataSizeLow = Usage.uRodataSize & 0xffff;
+  Response->uDataSizeHigh = (Usage.uDataSize >> 16) & 0xffff;
+  Response->uDataSizeLow = Usage.uDataSize & 0xffff;
+  Response->uBssSizeHigh = (Usage.uBssSize >> 16) & 0xffff;
+  Response->uBssSizeLow = Usage.uBssSize & 0xffff;
+  Response->uHeapSizeHigh = (Usage.uHeapSize >> 16) & 0xffff;
+  Response->uHeapSizeLow = Usage.uHeapSize & 0xffff;
+  Response->uHeapHighWaterHigh = (Usage.uHeapHighWater >> 16) & 0xffff;
+  Response->uHeapHighWaterLow = Usage.uHeapHighWater & 0xffff;
+  Response->uStackSizeHigh = (Usage.uStackSize >> 16) & 0xffff;
+  Response->uStackSizeLow = Usage.uStackSize & 0xffff;
+  Response->uStackHighWaterHigh = (Usage.uStackHighWater >> 16) & 0xffff;
+  Response->uStackHighWaterLow = Usage.uStackHighWater & 0xffff;
+  Response->uBramFreeHigh = (Usage.uBramFree >> 16) & 0xffff;
+  Response->uBramFreeLow = Usage.uBramFree & 0xffff;
+
+  Response->uPadding[0] = 0;
+  Response->uPadding[1] = 0;
+  Response->uPadding[2] = 0;
+
+  *uResponseLength = sizeof(sGetMemoryUsageRespT);
+
+  return XST_SUCCESS;
+}
+
+
+//=================================================================================
+//  ArpNeighbourControlHandler
+//--------------------------------------------------------------------------------
+//  This method executes the ARP_NEIGHBOUR_CONTROL command. It adds or removes a
+//  peer to be resolved on an interface and returns the neighbour table.
+//
+//  Parameter Dir   Description
+//  --------- ---   -----------
+//  pCommand        IN  Pointer to command header
+//  uCommandLength      IN  Length of command
+//  uResponsePacketPtr    IN  Pointer to where response packet must be constructed
+//  uResponseLength     OUT Length of payload of response packet
+//
+//  Return
+//  ------
+//  XST_SUCCESS if successful
+//=================================================================================
+static int ArpNeighbourControlHandler(u8 * pCommand, u32 uCommandLength, u8 * uResponsePacketPtr, u32 * uResponseLength){
+  sArpNeighbourControlReqT *Command = (sArpNeighbourControlReqT *) pCommand;
+  sArpNeighbourControlRespT *Response = (sArpNeighbourControlRespT *) uResponsePacketPtr;
+  const struct sArpNeighbour *pTable;
+  struct sIFObject *pIF;
+  u16 *pEntry;
+  u32 uIPAddr;
+  u16 uIndex;
+  u8 status;
+  u8 uRet = ARP_RETURN_OK;
+
+  if (uCommandLength < sizeof(sArpNeighbourControlReqT)){
+    return XST_FAILURE;
+  }
+
+  Response->Header.uCommandType = Command->Header.uCommandType + 1;
+  Response->Header.uSequenceNumber = Command->Header.uSequenceNumber;
+  Response->uId = Command->uId;
+  Response->uAction = Command->uAction;
+  Response->uNumEntries = 0;
+
+  for (uIndex = 0; uIndex < (ARP_NEIGH_ENTRIES_RESP_MAX * 8); uIndex++){
+    Response->uEntries[uIndex] = 0;
+  }
+  Response->uPadding[0] = 0;
+
+  *uResponseLength = sizeof(sArpNeighbourControlRespT);
+
+  status = check_interface_valid_quietly(Command->uId);
+  if (IF_ID_PRESENT != status){
+    if (IF_ID_INVALID_RANGE == status){
+      Response->uStatus = CMD_STATUS_ERROR_IF_OUT_OF_RANGE;
+    } else {
+      Response->uStatus = CMD_STATUS_ERROR_IF_NOT_PRESENT;
+    }
+    return XST_SUCCESS;   /* error signalled via the uStatus field */
+  }
+
+  pIF = lookup_if_handle_by_id(Command->uId);
+  uIPAddr = ((u32) Command->uIPAddrHigh << 16) | Command->uIPAddrLow;
+
+  switch (Command->uAction){
+    case ARP_NEIGH_ACTION_QUERY:
+      break;
+
+    case ARP_NEIGH_ACTION_RESOLVE:
+      uRet = ArpNeighbourResolve(pIF, uIPAddr, ARP_NEIGH_FLAG_PINNED);
+      break;
+
+    case ARP_NEIGH_ACTION_FORGET:
+      uRet = ArpNeighbourForget(pIF, uIPAddr);
+      break;
+
+    default:
+      uRet = ARP_RETURN_FAIL;
+      break;
+  }
+
+  Response->uStatus = (ARP_RETURN_OK == uRet) ? CMD_STATUS_SUCCESS : CMD_STATUS_ERROR_GENERAL;
+
+  pTable = ArpNeighbourGetTable(Command->uId);
+  if (NULL == pTable){
+    return XST_SUCCESS;
+  }
+
+  for (uIndex = 0; (uIndex < ARP_NEIGH_TABLE_SIZE) && (Response->uNumEntries < ARP_NEIGH_ENTRIES_RESP_MAX); uIndex++){
+    if (ARP_NEIGH_STATE_FREE == pTable[uIndex].uState){
+      continue;
+    }
+
+    pEntry = &(Response->uEntries[Response->uNumEntries * 8]);
+    pEntry[0] = (pTable[uIndex].uIPAddr >> 16) & 0xffff;
+    pEntry[1] = pTable[uIndex].uIPAddr & 0xffff;
+    pEntry[2] = (pTable[uIndex].arrMac[0] << 8) | pTable[uIndex].arrMac[1];
+    pEntry[3] = (pTable[uIndex].arrMac[2] << 8) | pTable[uIndex].arrMac[3];
+    pEntry[4] = (pTable[uIndex].arrMac[4] << 8) | pTable[uIndex].arrMac[5];
+    pEntry[5] = pTable[uIndex].uState;
+    pEntry[6] = pTable[uIndex].uFlags;
+    pEntry[7] = pTable[uIndex].uTimer;
+    Response->uNumEntries++;
+  }
+
+  return XST_SUCCESS;
+}
+
+
+//=================================================================================
+//  ArpCacheUploadHandler
+//--------------------------------------------------------------------------------
+//  This method executes the ARP_CACHE_UPLOAD command. It programs a list of
+//  entries into the fabric arp cache of an interface and optionally reads them
+//  back.
+//
+//  Parameter Dir   Description
+//  --------- ---   -----------
+//  pCommand        IN  Pointer to command header
+//  uCommandLength      IN  Length of command
+//  uResponsePacketPtr    IN  Pointer to where response packet must be constructed
+//  uResponseLength     OUT Length of payload of response packet
+//
+//  Return
+//  ------
+//  XST_SUCCESS if successful
+//=================================================================================
+static int ArpCacheUploadHandler(u8 * pCommand, u32 uCommandLength, u8 * uResponsePacketPtr, u32 * uResponseLength){
+  sArpCacheUploadReqT *Command = (sArpCacheUploadReqT *) pCommand;
+  sArpCacheUploadRespT *Response = (sArpCacheUploadRespT *) uResponsePacketPtr;
+  const u32 uHeaderLength = sizeof(sArpCacheUploadReqT) - sizeof(Command->uEntries);
+  u16 *pEntry;
+  u32 uUpper, uLower;
+  u32 uSum1 = 0;
+  u32 uSum2 = 0;
+  u16 uMac[3];
+  u16 uIndex;
+  u16 uWord;
+  u8 status;
+
+  if (uCommandLength < uHeaderLength){
+    return XST_FAILURE;
+  }
+
+  Response->Header.uCommandType = Command->Header.uCommandType + 1;
+  Response->Header.uSequenceNumber = Command->Header.uSequenceNumber;
+  Response->uId = Command->uId;
+  Response->uNumProgrammed = 0;
+  Response->uNumMismatches = 0;
+  Response->uDigestHigh = 0;
+  Response->uDigestLow = 0;
+
+  for (uWord = 0; uWord < 3; uWord++){
+    Response->uPadding[uWord] = 0;
+  }
+
+  *uResponseLength = sizeof(sArpCacheUploadRespT);
+
+  status = check_interface_valid_quietly(Command->uId);
+  if (IF_ID_PRESENT != status){
+    if (IF_ID_INVALID_RANGE == status){
+      Response->uStatus = CMD_STATUS_ERROR_IF_OUT_OF_RANGE;
+    } else {
+      Response->uStatus = CMD_STATUS_ERROR_IF_NOT_PRESENT;
+    }
+    return XST_SUCCESS;   /* error signalled via the uStatus field */
+  }
+
+  /* the entries must all be present in the packet */
+  if ((Command->uNumEntries > ARP_CACHE_UPLOAD_ENTRIES_MAX) ||
+      (uCommandLength < (uHeaderLength + (Command->uNumEntries * 4 * sizeof(u16))))){
+    Response->uStatus = CMD_STATUS_ERROR_GENERAL;
+    return XST_SUCCESS;
+  }
+
+  log_printf(LOG_SELECT_CTRL, LOG_LEVEL_INFO, "CTRL [%02x] arp cache upload of %d entries\r\n", Command->uId, Command->uNumEntries);
+
+  ProgramARPCacheEntries(Command->uId, Command->uEntries, Command->uNumEntries);
+  Response->uNumProgrammed = Command->uNumEntries;
+
+  if (Command->uFlags & ARP_CACHE_UPLOAD_FLAG_READBACK){
+    pEntry = Command->uEntries;
+    for (uIndex = 0; uIndex < Command->uNumEntries; uIndex++){
+      ReadARPCacheEntry(Command->uId, pEntry[0] & 0xFF, &uUpper, &uLower);
+      uMac[0] = uUpper & 0xFFFF;
+      uMac[1] = (uLower >> 16) & 0xFFFF;
+      uMac[2] = uLower & 0xFFFF;
+
+      if ((uMac[0] != pEntry[1]) || (uMac[1] != pEntry[2]) || (uMac[2] != pEntry[3])){
+        Response->uNumMismatches++;
+      }
+
+      for (uWord = 0; uWord < 3; uWord++){
+        uSum1 = (uSum1 + uMac[uWord]) % 65535;
+        uSum2 = (uSum2 + uSum1) % 65535;
+      }
+
+      pEntry += 4;
+    }
+
+    Response->uDigestHigh = uSum2;
+    Response->uDigestLow = uSum1;
+  }
+
+  Response->uStatus = (0 == Response->uNumMismatches) ? CMD_STATUS_SUCCESS : CMD_STATUS_ERROR_GENERAL;
+
+  return XST_SUCCESS;
+}
+
+
+//=================================================================================
+//  IGMPControlHandler
+//--------------------------------------------------------------------------------
+//  This method executes the IGMP_CONTROL command. It optionally sets the IGMP
+//  version and report rate of an interface and returns the IGMP status.
+//
+//  Parameter Dir   Description
+//  --------- ---   -----------
+//  pCommand        IN  Pointer to command header
+//  uCommandLength      IN  Length of command
+//  uResponsePacketPtr    IN  Pointer to where response packet must be constructed
+//  uResponseLength     OUT Length of payload of response packet
+//
+//  Return
+//  ------
+//  XST_SUCCESS if successful
+//=================================================================================
+static int IGMPControlHandler(u8 * pCommand, u32 uCommandLength, u8 * uResponsePacketPtr, u32 * uResponseLength){
+  sIGMPControlReqT *Command = (sIGMPControlReqT *) pCommand;
+  sIGMPControlRespT *Response = (sIGMPControlRespT *) uResponsePacketPtr;
+  const struct sIGMPObject *pIGMP;
+  u32 uMicroseconds;
+  u8 status;
+  u8 uRet = XST_SUCCESS;
+
+  if (uCommandLength < sizeof(sIGMPControlReqT)){
+    return XST_FAILURE;
+  }
+
+  Response->Header.uCommandType = Command->Header.uCommandType + 1;
+  Response->Header.uSequenceNumber = Command->Header.uSequenceNumber;
+  Response->uId = Command->uId;
+  Response->uAction = Command->uAction;
+  Response->uVersion = 0;
+  Response->uReportsPerTick = 0;
+  Response->uState = 0;
+  Response->uFilterAddrHigh = 0;
+  Response->uFilterAddrLow = 0;
+  Response->uFilterMaskHigh = 0;
+  Response->uFilterMaskLow = 0;
+  Response->uJoinToFirstReportHigh = 0;
+  Response->uJoinToFirstReportLow = 0;
+  Response->uJoinToAnnouncedHigh = 0;
+  Response->uJoinToAnnouncedLow = 0;
+  Response->uPadding[0] = 0;
+  Response->uPadding[1] = 0;
+  Response->uPadding[2] = 0;
+
+  *uResponseLength = sizeof(sIGMPControlRespT);
+
+  status = check_interface_valid_quietly(Command->uId);
+  if (IF_ID_PRESENT != status){
+    if (IF_ID_INVALID_RANGE == status){
+      Response->uStatus = CMD_STATUS_ERROR_IF_OUT_OF_RANGE;
+    } else {
+      Response->uStatus = CMD_STATUS_ERROR_IF_NOT_PRESENT;
+    }
+    return XST_SUCCESS;   /* error signalled via the uStatus field */
+  }
+
+  switch (Command->uAction){
+    case IGMP_CTRL_ACTION_QUERY:
+      break;
+
+    case IGMP_CTRL_ACTION_CONFIGURE:
+      uRet = uIGMPConfigure(Command->uId, Command->uVersion & 0xFF, Command->uReportsPerTick);
+      break;
+
+    default:
+      uRet = XST_FAILURE;
+      break;
+  }
+
+  Response->uStatus = (XST_SUCCESS == uRet) ? CMD_STATUS_SUCCESS : CMD_STATUS_ERROR_GENERAL;
+
+  pIGMP = pIGMPGetInfo(Command->uId);
+  if (NULL == pIGMP){
+    return XST_SUCCESS;
+  }
+
+  Response->uVersion = pIGMP->uIGMPVersion;
+  Response->uReportsPerTick = pIGMP->uIGMPReportsPerTick;
+  Response->uState = pIGMP->tIGMPCurrentState;
+  Response->uFilterAddrHigh = (pIGMP->uIGMPFilterAddr >> 16) & 0xFFFF;
+  Response->uFilterAddrLow = pIGMP->uIGMPFilterAddr & 0xFFFF;
+  Response->uFilterMaskHigh = (pIGMP->uIGMPFilterMask >> 16) & 0xFFFF;
+  Response->uFilterMaskLow = pIGMP->uIGMPFilterMask & 0xFFFF;
+
+  uMicroseconds = perfmon_cycles_to_us(pIGMP->uIGMPJoinToFirstReport);
+  Response->uJoinToFirstReportHigh = (uMicroseconds >> 16) & 0xFFFF;
+  Response->uJoinToFirstReportLow = uMicroseconds & 0xFFFF;
+
+  uMicroseconds = perfmon_cycles_to_us(pIGMP->uIGMPJoinToAnnounced);
+  Response->uJoinToAnnouncedHigh = (uMicroseconds >> 16) & 0xFFFF;
+  Response->uJoinToAnnouncedLow = uMicroseconds & 0xFFFF;
+
+  return XST_SUCCESS;
+}
+
+
+//=================================================================================
+//  MulticastRangeControlHandler
+//--------------------------------------------------------------------------------
+//  This method executes the MULTICAST_RANGE_CONTROL command. It joins or leaves
+//  a single multicast group range of an interface, leaving its other ranges
+//  untouched, and returns the interface's range table.
+//
+//  Parameter Dir   Description
+//  --------- ---   -----------
+//  uId             IN  Interface the command was received on
+//  pCommand        IN  Pointer to command header
+//  uCommandLength      IN  Length of command
+//  uResponsePacketPtr    IN  Pointer to where response packet must be constructed
+//  uResponseLength     OUT Length of payload of response packet
+//
+//  Return
+//  ------
+//  XST_SUCCESS if successful
+//=================================================================================
+static int MulticastRangeControlHandler(u8 uId, u8 * pCommand, u32 uCommandLength, u8 * uResponsePacketPtr, u32 * uResponseLength){
+  sMulticastRangeControlReqT *Command = (sMulticastRangeControlReqT *) pCommand;
+  sMulticastRangeControlRespT *Response = (sMulticastRangeControlRespT *) uResponsePacketPtr;
+  const struct sIGMPObject *pIGMP;
+  const struct sIGMPRange *pRange;
+  u32 uBaseAddr;
+  u32 uMask;
+  u8 if_id;
+  u8 status;
+  u8 uRet = XST_SUCCESS;
+  u8 r;
+  u16 uIndex;
+
+  if (uCommandLength < sizeof(sMulticastRangeControlReqT)){
+    return XST_FAILURE;
+  }
+
+  /* 0xff is a special case i.e. this interface */
+  if_id = (Command->uId == 0xff) ? uId : Command->uId;
+
+  Response->Header.uCommandType = Command->Header.uCommandType + 1;
+  Response->Header.uSequenceNumber = Command->Header.uSequenceNumber;
+  Response->uId = if_id;
+  Response->uAction = Command->uAction;
+  Response->uNumRanges = 0;
+  Response->uFilterAddrHigh = 0;
+  Response->uFilterAddrLow = 0;
+  Response->uFilterMaskHigh = 0;
+  Response->uFilterMaskLow = 0;
+  for (uIndex = 0; uIndex < (MC_RANGE_ENTRIES_RESP_MAX * 5); uIndex++){
+    Response->uRanges[uIndex] = 0;
+  }
+  Response->uPadding[0] = 0;
+  uIndex = 0;
+
+  *uResponseLength = sizeof(sMulticastRangeControlRespT);
+
+  status = check_interface_valid_quietly(if_id);
+  if (IF_ID_PRESENT != status){
+    if (IF_ID_INVALID_RANGE == status){
+      Response->uStatus = CMD_STATUS_ERROR_IF_OUT_OF_RANGE;
+    } else {
+      Response->uStatus = CMD_STATUS_ERROR_IF_NOT_PRESENT;
+    }
+    return XST_SUCCESS;   /* error signalled via the uStatus field */
+  }
+
+  uBaseAddr = (Command->uBaseAddrHigh << 16) | Command->uBaseAddrLow;
+  uMask = (Command->uMaskHigh << 16) | Command->uMaskLow;
+
+  switch (Command->uAction){
+    case MC_RANGE_ACTION_QUERY:
+      break;
+
+    case MC_RANGE_ACTION_JOIN:
+      log_printf(LOG_SELECT_CTRL, LOG_LEVEL_INFO, "CTRL [%02d] joining multicast range on if-%d - MC IP: %08x MC MASK: %08x\r\n",
+          uId, if_id, uBaseAddr, uMask);
+      uRet = uIGMPAddRange(if_id, uBaseAddr, uMask);
+      break;
+
+    case MC_RANGE_ACTION_LEAVE:
+      log_printf(LOG_SELECT_CTRL, LOG_LEVEL_INFO, "CTRL [%02d] leaving multicast range on if-%d - MC IP: %08x MC MASK: %08x\r\n",
+          uId, if_id, uBaseAddr, uMask);
+      uRet = uIGMPRemoveRange(if_id, uBaseAddr, uMask);
+      break;
+
+    default:
+      uRet = XST_FAILURE;
+      break;
+  }
+
+  Response->uStatus = (XST_SUCCESS == uRet) ? CMD_STATUS_SUCCESS : CMD_STATUS_ERROR_GENERAL;
+
+  pIGMP = pIGMPGetInfo(if_id);
+  if (NULL == pIGMP){
+    return XST_SUCCESS;
+  }
+
+  Response->uFilterAddrHigh = (pIGMP->uIGMPFilterAddr >> 16) & 0xFFFF;
+  Response->uFilterAddrLow = pIGMP->uIGMPFilterAddr & 0xFFFF;
+  Response->uFilterMaskHigh = (pIGMP->uIGMPFilterMask >> 16) & 0xFFFF;
+  Response->uFilterMaskLow = pIGMP->uIGMPFilterMask & 0xFFFF;
+
+  for (r = 0; (r < IGMP_RANGES_MAX) && (r < MC_RANGE_ENTRIES_RESP_MAX); r++){
+    pRange = &(pIGMP->IGMPRanges[r]);
+    if (pRange->tState == IGMP_RANGE_FREE){
+      continue;
+    }
+    Response->uRanges[uIndex++] = (pRange->uBaseAddr >> 16) & 0xFFFF;
+    Response->uRanges[uIndex++] = pRange->uBaseAddr & 0xFFFF;
+    Response->uRanges[uIndex++] = (pRange->uMask >> 16) & 0xFFFF;
+    Response->uRanges[uIndex++] = pRange->uMask & 0xFFFF;
+    Response->uRanges[uIndex++] = pRange->tState;
+    Response->uNumRanges++;
+  }
+
+  return XST_SUCCESS;
+}
+
+
+
+//=================================================================================
+//  StreamReadWishboneHandler
+//--------------------------------------------------------------------------------
+//  This method executes the STREAM_READ_WISHBONE command. A start request sets up
+//  a streamed read of a wishbone region which is then sent from the main loop as
+//  numbered data frames; a nack request queues lost frames for retransmission.
+//  Every request is answered with the state of the current stream.
+//
+//  Parameter Dir   Description
+//  --------- ---   -----------
+//  uId             IN  Interface the command was received on
+//  pCommand        IN  Pointer to command header
+//  uCommandLength      IN  Length of command
+//  uResponsePacketPtr    IN  Pointer to where response packet must be constructed
+//  uResponseLength     OUT Length of payload of response packet
+//
+//  Return
+//  ------
+//  XST_SUCCESS if successful
+//=================================================================================
+static int StreamReadWishboneHandler(u8 uId, u8 * pCommand, u32 uCommandLength, u8 * uResponsePacketPtr, u32 * uResponseLength){
+  sStreamReadWishboneReqT *Command = (sStreamReadWishboneReqT *) pCommand;
+  sStreamReadWishboneRespT *Response = (sStreamReadWishboneRespT *) uResponsePacketPtr;
+  struct sStreamStatus Status;
+  u32 uStartAddr;
+  u32 uLength;
+  u16 uWordsPerFrame;
+  int iRet = STREAM_RETURN_OK;
+
+  /* the nack list is variable length - only the fixed part has to be present */
+  if (uCommandLength < (sizeof(sStreamReadWishboneReqT) - sizeof(Command->uNackSeq))){
+    return XST_FAILURE;
+  }
+
+  Response->Header.uCommandType = Command->Header.uCommandType + 1;
+  Response->Header.uSequenceNumber = Command->Header.uSequenceNumber;
+  Response->uAction = Command->uAction;
+  Response->uStreamId = Command->uStreamId;
+  Response->uStatus = CMD_STATUS_SUCCESS;
+
+  *uResponseLength = sizeof(sStreamReadWishboneRespT);
+
+  switch (Command->uAction){
+    case STREAM_ACTION_STATUS:
+      break;
+
+    case STREAM_ACTION_START:
+      uStartAddr = (Command->uStartAddressHigh << 16) | Command->uStartAddressLow;
+      uLength = (Command->uLengthHigh << 16) | Command->uLengthLow;
+      uWordsPerFrame = (0 == Command->uWordsPerFrame) ? STREAM_WORDS_PER_FRAME_MAX : Command->uWordsPerFrame;
+
+      if ((0 == uLength) || (uWordsPerFrame > STREAM_WORDS_PER_FRAME_MAX) ||
+          (((uLength + uWordsPerFrame - 1) / uWordsPerFrame) > 0xFFFF)){
+        Response->uStatus = CMD_STATUS_ERROR_LENGTH;
+        break;
+      }
+
+      iRet = stream_start(uId, Command->uStreamId, Command->Header.uSequenceNumber, uStartAddr, uLength,
+          Command->uStride, uWordsPerFrame, Command->uFrameGapUs);
+      break;
+
+    case STREAM_ACTION_NACK:
+      if ((Command->uNumNacks > STREAM_NACK_MAX) ||
+          (uCommandLength < (sizeof(sStreamReadWishboneReqT) - sizeof(Command->uNackSeq) + (Command->uNumNacks * 2)))){
+        Response->uStatus = CMD_STATUS_ERROR_LENGTH;
+        break;
+      }
+
+      iRet = stream_nack(Command->uStreamId, Command->uNackSeq, Command->uNumNacks);
+      break;
+
+    case STREAM_ACTION_ABORT:
+      iRet = stream_abort(Command->uStreamId);
+      break;
+
+    default:
+      iRet = STREAM_RETURN_FAIL;
+      break;
+  }
+
+  if (STREAM_RETURN_OK != iRet){
+    Response->uStatus = CMD_STATUS_ERROR_GENERAL;
+  }
+
+  stream_get_status(&Status);
+  Response->uActive = Status.uActive;
+  Response->uTotalFrames = Status.uTotalFrames;
+  Response->uNextFrame = Status.uNextFrame;
+  Response->uWordsPerFrame = Status.uWordsPerFrame;
+  Response->uRetransmitPending = Status.uRetransmitPending;
+  Response->uFramesRetransmitted = Status.uFramesRetransmitted;
+
+  return XST_SUCCESS;
+}
+
+
+//=================================================================================
+//  ReadModifyWriteRegHandler
+//--------------------------------------------------------------------------------
+//  This method executes the READ_MODIFY_WRITE_REG command. It modifies the bits
+//  selected by the mask of a board, dsp or wishbone register (masked write, set,
+//  clear or toggle) and returns the value before and after the write.
+//
+//  Parameter Dir   Description
+//  --------- ---   -----------
+//  pCommand        IN  Pointer to command header
+//  uCommandLength      IN  Length of command
+//  uResponsePacketPtr    IN  Pointer to where response packet must be constructed
+//  uResponseLength     OUT Length of payload of response packet
+//
+//  Return
+//  ------
+//  XST_SUCCESS if successful
+//=================================================================================
+static int ReadModifyWriteRegHandler(u8 * pCommand, u32 uCommandLength, u8 * uResponsePacketPtr, u32 * uResponseLength){
+  sReadModifyWriteRegReqT *Command = (sReadModifyWriteRegReqT *) pCommand;
+  sReadModifyWriteRegRespT *Response = (sReadModifyWriteRegRespT *) uResponsePacketPtr;
+  u32 uAddress;
+  u32 uValue;
+  u32 uMask;
+  u32 uOld = 0;
+  u32 uNew = 0;
+
+  if (uCommandLength < sizeof(sReadModifyWriteRegReqT)){
+    return XST_FAILURE;
+  }
+
+  uAddress = (Command->uRegAddressHigh << 16) | Command->uRegAddressLow;
+  uValue = (Command->uValueHigh << 16) | Command->uValueLow;
+  uMask = (Command->uMaskHigh << 16) | Command->uMaskLow;
+
+  Response->Header.uCommandType = Command->Header.uCommandType + 1;
+  Response->Header.uSequenceNumber = Command->Header.uSequenceNumber;
+  Response->uRegSpace = Command->uRegSpace;
+  Response->uOperation = Command->uOperation;
+  Response->uRegAddressHigh = Command->uRegAddressHigh;
+  Response->uRegAddressLow = Command->uRegAddressLow;
+  Response->uStatus = CMD_STATUS_SUCCESS;
+
+  *uResponseLength = sizeof(sReadModifyWriteRegRespT);
+
+  if ((Command->uRegSpace != BOARD_REG) && (Command->uRegSpace != DSP_REG) && (Command->uRegSpace != WISHBONE_REG)){
+    Response->uStatus = CMD_STATUS_ERROR_GENERAL;
+  } else if ((Command->uRegSpace == BOARD_REG) && ((uAddress >> 2) >= NUM_REGISTERS)){
+    /* the shadow copy only covers NUM_REGISTERS board registers */
+    Response->uStatus = CMD_STATUS_ERROR_GENERAL;
+  } else if (Command->uOperation > RMW_OP_TOGGLE){
+    Response->uStatus = CMD_STATUS_ERROR_GENERAL;
+  }
+
+  if (Response->uStatus == CMD_STATUS_SUCCESS){
+    (void) read_and_clear_error_flag();
+
+    if (Command->uRegSpace == BOARD_REG){
+      uOld = uWriteBoardShadowRegs[uAddress >> 2];
+    } else if (Command->uRegSpace == DSP_REG){
+      uOld = ReadDSPRegister(uAddress);
+    } else {
+      uOld = ReadWishboneRegister(uAddress);
+    }
+
+    switch (Command->uOperation){
+      case RMW_OP_MASKED:
+        uNew = (uOld & ~uMask) | (uValue & uMask);
+        break;
+
+      case RMW_OP_SET:
+        uNew = uOld | uMask;
+        break;
+
+      case RMW_OP_CLEAR:
+        uNew = uOld & ~uMask;
+        break;
+
+      default:
+        uNew = uOld ^ uMask;
+        break;
+    }
+
+    /* do not write back a value which could not be read */
+    if (read_and_clear_error_flag() == ERROR_AXI_DATA_BUS){
+      Response->uStatus = CMD_STATUS_ERROR_BUS;
+    } else if (Command->uRegSpace == BOARD_REG){
+      WriteBoardRegister(uAddress, uNew);
+    } else if (Command->uRegSpace == DSP_REG){
+      WriteDSPRegister(uAddress, uNew);
+    } else {
+      WriteWishboneRegister(uAddress, uNew);
+    }
+
+    if (read_and_clear_error_flag() == ERROR_AXI_DATA_BUS){
+      Response->uStatus = CMD_STATUS_ERROR_BUS;
+    }
+
+    if (Response->uStatus == CMD_STATUS_ERROR_BUS){
+      log_printf(LOG_SELECT_CTRL, LOG_LEVEL_ERROR, "CTRL [..] AXI data bus error on read-modify-write of %08x\r\n", uAddress);
+      uNew = uOld;
+    }
+  }
+
+  Response->uOldValueHigh = (uOld >> 16) & 0xFFFF;
+  Response->uOldValueLow = uOld & 0xFFFF;
+  Response->uNewValueHigh = (uNew >> 16) & 0xFFFF;
+  Response->uNewValueLow = uNew & 0xFFFF;
+
+  return XST_SUCCESS;
+}
+
+
+//=================================================================================
+//  PollWishboneHandler
+//--------------------------------------------------------------------------------
+//  This method executes the POLL_WISHBONE command. The register is read once
+//  here; if the condition is not met yet the poll carries on from the main loop
+//  and no response is sent now (zero response length) - the single response
+//  follows when the poll completes.
+//
+//  Parameter Dir   Description
+//  --------- ---   -----------
+//  uId             IN  Interface the command was received on
+//  pCommand        IN  Pointer to command header
+//  uCommandLength      IN  Length of command
+//  uResponsePacketPtr    IN  Pointer to where response packet must be constructed
+//  uResponseLength     OUT Length of payload of response packet
+//
+//  Return
+//  ------
+//  XST_SUCCESS if successful
+//=================================================================================
+static int PollWishboneHandler(u8 uId, u8 * pCommand, u32 uCommandLength, u8 * uResponsePacketPtr, u32 * uResponseLength){
+  sPollWishboneReqT *Command = (sPollWishboneReqT *) pCommand;
+  sPollWishboneRespT *Response = (sPollWishboneRespT *) uResponsePacketPtr;
+
+  if (uCommandLength < sizeof(sPollWishboneReqT)){
+    return XST_FAILURE;
+  }
+
+  if (poll_start(uId, Command, uCommandLength, Response) == POLL_RETURN_DEFERRED){
+    *uResponseLength = 0;
+  } else {
+    *uResponseLength = sizeof(sPollWishboneRespT);
+  }
+
+  return XST_SUCCESS;
+}
+
+
+//=================================================================================
+//  WatchRegisterControlHandler
+//--------------------------------------------------------------------------------
+//  This method executes the WATCH_REGISTER_CONTROL command. It adds or removes
+//  watch list entries, sets the notification destination and returns the watch
+//  list. The notifications themselves are sent from the main loop.
+//
+//  Parameter Dir   Description
+//  --------- ---   -----------
+//  uId             IN  Interface the command was received on
+//  pCommand        IN  Pointer to command header
+//  uCommandLength      IN  Length of command
+//  uResponsePacketPtr    IN  Pointer to where response packet must be constructed
+//  uResponseLength     OUT Length of payload of response packet
+//
+//  Return
+//  ------
+//  XST_SUCCESS if successful
+//=================================================================================
+static int WatchRegisterControlHandler(u8 uId, u8 * pCommand, u32 uCommandLength, u8 * uResponsePacketPtr, u32 * uResponseLength){
+  sWatchRegisterControlReqT *Command = (sWatchRegisterControlReqT *) pCommand;
+  sWatchRegisterControlRespT *Response = (sWatchRegisterControlRespT *) uResponsePacketPtr;
+
+  if (uCommandLength < sizeof(sWatchRegisterControlReqT)){
+    return XST_FAILURE;
+  }
+
+  watch_control(uId, Command, Response);
+
+  *uResponseLength = sizeof(sWatchRegisterControlRespT);
+
+  return XST_SUCCESS;
+}
+
+
+//=================================================================================
+//  TelemetryControlHandler
+//--------------------------------------------------------------------------------
+//  This method executes the TELEMETRY_CONTROL command. It starts (or restarts
+//  with new settings), stops or queries the periodic telemetry push. The reports
+//  themselves are sent from the main loop.
+//
+//  Parameter Dir   Description
+//  --------- ---   -----------
+//  uId             IN  Interface the command was received on
+//  pCommand        IN  Pointer to command header
+//  uCommandLength      IN  Length of command
+//  uResponsePacketPtr    IN  Pointer to where response packet must be constructed
+//  uResponseLength     OUT Length of payload of response packet
+//
+//  Return
+//  ------
+//  XST_SUCCESS if successful
+//=================================================================================
+static int TelemetryControlHandler(u8 uId, u8 * pCommand, u32 uCommandLength, u8 * uResponsePacketPtr, u32 * uResponseLength){
+  sTelemetryControlReqT *Command = (sTelemetryControlReqT *) pCommand;
+  sTelemetryControlRespT *Response = (sTelemetryControlRespT *) uResponsePacketPtr;
+
+  if (uCommandLength < sizeof(sTelemetryControlReqT)){
+    return XST_FAILURE;
+  }
+
+  telemetry_control(uId, Command, Response);
+
+  *uResponseLength = sizeof(sTelemetryControlRespT);
+
+  return XST_SUCCESS;
+}
+
+
 //=================================================================================
 //	ADCMezzanineResetAndProgramCommandHandler
 //--------------------------------------------------------------------------------
@@ -30,6 +30,15 @@
 extern "C" {
 #endif
 
+/* client of a control request, saved so that its response can be sent later */
+struct sResponseClient {
+  u16 uMacHigh;
+  u16 uMacMid;
+  u16 uMacLow;
+  u32 uIPAddr;
+  u32 uUDPPort;
+};
+
 u32 CalculateIPChecksum(u32 uChecksum, u32 uLength, u16 *pHeaderPtr);
 int CheckIPV4Header(u32 uIPAddress, u32 uSubnet, u32 uPacketLength, u8 * pIPHeaderPointer);
 u8 * ExtractIPV4FieldsAndGetPayloadPointer(u8 *pIPHeaderPointer, u32 *uIPPayloadLength, u32 *uResponseIPAddr, u32 *uProtocol, u32 * uTOS);
@@ -38,9 +47,14 @@ u8 *ExtractUdpFieldsAndGetPayloadPointer(u8 *pUdpHeaderPointer,u32 *uPayloadLeng
 int CommandSorter(u8 uId, u8 * pCommand, u32 uCommandLength, u8 * uResponsePacketPtr, u32 * uResponseLength);
 int CheckCommandPacket(u8 * pCommand, u32 uCommandLength);
 void CreateResponsePacket(u8 uId, u8 * uResponsePacketPtr, u32 uResponseLength);
+void SaveResponseClient(struct sResponseClient *pClient);
+int SendResponseToClient(u8 uId, const struct sResponseClient *pClient, u32 uResponseLength);
+u32 PadResponse(u8 *pResponse, u32 uResponseLength);
+u8 ResolveResponseClient(u8 uId, struct sResponseClient *pClient);
 int CheckArpRequest(u8 uId, u32 uFabricIPAddress, u32 uPktLen, u8 *pArpPacket);
 void ArpHandler(u8 uId, u8 uType, u8 *pReceivedArp, u8 *pTransmitBuffer, u32 * uResponseLength, u32 uRequestedIPAddress);
 void CreateIGMPPacket(u8 uId, u8 *pTransmitBuffer, u32 * uResponseLength, u8 uMessageType, u32 uGroupAddress);
+void CreateIGMPv3ReportPacket(u8 uId, u8 *pTransmitBuffer, u32 * uResponseLength, u8 uRecordType, u32 uGroupAddress, u32 uNumRecords);
 
 // COMMAND HANDLERS
 int WriteRegCommandHandler(u8 * pCommand, u32 uCommandLength, u8 * uResponsePacketPtr, u32 * uResponseLength);
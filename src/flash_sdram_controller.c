@@ -683,29 +683,76 @@ int ProgramBuffer(u32 uAddress, u16 * puDataArray, u16 uTotalNumWords, u16 uNumW
 int EraseBlock(u32 uBlockAddress)
 {
   u32 uTimeOut = 0x0;
-  u32 uStatusReg = 0x0;
-
-  ClearStatusRegisterCmd(uBlockAddress);
+  int iStatus;
 
-  UnlockBlockCmd(uBlockAddress & FLASH_BLOCK_ADDRESS_MASK);
-
-  BlockEraseCmd(uBlockAddress & FLASH_BLOCK_ADDRESS_MASK);
+  StartEraseBlock(uBlockAddress);
 
   do
   {
-    uStatusReg = ReadStatusRegisterCmd(uBlockAddress & FLASH_PARTITION_ADDRESS_MASK);
+    iStatus = CheckEraseBlock(uBlockAddress);
     Delay(100);
     uTimeOut ++;
   }
-  while(((uStatusReg & FLASH_STATUS_WRITE_STATUS) == 0x0) && (uTimeOut < FLASH_ERASE_TIMEOUT));
+  while((iStatus == XST_DEVICE_BUSY) && (uTimeOut < FLASH_ERASE_TIMEOUT));
 
 
-  if (uTimeOut == FLASH_ERASE_TIMEOUT)
+  if (iStatus == XST_DEVICE_BUSY)
   {
     log_printf(LOG_SELECT_GENERAL, LOG_LEVEL_INFO, "Erase timeout!\r\n");
     return XST_FAILURE;
   }
 
+  return iStatus;
+
+}
+
+//=================================================================================
+//  StartEraseBlock
+//--------------------------------------------------------------------------------
+//  This method starts the erase of a block in the FLASH without waiting for it
+//  to complete. Use CheckEraseBlock to find out when it has. The FLASH cannot
+//  be read or programmed in the meantime.
+//
+//  Parameter Dir   Description
+//  --------- ---   -----------
+//  uBlockAddress IN  Device address to erase
+//
+//  Return
+//  ------
+//  None
+//=================================================================================
+void StartEraseBlock(u32 uBlockAddress)
+{
+  ClearStatusRegisterCmd(uBlockAddress);
+
+  UnlockBlockCmd(uBlockAddress & FLASH_BLOCK_ADDRESS_MASK);
+
+  BlockEraseCmd(uBlockAddress & FLASH_BLOCK_ADDRESS_MASK);
+}
+
+//=================================================================================
+//  CheckEraseBlock
+//--------------------------------------------------------------------------------
+//  This method checks on a block erase started with StartEraseBlock.
+//
+//  Parameter Dir   Description
+//  --------- ---   -----------
+//  uBlockAddress IN  Device address being erased
+//
+//  Return
+//  ------
+//  XST_DEVICE_BUSY while the erase is still in progress, otherwise XST_SUCCESS
+//  if the block was erased successfully
+//=================================================================================
+int CheckEraseBlock(u32 uBlockAddress)
+{
+  u32 uStatusReg = 0x0;
+
+  uStatusReg = ReadStatusRegisterCmd(uBlockAddress & FLASH_PARTITION_ADDRESS_MASK);
+
+  if ((uStatusReg & FLASH_STATUS_WRITE_STATUS) == 0x0)
+    return XST_DEVICE_BUSY;
+
   if ((uStatusReg & FLASH_STATUS_ERASE_STATUS) != 0x0)
   {
     log_printf(LOG_SELECT_GENERAL, LOG_LEVEL_INFO, "Erase error!\r\n");
@@ -727,7 +774,6 @@ int EraseBlock(u32 uBlockAddress)
   ClearStatusRegisterCmd(uBlockAddress);
 
   return XST_SUCCESS;
-
 }
 
 //=================================================================================
@@ -158,6 +158,9 @@ int ProgramWord(u32 uAddress, u16 uData);
 int ProgramBuffer(u32 uAddress, u16 * puDataArray, u16 uTotalNumWords, u16 uNumWords, u16 uStartProgram, u16 uFinishProgram);
 // Maximum buffer size is 512 words
 int EraseBlock(u32 uBlockAddress);
+// Non-blocking erase - CheckEraseBlock returns XST_DEVICE_BUSY until it completes
+void StartEraseBlock(u32 uBlockAddress);
+int CheckEraseBlock(u32 uBlockAddress);
 
 #ifdef __cplusplus
 }
@@ -20,9 +20,11 @@
 #include "constant_defs.h"
 #include "igmp.h"
 #include "eth_mac.h"
+#include "arp.h"
 #include "scratchpad.h"
 #include "flash_sdram_controller.h"
 #include "dhcp.h"
+#include "perfmon.h"
 
 /*********** Sanity Checks ***************/
 #ifdef DO_SANITY_CHECKS
@@ -45,6 +47,8 @@ static void __sanity_check_interface_id(u8 if_id){
 }
 #endif
 
+static void if_link_up_dhcp_start(struct sIFObject *pIFObjectPtr);
+
 
 /**************** API ********************/
 
@@ -111,7 +115,6 @@ struct sIFObject *InterfaceInit(u8 uEthernetId, u8 *pRxBufferPtr, u16 uRxBufferS
     return NULL;
   }
   pIFObjectPtr->uIFEnableArpRequests = ARP_REQUESTS_DISABLE;
-  pIFObjectPtr->uIFCurrentArpRequest = 1;
   pIFObjectPtr->uIFEnableArpProcessing = ARP_PROCESSING_ENABLE;
 
   pIFObjectPtr->uIFEthernetSubnet = 0;
@@ -120,52 +123,15 @@ struct sIFObject *InterfaceInit(u8 uEthernetId, u8 *pRxBufferPtr, u16 uRxBufferS
   pIFObjectPtr->uIFLinkRxActive = 0;
   pIFObjectPtr->uIFValidPacketRx = 0;
 
+  pIFObjectPtr->uIFLeaseHeld = 0;
+  pIFObjectPtr->uIFRecoveryPending = 0;
+  pIFObjectPtr->uIFLinkUpTimestamp = 0;
+  pIFObjectPtr->uIFLinkUpToRestored = 0;
+
   pIFObjectPtr->uMsgSize = 0;
   pIFObjectPtr->uNumWordsRead = 0;
 
-  pIFObjectPtr->uRxTotal = 0;
-  pIFObjectPtr->uRxEthArp = 0;
-  pIFObjectPtr->uRxArpReply = 0;
-  pIFObjectPtr->uRxArpRequest = 0;
-  pIFObjectPtr->uRxArpConflict = 0;
-  pIFObjectPtr->uRxArpInvalid = 0;
-  pIFObjectPtr->uRxEthIp = 0;
-  pIFObjectPtr->uRxIpChecksumErrors = 0;
-  pIFObjectPtr->uRxIpIcmp = 0;
-  pIFObjectPtr->uRxIcmpInvalid = 0;
-  pIFObjectPtr->uRxIpUdp = 0;
-  pIFObjectPtr->uRxUdpChecksumErrors = 0;
-  pIFObjectPtr->uRxUdpCtrl = 0;
-  pIFObjectPtr->uRxUdpDhcp = 0;
-  pIFObjectPtr->uRxDhcpInvalid = 0;
-  pIFObjectPtr->uRxDhcpUnknown = 0;
-  pIFObjectPtr->uRxUdpUnknown = 0;
-  pIFObjectPtr->uRxIpUnknown = 0;
-  pIFObjectPtr->uRxIpPim = 0;
-  pIFObjectPtr->uRxIpPimDropped = 0;
-  pIFObjectPtr->uRxIpIgmp = 0;
-  pIFObjectPtr->uRxIpIgmpDropped = 0;
-  pIFObjectPtr->uRxIpTcp = 0;
-  pIFObjectPtr->uRxIpTcpDropped = 0;
-  pIFObjectPtr->uRxEthLldp = 0;
-  pIFObjectPtr->uRxEthLldpDropped = 0;
-  pIFObjectPtr->uRxEthUnknown = 0;
-
-  pIFObjectPtr->uTxTotal = 0;
-  pIFObjectPtr->uTxEthArpRequestOk = 0;
-  pIFObjectPtr->uTxEthArpReplyOk = 0;
-  pIFObjectPtr->uTxEthArpErr = 0;
-  pIFObjectPtr->uTxEthLldpOk = 0;
-  pIFObjectPtr->uTxEthLldpErr = 0;
-  pIFObjectPtr->uTxIpIcmpReplyOk = 0;
-  pIFObjectPtr->uTxIpIcmpReplyErr = 0;
-  pIFObjectPtr->uTxIpIgmpOk = 0;
-  pIFObjectPtr->uTxIpIgmpErr = 0;
-  pIFObjectPtr->uTxUdpDhcpOk = 0;
-  pIFObjectPtr->uTxUdpDhcpErr = 0;
-  pIFObjectPtr->uTxUdpCtrlOk = 0;
-  pIFObjectPtr->uTxUdpCtrlAck = 0;  /*TODO*/
-  pIFObjectPtr->uTxUdpCtrlNack = 0; /*TODO*/
+  IFCountersReset(pIFObjectPtr);
 
   /* initialize the igmp object */
   pIGMPInit(uEthernetId);
@@ -182,7 +148,10 @@ struct sIFObject *InterfaceInit(u8 uEthernetId, u8 *pRxBufferPtr, u16 uRxBufferS
 //--------------------------------------------------------------------------------
 //  This method updates the Ethernet link up status. The Ethernet interface is not
 //  checked for received messages if it is not up. When the Ethernet link comes up,
-//  the ARP packet requests are enabled to populate the ARP cache.
+//  the ARP packet requests are enabled to populate the ARP cache. If a lease was
+//  held when the link went down, it is requested again straight away and the
+//  address and multicast groups are re-announced as soon as it is acked (see
+//  if_link_up_announce()).
 //
 //  Parameter       Dir   Description
 //  ---------       ---   -----------
@@ -210,18 +179,17 @@ void UpdateEthernetLinkUpStatus(struct sIFObject *pIFObjectPtr){
     // Check if the link was previously down
     if (pIFObjectPtr->uIFLinkStatus == LINK_DOWN){
       log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, "I/F  [%02x] LINK %x HAS COME UP!\r\n", uId, uId);
+      pIFObjectPtr->uIFLinkUpTimestamp = perfmon_timestamp();
 
       if (uId == 0){  /* 1gbe i/f */
         /* do not enable dhcp in loopback mode */
 #ifndef DO_1GBE_LOOPBACK_TEST
-        vDHCPStateMachineReset(pIFObjectPtr);
-        uDHCPSetStateMachineEnable(pIFObjectPtr, SM_TRUE);
+        if_link_up_dhcp_start(pIFObjectPtr);
 #endif
       } else {    /* for all other i/f's i.e. the 40gbe i/f's */
         /* do not enable dhcp in loopback mode */
 #ifndef DO_40GBE_LOOPBACK_TEST
-        vDHCPStateMachineReset(pIFObjectPtr);
-        uDHCPSetStateMachineEnable(pIFObjectPtr, SM_TRUE);
+        if_link_up_dhcp_start(pIFObjectPtr);
 #endif
       }
     }
@@ -246,6 +214,9 @@ void UpdateEthernetLinkUpStatus(struct sIFObject *pIFObjectPtr){
     // Check if the link was previously up
     if (pIFObjectPtr->uIFLinkStatus == LINK_UP){
       log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, "I/F  [%02x] LINK %x HAS GONE DOWN!\r\n", uId, uId);
+      /* a lease still being re-requested after a previous flap counts as held */
+      pIFObjectPtr->uIFLeaseHeld = ((uDHCPGetBoundStatus(pIFObjectPtr) == DHCP_RETURN_TRUE) || pIFObjectPtr->uIFRecoveryPending) ? 1 : 0;
+      pIFObjectPtr->uIFRecoveryPending = 0;
       pIFObjectPtr->uIFValidPacketRx = 0;   /* reset the valid pck flag here - a link flap has also been shown to lead
                                                to rx-link bringup issues (when the image has the issue). Thus this flag
                                                must be cleared in order for the link mon task to catch any rx issues.
@@ -283,6 +254,7 @@ void UpdateEthernetLinkUpStatus(struct sIFObject *pIFObjectPtr){
 
     pIFObjectPtr->uIFLinkStatus = LINK_DOWN;
     pIFObjectPtr->uIFEnableArpRequests = ARP_REQUESTS_DISABLE;
+    ArpNeighbourFlush(pIFObjectPtr);
 
     //uIGMPSendMessage[uId] = IGMP_DONE_SENDING_MESSAGE;
     /*
@@ -297,6 +269,72 @@ void UpdateEthernetLinkUpStatus(struct sIFObject *pIFObjectPtr){
   }
 }
 
+//=================================================================================
+//  if_link_up_dhcp_start
+//--------------------------------------------------------------------------------
+//  This method restarts dhcp when the link comes up. A lease held when the link
+//  went down is requested immediately (RFC 2131 INIT-REBOOT), skipping the init
+//  wait, otherwise dhcp starts from scratch.
+//
+//  Parameter       Dir   Description
+//  ---------       ---   -----------
+//  pIFObjectPtr    IN    handle to IF State Object
+//
+//  Return
+//  ------
+//  None
+//=================================================================================
+static void if_link_up_dhcp_start(struct sIFObject *pIFObjectPtr){
+  vDHCPStateMachineReset(pIFObjectPtr);
+
+  if (pIFObjectPtr->uIFLeaseHeld && (uDHCPRequestHeldLease(pIFObjectPtr) == DHCP_RETURN_OK)){
+    pIFObjectPtr->uIFRecoveryPending = 1;
+  } else {
+    uDHCPSetStateMachineEnable(pIFObjectPtr, SM_TRUE);
+  }
+
+  pIFObjectPtr->uIFLeaseHeld = 0;
+}
+
+
+//=================================================================================
+//  if_link_up_announce
+//--------------------------------------------------------------------------------
+//  This method completes the link-up recovery once the held lease has been
+//  acked. Rather than waiting for the next 100ms arp and igmp ticks, the
+//  gratuitous arp (and gateway resolution) and the igmp membership reports are
+//  sent straight away, so that the switch forwards the multicast streams again
+//  as soon as possible. The time from link up to here is recorded.
+//
+//  Parameter       Dir   Description
+//  ---------       ---   -----------
+//  pIFObjectPtr    IN    handle to IF State Object
+//
+//  Return
+//  ------
+//  None
+//=================================================================================
+void if_link_up_announce(struct sIFObject *pIFObjectPtr){
+  u8 uId;
+
+  SANE_IF(pIFObjectPtr);
+
+  uId = pIFObjectPtr->uIFEthernetId;
+
+  ArpRequestHandler(pIFObjectPtr);
+
+  if (XST_FAILURE == uIGMPRejoinPrevGroupNow(uId)){
+    log_printf(LOG_SELECT_IGMP, LOG_LEVEL_ERROR, "IGMP [%02x] FAILED to rejoin multicast group\r\n", uId);
+  }
+
+  pIFObjectPtr->uIFLinkUpToRestored = perfmon_timestamp() - pIFObjectPtr->uIFLinkUpTimestamp;
+  pIFObjectPtr->uIFRecoveryPending = 0;
+
+  /* log-level set to WARN in order to display during link flaps */
+  log_printf(LOG_SELECT_IFACE, LOG_LEVEL_WARN, "I/F  [%02x] link up to lease rebound and re-announced: %uus\r\n", uId,
+      perfmon_cycles_to_us(pIFObjectPtr->uIFLinkUpToRestored));
+}
+
 //=================================================================================
 //  uRecvPacketFilter
 //---------------------------------------------------------------------------------
@@ -332,7 +370,7 @@ typePacketFilter uRecvPacketFilter(struct sIFObject *pIFObjectPtr){
     return PACKET_FILTER_ERROR;
   }
 
-  pIFObjectPtr->uRxTotal++;
+  pIFObjectPtr->uIFCounter[RX_TOTAL]++;
 
   /* inspect the ethernet frame type */
   uL2Type = (pRxBuffer[ETH_FRAME_TYPE_OFFSET] << 8) & 0xff00;
@@ -343,7 +381,7 @@ typePacketFilter uRecvPacketFilter(struct sIFObject *pIFObjectPtr){
   switch(uL2Type){
     case ETHER_TYPE_ARP:
       log_printf(LOG_SELECT_ARP, LOG_LEVEL_TRACE, "ARP pkt\r\n");
-      pIFObjectPtr->uRxEthArp++;
+      pIFObjectPtr->uIFCounter[RX_ETH_ARP]++;
       uReturnType = PACKET_FILTER_ARP;
       /* no further filtering required */
       break;
@@ -352,19 +390,19 @@ typePacketFilter uRecvPacketFilter(struct sIFObject *pIFObjectPtr){
       /* further filtering required on ip packet */
       /* inspect the ip header protocol type */
       log_printf(LOG_SELECT_IFACE, LOG_LEVEL_TRACE, "IP pkt\r\n");
-      pIFObjectPtr->uRxEthIp++;
+      pIFObjectPtr->uIFCounter[RX_ETH_IP]++;
       uL3Type = pRxBuffer[IP_FRAME_BASE + IP_PROT_OFFSET] & 0xff;
       switch(uL3Type){
         case IPV4_TYPE_ICMP:
           log_printf(LOG_SELECT_ICMP, LOG_LEVEL_TRACE, "ICMP pkt\r\n");
-          pIFObjectPtr->uRxIpIcmp++;
+          pIFObjectPtr->uIFCounter[RX_IP_ICMP]++;
           uReturnType = PACKET_FILTER_ICMP;
           /* no further filtering required */
           break;
 
         case IPV4_TYPE_UDP:
           log_printf(LOG_SELECT_IFACE, LOG_LEVEL_TRACE, "UDP pkt\r\n");
-          pIFObjectPtr->uRxIpUdp++;
+          pIFObjectPtr->uIFCounter[RX_IP_UDP]++;
           /* further filtering required on udp datagram */
           /* allow for variable ip header lengths */
           /* adjust ip base value if ip length greater than 20 bytes. Min header length = 20 bytes; Max header length = 60 bytes */
@@ -383,53 +421,53 @@ typePacketFilter uRecvPacketFilter(struct sIFObject *pIFObjectPtr){
 
           if (uUDPDstPort == UDP_CONTROL_PORT){
             log_printf(LOG_SELECT_IFACE, LOG_LEVEL_TRACE, "CTRL pkt\r\n");
-            pIFObjectPtr->uRxUdpCtrl++;
+            pIFObjectPtr->uIFCounter[RX_UDP_CTRL]++;
             uReturnType = PACKET_FILTER_CONTROL;
           } else if ((uUDPDstPort == BOOTP_CLIENT_PORT) && (uUDPSrcPort == BOOTP_SERVER_PORT)){
             log_printf(LOG_SELECT_DHCP, LOG_LEVEL_TRACE, "DHCP pkt\r\n");
-            pIFObjectPtr->uRxUdpDhcp++;
+            pIFObjectPtr->uIFCounter[RX_UDP_DHCP]++;
             uReturnType = PACKET_FILTER_DHCP;
           } else if ((uUDPDstPort == BOOTP_SERVER_PORT) && (uUDPSrcPort == BOOTP_CLIENT_PORT)){
             /* These are probably broadcast DISCOVER / REQUEST packets from other network nodes / SKARABs
                destined for the dhcp server and can probably safely be dropped */
             log_printf(LOG_SELECT_DHCP, LOG_LEVEL_TRACE, "DHCP packet destined for DHCP server received! Can probably safely drop packet!\r\n");
-            pIFObjectPtr->uRxDhcpUnknown++;
-            pIFObjectPtr->uRxUdpDhcp++;   /* increment total dhcp counter too since this is a dhcp packet (even tho not destined for us) */
+            pIFObjectPtr->uIFCounter[RX_DHCP_UNKNOWN]++;
+            pIFObjectPtr->uIFCounter[RX_UDP_DHCP]++;   /* increment total dhcp counter too since this is a dhcp packet (even tho not destined for us) */
             uReturnType = PACKET_FILTER_DROP;
           } else {
             //log_printf(LOG_SELECT_IFACE, LOG_LEVEL_DEBUG, "UNKNOWN UDP ports: [src] 0x%04x & [dst] 0x%04x!\r\n", uUDPSrcPort, uUDPDstPort);
             log_printf(LOG_SELECT_IFACE, LOG_LEVEL_DEBUG, "I/F  [%02x] UNKNOWN UDP ports: [src] 0x%04x & [dst] 0x%04x!\r\n", uId, uUDPSrcPort, uUDPDstPort);
-            pIFObjectPtr->uRxUdpUnknown++;
+            pIFObjectPtr->uIFCounter[RX_UDP_UNKNOWN]++;
             uReturnType = PACKET_FILTER_UNKNOWN_UDP;
           }
           break;
 
+        case IPV4_TYPE_IGMP:
+          log_printf(LOG_SELECT_IGMP, LOG_LEVEL_TRACE, "IGMP pkt\r\n");
+          pIFObjectPtr->uIFCounter[RX_IP_IGMP]++;
+          uReturnType = PACKET_FILTER_IGMP;
+          /* no further filtering required */
+          break;
+
         /* unhandled cases - known packet types*/
         case IPV4_TYPE_PIM:
           log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, "I/F  [%02x] PIM pkt recvd & dropped!\r\n", uId);
-          pIFObjectPtr->uRxIpPim++;
-          pIFObjectPtr->uRxIpPimDropped++;
+          pIFObjectPtr->uIFCounter[RX_IP_PIM]++;
+          pIFObjectPtr->uIFCounter[RX_IP_PIM_DROPPED]++;
           uReturnType = PACKET_FILTER_PIM_UNHANDLED;
           break;
 
-        case IPV4_TYPE_IGMP:
-          log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, "I/F  [%02x] IGMP pkt recvd & dropped!\r\n", uId);
-          pIFObjectPtr->uRxIpIgmp++;
-          pIFObjectPtr->uRxIpIgmpDropped++;
-          uReturnType = PACKET_FILTER_IGMP_UNHANDLED;
-          break;
-
         case IPV4_TYPE_TCP:
           log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, "I/F  [%02x] TCP pkt recvd & dropped!\r\n", uId);
-          pIFObjectPtr->uRxIpTcp++;
-          pIFObjectPtr->uRxIpTcpDropped++;
+          pIFObjectPtr->uIFCounter[RX_IP_TCP]++;
+          pIFObjectPtr->uIFCounter[RX_IP_TCP_DROPPED]++;
           uReturnType = PACKET_FILTER_TCP_UNHANDLED;
           break;
 
         /* ... unknown packet types */
         default:
           log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, "I/F  [%02x] IP type 0x%02x recvd & dropped!\r\n", uId, uL3Type);
-          pIFObjectPtr->uRxIpUnknown++;
+          pIFObjectPtr->uIFCounter[RX_IP_UNKNOWN]++;
           uReturnType = PACKET_FILTER_UNKNOWN_IP;
           break;
       }
@@ -437,15 +475,15 @@ typePacketFilter uRecvPacketFilter(struct sIFObject *pIFObjectPtr){
 
     case ETHER_TYPE_LLDP:
       log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, "I/F  [%02x] LLDP pkt recvd & dropped!\r\n", uId);
-      pIFObjectPtr->uRxEthLldp++;
-      pIFObjectPtr->uRxEthLldpDropped++;
+      pIFObjectPtr->uIFCounter[RX_ETH_LLDP]++;
+      pIFObjectPtr->uIFCounter[RX_ETH_LLDP_DROPPED]++;
       uReturnType = PACKET_FILTER_LLDP_UNHANDLED;
       break;
 
     default:
       /* Handle unimplemented / unknown ethernet frames */
       log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, "I/F  [%02x] ETH type 0x%04x - dropped!\r\n", uId, uL2Type);
-      pIFObjectPtr->uRxEthUnknown++;
+      pIFObjectPtr->uIFCounter[RX_ETH_UNKNOWN]++;
       uReturnType = PACKET_FILTER_UNKNOWN_ETH;
       break;
   }
@@ -453,6 +491,130 @@ typePacketFilter uRecvPacketFilter(struct sIFObject *pIFObjectPtr){
   return uReturnType;
 }
 
+//=================================================================================
+//  uRecvPacketEarlyDrop
+//---------------------------------------------------------------------------------
+//  This method classifies a packet of which only the first ETH_MAC_RX_HEADER_WORDS
+//  words have been read (see ReadHostPacketHeader) and picks out the packets which
+//  uRecvPacketFilter would drop anyway, so that the rest of them need not be read.
+//  The headers are as read from the mac, i.e. not endian swapped yet - each 16-bit
+//  half-word holds the value in network order. ARP, ICMP, IGMP, CONTROL and DHCP
+//  replies (which still need the address checks on the full packet) are kept, as
+//  are udp datagrams behind ip options. The counters of uRecvPacketFilter are kept
+//  for a dropped packet too, along with an early drop counter per reason.
+//
+//  Parameter       Dir   Description
+//  ---------       ---   -----------
+//  pIFObjectPtr    IN    handle to IF state object
+//
+//  Return
+//  ------
+//  1 if the packet is to be dropped, else 0
+//=================================================================================
+u8 uRecvPacketEarlyDrop(struct sIFObject *pIFObjectPtr){
+  u16 *pRxHeader = NULL;
+  u16 uL2Type;
+  u8 uL3Type;
+  u16 uUDPSrcPort;
+  u16 uUDPDstPort;
+  u8 uId = pIFObjectPtr->uIFEthernetId;
+
+  SANE_IF(pIFObjectPtr);
+
+  pRxHeader = (u16 *) pIFObjectPtr->pUserRxBufferPtr;
+  if (pRxHeader == NULL){
+    return 0;
+  }
+
+  uL2Type = pRxHeader[ETH_FRAME_TYPE_OFFSET / 2];
+
+  switch(uL2Type){
+    case ETHER_TYPE_ARP:
+      /* foreign arp packets still refresh the neighbour cache */
+      return 0;
+
+    case ETHER_TYPE_IPV4:
+      break;
+
+    case ETHER_TYPE_LLDP:
+      log_printf(LOG_SELECT_IFACE, LOG_LEVEL_DEBUG, "I/F  [%02x] LLDP pkt dropped early!\r\n", uId);
+      pIFObjectPtr->uIFCounter[RX_TOTAL]++;
+      pIFObjectPtr->uIFCounter[RX_ETH_LLDP]++;
+      pIFObjectPtr->uIFCounter[RX_ETH_LLDP_DROPPED]++;
+      pIFObjectPtr->uIFCounter[RX_EARLY_DROP_LLDP]++;
+      /* disable the dhcp unbound monitor loop upon receipt of any valid known packet */
+      if_valid_rx_set(uId);
+      return 1;
+
+    default:
+      log_printf(LOG_SELECT_IFACE, LOG_LEVEL_DEBUG, "I/F  [%02x] ETH type 0x%04x - dropped early!\r\n", uId, uL2Type);
+      pIFObjectPtr->uIFCounter[RX_TOTAL]++;
+      pIFObjectPtr->uIFCounter[RX_ETH_UNKNOWN]++;
+      pIFObjectPtr->uIFCounter[RX_EARLY_DROP_ETH_UNKNOWN]++;
+      return 1;
+  }
+
+  /* the ip protocol is the low byte of the ttl / protocol half-word */
+  uL3Type = pRxHeader[(IP_FRAME_BASE + IP_PROT_OFFSET) / 2] & 0xff;
+
+  switch(uL3Type){
+    case IPV4_TYPE_ICMP:
+    case IPV4_TYPE_IGMP:
+      return 0;
+
+    case IPV4_TYPE_UDP:
+      break;
+
+    case IPV4_TYPE_PIM:
+    case IPV4_TYPE_TCP:
+      log_printf(LOG_SELECT_IFACE, LOG_LEVEL_DEBUG, "I/F  [%02x] %s pkt dropped early!\r\n", uId, uL3Type == IPV4_TYPE_PIM ? "PIM" : "TCP");
+      pIFObjectPtr->uIFCounter[RX_TOTAL]++;
+      pIFObjectPtr->uIFCounter[RX_ETH_IP]++;
+      pIFObjectPtr->uIFCounter[uL3Type == IPV4_TYPE_PIM ? RX_IP_PIM : RX_IP_TCP]++;
+      pIFObjectPtr->uIFCounter[uL3Type == IPV4_TYPE_PIM ? RX_IP_PIM_DROPPED : RX_IP_TCP_DROPPED]++;
+      pIFObjectPtr->uIFCounter[RX_EARLY_DROP_IP_UNHANDLED]++;
+      if_valid_rx_set(uId);
+      return 1;
+
+    default:
+      log_printf(LOG_SELECT_IFACE, LOG_LEVEL_DEBUG, "I/F  [%02x] IP type 0x%02x dropped early!\r\n", uId, uL3Type);
+      pIFObjectPtr->uIFCounter[RX_TOTAL]++;
+      pIFObjectPtr->uIFCounter[RX_ETH_IP]++;
+      pIFObjectPtr->uIFCounter[RX_IP_UNKNOWN]++;
+      pIFObjectPtr->uIFCounter[RX_EARLY_DROP_IP_UNHANDLED]++;
+      return 1;
+  }
+
+  /* the udp header is only within the header words if there are no ip options */
+  if ((pRxHeader[IP_FRAME_BASE / 2] & 0x0F00) != 0x0500){
+    return 0;
+  }
+
+  uUDPSrcPort = pRxHeader[(UDP_FRAME_BASE + UDP_SRC_PORT_OFFSET) / 2];
+  uUDPDstPort = pRxHeader[(UDP_FRAME_BASE + UDP_DST_PORT_OFFSET) / 2];
+
+  if ((uUDPDstPort == UDP_CONTROL_PORT) || ((uUDPDstPort == BOOTP_CLIENT_PORT) && (uUDPSrcPort == BOOTP_SERVER_PORT))){
+    return 0;
+  }
+
+  pIFObjectPtr->uIFCounter[RX_TOTAL]++;
+  pIFObjectPtr->uIFCounter[RX_ETH_IP]++;
+  pIFObjectPtr->uIFCounter[RX_IP_UDP]++;
+
+  if ((uUDPDstPort == BOOTP_SERVER_PORT) && (uUDPSrcPort == BOOTP_CLIENT_PORT)){
+    /* broadcast DISCOVER / REQUEST packets from other network nodes destined for the dhcp server */
+    pIFObjectPtr->uIFCounter[RX_DHCP_UNKNOWN]++;
+    pIFObjectPtr->uIFCounter[RX_UDP_DHCP]++;
+    pIFObjectPtr->uIFCounter[RX_EARLY_DROP_DHCP_SERVER]++;
+  } else {
+    log_printf(LOG_SELECT_IFACE, LOG_LEVEL_DEBUG, "I/F  [%02x] UNKNOWN UDP ports: [src] 0x%04x & [dst] 0x%04x dropped early!\r\n", uId, uUDPSrcPort, uUDPDstPort);
+    pIFObjectPtr->uIFCounter[RX_UDP_UNKNOWN]++;
+    pIFObjectPtr->uIFCounter[RX_EARLY_DROP_UDP_UNKNOWN]++;
+  }
+
+  return 1;
+}
+
 
 void IFConfig(struct sIFObject *pIFObjectPtr, u32 ip, u32 mask){
   u8 id;
@@ -499,111 +661,61 @@ void IFCounterIncr(struct sIFObject *pIFObjectPtr, tCounter c){
 
   SANE_IF(pIFObjectPtr);
 
-  switch (c){
-    case RX_TOTAL :
-      pIFObjectPtr->uRxTotal++;
-      break;
-    case RX_ETH_ARP :
-      pIFObjectPtr->uRxEthArp++;
-      break;
-    case RX_ARP_REPLY :
-      pIFObjectPtr->uRxArpReply++;
-      break;
-    case RX_ARP_REQUEST :
-      pIFObjectPtr->uRxArpRequest++;
-      break;
-    case RX_ARP_CONFLICT :
-      pIFObjectPtr->uRxArpConflict++;
-      break;
-    case RX_ARP_INVALID :
-      pIFObjectPtr->uRxArpInvalid++;
-      break;
-    case RX_ETH_IP :
-      pIFObjectPtr->uRxEthIp++;
-      break;
-    case RX_IP_CHK_ERR :
-      pIFObjectPtr->uRxIpChecksumErrors++;
-      break;
-    case RX_IP_ICMP :
-      pIFObjectPtr->uRxIpIcmp++;
-      break;
-    case RX_ICMP_INVALID :
-      pIFObjectPtr->uRxIcmpInvalid++;
-      break;
-    case RX_IP_UDP :
-      pIFObjectPtr->uRxIpUdp++;
-      break;
-    case RX_UDP_CHK_ERR :
-      pIFObjectPtr->uRxUdpChecksumErrors++;
-      break;
-    case RX_UDP_CTRL :
-      pIFObjectPtr->uRxUdpCtrl++;
-      break;
-    case RX_UDP_DHCP :
-      pIFObjectPtr->uRxUdpDhcp++;
-      break;
-    case RX_DHCP_INVALID :
-      pIFObjectPtr->uRxDhcpInvalid++;
-      break;
-    case RX_DHCP_UNKNOWN :
-      pIFObjectPtr->uRxDhcpUnknown++;
-      break;
-    case RX_UDP_UNKNOWN :
-      pIFObjectPtr->uRxUdpUnknown++;
-      break;
-    case RX_IP_UNKNOWN :
-      pIFObjectPtr->uRxIpUnknown++;
-      break;
-    case RX_ETH_UNKNOWN :
-      pIFObjectPtr->uRxEthUnknown++;
-      break;
-    case TX_TOTAL :
-      pIFObjectPtr->uTxTotal++;
-      break;
-    case TX_ETH_ARP_REQ_OK :
-      pIFObjectPtr->uTxEthArpRequestOk++;
-      break;
-    case TX_ETH_ARP_REPLY_OK :
-      pIFObjectPtr->uTxEthArpReplyOk++;
-      break;
-    case TX_ETH_ARP_ERR :
-      pIFObjectPtr->uTxEthArpErr++;
-      break;
-    case TX_ETH_LLDP_OK :
-      pIFObjectPtr->uTxEthLldpOk++;
-      break;
-    case TX_ETH_LLDP_ERR :
-      pIFObjectPtr->uTxEthLldpErr++;
-      break;
-    case TX_IP_ICMP_REPLY_OK :
-      pIFObjectPtr->uTxIpIcmpReplyOk++;
-      break;
-    case TX_IP_ICMP_REPLY_ERR :
-      pIFObjectPtr->uTxIpIcmpReplyErr++;
-      break;
-    case TX_IP_IGMP_OK :
-      pIFObjectPtr->uTxIpIgmpOk++;
-      break;
-    case TX_IP_IGMP_ERR :
-      pIFObjectPtr->uTxIpIgmpErr++;
-      break;
-    case TX_UDP_DHCP_OK :
-      pIFObjectPtr->uTxUdpDhcpOk++;
-      break;
-    case TX_UDP_DHCP_ERR :
-      pIFObjectPtr->uTxUdpDhcpErr++;
-      break;
-    case TX_UDP_CTRL_OK :
-      pIFObjectPtr->uTxUdpCtrlOk++;
-      break;
-    case TX_UDP_CTRL_ACK :
-      pIFObjectPtr->uTxUdpCtrlAck++;
-      break;
-    case TX_UDP_CTRL_NACK :
-      pIFObjectPtr->uTxUdpCtrlNack++;
-      break;
-    default:
-      break;
+  if (c >= IF_COUNTER_MAX){
+    return;
+  }
+
+  pIFObjectPtr->uIFCounter[c]++;
+}
+
+
+void IFCountersReset(struct sIFObject *pIFObjectPtr){
+  u8 i;
+
+  SANE_IF(pIFObjectPtr);
+
+  for (i = 0; i < IF_COUNTER_MAX; i++){
+    pIFObjectPtr->uIFCounter[i] = 0;
+  }
+}
+
+
+/* the tx total is not incremented directly - derive it from the successful tx counters */
+void IFCounterUpdateTxTotal(struct sIFObject *pIFObjectPtr){
+  u64 *c;
+
+  SANE_IF(pIFObjectPtr);
+
+  c = pIFObjectPtr->uIFCounter;
+
+  c[TX_TOTAL] = c[TX_ETH_ARP_REPLY_OK] + c[TX_ETH_ARP_REQ_OK] + c[TX_ETH_LLDP_OK] +
+    c[TX_IP_ICMP_REPLY_OK] + c[TX_IP_IGMP_OK] + c[TX_UDP_DHCP_OK] + c[TX_UDP_CTRL_OK];
+}
+
+
+/*
+ * Copy all the counters of an interface into pSnapshot (which must hold
+ * IF_COUNTER_MAX entries) and optionally clear them. Counters are only
+ * updated from the main loop, so the copy is consistent as long as this is
+ * also called from the main loop context.
+ */
+void IFCountersSnapshot(struct sIFObject *pIFObjectPtr, u64 *pSnapshot, u8 uResetOnRead){
+  u8 i;
+
+  SANE_IF(pIFObjectPtr);
+
+  if (NULL == pSnapshot){
+    return;
+  }
+
+  IFCounterUpdateTxTotal(pIFObjectPtr);
+
+  for (i = 0; i < IF_COUNTER_MAX; i++){
+    pSnapshot[i] = pIFObjectPtr->uIFCounter[i];
+  }
+
+  if (uResetOnRead){
+    IFCountersReset(pIFObjectPtr);
   }
 }
 
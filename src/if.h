@@ -15,6 +15,68 @@ extern "C" {
 #define IF_RX_MIN_BUFFER_SIZE 1500   /*mtu*/
 #define IF_TX_MIN_BUFFER_SIZE 1024
 
+/*
+ * Interface counter indices. Counters live in a u64 array in the IF object so
+ * that an increment is a single indexed access. The index order is also the
+ * order in which the counters are returned by the GET_IF_COUNTERS opcode, so
+ * only ever append new entries before IF_COUNTER_MAX.
+ */
+typedef enum {
+  RX_TOTAL,
+  RX_ETH_ARP,
+  RX_ARP_REPLY,
+  RX_ARP_REQUEST,
+  RX_ARP_CONFLICT,
+  RX_ARP_INVALID,
+  RX_ETH_IP,
+  RX_IP_CHK_ERR,
+  RX_IP_ICMP,
+  RX_ICMP_INVALID,
+  RX_IP_UDP,
+  RX_UDP_CHK_ERR,
+  RX_UDP_CTRL,
+  RX_UDP_DHCP,
+  RX_DHCP_INVALID,
+  RX_DHCP_UNKNOWN,
+  RX_UDP_UNKNOWN,
+  RX_IP_UNKNOWN,
+  RX_ETH_UNKNOWN,
+  TX_TOTAL,
+  TX_ETH_ARP_REQ_OK,
+  TX_ETH_ARP_REPLY_OK,
+  TX_ETH_ARP_ERR,
+  TX_ETH_LLDP_OK,
+  TX_ETH_LLDP_ERR,
+  TX_IP_ICMP_REPLY_OK,
+  TX_IP_ICMP_REPLY_ERR,
+  TX_IP_IGMP_OK,
+  TX_IP_IGMP_ERR,
+  TX_UDP_DHCP_OK,
+  TX_UDP_DHCP_ERR,
+  TX_UDP_CTRL_OK,
+  TX_UDP_CTRL_ACK,
+  TX_UDP_CTRL_NACK,
+  /* appended to keep the GET_IF_COUNTERS index order stable */
+  RX_IP_PIM,
+  RX_IP_PIM_DROPPED,
+  RX_IP_IGMP,
+  RX_IP_IGMP_DROPPED,
+  RX_IP_TCP,
+  RX_IP_TCP_DROPPED,
+  RX_ETH_LLDP,
+  RX_ETH_LLDP_DROPPED,
+  RX_IGMP_QUERY,
+  RX_IGMP_INVALID,
+  TX_IGMP_SUPPRESSED,   /* reports not sent since a querier is present or another host answered */
+  TX_UDP_CTRL_CACHED,   /* control responses resent from the response cache for a retransmitted request */
+  RX_EARLY_DROP_ETH_UNKNOWN,  /* early drops - only the headers were read, see uRecvPacketEarlyDrop() */
+  RX_EARLY_DROP_LLDP,
+  RX_EARLY_DROP_IP_UNHANDLED, /* pim, tcp and unknown ip protocols */
+  RX_EARLY_DROP_UDP_UNKNOWN,
+  RX_EARLY_DROP_DHCP_SERVER,  /* dhcp requests of other hosts */
+  IF_COUNTER_MAX      /* keep last - number of counters */
+} tCounter;
+
   /*TODO: note the order of the following may introduce stuct padding - perhaps
    * reorder for better ram usage */
 struct sIFObject{
@@ -59,68 +121,19 @@ struct sIFObject{
 //  struct sICMPObject ICMPContextState;    /* holds the icmp states for this interface */
 
   u8 uIFEnableArpRequests;  /* enable arp requests on this interface */
-  u8 uIFCurrentArpRequest;  /* keep a counter to cycle through arp request IP's */
 
 #define ARP_PROCESSING_DISABLE  0
 #define ARP_PROCESSING_ENABLE   1
   u8 uIFEnableArpProcessing;  /* enable arp processing on this interface */
 
-  /* RX Packet Counters */
-  u32 uRxTotal; /* total packets received */
-    /* Filtered Ethernet Types we handle */
-    u32 uRxEthArp;
-      u32 uRxArpReply;
-      u32 uRxArpRequest;
-      u32 uRxArpConflict;
-      u32 uRxArpInvalid;
-    u32 uRxEthIp;
-      u32 uRxIpChecksumErrors;  /* IP header checksum errors */
-      /* IP Types we handle */
-      u32 uRxIpIcmp;
-        u32 uRxIcmpInvalid;   /* these are packets destined for us but failed validation (problems with length, type, etc.) */
-      u32 uRxIpUdp;
-        u32 uRxUdpChecksumErrors;  /* UDP checksum errors */
-        /* UDP Types we handle */
-        u32 uRxUdpCtrl;     /* control packets */
-          /* TODO control validation */
-        u32 uRxUdpDhcp;     /* dhcp reply */
-          u32 uRxDhcpInvalid;   /* these are packets destined for us but failed validation (problems with xid, etc.). 
-                                   These include dhcp server bcast replies meant for other nodes */
-          u32 uRxDhcpUnknown;   /* possible dhcp broadcasts from other nodes destined for the dhcp server */
-        u32 uRxUdpUnknown;  /* packets dropped at UDP layer */
-      u32 uRxIpUnknown;     /* packets dropped at IP layer */
-      u32 uRxIpPim;
-        u32 uRxIpPimDropped;
-      u32 uRxIpIgmp;
-        u32 uRxIpIgmpDropped;
-      u32 uRxIpTcp;
-        u32 uRxIpTcpDropped;
-    u32 uRxEthLldp;         /* lldp packets */
-      u32 uRxEthLldpDropped;
-    u32 uRxEthUnknown;      /* packets dropped at Ethernet layer */
-
-  /* TX Packet Counters */
-  u32 uTxTotal;   /* total packets sent */
-
-  /* layer 3 counters */
-  u32 uTxEthArpRequestOk;
-  u32 uTxEthArpReplyOk;
-  u32 uTxEthArpErr;
-  u32 uTxEthLldpOk;
-  u32 uTxEthLldpErr;
-
-  /* layer 4 counters */
-  u32 uTxIpIcmpReplyOk;
-  u32 uTxIpIcmpReplyErr;
-  u32 uTxIpIgmpOk;
-  u32 uTxIpIgmpErr;
-
-  /* layer 5 counters */
-  u32 uTxUdpDhcpOk;
-  u32 uTxUdpDhcpErr;
-  u32 uTxUdpCtrlOk;
-  u32 uTxUdpCtrlAck;
-  u32 uTxUdpCtrlNack;
+  /* link-up recovery - times in perfmon timer cycles */
+  u8 uIFLeaseHeld;            /* a dhcp lease was bound when the link last went down */
+  u8 uIFRecoveryPending;      /* held lease requested on link up, re-announce follows on the ack */
+  u32 uIFLinkUpTimestamp;
+  u32 uIFLinkUpToRestored;    /* link up to the lease being rebound and re-announced, 0 if never */
+
+  /* RX / TX packet counters - indexed by tCounter */
+  u64 uIFCounter[IF_COUNTER_MAX];
 };
 
 struct sIFObject *InterfaceInit(u8 uEthernetId, u8 *pRxBufferPtr, u16 uRxBufferSize, u8 *pTxBufferPtr, u16 uTxBufferSize, u8 *arrUserMacAddr);
@@ -133,6 +146,7 @@ void if_valid_rx_set(u8 physical_interface_id);
 int if_valid_rx_get(u8 physical_interface_id);
 
 void if_link_recovery_task(u8 phy_if_id, u32 timeout);
+void if_link_up_announce(struct sIFObject *pIFObjectPtr);
 
 void print_interface_map(void);
 
@@ -157,9 +171,9 @@ typedef enum {
   PACKET_FILTER_ICMP,
   PACKET_FILTER_DHCP,
   PACKET_FILTER_CONTROL,
+  PACKET_FILTER_IGMP,
 
   /* known but unhandled / dropped protocols */
-  PACKET_FILTER_IGMP_UNHANDLED,
   PACKET_FILTER_PIM_UNHANDLED,
   PACKET_FILTER_TCP_UNHANDLED,
   PACKET_FILTER_LLDP_UNHANDLED,
@@ -188,45 +202,12 @@ typedef enum {
 #define BOOTP_SERVER_PORT 0x43
 
 typePacketFilter uRecvPacketFilter(struct sIFObject *pIFObjectPtr);
-
-typedef enum {
-  RX_TOTAL,
-  RX_ETH_ARP,
-  RX_ARP_REPLY,
-  RX_ARP_REQUEST,
-  RX_ARP_CONFLICT,
-  RX_ARP_INVALID,
-  RX_ETH_IP,
-  RX_IP_CHK_ERR,
-  RX_IP_ICMP,
-  RX_ICMP_INVALID,
-  RX_IP_UDP,
-  RX_UDP_CHK_ERR,
-  RX_UDP_CTRL,
-  RX_UDP_DHCP,
-  RX_DHCP_INVALID,
-  RX_DHCP_UNKNOWN,
-  RX_UDP_UNKNOWN,
-  RX_IP_UNKNOWN,
-  RX_ETH_UNKNOWN,
-  TX_TOTAL,
-  TX_ETH_ARP_REQ_OK,
-  TX_ETH_ARP_REPLY_OK,
-  TX_ETH_ARP_ERR,
-  TX_ETH_LLDP_OK,
-  TX_ETH_LLDP_ERR,
-  TX_IP_ICMP_REPLY_OK,
-  TX_IP_ICMP_REPLY_ERR,
-  TX_IP_IGMP_OK,
-  TX_IP_IGMP_ERR,
-  TX_UDP_DHCP_OK,
-  TX_UDP_DHCP_ERR,
-  TX_UDP_CTRL_OK,
-  TX_UDP_CTRL_ACK,
-  TX_UDP_CTRL_NACK
-} tCounter;
+u8 uRecvPacketEarlyDrop(struct sIFObject *pIFObjectPtr);
 
 void IFCounterIncr(struct sIFObject *pIFObjectPtr, tCounter c);
+void IFCountersReset(struct sIFObject *pIFObjectPtr);
+void IFCounterUpdateTxTotal(struct sIFObject *pIFObjectPtr);
+void IFCountersSnapshot(struct sIFObject *pIFObjectPtr, u64 *pSnapshot, u8 uResetOnRead);
 
 #ifdef __cplusplus
 }
@@ -12,6 +12,9 @@
 #include "constant_defs.h"
 #include "eth_sorter.h"
 #include "eth_mac.h"
+#include "perfmon.h"
+#include "ipv4.h"
+#include "net_utils.h"
 
 typedef typeIGMPState (*igmp_state_func_ptr)(struct sIGMPObject *pIGMPObjectPtr);
 
@@ -35,6 +38,14 @@ static const char *igmp_state_name_lookup[] = {
 };
 
 static struct sIGMPObject *pIGMPGetContext(u8 uId);
+static u32 igmp_send_group_reports(struct sIGMPObject *pIGMPObjectPtr, u32 uBaseAddr, u32 uMask, u8 uReportType, u32 uMaxReports);
+static typeIGMPState igmp_settled_state(struct sIGMPObject *pIGMPObjectPtr);
+static u8 igmp_range_count(struct sIGMPObject *pIGMPObjectPtr, typeIGMPRangeState tState);
+static u8 igmp_find_range(struct sIGMPObject *pIGMPObjectPtr, u32 uBaseAddr, u32 uMask);
+static void igmp_update_fabric_filter(struct sIGMPObject *pIGMPObjectPtr);
+static void igmp_join_timing_start(struct sIGMPObject *pIGMPObjectPtr);
+static void igmp_query_received(struct sIGMPObject *pIGMPObjectPtr, u32 uGroupAddr, u16 uMaxResponseTicks);
+static u32 igmp_random(u32 uSeed);
 
 /*TODO this should be a tunable and configurable parameter */
 #define IGMP_REPORT_TIMER 600
@@ -42,6 +53,11 @@ static struct sIGMPObject *pIGMPGetContext(u8 uId);
 
 #define IGMP_MAGIC_CANARY   0xB17D5EED
 
+/* report types passed to igmp_send_group_reports() */
+#define IGMP_REPORT_JOIN      0   /* state change on joining */
+#define IGMP_REPORT_CURRENT   1   /* current state, i.e. refresh or query response */
+#define IGMP_REPORT_LEAVE     2
+
 /*********** Sanity Checks ***************/
 #ifdef DO_SANITY_CHECKS
 #define SANE_IGMP(IGMPObject) __sanity_check_igmp(IGMPObject);
@@ -67,6 +83,7 @@ static void __sanity_check_igmp_interface_id(u8 if_id){
 
 struct sIGMPObject *pIGMPInit(u8 uId){
   struct sIGMPObject *pIGMPObjectPtr;
+  u8 r;
 
   SANE_IGMP_IF_ID(uId);
 
@@ -80,15 +97,30 @@ struct sIGMPObject *pIGMPInit(u8 uId){
   pIGMPObjectPtr->uIGMPCurrentClkTick = 0;
   pIGMPObjectPtr->uIGMPIfId = uId;
 
-  /* FIXME - double check the assignment of join and leave mc addr and mask throughout the s/m */
-  pIGMPObjectPtr->uIGMPJoinMulticastAddress = 0;
-  pIGMPObjectPtr->uIGMPJoinMulticastAddressMask = 0xffffffff;
+  for (r = 0; r < IGMP_RANGES_MAX; r++){
+    pIGMPObjectPtr->IGMPRanges[r].uBaseAddr = 0;
+    pIGMPObjectPtr->IGMPRanges[r].uMask = 0xffffffff;
+    pIGMPObjectPtr->IGMPRanges[r].tState = IGMP_RANGE_FREE;
+  }
+  pIGMPObjectPtr->uIGMPCurrentRange = 0;
+
+  pIGMPObjectPtr->uIGMPFilterAddr = 0;
+  pIGMPObjectPtr->uIGMPFilterMask = 0xffffffff;
+
+  pIGMPObjectPtr->uIGMPVersion = IGMP_VERSION_2;
+  pIGMPObjectPtr->uIGMPReportsPerTick = IGMP_V2_REPORTS_PER_TICK_DEFAULT;
+  pIGMPObjectPtr->uIGMPRefresh = FALSE;
 
-  pIGMPObjectPtr->uIGMPLeaveMulticastAddress = 0;
-  pIGMPObjectPtr->uIGMPLeaveMulticastAddressMask = 0xffffffff;
+  pIGMPObjectPtr->tIGMPJoinTiming = IGMP_TIMING_IDLE;
+  pIGMPObjectPtr->uIGMPJoinTimestamp = 0;
+  pIGMPObjectPtr->uIGMPJoinToFirstReport = 0;
+  pIGMPObjectPtr->uIGMPJoinToAnnounced = 0;
 
-  pIGMPObjectPtr->uIGMPJoinRequestFlag = FALSE;
-  pIGMPObjectPtr->uIGMPLeaveRequestFlag = FALSE;
+  pIGMPObjectPtr->uIGMPQuerierVersion = 0;
+  pIGMPObjectPtr->uIGMPQuerierIPAddr = 0;
+  pIGMPObjectPtr->uIGMPQuerierAge = 0;
+  pIGMPObjectPtr->uIGMPResponseTimer = 0;
+  pIGMPObjectPtr->uIGMPResponseGroup = 0;
 
   return pIGMPObjectPtr;
 }
@@ -106,8 +138,13 @@ static struct sIGMPObject *pIGMPGetContext(u8 uId){
  * therefore it's not a good idea to assert() args inside these functions
  */
 
+/* legacy single range subscription - any other ranges are left */
 u8 uIGMPJoinGroup(u8 uId, u32 uMulticastBaseAddr, u32 uMulticastAddrMask){
   struct sIGMPObject *pIGMPObjectPtr;
+  struct sIGMPRange *pRange;
+  u8 uSubscribed = FALSE;
+  u8 uOthers = FALSE;
+  u8 r;
 
   if (IF_ID_PRESENT != check_interface_valid(uId)) {
     log_printf(LOG_SELECT_IGMP, LOG_LEVEL_ERROR, "IGMP [..] Multicast join failed\r\n");
@@ -123,29 +160,48 @@ u8 uIGMPJoinGroup(u8 uId, u32 uMulticastBaseAddr, u32 uMulticastAddrMask){
                to only one specific addr, this will do it */
           /* however, perhaps we should guard against extra-ordinarily large  groups, like a mask of 0xffff0000*/
 
-  /* only set mc parameters and invoke s/m if there's a change... */
-  if ((pIGMPObjectPtr->uIGMPJoinMulticastAddress != uMulticastBaseAddr) ||
-     (pIGMPObjectPtr->uIGMPJoinMulticastAddressMask != uMulticastAddrMask )){
+  /* only invoke the s/m if there's a change... */
+  for (r = 0; r < IGMP_RANGES_MAX; r++){
+    pRange = &(pIGMPObjectPtr->IGMPRanges[r]);
+    if ((pRange->tState != IGMP_RANGE_JOINING) && (pRange->tState != IGMP_RANGE_JOINED)){
+      continue;
+    }
+    if ((pRange->uBaseAddr == (uMulticastBaseAddr & uMulticastAddrMask)) && (pRange->uMask == uMulticastAddrMask)){
+      uSubscribed = TRUE;
+    } else {
+      uOthers = TRUE;
+    }
+  }
 
-    pIGMPObjectPtr->uIGMPLeaveMulticastAddress = pIGMPObjectPtr->uIGMPJoinMulticastAddress;
-    pIGMPObjectPtr->uIGMPLeaveMulticastAddressMask = pIGMPObjectPtr->uIGMPJoinMulticastAddressMask;
+  if ((uSubscribed == TRUE) && (uOthers == FALSE)){
+    log_printf(LOG_SELECT_IGMP, LOG_LEVEL_INFO, "IGMP [%02d] Already subscribed with base %08x and mask %08x\r\n", uId, uMulticastBaseAddr,uMulticastAddrMask);
+    igmp_update_fabric_filter(pIGMPObjectPtr);
+    return XST_SUCCESS;
+  }
 
-    pIGMPObjectPtr->uIGMPJoinMulticastAddress = uMulticastBaseAddr;
-    pIGMPObjectPtr->uIGMPJoinMulticastAddressMask = uMulticastAddrMask;
+  /* the other ranges are only left once the new one is known to fit - a failed join leaves the subscriptions as they are */
+  if ((igmp_find_range(pIGMPObjectPtr, uMulticastBaseAddr, uMulticastAddrMask) >= IGMP_RANGES_MAX) &&
+      (igmp_range_count(pIGMPObjectPtr, IGMP_RANGE_FREE) == 0)){
+    log_printf(LOG_SELECT_IGMP, LOG_LEVEL_ERROR, "IGMP [%02d] No free range for base %08x and mask %08x\r\n", uId, uMulticastBaseAddr, uMulticastAddrMask);
+    return XST_FAILURE;
+  }
 
-    pIGMPObjectPtr->uIGMPJoinRequestFlag = TRUE;
-    /*pIGMPObjectPtr->tIGMPCurrentState = IGMP_IDLE_STATE;*/
-  } else {
-    log_printf(LOG_SELECT_IGMP, LOG_LEVEL_INFO, "IGMP [%02d] Already subscribed with base %08x and mask %08x\r\n", uId, uMulticastBaseAddr,uMulticastAddrMask);
+  for (r = 0; r < IGMP_RANGES_MAX; r++){
+    pRange = &(pIGMPObjectPtr->IGMPRanges[r]);
+    if (((pRange->tState == IGMP_RANGE_JOINING) || (pRange->tState == IGMP_RANGE_JOINED)) &&
+        ((pRange->uBaseAddr != (uMulticastBaseAddr & uMulticastAddrMask)) || (pRange->uMask != uMulticastAddrMask))){
+      pRange->tState = IGMP_RANGE_LEAVING;
+    }
   }
 
-  return XST_SUCCESS;
+  return uIGMPAddRange(uId, uMulticastBaseAddr, uMulticastAddrMask);
 }
 
-/* TODO roll leave and join flag into one variable */
-
+/* leave all the ranges */
 u8 uIGMPLeaveGroup(u8 uId){
   struct sIGMPObject *pIGMPObjectPtr;
+  struct sIGMPRange *pRange;
+  u8 r;
 
   log_printf(LOG_SELECT_IGMP, LOG_LEVEL_INFO, "IGMP [..] Leaving groups on if-%d\r\n", uId);
 
@@ -160,13 +216,15 @@ u8 uIGMPLeaveGroup(u8 uId){
                                  that this is a function called from a user command but also that the ptr should have
                                  been initialised first i.e. an assert would catch this in development... */
 
-  pIGMPObjectPtr->uIGMPLeaveRequestFlag = TRUE;
-
-  pIGMPObjectPtr->uIGMPLeaveMulticastAddress = pIGMPObjectPtr->uIGMPJoinMulticastAddress;
-  pIGMPObjectPtr->uIGMPLeaveMulticastAddressMask = pIGMPObjectPtr->uIGMPJoinMulticastAddressMask;
+  for (r = 0; r < IGMP_RANGES_MAX; r++){
+    pRange = &(pIGMPObjectPtr->IGMPRanges[r]);
+    if ((pRange->tState == IGMP_RANGE_JOINING) || (pRange->tState == IGMP_RANGE_JOINED)){
+      pRange->tState = IGMP_RANGE_LEAVING;
+    }
+  }
 
-  pIGMPObjectPtr->uIGMPJoinMulticastAddress = 0;
-  pIGMPObjectPtr->uIGMPJoinMulticastAddressMask = 0xffffffff;
+  /* no ranges remain - clears the fabric multicast filter */
+  igmp_update_fabric_filter(pIGMPObjectPtr);
 
   return XST_SUCCESS;
 }
@@ -196,10 +254,99 @@ u8 uIGMPLeaveGroupFlush(u8 uId){
 }
 
 
+/*
+ * Subscribe to another group range. Re-adding a range which is still being
+ * left cancels the leave. The fabric filter is widened straight away so that
+ * traffic is accepted as soon as the switch starts forwarding it.
+ */
+u8 uIGMPAddRange(u8 uId, u32 uMulticastBaseAddr, u32 uMulticastAddrMask){
+  struct sIGMPObject *pIGMPObjectPtr;
+  struct sIGMPRange *pRange;
+  u8 r;
+
+  if (IF_ID_PRESENT != check_interface_valid(uId)) {
+    log_printf(LOG_SELECT_IGMP, LOG_LEVEL_ERROR, "IGMP [..] Multicast join failed\r\n");
+    return XST_FAILURE;
+  }
+
+  pIGMPObjectPtr = pIGMPGetContext(uId);
+
+  SANE_IGMP(pIGMPObjectPtr);
+
+  r = igmp_find_range(pIGMPObjectPtr, uMulticastBaseAddr, uMulticastAddrMask);
+  if (r < IGMP_RANGES_MAX){
+    pRange = &(pIGMPObjectPtr->IGMPRanges[r]);
+    if (pRange->tState == IGMP_RANGE_LEAVING){
+      pRange->tState = IGMP_RANGE_JOINING;
+      igmp_join_timing_start(pIGMPObjectPtr);
+    } else {
+      log_printf(LOG_SELECT_IGMP, LOG_LEVEL_INFO, "IGMP [%02d] Already subscribed with base %08x and mask %08x\r\n", uId, uMulticastBaseAddr,uMulticastAddrMask);
+    }
+    igmp_update_fabric_filter(pIGMPObjectPtr);
+    return XST_SUCCESS;
+  }
+
+  for (r = 0; r < IGMP_RANGES_MAX; r++){
+    if (pIGMPObjectPtr->IGMPRanges[r].tState == IGMP_RANGE_FREE){
+      break;
+    }
+  }
+
+  if (r >= IGMP_RANGES_MAX){
+    log_printf(LOG_SELECT_IGMP, LOG_LEVEL_ERROR, "IGMP [%02d] No free range for base %08x and mask %08x\r\n", uId, uMulticastBaseAddr, uMulticastAddrMask);
+    return XST_FAILURE;
+  }
+
+  pRange = &(pIGMPObjectPtr->IGMPRanges[r]);
+  pRange->uBaseAddr = uMulticastBaseAddr & uMulticastAddrMask;
+  pRange->uMask = uMulticastAddrMask;
+  pRange->tState = IGMP_RANGE_JOINING;
+
+  igmp_join_timing_start(pIGMPObjectPtr);
+  igmp_update_fabric_filter(pIGMPObjectPtr);
+
+  log_printf(LOG_SELECT_IGMP, LOG_LEVEL_INFO, "IGMP [%02d] Joining range %d with base %08x and mask %08x\r\n", uId, r, pRange->uBaseAddr, pRange->uMask);
+
+  return XST_SUCCESS;
+}
+
+
+/* leave one group range, the fabric filter is narrowed to the remaining ranges */
+u8 uIGMPRemoveRange(u8 uId, u32 uMulticastBaseAddr, u32 uMulticastAddrMask){
+  struct sIGMPObject *pIGMPObjectPtr;
+  struct sIGMPRange *pRange;
+  u8 r;
+
+  if (IF_ID_PRESENT != check_interface_valid(uId)) {
+    log_printf(LOG_SELECT_IGMP, LOG_LEVEL_ERROR, "IGMP [..] Multicast leave failed\r\n");
+    return XST_FAILURE;
+  }
+
+  pIGMPObjectPtr = pIGMPGetContext(uId);
+
+  SANE_IGMP(pIGMPObjectPtr);
+
+  r = igmp_find_range(pIGMPObjectPtr, uMulticastBaseAddr, uMulticastAddrMask);
+  if (r >= IGMP_RANGES_MAX){
+    log_printf(LOG_SELECT_IGMP, LOG_LEVEL_ERROR, "IGMP [%02d] Not subscribed with base %08x and mask %08x\r\n", uId, uMulticastBaseAddr, uMulticastAddrMask);
+    return XST_FAILURE;
+  }
+
+  pRange = &(pIGMPObjectPtr->IGMPRanges[r]);
+  if (pRange->tState != IGMP_RANGE_LEAVING){
+    pRange->tState = IGMP_RANGE_LEAVING;
+    igmp_update_fabric_filter(pIGMPObjectPtr);
+    log_printf(LOG_SELECT_IGMP, LOG_LEVEL_INFO, "IGMP [%02d] Leaving range %d with base %08x and mask %08x\r\n", uId, r, pRange->uBaseAddr, pRange->uMask);
+  }
+
+  return XST_SUCCESS;
+}
+
 
 /* This function was introduced to deal with link-flap scenarios and rejoin the mc group */
 u8 uIGMPRejoinPrevGroup(u8 uId){
   struct sIGMPObject *pIGMPObjectPtr;
+  u8 r;
 
   if (IF_ID_PRESENT != check_interface_valid(uId)) {
     log_printf(LOG_SELECT_IGMP, LOG_LEVEL_ERROR, "IGMP [..] Multicast rejoin failed\r\n");
@@ -211,36 +358,218 @@ u8 uIGMPRejoinPrevGroup(u8 uId){
   SANE_IGMP(pIGMPObjectPtr);    /* TODO: should we assert here or throw a runtime error? same reason as above... */
 
   if ((pIGMPObjectPtr->tIGMPCurrentState == IGMP_JOINED_STATE) || (pIGMPObjectPtr->tIGMPCurrentState == IGMP_SEND_MEMBERSHIP_REPORTS_STATE)){
-    pIGMPObjectPtr->uIGMPJoinRequestFlag = TRUE;
+    for (r = 0; r < IGMP_RANGES_MAX; r++){
+      if (pIGMPObjectPtr->IGMPRanges[r].tState == IGMP_RANGE_JOINED){
+        pIGMPObjectPtr->IGMPRanges[r].tState = IGMP_RANGE_JOINING;
+      }
+    }
     pIGMPObjectPtr->tIGMPCurrentState = IGMP_IDLE_STATE;
+    igmp_join_timing_start(pIGMPObjectPtr);
   }
 
   return XST_SUCCESS;
 }
 
 
+
+/* link-up fast path - rather than waiting for the next tick(s), the first burst of reports is sent immediately */
+u8 uIGMPRejoinPrevGroupNow(u8 uId){
+  struct sIGMPObject *pIGMPObjectPtr;
+
+  if (XST_FAILURE == uIGMPRejoinPrevGroup(uId)){
+    return XST_FAILURE;
+  }
+
+  pIGMPObjectPtr = pIGMPGetContext(uId);
+
+  if (pIGMPObjectPtr->tIGMPCurrentState == IGMP_IDLE_STATE){
+    pIGMPObjectPtr->tIGMPCurrentState = igmp_idle_state(pIGMPObjectPtr);
+    if (pIGMPObjectPtr->tIGMPCurrentState == IGMP_SEND_MEMBERSHIP_REPORTS_STATE){
+      pIGMPObjectPtr->tIGMPCurrentState = igmp_send_membership_reports_state(pIGMPObjectPtr);
+    }
+  }
+
+  return XST_SUCCESS;
+}
+
+u8 uIGMPConfigure(u8 uId, u8 uVersion, u16 uReportsPerTick){
+  struct sIGMPObject *pIGMPObjectPtr;
+
+  if (IF_ID_PRESENT != check_interface_valid(uId)) {
+    log_printf(LOG_SELECT_IGMP, LOG_LEVEL_ERROR, "IGMP [..] Configure failed\r\n");
+    return XST_FAILURE;
+  }
+
+  if (((uVersion != IGMP_VERSION_2) && (uVersion != IGMP_VERSION_3)) ||
+      (uReportsPerTick == 0) || (uReportsPerTick > IGMP_V2_REPORTS_PER_TICK_MAX)){
+    log_printf(LOG_SELECT_IGMP, LOG_LEVEL_ERROR, "IGMP [%02d] Invalid version %d or reports per tick %d\r\n", uId, uVersion, uReportsPerTick);
+    return XST_FAILURE;
+  }
+
+  pIGMPObjectPtr = pIGMPGetContext(uId);
+
+  SANE_IGMP(pIGMPObjectPtr);
+
+  /* takes effect from the next report pass */
+  pIGMPObjectPtr->uIGMPVersion = uVersion;
+  pIGMPObjectPtr->uIGMPReportsPerTick = uReportsPerTick;
+
+  log_printf(LOG_SELECT_IGMP, LOG_LEVEL_INFO, "IGMP [%02d] Using igmpv%d, %d v2 reports per tick\r\n", uId, uVersion, uReportsPerTick);
+
+  return XST_SUCCESS;
+}
+
+
+/*
+ * Parse an igmp message in the interface's receive buffer (ip header checksum
+ * already verified). Queries schedule a delayed response, membership reports
+ * from other hosts may suppress a pending response.
+ */
+u8 uIGMPMessageProcess(struct sIFObject *pIFObjectPtr){
+  struct sIGMPObject *pIGMPObjectPtr;
+  u8 *pBuffer;
+  u8 id;
+  u8 uType;
+  u8 uCode;
+  u16 uIPHeaderLen;
+  u16 uIPTotalLen;
+  u16 uIGMPBase;
+  u16 uIGMPLen;
+  u16 uChecksum;
+  u16 uMaxResponseTicks;
+  u32 uGroupAddr;
+
+  id = pIFObjectPtr->uIFEthernetId;
+  pBuffer = pIFObjectPtr->pUserRxBufferPtr;
+
+  pIGMPObjectPtr = pIGMPGetContext(id);
+
+  SANE_IGMP(pIGMPObjectPtr);
+
+  uIPHeaderLen = (pBuffer[IP_FRAME_BASE] & 0x0F) * 4;
+  uIPTotalLen = (pBuffer[IP_FRAME_BASE + IP_TLEN_OFFSET] << 8) | pBuffer[IP_FRAME_BASE + IP_TLEN_OFFSET + 1];
+  if ((uIPHeaderLen < IP_FRAME_TOTAL_LEN) || (uIPTotalLen < (uIPHeaderLen + 8)) ||
+      ((IP_FRAME_BASE + uIPTotalLen) > (pIFObjectPtr->uNumWordsRead * 4)) ||
+      ((IP_FRAME_BASE + uIPTotalLen) > pIFObjectPtr->uUserRxBufferSize)){
+    return XST_FAILURE;
+  }
+
+  uIGMPBase = IP_FRAME_BASE + uIPHeaderLen;
+  uIGMPLen = uIPTotalLen - uIPHeaderLen;
+
+  if (uChecksum16Calc(pBuffer, uIGMPBase, uIGMPBase + uIGMPLen - 1, &uChecksum, 0, 0) || (uChecksum != 0xFFFF)){
+    return XST_FAILURE;
+  }
+
+  uType = pBuffer[uIGMPBase];
+  uCode = pBuffer[uIGMPBase + 1];
+  uGroupAddr = (pBuffer[uIGMPBase + 4] << 24) | (pBuffer[uIGMPBase + 5] << 16) | (pBuffer[uIGMPBase + 6] << 8) | pBuffer[uIGMPBase + 7];
+
+  switch (uType){
+    case IGMP_QUERY:
+      IFCounterIncr(pIFObjectPtr, RX_IGMP_QUERY);
+
+      /* the version is told apart by the message length and max response code (rfc 3376 section 7.1) */
+      if (uIGMPLen >= 12){
+        pIGMPObjectPtr->uIGMPQuerierVersion = IGMP_VERSION_3;
+        if (uCode < 128){
+          uMaxResponseTicks = uCode;
+        } else {
+          uMaxResponseTicks = ((uCode & 0x0F) | 0x10) << (((uCode >> 4) & 0x07) + 3);
+        }
+      } else if (uCode == 0){
+        pIGMPObjectPtr->uIGMPQuerierVersion = 1;
+        uMaxResponseTicks = IGMP_V1_MAX_RESPONSE_TICKS;
+      } else {
+        pIGMPObjectPtr->uIGMPQuerierVersion = IGMP_VERSION_2;
+        uMaxResponseTicks = uCode;    /* units of 1/10 second, i.e. igmp s/m ticks */
+      }
+
+      pIGMPObjectPtr->uIGMPQuerierIPAddr = (pBuffer[IP_FRAME_BASE + IP_SRC_OFFSET] << 24) | (pBuffer[IP_FRAME_BASE + IP_SRC_OFFSET + 1] << 16) |
+        (pBuffer[IP_FRAME_BASE + IP_SRC_OFFSET + 2] << 8) | pBuffer[IP_FRAME_BASE + IP_SRC_OFFSET + 3];
+      pIGMPObjectPtr->uIGMPQuerierAge = 0;
+
+      log_printf(LOG_SELECT_IGMP, LOG_LEVEL_DEBUG, "IGMP [%02d] v%d query for group %08x, max response %d00ms\r\n", id,
+          pIGMPObjectPtr->uIGMPQuerierVersion, uGroupAddr, uMaxResponseTicks);
+
+      igmp_query_received(pIGMPObjectPtr, uGroupAddr, uMaxResponseTicks);
+      break;
+
+    case IGMP_V1_MEMBERSHIP_REPORT:
+    case IGMP_MEMBERSHIP_REPORT:
+      /* rfc 2236 section 3: another member answered the query for this group, so ours is redundant */
+      if ((pIGMPObjectPtr->uIGMPVersion == IGMP_VERSION_2) && (pIGMPObjectPtr->uIGMPResponseTimer != 0) &&
+          (pIGMPObjectPtr->uIGMPResponseGroup != 0) && (pIGMPObjectPtr->uIGMPResponseGroup == uGroupAddr)){
+        pIGMPObjectPtr->uIGMPResponseTimer = 0;
+        IFCounterIncr(pIFObjectPtr, TX_IGMP_SUPPRESSED);
+        log_printf(LOG_SELECT_IGMP, LOG_LEVEL_DEBUG, "IGMP [%02d] report for %08x heard, response suppressed\r\n", id, uGroupAddr);
+      } else {
+        IFCounterIncr(pIFObjectPtr, RX_IP_IGMP_DROPPED);
+      }
+      break;
+
+    default:
+      /* leave messages, igmpv3 reports... */
+      IFCounterIncr(pIFObjectPtr, RX_IP_IGMP_DROPPED);
+      break;
+  }
+
+  return XST_SUCCESS;
+}
+
+
+const struct sIGMPObject *pIGMPGetInfo(u8 uId){
+  if (uId >= NUM_ETHERNET_INTERFACES){
+    return NULL;
+  }
+
+  return pIGMPGetContext(uId);
+}
+
+
 void vIGMPPrintInfo(void){
   u8 num_links;
   u8 logical_link;
   u8 physical_id;
-  u32 base_addr;
-  u32 mask_addr;
+  u8 r;
   typeIGMPState current_state;
   u8 cached_id;
   struct sIGMPObject *pIGMPObjectPtr;
+  struct sIGMPRange *pRange;
+  static const char *range_state_name[] = {
+    [IGMP_RANGE_FREE]     = "free",
+    [IGMP_RANGE_JOINING]  = "joining",
+    [IGMP_RANGE_JOINED]   = "joined",
+    [IGMP_RANGE_LEAVING]  = "leaving"
+  };
 
   num_links = get_num_interfaces();
   for (logical_link = 0; logical_link < num_links; logical_link++){
     physical_id = get_physical_interface_id(logical_link);
     pIGMPObjectPtr = pIGMPGetContext(physical_id);
 
-    base_addr = pIGMPObjectPtr->uIGMPJoinMulticastAddress;
-    mask_addr = pIGMPObjectPtr->uIGMPJoinMulticastAddressMask;
     cached_id = pIGMPObjectPtr->uIGMPIfId;   /* included as cross-check to verify that the id mapping is correct */
     current_state = pIGMPObjectPtr->tIGMPCurrentState;
 
-    log_printf(LOG_SELECT_IGMP, LOG_LEVEL_INFO, "IGMP [%02d] id: %02d base: %08x mask: %08x state: %s\r\n", physical_id,
-        cached_id, base_addr, mask_addr, igmp_state_name_lookup[current_state]);
+    log_printf(LOG_SELECT_IGMP, LOG_LEVEL_INFO, "IGMP [%02d] id: %02d filter: %08x mask: %08x state: %s\r\n", physical_id,
+        cached_id, pIGMPObjectPtr->uIGMPFilterAddr, pIGMPObjectPtr->uIGMPFilterMask, igmp_state_name_lookup[current_state]);
+    for (r = 0; r < IGMP_RANGES_MAX; r++){
+      pRange = &(pIGMPObjectPtr->IGMPRanges[r]);
+      if (pRange->tState != IGMP_RANGE_FREE){
+        log_printf(LOG_SELECT_IGMP, LOG_LEVEL_INFO, "IGMP [%02d] range %d base: %08x mask: %08x %s\r\n", physical_id, r,
+            pRange->uBaseAddr, pRange->uMask, range_state_name[pRange->tState]);
+      }
+    }
+    log_printf(LOG_SELECT_IGMP, LOG_LEVEL_INFO, "IGMP [%02d] igmpv%d v2-reports/tick: %d join->first report: %uus join->announced: %uus\r\n",
+        physical_id, pIGMPObjectPtr->uIGMPVersion, pIGMPObjectPtr->uIGMPReportsPerTick,
+        perfmon_cycles_to_us(pIGMPObjectPtr->uIGMPJoinToFirstReport), perfmon_cycles_to_us(pIGMPObjectPtr->uIGMPJoinToAnnounced));
+    if (pIGMPObjectPtr->uIGMPQuerierVersion != 0){
+      log_printf(LOG_SELECT_IGMP, LOG_LEVEL_INFO, "IGMP [%02d] v%d querier: %08x last heard: %ds ago%s\r\n", physical_id,
+          pIGMPObjectPtr->uIGMPQuerierVersion, pIGMPObjectPtr->uIGMPQuerierIPAddr, pIGMPObjectPtr->uIGMPQuerierAge / 10,
+          pIGMPObjectPtr->uIGMPResponseTimer ? " (response pending)" : "");
+    } else {
+      log_printf(LOG_SELECT_IGMP, LOG_LEVEL_INFO, "IGMP [%02d] no querier heard\r\n", physical_id);
+    }
   }
 }
 
@@ -258,6 +587,10 @@ u8 uIGMPStateMachine(u8 uId)
 
   log_printf(LOG_SELECT_IGMP, LOG_LEVEL_TRACE, "IGMP [%02d] entering state %s\r\n", pIGMPObjectPtr->uIGMPIfId, igmp_state_name_lookup[pIGMPObjectPtr->tIGMPCurrentState]);
 
+  if (pIGMPObjectPtr->uIGMPQuerierAge < IGMP_QUERIER_PRESENT_TICKS){
+    pIGMPObjectPtr->uIGMPQuerierAge++;
+  }
+
   tIGMPNextState = igmp_state_table[pIGMPObjectPtr->tIGMPCurrentState](pIGMPObjectPtr);
 
   /* only upon a state change, print debug info... */
@@ -275,12 +608,15 @@ u8 uIGMPStateMachine(u8 uId)
 static typeIGMPState igmp_idle_state(struct sIGMPObject *pIGMPObjectPtr)
 {
   pIGMPObjectPtr->uIGMPCurrentMessage = 0;
+  pIGMPObjectPtr->uIGMPCurrentRange = 0;
   pIGMPObjectPtr->uIGMPCurrentClkTick = 0;
-  pIGMPObjectPtr->uIGMPLeaveRequestFlag = FALSE;
+  pIGMPObjectPtr->uIGMPRefresh = FALSE;
 
-  if (pIGMPObjectPtr->uIGMPJoinRequestFlag == TRUE){
-    /* clear the join request flag here to prevent rejoining once a leave is requested later, creating a cycle */
-    pIGMPObjectPtr->uIGMPJoinRequestFlag = FALSE;
+  if (igmp_range_count(pIGMPObjectPtr, IGMP_RANGE_LEAVING) != 0){
+    return IGMP_LEAVING_STATE;
+  }
+
+  if (igmp_range_count(pIGMPObjectPtr, IGMP_RANGE_JOINING) != 0){
     return IGMP_SEND_MEMBERSHIP_REPORTS_STATE;
   }
 
@@ -288,76 +624,114 @@ static typeIGMPState igmp_idle_state(struct sIGMPObject *pIGMPObjectPtr)
 }
 
 
+/*
+ * Announce the ranges still to be joined, and all the joined ranges as well
+ * when this is a refresh, sharing one tick's report budget between them.
+ */
 static typeIGMPState igmp_send_membership_reports_state(struct sIGMPObject *pIGMPObjectPtr){
-  struct sIFObject *ifptr;
-  int iStatus;
-  u8 id;
-  u32 groupaddr;
-  u32 baseip;
-  u32 mask;
-  u32 pktlen;
-  u8 *txbuf;
-
-  /* have we cycled through all the masked addresses? */
-  if (pIGMPObjectPtr->uIGMPCurrentMessage > (~((unsigned) pIGMPObjectPtr->uIGMPJoinMulticastAddressMask))){
-    /* pIGMPObjectPtr->uIGMPCurrentMessage = 0; */
-    return IGMP_JOINED_STATE;
+  struct sIGMPRange *pRange;
+  u32 uBudget;
+  u32 uElapsed;
+  u8 r;
+
+  uBudget = (pIGMPObjectPtr->uIGMPVersion == IGMP_VERSION_3) ? IGMP_V3_REPORTS_PER_TICK : pIGMPObjectPtr->uIGMPReportsPerTick;
+
+  while (uBudget > 0){
+    for (r = pIGMPObjectPtr->uIGMPCurrentRange; r < IGMP_RANGES_MAX; r++){
+      pRange = &(pIGMPObjectPtr->IGMPRanges[r]);
+      if ((pRange->tState == IGMP_RANGE_JOINING) || ((pRange->tState == IGMP_RANGE_JOINED) && (pIGMPObjectPtr->uIGMPRefresh == TRUE))){
+        break;
+      }
+    }
+
+    /* have we cycled through all the masked addresses of all the ranges? */
+    if (r >= IGMP_RANGES_MAX){
+      pIGMPObjectPtr->uIGMPCurrentMessage = 0;
+      pIGMPObjectPtr->uIGMPCurrentRange = 0;
+      pIGMPObjectPtr->uIGMPRefresh = FALSE;
+
+      if (pIGMPObjectPtr->tIGMPJoinTiming == IGMP_TIMING_WAIT_ANNOUNCED){
+        uElapsed = perfmon_timestamp() - pIGMPObjectPtr->uIGMPJoinTimestamp;
+        pIGMPObjectPtr->uIGMPJoinToAnnounced = uElapsed;
+        pIGMPObjectPtr->tIGMPJoinTiming = IGMP_TIMING_IDLE;
+        log_printf(LOG_SELECT_IGMP, LOG_LEVEL_WARN, "IGMP [%02d] group ranges announced %uus after join\r\n", pIGMPObjectPtr->uIGMPIfId,
+            perfmon_cycles_to_us(uElapsed));
+      }
+
+      return igmp_settled_state(pIGMPObjectPtr);
+    }
+
+    if (r != pIGMPObjectPtr->uIGMPCurrentRange){
+      pIGMPObjectPtr->uIGMPCurrentRange = r;
+      pIGMPObjectPtr->uIGMPCurrentMessage = 0;
+    }
+
+    uBudget -= igmp_send_group_reports(pIGMPObjectPtr, pRange->uBaseAddr, pRange->uMask,
+        (pRange->tState == IGMP_RANGE_JOINING) ? IGMP_REPORT_JOIN : IGMP_REPORT_CURRENT, uBudget);
+
+    if (pIGMPObjectPtr->uIGMPCurrentMessage > (~((unsigned) pRange->uMask))){
+      if (pRange->tState == IGMP_RANGE_JOINING){
+        pRange->tState = IGMP_RANGE_JOINED;
+      }
+      pIGMPObjectPtr->uIGMPCurrentRange++;
+      pIGMPObjectPtr->uIGMPCurrentMessage = 0;
+    }
   }
 
-  baseip = pIGMPObjectPtr->uIGMPJoinMulticastAddress;
-  mask = pIGMPObjectPtr->uIGMPJoinMulticastAddressMask;
-
-  groupaddr = (baseip & mask) | pIGMPObjectPtr->uIGMPCurrentMessage;
-
-  id = pIGMPObjectPtr->uIGMPIfId;
-  ifptr = lookup_if_handle_by_id(id);
-  txbuf = ifptr->pUserTxBufferPtr;    /* reaching into the ifptr data struct here. Should possibly hide this in an
-                                         abstraction or a wrapper in future */
-
-  CreateIGMPPacket(id, txbuf, &pktlen, IGMP_MEMBERSHIP_REPORT, groupaddr);
-  pktlen = (pktlen >> 2);
-  iStatus =  TransmitHostPacket(id, (u32 *) txbuf, pktlen);
-
-  if (iStatus != XST_SUCCESS){
-    IFCounterIncr(ifptr, TX_IP_IGMP_ERR);
-    log_printf(LOG_SELECT_IGMP, LOG_LEVEL_ERROR, "IGMP [%02d] FAILED to send membership report for ip %08x\r\n", id, groupaddr);
-  } else {
-    IFCounterIncr(ifptr, TX_IP_IGMP_OK);
-    /* log-level set to WARN in order to display during programming */
-    log_printf(LOG_SELECT_IGMP, LOG_LEVEL_WARN, "IGMP [%02d] sent membership report for ip %08x\r\n", id, groupaddr);
-  }
-
-  pIGMPObjectPtr->uIGMPCurrentMessage++;
-
   return IGMP_SEND_MEMBERSHIP_REPORTS_STATE;
 }
 
 
 static typeIGMPState igmp_joined_state(struct sIGMPObject *pIGMPObjectPtr)
 {
+  struct sIFObject *ifptr;
+  u32 uGroup;
 
   pIGMPObjectPtr->uIGMPCurrentClkTick++;
   pIGMPObjectPtr->uIGMPCurrentMessage = 0;
+  pIGMPObjectPtr->uIGMPCurrentRange = 0;
 
   /* TODO: SANE_IGMP_TICK() - check that the igmp state will actually fire since timeout may be larger than sizeof(tick) */
 
+  /* answer a query once its random delay has expired */
+  if (pIGMPObjectPtr->uIGMPResponseTimer != 0){
+    pIGMPObjectPtr->uIGMPResponseTimer--;
+    if (pIGMPObjectPtr->uIGMPResponseTimer == 0){
+      pIGMPObjectPtr->uIGMPCurrentClkTick = 0;
+      if (pIGMPObjectPtr->uIGMPResponseGroup == 0){
+        pIGMPObjectPtr->uIGMPRefresh = TRUE;
+        return IGMP_SEND_MEMBERSHIP_REPORTS_STATE;
+      }
+      /* group specific query - report only the queried group */
+      uGroup = pIGMPObjectPtr->uIGMPResponseGroup;
+      igmp_send_group_reports(pIGMPObjectPtr, uGroup, 0xffffffff, IGMP_REPORT_CURRENT, 1);
+      pIGMPObjectPtr->uIGMPCurrentMessage = 0;
+    }
+  }
+
   /* is it time to send IGMP reports to the router/switch? */
   if (pIGMPObjectPtr->uIGMPCurrentClkTick >= IGMP_REPORT_TIMER) {
     pIGMPObjectPtr->uIGMPCurrentClkTick = 0;
-    return IGMP_SEND_MEMBERSHIP_REPORTS_STATE;
+
+    /* an active querier solicits the reports it needs, so unsolicited refreshes would be redundant */
+    if ((pIGMPObjectPtr->uIGMPQuerierVersion != 0) && (pIGMPObjectPtr->uIGMPQuerierAge < IGMP_QUERIER_PRESENT_TICKS)){
+      ifptr = lookup_if_handle_by_id(pIGMPObjectPtr->uIGMPIfId);
+      IFCounterIncr(ifptr, TX_IGMP_SUPPRESSED);
+      log_printf(LOG_SELECT_IGMP, LOG_LEVEL_DEBUG, "IGMP [%02d] querier present, periodic reports suppressed\r\n", pIGMPObjectPtr->uIGMPIfId);
+    } else {
+      pIGMPObjectPtr->uIGMPRefresh = TRUE;
+      return IGMP_SEND_MEMBERSHIP_REPORTS_STATE;
+    }
   }
 
-  if (pIGMPObjectPtr->uIGMPLeaveRequestFlag == TRUE){
-    pIGMPObjectPtr->uIGMPLeaveRequestFlag = FALSE;
+  /* ranges are left before new ones are announced, so that a range move doesn't transiently double the subscription */
+  if (igmp_range_count(pIGMPObjectPtr, IGMP_RANGE_LEAVING) != 0){
+    pIGMPObjectPtr->uIGMPResponseTimer = 0;
     return IGMP_LEAVING_STATE;
   }
 
-  /* if the uIGMPJoinRequestFlag flag is set while in 'joined state', a new multicast configuration (addr and mask) was
-   * most likely requested. We have to leave current group and re-issue new igmp join requests...  */
-  if (pIGMPObjectPtr->uIGMPJoinRequestFlag == TRUE){
-    /* NOTE DO NOT clear the join request flag here since we want the s/m to filter back to the joined state after the
-     * next leave state and this flag will allow us to do this when we get back to 'idle state'. */
-    return IGMP_LEAVING_STATE;
+  if (igmp_range_count(pIGMPObjectPtr, IGMP_RANGE_JOINING) != 0){
+    return IGMP_SEND_MEMBERSHIP_REPORTS_STATE;
   }
 
   return IGMP_JOINED_STATE;
@@ -365,51 +739,303 @@ static typeIGMPState igmp_joined_state(struct sIGMPObject *pIGMPObjectPtr)
 
 
 static typeIGMPState igmp_leaving_state(struct sIGMPObject *pIGMPObjectPtr){
+  struct sIGMPRange *pRange;
+  u32 uBudget;
+  u8 r;
+
+  uBudget = (pIGMPObjectPtr->uIGMPVersion == IGMP_VERSION_3) ? IGMP_V3_REPORTS_PER_TICK : pIGMPObjectPtr->uIGMPReportsPerTick;
+
+  while (uBudget > 0){
+    for (r = pIGMPObjectPtr->uIGMPCurrentRange; r < IGMP_RANGES_MAX; r++){
+      if (pIGMPObjectPtr->IGMPRanges[r].tState == IGMP_RANGE_LEAVING){
+        break;
+      }
+    }
+
+    /* have we unsubscribed from all multicast group addresses? */
+    if (r >= IGMP_RANGES_MAX){
+      pIGMPObjectPtr->uIGMPCurrentMessage = 0;
+      pIGMPObjectPtr->uIGMPCurrentRange = 0;
+      return igmp_settled_state(pIGMPObjectPtr);
+    }
+
+    if (r != pIGMPObjectPtr->uIGMPCurrentRange){
+      pIGMPObjectPtr->uIGMPCurrentRange = r;
+      pIGMPObjectPtr->uIGMPCurrentMessage = 0;
+    }
+
+    pRange = &(pIGMPObjectPtr->IGMPRanges[r]);
+    uBudget -= igmp_send_group_reports(pIGMPObjectPtr, pRange->uBaseAddr, pRange->uMask, IGMP_REPORT_LEAVE, uBudget);
+
+    if (pIGMPObjectPtr->uIGMPCurrentMessage > (~((unsigned) pRange->uMask))){
+      pRange->tState = IGMP_RANGE_FREE;
+      pIGMPObjectPtr->uIGMPCurrentRange++;
+      pIGMPObjectPtr->uIGMPCurrentMessage = 0;
+    }
+  }
+
+  return IGMP_LEAVING_STATE;
+}
+
+
+
+/*----------------------------------private functions----------------------------------------------*/
+
+/* the state to move to once a report pass has completed */
+static typeIGMPState igmp_settled_state(struct sIGMPObject *pIGMPObjectPtr){
+  if (igmp_range_count(pIGMPObjectPtr, IGMP_RANGE_LEAVING) != 0){
+    return IGMP_LEAVING_STATE;
+  }
+
+  if (igmp_range_count(pIGMPObjectPtr, IGMP_RANGE_JOINING) != 0){
+    return IGMP_SEND_MEMBERSHIP_REPORTS_STATE;
+  }
+
+  if (igmp_range_count(pIGMPObjectPtr, IGMP_RANGE_JOINED) != 0){
+    return IGMP_JOINED_STATE;
+  }
+
+  return IGMP_IDLE_STATE;
+}
+
+
+static u8 igmp_range_count(struct sIGMPObject *pIGMPObjectPtr, typeIGMPRangeState tState){
+  u8 uCount = 0;
+  u8 r;
+
+  for (r = 0; r < IGMP_RANGES_MAX; r++){
+    if (pIGMPObjectPtr->IGMPRanges[r].tState == tState){
+      uCount++;
+    }
+  }
+
+  return uCount;
+}
+
+
+/* returns the index of the (non-free) range, or IGMP_RANGES_MAX if there is none */
+static u8 igmp_find_range(struct sIGMPObject *pIGMPObjectPtr, u32 uBaseAddr, u32 uMask){
+  struct sIGMPRange *pRange;
+  u8 r;
+
+  for (r = 0; r < IGMP_RANGES_MAX; r++){
+    pRange = &(pIGMPObjectPtr->IGMPRanges[r]);
+    if ((pRange->tState != IGMP_RANGE_FREE) && (pRange->uBaseAddr == (uBaseAddr & uMask)) && (pRange->uMask == uMask)){
+      return r;
+    }
+  }
+
+  return IGMP_RANGES_MAX;
+}
+
+
+/*
+ * The fabric only has one multicast address / mask filter per interface, so it
+ * is set to the tightest filter which still passes every joined range: only
+ * address bits which are masked in by all the ranges and on which all the
+ * bases agree are matched. Groups in between ranges may pass the filter too,
+ * but the switch only forwards the groups which have been joined. The filter
+ * is cleared once no ranges remain.
+ */
+static void igmp_update_fabric_filter(struct sIGMPObject *pIGMPObjectPtr){
+  struct sIGMPRange *pRange;
+  u32 uAddr = 0;
+  u32 uMask = 0xffffffff;
+  u32 uDiffer = 0;
+  u8 uFound = FALSE;
+  u8 r;
+
+  for (r = 0; r < IGMP_RANGES_MAX; r++){
+    pRange = &(pIGMPObjectPtr->IGMPRanges[r]);
+    if ((pRange->tState != IGMP_RANGE_JOINING) && (pRange->tState != IGMP_RANGE_JOINED)){
+      continue;
+    }
+
+    if (uFound == FALSE){
+      uAddr = pRange->uBaseAddr;
+      uFound = TRUE;
+    } else {
+      uDiffer |= uAddr ^ pRange->uBaseAddr;
+    }
+    uMask &= pRange->uMask;
+  }
+
+  if (uFound == FALSE){
+    uAddr = 0xffffffff;     /* cleared, as done by the multicast leave command */
+    uMask = 0xffffffff;
+  } else {
+    uMask &= ~uDiffer;
+    uAddr &= uMask;
+  }
+
+  pIGMPObjectPtr->uIGMPFilterAddr = uAddr;
+  pIGMPObjectPtr->uIGMPFilterMask = uMask;
+
+  SetMultiCastIPAddress(pIGMPObjectPtr->uIGMPIfId, uAddr, uMask);
+
+  log_printf(LOG_SELECT_IGMP, LOG_LEVEL_INFO, "IGMP [%02d] fabric multicast filter set to address %08x mask %08x\r\n",
+      pIGMPObjectPtr->uIGMPIfId, uAddr, uMask);
+}
+
+
+/*
+ * Send up to uMaxReports reports of the given type for the group range,
+ * starting at group uIGMPCurrentMessage, and return the number sent. IGMPv2
+ * sends one report per group. IGMPv3 packs up to IGMP_V3_RECORDS_PER_REPORT
+ * groups into a report. The burst is cut short if a transmit fails.
+ */
+static u32 igmp_send_group_reports(struct sIGMPObject *pIGMPObjectPtr, u32 uBaseAddr, u32 uMask, u8 uReportType, u32 uMaxReports){
   struct sIFObject *ifptr;
   int iStatus;
   u8 id;
+  u8 uRecordType;
+  u32 uLastGroup;
+  u32 uFirstGroup;
+  u32 uNumGroups;
+  u32 uNumReports = 0;
   u32 groupaddr;
-  u32 baseip;
-  u32 mask;
   u32 pktlen;
   u8 *txbuf;
 
-  /* have we unsubscribed from all multicast group addresses? */
-  if (pIGMPObjectPtr->uIGMPCurrentMessage > (~((unsigned) pIGMPObjectPtr->uIGMPLeaveMulticastAddressMask))){
-    return IGMP_IDLE_STATE;
-  }
-
-  baseip = pIGMPObjectPtr->uIGMPLeaveMulticastAddress;
-  mask = pIGMPObjectPtr->uIGMPLeaveMulticastAddressMask;
-
-  groupaddr = (baseip & mask) | pIGMPObjectPtr->uIGMPCurrentMessage;
-
   id = pIGMPObjectPtr->uIGMPIfId;
   ifptr = lookup_if_handle_by_id(id);
   txbuf = ifptr->pUserTxBufferPtr;    /* reaching into the ifptr data struct here. Should possibly hide this in an
                                          abstraction or a wrapper in future */
 
-  CreateIGMPPacket(id, txbuf, &pktlen, IGMP_LEAVE_REPORT, groupaddr);
-  pktlen = (pktlen >> 2);
-  iStatus =  TransmitHostPacket(id, (u32 *) txbuf, pktlen);
-
-  if (iStatus != XST_SUCCESS){
-    IFCounterIncr(ifptr, TX_IP_IGMP_ERR);
-    log_printf(LOG_SELECT_IGMP, LOG_LEVEL_ERROR, "IGMP [%02d] FAILED to send leave report for ip %08x\r\n", id, groupaddr);
+  uLastGroup = ~((unsigned) uMask);
+  uFirstGroup = pIGMPObjectPtr->uIGMPCurrentMessage;
+
+  if (pIGMPObjectPtr->uIGMPVersion == IGMP_VERSION_3){
+    if (uReportType == IGMP_REPORT_LEAVE){
+      uRecordType = IGMP_V3_CHANGE_TO_INCLUDE_MODE;   /* include nothing i.e. leave */
+    } else if (uReportType == IGMP_REPORT_CURRENT){
+      uRecordType = IGMP_V3_MODE_IS_EXCLUDE;
+    } else {
+      uRecordType = IGMP_V3_CHANGE_TO_EXCLUDE_MODE;
+    }
   } else {
+    uRecordType = (uReportType == IGMP_REPORT_LEAVE) ? IGMP_LEAVE_REPORT : IGMP_MEMBERSHIP_REPORT;
+  }
+
+  while ((pIGMPObjectPtr->uIGMPCurrentMessage <= uLastGroup) && (uNumReports < uMaxReports)){
+    groupaddr = (uBaseAddr & uMask) | pIGMPObjectPtr->uIGMPCurrentMessage;
+
+    if (pIGMPObjectPtr->uIGMPVersion == IGMP_VERSION_3){
+      uNumGroups = uLastGroup - pIGMPObjectPtr->uIGMPCurrentMessage;
+      uNumGroups = (uNumGroups >= IGMP_V3_RECORDS_PER_REPORT) ? IGMP_V3_RECORDS_PER_REPORT : (uNumGroups + 1);
+      CreateIGMPv3ReportPacket(id, txbuf, &pktlen, uRecordType, groupaddr, uNumGroups);
+    } else {
+      uNumGroups = 1;
+      CreateIGMPPacket(id, txbuf, &pktlen, uRecordType, groupaddr);
+    }
+
+    pktlen = (pktlen >> 2);
+    iStatus =  TransmitHostPacket(id, (u32 *) txbuf, pktlen);
+
+    pIGMPObjectPtr->uIGMPCurrentMessage += uNumGroups;
+    uNumReports++;
+
+    if (iStatus != XST_SUCCESS){
+      IFCounterIncr(ifptr, TX_IP_IGMP_ERR);
+      log_printf(LOG_SELECT_IGMP, LOG_LEVEL_ERROR, "IGMP [%02d] FAILED to send %s report for ip %08x (%d groups)\r\n", id,
+          (uReportType != IGMP_REPORT_LEAVE) ? "membership" : "leave", groupaddr, uNumGroups);
+      break;
+    }
+
     IFCounterIncr(ifptr, TX_IP_IGMP_OK);
-    /* log-level set to WARN in order to display during programming */
-    log_printf(LOG_SELECT_IGMP, LOG_LEVEL_WARN, "IGMP [%02d] sent leave report for ip %08x\r\n", id, groupaddr);
+    log_printf(LOG_SELECT_IGMP, LOG_LEVEL_DEBUG, "IGMP [%02d] sent %s report for ip %08x (%d groups)\r\n", id,
+        (uReportType != IGMP_REPORT_LEAVE) ? "membership" : "leave", groupaddr, uNumGroups);
+
+    if ((uReportType == IGMP_REPORT_JOIN) && (pIGMPObjectPtr->tIGMPJoinTiming == IGMP_TIMING_WAIT_FIRST_REPORT)){
+      pIGMPObjectPtr->uIGMPJoinToFirstReport = perfmon_timestamp() - pIGMPObjectPtr->uIGMPJoinTimestamp;
+      pIGMPObjectPtr->tIGMPJoinTiming = IGMP_TIMING_WAIT_ANNOUNCED;
+    }
   }
 
-  pIGMPObjectPtr->uIGMPCurrentMessage++;
+  /* log-level set to WARN in order to display during programming */
+  log_printf(LOG_SELECT_IGMP, LOG_LEVEL_WARN, "IGMP [%02d] sent %d igmpv%d %s reports for ip %08x to %08x\r\n", id, uNumReports,
+      pIGMPObjectPtr->uIGMPVersion, (uReportType != IGMP_REPORT_LEAVE) ? "membership" : "leave", (uBaseAddr & uMask) | uFirstGroup,
+      (uBaseAddr & uMask) | (pIGMPObjectPtr->uIGMPCurrentMessage - 1));
 
-  return IGMP_LEAVING_STATE;
+  return uNumReports;
 }
 
 
+static void igmp_join_timing_start(struct sIGMPObject *pIGMPObjectPtr){
+  pIGMPObjectPtr->uIGMPJoinTimestamp = perfmon_timestamp();
+  pIGMPObjectPtr->tIGMPJoinTiming = IGMP_TIMING_WAIT_FIRST_REPORT;
+}
+
+
+/*
+ * Schedule the response to a general (group 0) or group specific query. The
+ * delay is random within the max response time (rfc 2236 section 3). A pending
+ * response is only brought forward, never postponed, and a second query for a
+ * different group widens the response to all the joined ranges.
+ */
+static void igmp_query_received(struct sIGMPObject *pIGMPObjectPtr, u32 uGroupAddr, u16 uMaxResponseTicks){
+  struct sIFObject *ifptr;
+  struct sIGMPRange *pRange;
+  u16 uDelay;
+  u8 r;
+
+  /* only a settled membership is reported on, the other states send their own reports */
+  if (pIGMPObjectPtr->tIGMPCurrentState != IGMP_JOINED_STATE){
+    return;
+  }
+
+  if (uGroupAddr != 0){
+    for (r = 0; r < IGMP_RANGES_MAX; r++){
+      pRange = &(pIGMPObjectPtr->IGMPRanges[r]);
+      if ((pRange->tState == IGMP_RANGE_JOINED) && ((uGroupAddr & pRange->uMask) == pRange->uBaseAddr)){
+        break;
+      }
+    }
+    if (r >= IGMP_RANGES_MAX){
+      return;   /* not one of ours */
+    }
+  }
+
+  if (uMaxResponseTicks == 0){
+    uMaxResponseTicks = 1;
+  }
+
+  ifptr = lookup_if_handle_by_id(pIGMPObjectPtr->uIGMPIfId);
+  uDelay = (igmp_random(ifptr->uIFAddrIP) % uMaxResponseTicks) + 1;
+
+  if (pIGMPObjectPtr->uIGMPResponseTimer == 0){
+    pIGMPObjectPtr->uIGMPResponseGroup = uGroupAddr;
+  } else if (pIGMPObjectPtr->uIGMPResponseGroup != uGroupAddr){
+    pIGMPObjectPtr->uIGMPResponseGroup = 0;
+  }
+
+  if ((pIGMPObjectPtr->uIGMPResponseTimer == 0) || (uDelay < pIGMPObjectPtr->uIGMPResponseTimer)){
+    pIGMPObjectPtr->uIGMPResponseTimer = uDelay;
+  }
+
+  log_printf(LOG_SELECT_IGMP, LOG_LEVEL_DEBUG, "IGMP [%02d] responding for group %08x in %d00ms\r\n", pIGMPObjectPtr->uIGMPIfId,
+      pIGMPObjectPtr->uIGMPResponseGroup, pIGMPObjectPtr->uIGMPResponseTimer);
+}
+
+
+/* xorshift32, seeded on first use from the timer and the interface address */
+static u32 igmp_random(u32 uSeed){
+  static u32 uState = 0;
+
+  if (uState == 0){
+    uState = perfmon_timestamp() ^ uSeed;
+    if (uState == 0){
+      uState = IGMP_MAGIC_CANARY;
+    }
+  }
+
+  uState ^= uState << 13;
+  uState ^= uState >> 17;
+  uState ^= uState << 5;
+
+  return uState;
+}
 
-/*----------------------------------private functions----------------------------------------------*/
 
 
 #if 0
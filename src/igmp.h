@@ -16,6 +16,51 @@ typedef enum {
   IGMP_LEAVING_STATE
 } typeIGMPState;
 
+#define IGMP_VERSION_2    2
+#define IGMP_VERSION_3    3
+
+/* igmpv2 reports sent per 100ms tick while announcing or leaving a group range */
+#define IGMP_V2_REPORTS_PER_TICK_DEFAULT  128
+#define IGMP_V2_REPORTS_PER_TICK_MAX      256
+
+/* igmpv3 reports, of up to IGMP_V3_RECORDS_PER_REPORT groups each, sent per 100ms tick */
+#define IGMP_V3_REPORTS_PER_TICK          4
+
+/*
+ * Query handling. A response to a query is sent after a random delay within the
+ * query's max response time. While a querier has been heard within
+ * IGMP_QUERIER_PRESENT_TICKS (the rfc 2236 other querier present interval),
+ * the periodic timer driven reports are suppressed.
+ */
+#define IGMP_QUERIER_PRESENT_TICKS        2550
+#define IGMP_V1_MAX_RESPONSE_TICKS        100
+
+/*
+ * An interface can be subscribed to a small table of independent group ranges,
+ * each a base address and mask. Every range is joined and left with its own
+ * reports.
+ */
+#define IGMP_RANGES_MAX                   8
+
+typedef enum {
+  IGMP_RANGE_FREE=0,
+  IGMP_RANGE_JOINING,         /* membership still to be announced */
+  IGMP_RANGE_JOINED,
+  IGMP_RANGE_LEAVING          /* leave reports still to be sent, freed thereafter */
+} typeIGMPRangeState;
+
+struct sIGMPRange {
+  u32 uBaseAddr;
+  u32 uMask;
+  typeIGMPRangeState tState;
+};
+
+typedef enum {
+  IGMP_TIMING_IDLE=0,
+  IGMP_TIMING_WAIT_FIRST_REPORT,
+  IGMP_TIMING_WAIT_ANNOUNCED
+} typeIGMPTiming;
+
 struct sIGMPObject {
   u32 uIGMPMagic;
 
@@ -25,25 +70,49 @@ struct sIGMPObject {
   u32 uIGMPCurrentClkTick;     /* internal timer tick */
   u8 uIGMPIfId;               /* interface id associated with this igmp context */
 
-  u32 uIGMPJoinMulticastAddress;      /* base multicast address */
-  u32 uIGMPJoinMulticastAddressMask;  /* mask to be applied to the base multicast addr above */
+  struct sIGMPRange IGMPRanges[IGMP_RANGES_MAX];
+  u8 uIGMPCurrentRange;       /* range uIGMPCurrentMessage refers to */
 
-  u32 uIGMPLeaveMulticastAddress;
-  u32 uIGMPLeaveMulticastAddressMask;
+  /* the fabric has a single multicast filter per interface, set to cover all the ranges */
+  u32 uIGMPFilterAddr;
+  u32 uIGMPFilterMask;
 
-  volatile u8 uIGMPJoinRequestFlag;
-  volatile u8 uIGMPLeaveRequestFlag;
+  u8 uIGMPVersion;            /* IGMP_VERSION_2 or IGMP_VERSION_3 */
+  u16 uIGMPReportsPerTick;    /* igmpv2 burst limit */
+  u8 uIGMPRefresh;            /* current report pass is a periodic refresh rather than a join */
+
+  /* join timing in perfmon timer cycles */
+  typeIGMPTiming tIGMPJoinTiming;
+  u32 uIGMPJoinTimestamp;
+  u32 uIGMPJoinToFirstReport;
+  u32 uIGMPJoinToAnnounced;
+
+  /* query handling */
+  u8 uIGMPQuerierVersion;     /* version of the last query heard, 0 if none */
+  u32 uIGMPQuerierIPAddr;
+  u32 uIGMPQuerierAge;        /* ticks since the last query */
+  u16 uIGMPResponseTimer;     /* ticks until the query response is sent, 0 if none pending */
+  u32 uIGMPResponseGroup;     /* group queried, 0 to report the whole range */
 };
 
+struct sIFObject;
+
 struct sIGMPObject *pIGMPInit(u8 uId);
 
-u8 uIGMPJoinGroup(u8 uId, u32 uMulticaseBaseAddr, u32 uMulticastAddrMask);
-u8 uIGMPLeaveGroup(u8 uId);
+u8 uIGMPJoinGroup(u8 uId, u32 uMulticaseBaseAddr, u32 uMulticastAddrMask);   /* replaces all ranges with this one */
+u8 uIGMPLeaveGroup(u8 uId);                                                     /* leaves all ranges */
+u8 uIGMPAddRange(u8 uId, u32 uMulticastBaseAddr, u32 uMulticastAddrMask);
+u8 uIGMPRemoveRange(u8 uId, u32 uMulticastBaseAddr, u32 uMulticastAddrMask);
 u8 uIGMPLeaveGroupFlush(u8 uId);    /* blocks till all leave requests have been sent */
 u8 uIGMPRejoinPrevGroup(u8 uId);
+u8 uIGMPRejoinPrevGroupNow(u8 uId);   /* as above, but sends the first reports straight away */
 
 u8 uIGMPStateMachine(u8 uId);
 
+u8 uIGMPConfigure(u8 uId, u8 uVersion, u16 uReportsPerTick);
+u8 uIGMPMessageProcess(struct sIFObject *pIFObjectPtr);
+const struct sIGMPObject *pIGMPGetInfo(u8 uId);
+
 void vIGMPPrintInfo(void);
 #ifdef __cplusplus
 }
@@ -11,6 +11,7 @@
 #include "improved_read_write.h"
 #include "custom_constants.h"
 #include "error.h"
+#include "eth_sorter.h"
 #include "logging.h"
 #include "register.h"
 
@@ -193,3 +194,306 @@ int BigWriteWishboneCommandHandler(u8 * pCommand, u32 uCommandLength, u8 * uResp
 
   return XST_SUCCESS;
 }
+
+//=================================================================================
+//  BigReadWishboneJumboCommandHandler
+//--------------------------------------------------------------------------------
+//  This method executes the BIG_READ_WISHBONE_JUMBO command. As for the big read
+//  above, but for up to BIG_WB_JUMBO_MAX_WORDS 32-bit words and the response only
+//  carries the words read, padded out to a 64-bit boundary.
+//
+//  Parameter Dir   Description
+//  --------- ---   -----------
+//  pCommand        IN  Pointer to command header
+//  uCommandLength      IN  Length of command
+//  uResponsePacketPtr    IN  Pointer to where response packet must be constructed
+//  uResponseLength     OUT Length of payload of response packet
+//
+//  Return
+//  ------
+//  XST_SUCCESS if successful
+//=================================================================================
+int BigReadWishboneJumboCommandHandler(u8 * pCommand, u32 uCommandLength, u8 * uResponsePacketPtr, u32 * uResponseLength){
+
+  sBigReadWishboneJumboReqT *Command = (sBigReadWishboneJumboReqT *) pCommand;
+  sBigReadWishboneJumboRespT *Response = (sBigReadWishboneJumboRespT *) uResponsePacketPtr;
+  u32 uAddress;
+  u32 uReadData;
+  u32 uLength;
+  u16 uReadIndex;
+  u16 uDataIndex = 0;
+  u8 errno = 0;
+
+  if (uCommandLength < sizeof(sBigReadWishboneJumboReqT)){
+    return XST_FAILURE;
+  }
+
+  Response->Header.uCommandType = Command->Header.uCommandType + 1;
+  Response->Header.uSequenceNumber = Command->Header.uSequenceNumber;
+  Response->uStartAddressHigh = Command->uStartAddressHigh;
+  Response->uStartAddressLow  = Command->uStartAddressLow;
+  Response->uNumberOfReads = Command->uNumberOfReads;
+  Response->uStatus = CMD_STATUS_SUCCESS;
+
+  if (Command->uNumberOfReads > BIG_WB_JUMBO_MAX_WORDS){
+    Response->uNumberOfReads = 0;
+    Response->uStatus = CMD_STATUS_ERROR_LENGTH;
+  }
+
+  uAddress = (Command->uStartAddressHigh << 16) | (Command->uStartAddressLow);
+
+  for (uReadIndex = 0; uReadIndex < Response->uNumberOfReads; uReadIndex++)
+  {
+    uReadData = ReadWishboneRegister(uAddress);
+    Response->uReadData[uDataIndex] = (uReadData >> 16) & 0xFFFF; // upper 16 bits
+    Response->uReadData[uDataIndex + 1] = uReadData & 0xFFFF; // lower 16 bits
+    uDataIndex = uDataIndex + 2;
+    uAddress = uAddress + 4;
+  }
+
+  errno = read_and_clear_error_flag();
+  if (errno == ERROR_AXI_DATA_BUS){
+    log_printf(LOG_SELECT_CTRL, LOG_LEVEL_ERROR, "CTRL [..] AXI data bus error - wishbone addr outside range perhaps?\r\n", errno);
+    Response->uStatus = CMD_STATUS_ERROR_BUS;
+  }
+
+  uLength = sizeof(sBigReadWishboneJumboRespT) - sizeof(Response->uReadData) + (uDataIndex * 2);
+  uLength = PadResponse((u8 *) Response, uLength);
+
+  *uResponseLength = uLength;
+
+  return XST_SUCCESS;
+}
+
+//=================================================================================
+//  BigWriteWishboneJumboCommandHandler
+//--------------------------------------------------------------------------------
+//  This method executes the BIG_WRITE_WISHBONE_JUMBO command. As for the big write
+//  above, but for up to BIG_WB_JUMBO_MAX_WORDS 32-bit words and the request need
+//  only carry the words to be written.
+//
+//  Parameter Dir   Description
+//  --------- ---   -----------
+//  pCommand        IN  Pointer to command header
+//  uCommandLength      IN  Length of command
+//  uResponsePacketPtr    IN  Pointer to where response packet must be constructed
+//  uResponseLength     OUT Length of payload of response packet
+//
+//  Return
+//  ------
+//  XST_SUCCESS if successful
+//=================================================================================
+int BigWriteWishboneJumboCommandHandler(u8 * pCommand, u32 uCommandLength, u8 * uResponsePacketPtr, u32 * uResponseLength){
+
+  sBigWriteWishboneJumboReqT *Command = (sBigWriteWishboneJumboReqT *) pCommand;
+  sBigWriteWishboneJumboRespT *Response = (sBigWriteWishboneJumboRespT *) uResponsePacketPtr;
+  u32 uAddress;
+  u32 uWriteData;
+  u16 uWriteCount;
+  u16 uDataIndex = 0;
+  u16 uNumberOfWritesDone = 0;
+  u8 uPaddingIndex;
+  u8 errno = 0;
+
+  if (uCommandLength < (sizeof(sBigWriteWishboneJumboReqT) - sizeof(Command->uWriteData))){
+    return XST_FAILURE;
+  }
+
+  Response->uStatus = CMD_STATUS_SUCCESS;
+
+  /* the request must hold all the data words it claims to */
+  if ((Command->uNumberOfWrites > BIG_WB_JUMBO_MAX_WORDS) ||
+      (uCommandLength < (sizeof(sBigWriteWishboneJumboReqT) - sizeof(Command->uWriteData) + (Command->uNumberOfWrites * 4)))){
+    Response->uStatus = CMD_STATUS_ERROR_LENGTH;
+  } else {
+    uAddress = (Command->uStartAddressHigh << 16) | (Command->uStartAddressLow);
+
+    for (uWriteCount = 0; uWriteCount < Command->uNumberOfWrites; uWriteCount++)
+    {
+      uWriteData = (Command->uWriteData[uDataIndex] << 16) | (Command->uWriteData[uDataIndex + 1]);
+      WriteWishboneRegister(uAddress, uWriteData);
+
+      uNumberOfWritesDone += 1;
+      uDataIndex = uDataIndex + 2;
+      uAddress = uAddress + 4;
+    }
+
+    errno = read_and_clear_error_flag();
+    if (errno == ERROR_AXI_DATA_BUS){
+      log_printf(LOG_SELECT_CTRL, LOG_LEVEL_ERROR, "CTRL [..] AXI data bus error - wishbone addr outside range perhaps?\r\n", errno);
+      Response->uStatus = CMD_STATUS_ERROR_BUS;
+    }
+  }
+
+  Response->Header.uCommandType = Command->Header.uCommandType + 1;
+  Response->Header.uSequenceNumber = Command->Header.uSequenceNumber;
+  Response->uStartAddressHigh = Command->uStartAddressHigh;
+  Response->uStartAddressLow  = Command->uStartAddressLow;
+  Response->uNumberOfWritesDone = uNumberOfWritesDone;
+
+  // pad to minimum packet size and 64-bit boundary
+  for (uPaddingIndex = 0; uPaddingIndex < 5; uPaddingIndex++)
+    Response->uPadding[uPaddingIndex] = 0;
+
+  *uResponseLength = sizeof(sBigWriteWishboneJumboRespT);
+
+  return XST_SUCCESS;
+}
+
+//=================================================================================
+//  ScatterReadWishboneCommandHandler
+//--------------------------------------------------------------------------------
+//  This method executes the SCATTER_READ_WISHBONE command. Reads each of a list of
+//  up to SCATTER_WB_MAX_ENTRIES unrelated wishbone addresses and returns the data
+//  with a bus error flag per entry.
+//
+//  Parameter Dir   Description
+//  --------- ---   -----------
+//  pCommand        IN  Pointer to command header
+//  uCommandLength      IN  Length of command
+//  uResponsePacketPtr    IN  Pointer to where response packet must be constructed
+//  uResponseLength     OUT Length of payload of response packet
+//
+//  Return
+//  ------
+//  XST_SUCCESS if successful
+//=================================================================================
+int ScatterReadWishboneCommandHandler(u8 * pCommand, u32 uCommandLength, u8 * uResponsePacketPtr, u32 * uResponseLength){
+
+  sScatterReadWishboneReqT *Command = (sScatterReadWishboneReqT *) pCommand;
+  sScatterReadWishboneRespT *Response = (sScatterReadWishboneRespT *) uResponsePacketPtr;
+  u32 uAddress;
+  u32 uReadData;
+  u32 uLength;
+  u16 uReadIndex;
+  u16 uDataIndex = 0;
+  u16 uNumberOfErrors = 0;
+
+  if (uCommandLength < (sizeof(sScatterReadWishboneReqT) - sizeof(Command->uAddress))){
+    return XST_FAILURE;
+  }
+
+  Response->Header.uCommandType = Command->Header.uCommandType + 1;
+  Response->Header.uSequenceNumber = Command->Header.uSequenceNumber;
+  Response->uNumberOfReads = Command->uNumberOfReads;
+  Response->uStatus = CMD_STATUS_SUCCESS;
+
+  /* the request must hold all the addresses it claims to */
+  if ((Command->uNumberOfReads > SCATTER_WB_MAX_ENTRIES) ||
+      (uCommandLength < (sizeof(sScatterReadWishboneReqT) - sizeof(Command->uAddress) + (Command->uNumberOfReads * 4)))){
+    Response->uNumberOfReads = 0;
+    Response->uStatus = CMD_STATUS_ERROR_LENGTH;
+  }
+
+  /* discard any stale error so that each entry only reports its own */
+  (void) read_and_clear_error_flag();
+
+  for (uReadIndex = 0; uReadIndex < Response->uNumberOfReads; uReadIndex++)
+  {
+    uAddress = (Command->uAddress[2 * uReadIndex] << 16) | (Command->uAddress[(2 * uReadIndex) + 1]);
+    uReadData = ReadWishboneRegister(uAddress);
+
+    if (read_and_clear_error_flag() == ERROR_AXI_DATA_BUS){
+      Response->uReadData[uDataIndex] = 1;
+      uNumberOfErrors++;
+    } else {
+      Response->uReadData[uDataIndex] = 0;
+    }
+    Response->uReadData[uDataIndex + 1] = (uReadData >> 16) & 0xFFFF; // upper 16 bits
+    Response->uReadData[uDataIndex + 2] = uReadData & 0xFFFF; // lower 16 bits
+    uDataIndex = uDataIndex + 3;
+  }
+
+  if (uNumberOfErrors){
+    log_printf(LOG_SELECT_CTRL, LOG_LEVEL_ERROR, "CTRL [..] AXI data bus error on %d of %d scatter reads\r\n",
+        uNumberOfErrors, Response->uNumberOfReads);
+    Response->uStatus = CMD_STATUS_ERROR_BUS;
+  }
+  Response->uNumberOfErrors = uNumberOfErrors;
+
+  uLength = sizeof(sScatterReadWishboneRespT) - sizeof(Response->uReadData) + (uDataIndex * 2);
+  uLength = PadResponse((u8 *) Response, uLength);
+
+  *uResponseLength = uLength;
+
+  return XST_SUCCESS;
+}
+
+//=================================================================================
+//  ScatterWriteWishboneCommandHandler
+//--------------------------------------------------------------------------------
+//  This method executes the SCATTER_WRITE_WISHBONE command. Writes each of a list
+//  of up to SCATTER_WB_MAX_ENTRIES (address, value) pairs, in order, and returns a
+//  bus error flag per entry.
+//
+//  Parameter Dir   Description
+//  --------- ---   -----------
+//  pCommand        IN  Pointer to command header
+//  uCommandLength      IN  Length of command
+//  uResponsePacketPtr    IN  Pointer to where response packet must be constructed
+//  uResponseLength     OUT Length of payload of response packet
+//
+//  Return
+//  ------
+//  XST_SUCCESS if successful
+//=================================================================================
+int ScatterWriteWishboneCommandHandler(u8 * pCommand, u32 uCommandLength, u8 * uResponsePacketPtr, u32 * uResponseLength){
+
+  sScatterWriteWishboneReqT *Command = (sScatterWriteWishboneReqT *) pCommand;
+  sScatterWriteWishboneRespT *Response = (sScatterWriteWishboneRespT *) uResponsePacketPtr;
+  u32 uAddress;
+  u32 uWriteData;
+  u32 uLength;
+  u16 uWriteIndex;
+  u16 uDataIndex = 0;
+  u16 uFlagIndex = 0;
+  u16 uNumberOfErrors = 0;
+
+  if (uCommandLength < (sizeof(sScatterWriteWishboneReqT) - sizeof(Command->uWriteData))){
+    return XST_FAILURE;
+  }
+
+  Response->Header.uCommandType = Command->Header.uCommandType + 1;
+  Response->Header.uSequenceNumber = Command->Header.uSequenceNumber;
+  Response->uNumberOfWrites = Command->uNumberOfWrites;
+  Response->uStatus = CMD_STATUS_SUCCESS;
+
+  /* the request must hold all the (address, value) pairs it claims to */
+  if ((Command->uNumberOfWrites > SCATTER_WB_MAX_ENTRIES) ||
+      (uCommandLength < (sizeof(sScatterWriteWishboneReqT) - sizeof(Command->uWriteData) + (Command->uNumberOfWrites * 8)))){
+    Response->uNumberOfWrites = 0;
+    Response->uStatus = CMD_STATUS_ERROR_LENGTH;
+  }
+
+  /* discard any stale error so that each entry only reports its own */
+  (void) read_and_clear_error_flag();
+
+  for (uWriteIndex = 0; uWriteIndex < Response->uNumberOfWrites; uWriteIndex++)
+  {
+    uAddress = (Command->uWriteData[uDataIndex] << 16) | (Command->uWriteData[uDataIndex + 1]);
+    uWriteData = (Command->uWriteData[uDataIndex + 2] << 16) | (Command->uWriteData[uDataIndex + 3]);
+    WriteWishboneRegister(uAddress, uWriteData);
+    uDataIndex = uDataIndex + 4;
+
+    if (read_and_clear_error_flag() == ERROR_AXI_DATA_BUS){
+      Response->uErrorFlags[uFlagIndex++] = 1;
+      uNumberOfErrors++;
+    } else {
+      Response->uErrorFlags[uFlagIndex++] = 0;
+    }
+  }
+
+  if (uNumberOfErrors){
+    log_printf(LOG_SELECT_CTRL, LOG_LEVEL_ERROR, "CTRL [..] AXI data bus error on %d of %d scatter writes\r\n",
+        uNumberOfErrors, Response->uNumberOfWrites);
+    Response->uStatus = CMD_STATUS_ERROR_BUS;
+  }
+  Response->uNumberOfErrors = uNumberOfErrors;
+
+  uLength = sizeof(sScatterWriteWishboneRespT) - sizeof(Response->uErrorFlags) + (uFlagIndex * 2);
+  uLength = PadResponse((u8 *) Response, uLength);
+
+  *uResponseLength = uLength;
+
+  return XST_SUCCESS;
+}
@@ -17,11 +17,29 @@
 
 static char lookup[17] = "0123456789ABCDEF";
 
+/*
+ * Per-interface copy of the last LLDP frame built. The frame only depends on
+ * the interface's ip address, mac address, hostname and the firmware type, so
+ * it is re-sent as is until one of these change.
+ */
+struct sLLDPTemplate {
+  u8 uValid;
+  u32 uIPAddress;
+  u8 arrMacAddr[ETH_SRC_LEN];
+  u8 arrHostName[LLDP_SYSTEM_NAME_TLV_LEN];
+  u16 uFirmwareType;
+  u32 uLength;
+  u8 arrFrame[LLDP_TEMPLATE_SIZE];
+};
+
+static struct sLLDPTemplate LLDPTemplate[NUM_ETHERNET_INTERFACES];
+
 /***********************LLDP API functions***************************/
 //=================================================================================
 //  uLLDPBuildPacket
 //---------------------------------------------------------------------------------
-// This method builds the LLDP Packet into the user supplied buffer
+// This method builds the LLDP Packet into the user supplied buffer. The frame
+// is cached per interface and only rebuilt when its contents would change.
 //
 //  Parameter Dir   Description
 //  --------- ---   -----------
@@ -43,6 +61,7 @@ int uLLDPBuildPacket(u8 uId, u8 *pTransmitBuffer, u32 *uResponseLength){
   u8 *src_mac_addr;
   u8 *hostname;
   u16 first_part;
+  struct sLLDPTemplate *pTemplate = NULL;
 
   pIF = lookup_if_handle_by_id(uId);
 
@@ -51,8 +70,27 @@ int uLLDPBuildPacket(u8 uId, u8 *pTransmitBuffer, u32 *uResponseLength){
 
   hostname = pIF->DHCPContextState.arrDHCPHostName;
 
-  /* zero the buffer, saves us from having to explicitly set zero valued bytes */
-  memset(pTransmitBuffer, 0, LLDP_MAX_BUFFER_SIZE);
+  version = ReadBoardRegister(C_RD_VERSION_ADDR);
+  first_part = (version & 0xff000000) >> 24; // for BSP or TLF
+
+  if (uId < NUM_ETHERNET_INTERFACES){
+    pTemplate = &LLDPTemplate[uId];
+
+    if ((pTemplate->uValid) &&
+        (pTemplate->uIPAddress == uIPAddress) &&
+        ((pTemplate->uFirmwareType > 0) == (first_part > 0)) &&
+        (memcmp(pTemplate->arrMacAddr, src_mac_addr, ETH_SRC_LEN) == 0) &&
+        (memcmp(pTemplate->arrHostName, hostname, LLDP_SYSTEM_NAME_TLV_LEN) == 0)){
+      memcpy(pTransmitBuffer, pTemplate->arrFrame, pTemplate->uLength);
+      *uResponseLength = pTemplate->uLength;
+
+      log_printf(LOG_SELECT_LLDP, LOG_LEVEL_INFO, "LLDP [%02x] sending LLDP (len %d)\r\n", pIF->uIFEthernetId, *uResponseLength);
+      return LLDP_RETURN_OK;
+    }
+  }
+
+  /* zero the whole (padded) frame, saves us from having to explicitly set zero valued bytes */
+  memset(pTransmitBuffer, 0, LLDP_TEMPLATE_SIZE);
 
   /******* Ethernet frame stuff ******/
 
@@ -134,8 +172,6 @@ int uLLDPBuildPacket(u8 uId, u8 *pTransmitBuffer, u32 *uResponseLength){
   /* LLDP_SYSTEM_DESCR_TLV */
   pTransmitBuffer[LLDP_SYSTEM_DESCR_TLV_TYPE_OFFSET] = LLDP_SYSTEM_DESCR_TLV;
   pTransmitBuffer[LLDP_SYSTEM_DESCR_TLV_LEN_OFFSET] = LLDP_SYSTEM_DESCR_TLV_LEN;
-  version = ReadBoardRegister(C_RD_VERSION_ADDR);
-  first_part = (version & 0xff000000) >> 24; // for BSP or TLF
   if(first_part > 0){
     memcpy(pTransmitBuffer + LLDP_SYSTEM_DESCR_TLV_OFFSET, "BSP", LLDP_SYSTEM_DESCR_TLV_LEN);
   }
@@ -170,6 +206,16 @@ int uLLDPBuildPacket(u8 uId, u8 *pTransmitBuffer, u32 *uResponseLength){
 
   *uResponseLength = *uResponseLength + uPaddingLength;
 
+  if ((pTemplate != NULL) && (*uResponseLength <= LLDP_TEMPLATE_SIZE)){
+    pTemplate->uIPAddress = uIPAddress;
+    memcpy(pTemplate->arrMacAddr, src_mac_addr, ETH_SRC_LEN);
+    memcpy(pTemplate->arrHostName, hostname, LLDP_SYSTEM_NAME_TLV_LEN);
+    pTemplate->uFirmwareType = first_part;
+    pTemplate->uLength = *uResponseLength;
+    memcpy(pTemplate->arrFrame, pTransmitBuffer, *uResponseLength);
+    pTemplate->uValid = 1;
+  }
+
   log_printf(LOG_SELECT_LLDP, LOG_LEVEL_INFO, "LLDP [%02x] sending LLDP (len %d)\r\n", (pIF != NULL) ?
       pIF->uIFEthernetId : 0xFF, *uResponseLength);
 
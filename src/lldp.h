@@ -89,6 +89,10 @@ extern "C" {
 
 #define LLDP_MIN_BUFFER_SIZE    82
 #define LLDP_MAX_BUFFER_SIZE    1024
+
+/* length of a fully built lldp frame - up to the end of lldpdu tlv, padded to a
+   64-bit boundary (see uLLDPBuildPacket) */
+#define LLDP_TEMPLATE_SIZE      (((LLDP_END_OF_LLDPDU_TLV_OFFSET + 1) + 7) & ~0x7)
 volatile u8 uIPAddr[4];  // for IP address before dot notation 
 volatile char pIPBuffer[15]; // for IP address string in dot notation 
 
@@ -63,6 +63,15 @@
 #include "time.h"
 #include "init.h"
 #include "error.h"
+#include "perfmon.h"
+#include "prof.h"
+#include "memmon.h"
+#include "stream.h"
+#include "poll.h"
+#include "watch.h"
+#include "telemetry.h"
+#include "resp_cache.h"
+#include "session.h"
 
 #define DHCP_MAX_RECONFIG_COUNT 2
 
@@ -155,6 +164,8 @@ void TimerHandler(void * CallBackRef, u8 uTimerCounterNumber)
 
     uTick_100ms = 1;
 
+    perfmon_timer_tick();
+
     /* every 5 mins */
     if (uPrintStatsCounter >= 3000){
       uFlagRunTask_Diagnostics = 1;
@@ -180,7 +191,7 @@ void TimerHandler(void * CallBackRef, u8 uTimerCounterNumber)
       /* set the igmp task flag every 100ms which in turn runs igmp state machine */
       uFlagRunTask_IGMP[i] = 1;
 
-      // Every 100 ms, send another ARP request
+      /* run the arp neighbour table every 100ms */
       uFlagRunTask_ARP_Requests[i] = ARP_REQUEST_UPDATE;
     }
 
@@ -195,7 +206,12 @@ void TimerHandler(void * CallBackRef, u8 uTimerCounterNumber)
   }
 
 	if (XTmrCtr_IsExpired(InstancePtr, AUX_RETRY_TIMER_ID)) {
-    uFlagRunTask_Aux = 1;
+    /* the aux timer is borrowed as the sampling time base while profiling */
+    if (prof_is_running()){
+      prof_sample_isr();
+    } else {
+      uFlagRunTask_Aux = 1;
+    }
   }
 }
 
@@ -297,9 +313,25 @@ int EthernetRecvHandler(u8 uId, u32 uNumWords, u32 * uResponsePacketLengthBytes)
           // Command protocol
           if (uUdpDstPort == ETHERNET_CONTROL_PORT_ADDRESS){
             log_printf(LOG_SELECT_GENERAL, LOG_LEVEL_TRACE, "Control packet received!\r\n");
-            iStatus = CommandSorter(uId, pL5Ptr, uL5PktLen, uResponsePacketPtr, & uResponseLength);
+            // Handle the request in the session of its client
+            (void) session_open(uId);
+            // Retransmitted request - answer with the response already sent rather than executing it again
+            if (resp_cache_lookup(uId, pL5Ptr, uL5PktLen, uResponsePacketPtr, & uResponseLength) == RESP_CACHE_RETURN_HIT){
+              IFCounterIncr(pIFObjectPtr, TX_UDP_CTRL_CACHED);
+              iStatus = XST_SUCCESS;
+            } else {
+              iStatus = CommandSorter(uId, pL5Ptr, uL5PktLen, uResponsePacketPtr, & uResponseLength);
+              if (iStatus == XST_SUCCESS){
+                resp_cache_store(uId, pL5Ptr, uL5PktLen, uResponsePacketPtr, uResponseLength);
+              }
+            }
             if (iStatus == XST_SUCCESS){
               log_printf(LOG_SELECT_GENERAL, LOG_LEVEL_TRACE, "Control packet success\r\n");
+              // Response deferred by the handler - it will be sent outside of the control task
+              if (uResponseLength == 0){
+                * uResponsePacketLengthBytes = 0;
+                return XST_SUCCESS;
+              }
               // Create rest of Ethernet packet in transmit buffer for response
               CreateResponsePacket(uId, (u8 *) uTransmitBuffer, uResponseLength);
               * uResponsePacketLengthBytes = (uResponseLength + sizeof(sEthernetHeaderT) + sizeof(sIPV4HeaderT) + sizeof(sUDPHeaderT));
@@ -353,9 +385,6 @@ void InitialiseEthernetInterfaceParameters()
   u8 status;
   u8 n;
 
-  uPreviousAsyncSdramRead = 0;
-  uPreviousSequenceNumber = 0;
-
   status = get_skarab_serial(uSerial, ID_SK_SERIAL_LEN);
   if (status == XST_FAILURE){
     log_printf(LOG_SELECT_GENERAL, LOG_LEVEL_ERROR, "INIT [..] Failed to read SKARAB serial number.\r\n");
@@ -503,6 +532,9 @@ void InitialiseInterruptControllerAndTimer(XTmrCtr * pTimer, XIntc * pInterruptC
 
 int main()
 {
+  /* fill the free stack and the heap with a known pattern for high-water mark monitoring */
+  memmon_paint();
+
   /* initialise globals TODO: narrow down scope */
   uQSFPMezzanineLocation = 0x0;
   uQSFPMezzaninePresent = QSFP_MEZZANINE_NOT_PRESENT;
@@ -518,6 +550,7 @@ int main()
   u32 uReadReg;
   u8 uPhysicalEthernetId;
   u32 uNumWords;
+  u8 uEarlyDrop;
   u32 uResponsePacketLength;
   XTmrCtr Timer;
   XIntc InterruptController;
@@ -530,6 +563,7 @@ int main()
 
   //u32 uIGMPGroupAddress;
   u8 uOKToReboot;
+  u8 uBoardSerial[ID_SK_SERIAL_LEN];
 
 #ifdef LINK_MONITOR
   u8 uDHCPReconfigCount = DHCP_MAX_RECONFIG_COUNT;
@@ -584,6 +618,8 @@ int main()
 
   unsigned char *buf,temp;
 
+  u32 uPerfStart;   /* task start timestamp for the load instrumentation */
+
   u16 rom[8];
   u16 data[4];    /* this variable reused to read eeprom data - note: only 4 bytes */
   u16 dhcp_wait = 0;
@@ -697,6 +733,8 @@ int main()
   microblaze_register_exception_handler(XIL_EXCEPTION_ID_ILLEGAL_OPCODE, &IllegalOpcodeException, NULL);
   //microblaze_register_exception_handler(XIL_EXCEPTION_ID_UNALIGNED_ACCESS, &UnalignedAccessException, NULL);
   InitialiseInterruptControllerAndTimer(& Timer, & InterruptController);
+  perfmon_init(& Timer);
+  prof_init(& Timer);
   microblaze_enable_exceptions();
   log_printf(LOG_SELECT_GENERAL, LOG_LEVEL_ERROR, "[DONE]\r\n");
 
@@ -1019,6 +1057,12 @@ int main()
   ReadAndPrintFPGADNA();
   ReadAndPrintPeralexSerial();
 
+  /* seed the dhcp retry randomization with values unique to this board so that
+   * boards powered up together do not retry in lock step */
+  get_skarab_serial(uBoardSerial, ID_SK_SERIAL_LEN);
+  vDHCPSetRandomSeed(((u32) uBoardSerial[0] << 24 | (u32) uBoardSerial[1] << 16 | (u32) uBoardSerial[2] << 8 | (u32) uBoardSerial[3]) ^
+      ReadBoardRegister(C_RD_FPGA_DNA_LOW_ADDR) ^ ReadBoardRegister(C_RD_FPGA_DNA_HIGH_ADDR));
+
   /*
    * read dhcp init and retry times stored in pg15 of DS2433 EEPROM on Motherboard/
    * -> Init wait time at addr 0x1E0(LSB) and 0x1E1(MSB)
@@ -1142,6 +1186,8 @@ int main()
           pIFObjectPtr[uPhysicalEthernetId]->uIFEnableArpRequests = ARP_REQUESTS_ENABLE;
 
           IFConfig(pIFObjectPtr[uPhysicalEthernetId], tempIP, tempMask);
+          /* only the last octet of the gateway is cached */
+          ArpNeighbourConfigure(pIFObjectPtr[uPhysicalEthernetId], ((tempIP & tempMask) | byte));
 
           /* legacy dhcp states */
           uDHCPState[uPhysicalEthernetId] = DHCP_STATE_COMPLETE;
@@ -1190,12 +1236,16 @@ int main()
      */
     if (uQSFPUpdateStatusEnable == UPDATE_QSFP_STATUS){
       uQSFPUpdateStatusEnable = DO_NOT_UPDATE_QSFP_STATUS;
+      uPerfStart = perfmon_task_start();
       run_qsfp_mezz_mgmt();
+      perfmon_task_end(PERF_TASK_QSFP, uPerfStart);
     }
 
     if (uADC32RF45X2UpdateStatusEnable == UPDATE_ADC32RF45X2_STATUS){
       uADC32RF45X2UpdateStatusEnable = DO_NOT_UPDATE_ADC32RF45X2_STATUS;
+      uPerfStart = perfmon_task_start();
       run_adc_mezz_mgmt();
+      perfmon_task_end(PERF_TASK_ADC, uPerfStart);
     }
 
 
@@ -1209,8 +1259,10 @@ int main()
         uNumWords = GetHostReceiveBufferLevel(uPhysicalEthernetId);
         if (uNumWords != 0)
         {
-          /* zero the receive buffer */
-          memset((u8 *) uReceiveBuffer, 0, RX_BUFFER_MAX * 4);
+          uPerfStart = perfmon_task_start();
+
+          /* zero the header words of the receive buffer - the rest is only zeroed for packets which are kept */
+          memset((u8 *) uReceiveBuffer, 0, ETH_MAC_RX_HEADER_WORDS * 4);
 
           /* General packet reception handling:
              FILTER ( by layer and packet type)
@@ -1221,11 +1273,23 @@ int main()
              V
              PROCESS  (Do the work) */
 
-          // Read packet into receive buffer
-          iStatus  = ReadHostPacket(uPhysicalEthernetId, uReceiveBuffer, uNumWords);
+          /* Read the packet headers into the receive buffer first - packets which would be
+             dropped anyway are discarded from the mac without reading the rest of them */
+          uEarlyDrop = 0;
+          iStatus = ReadHostPacketHeader(uPhysicalEthernetId, uReceiveBuffer, uNumWords);
+          if (iStatus == XST_SUCCESS){
+            if ((uNumWords >= ETH_MAC_RX_HEADER_WORDS) && uRecvPacketEarlyDrop(pIFObjectPtr[uPhysicalEthernetId])){
+              AckHostPacketReceive(uPhysicalEthernetId);
+              uEarlyDrop = 1;
+            } else {
+              memset((u8 *) &uReceiveBuffer[ETH_MAC_RX_HEADER_WORDS], 0, (RX_BUFFER_MAX - ETH_MAC_RX_HEADER_WORDS) * 4);
+              iStatus = ReadHostPacketRemainder(uPhysicalEthernetId, uReceiveBuffer, uNumWords);
+            }
+          }
+
           if (iStatus != XST_SUCCESS){
             log_printf(LOG_SELECT_GENERAL, LOG_LEVEL_ERROR, "Read Host Packet Error!\r\n");
-          } else {
+          } else if (uEarlyDrop == 0){
 #ifdef TIME_PROFILE
             time1 = XWdtTb_ReadReg(WatchdogTimerConfig->BaseAddr, XWT_TWCSR0_OFFSET);
 #endif
@@ -1286,13 +1350,14 @@ int main()
                 }
                 /* else no break statement - fall through */
 
+              case PACKET_FILTER_IGMP:
               case PACKET_FILTER_ICMP:
                 /* ip layer checks */
                 /* FIXME: TODO check ip destination address */
                 /* verify ip header checksum */
                 if(uIPChecksumCalc((u8 *) pBuffer, &uChecksum) == 0){
                   if(uChecksum != 0xffff){
-                    log_printf(LOG_SELECT_IFACE, LOG_LEVEL_ERROR, "%s [%02x] RX - Invalid IP Checksum!\r\n", uPacketType == PACKET_FILTER_DHCP ? "DHCP" : uPacketType == PACKET_FILTER_ICMP ? "ICMP" : "CTRL", uPhysicalEthernetId);
+                    log_printf(LOG_SELECT_IFACE, LOG_LEVEL_ERROR, "%s [%02x] RX - Invalid IP Checksum!\r\n", uPacketType == PACKET_FILTER_DHCP ? "DHCP" : uPacketType == PACKET_FILTER_ICMP ? "ICMP" : uPacketType == PACKET_FILTER_IGMP ? "IGMP" : "CTRL", uPhysicalEthernetId);
                     IFCounterIncr(pIFObjectPtr[uPhysicalEthernetId], RX_IP_CHK_ERR);
                     break;
                   }
@@ -1304,7 +1369,6 @@ int main()
                 uValidate = 1;
                 break;
 
-              case PACKET_FILTER_IGMP_UNHANDLED:
               case PACKET_FILTER_PIM_UNHANDLED:
               case PACKET_FILTER_TCP_UNHANDLED:
               case PACKET_FILTER_LLDP_UNHANDLED:
@@ -1382,12 +1446,21 @@ int main()
                     log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, "ARP  [%02x] malformed packet!\r\n", uPhysicalEthernetId);
                     IFCounterIncr(pIFObjectPtr[uPhysicalEthernetId], RX_ARP_INVALID);
                   } else {
-                    /* arp packet probably not meant for us */
+                    /* arp packet probably not meant for us - still refresh the sender if we know it */
                     log_printf(LOG_SELECT_IFACE, LOG_LEVEL_TRACE, "ARP  [%02x] dropping packet!\r\n", uPhysicalEthernetId);
+                    if (iStatus == ARP_RETURN_IGNORE){
+                      ArpNeighbourLearn(pIFObjectPtr[uPhysicalEthernetId], 0);
+                    }
+                  }
+                  break;
+
+                case PACKET_FILTER_IGMP:
+                  if (uIGMPMessageProcess(pIFObjectPtr[uPhysicalEthernetId]) != XST_SUCCESS){
+                    IFCounterIncr(pIFObjectPtr[uPhysicalEthernetId], RX_IGMP_INVALID);
+                    log_printf(LOG_SELECT_IFACE, LOG_LEVEL_INFO, "IGMP [%02x] invalid packet received!\r\n", uPhysicalEthernetId);
                   }
                   break;
 
-                case PACKET_FILTER_IGMP_UNHANDLED:
                 case PACKET_FILTER_PIM_UNHANDLED:
                 case PACKET_FILTER_TCP_UNHANDLED:
                 case PACKET_FILTER_LLDP_UNHANDLED:
@@ -1407,6 +1480,8 @@ int main()
               uValidate = 0;
             }
           }
+
+          perfmon_task_end(PERF_TASK_RX, uPerfStart);
         }
       }
 
@@ -1418,7 +1493,9 @@ int main()
       //----------------------------------------------------------------------------//
       if (uFlagRunTask_DHCP[uPhysicalEthernetId]){
         uFlagRunTask_DHCP[uPhysicalEthernetId] = 0;     /* reset task flag */
+        uPerfStart = perfmon_task_start();
         uDHCPStateMachine(pIFObjectPtr[uPhysicalEthernetId]);
+        perfmon_task_end(PERF_TASK_DHCP, uPerfStart);
       }
 
       //----------------------------------------------------------------------------//
@@ -1428,7 +1505,9 @@ int main()
       if (uFlagRunTask_IGMP[uPhysicalEthernetId]){
         uFlagRunTask_IGMP[uPhysicalEthernetId] = 0;     /* reset task flag */
         if (pIFObjectPtr[uPhysicalEthernetId]->uIFLinkStatus == LINK_UP){
+          uPerfStart = perfmon_task_start();
           uIGMPStateMachine(uPhysicalEthernetId);
+          perfmon_task_end(PERF_TASK_IGMP, uPerfStart);
         }
       }
 
@@ -1438,6 +1517,7 @@ int main()
       //----------------------------------------------------------------------------//
       if (uFlagRunTask_CTRL[uPhysicalEthernetId]){
         log_printf(LOG_SELECT_CTRL, LOG_LEVEL_TRACE, "CTRL [%02x] Running control task...\r\n", uPhysicalEthernetId);
+        uPerfStart = perfmon_task_start();
         /* TODO: for now, run Peralex Control Protocol handler, slightly hackish */
         /* flip the endianess again */
         pBuffer = (u16 *) pIFObjectPtr[uPhysicalEthernetId]->pUserRxBufferPtr;
@@ -1448,7 +1528,7 @@ int main()
 
         iStatus = EthernetRecvHandler(uPhysicalEthernetId, pIFObjectPtr[uPhysicalEthernetId]->uNumWordsRead, &uResponsePacketLength);
 
-        if (iStatus == XST_SUCCESS){
+        if ((iStatus == XST_SUCCESS) && (uResponsePacketLength != 0)){
           // Send the response packet now
 #ifdef TIME_PROFILE
           time2 = XWdtTb_ReadReg(WatchdogTimerConfig->BaseAddr, XWT_TWCSR0_OFFSET);
@@ -1466,6 +1546,7 @@ int main()
         }
 
         uFlagRunTask_CTRL[uPhysicalEthernetId] = 0;
+        perfmon_task_end(PERF_TASK_CTRL, uPerfStart);
       }
 
 
@@ -1474,6 +1555,7 @@ int main()
       //  Triggered on ICMP message receipt                                         //
       //----------------------------------------------------------------------------//
       if (uFlagRunTask_ICMP_Reply[uPhysicalEthernetId]){
+        uPerfStart = perfmon_task_start();
         iStatus = uICMPBuildReplyMessage(pIFObjectPtr[uPhysicalEthernetId]);
         if (iStatus != ICMP_RETURN_OK){
           log_printf(LOG_SELECT_ICMP, LOG_LEVEL_INFO, "ICMP [%02x] Packet build error!\r\n", uPhysicalEthernetId);
@@ -1497,31 +1579,21 @@ int main()
         }
         uFlagRunTask_ICMP_Reply[uPhysicalEthernetId] = 0;
         uFlagRunTask_Diagnostics = 1;   /* dump interface counters to console upon ping */
+        perfmon_task_end(PERF_TASK_ICMP, uPerfStart);
       }
 
 
       //----------------------------------------------------------------------------//
       //  ARP PROCESSING TASK                                                       //
-      //  Triggered on ARP reply message reception                                  //
+      //  Triggered on ARP reply message reception - updates the neighbour table    //
       //----------------------------------------------------------------------------//
       if (uFlagRunTask_ARP_Process[uPhysicalEthernetId]){
+        uPerfStart = perfmon_task_start();
 
-        /* TODO FIXME refactor following lines: remove inline declarations, etc. */
-        u32 ip;
-        ip = (pIFObjectPtr[uPhysicalEthernetId]->pUserRxBufferPtr[ARP_FRAME_BASE + ARP_SRC_PROTO_ADDR_OFFSET + 3] & 0xff);
-
-        u32 u = ((pIFObjectPtr[uPhysicalEthernetId]->pUserRxBufferPtr[ARP_FRAME_BASE + ARP_SRC_HW_ADDR_OFFSET] << 8) & 0xff00) |
-          (pIFObjectPtr[uPhysicalEthernetId]->pUserRxBufferPtr[ARP_FRAME_BASE + ARP_SRC_HW_ADDR_OFFSET + 1] & 0xff); 
-        u32 l = ((pIFObjectPtr[uPhysicalEthernetId]->pUserRxBufferPtr[ARP_FRAME_BASE + ARP_SRC_HW_ADDR_OFFSET + 2] << 24) & 0xff000000) |
-          ((pIFObjectPtr[uPhysicalEthernetId]->pUserRxBufferPtr[ARP_FRAME_BASE + ARP_SRC_HW_ADDR_OFFSET + 3] << 16) & 0xff0000) |
-          ((pIFObjectPtr[uPhysicalEthernetId]->pUserRxBufferPtr[ARP_FRAME_BASE + ARP_SRC_HW_ADDR_OFFSET + 4] << 8) & 0xff00) |
-          (pIFObjectPtr[uPhysicalEthernetId]->pUserRxBufferPtr[ARP_FRAME_BASE + ARP_SRC_HW_ADDR_OFFSET + 5] & 0xff); 
-
-        log_printf(LOG_SELECT_ARP, LOG_LEVEL_INFO, "ARP  [%02x] ENTRY - IP#: %03d MAC: %04x.%04x.%04x\r\n", uPhysicalEthernetId, ip, (u & 0xffff), ((l >> 16) & 0xffff), (l & 0xffff));
-        /* TODO: API functions */
-        ProgramARPCacheEntry(uPhysicalEthernetId, ip, u, l);
+        ArpNeighbourLearn(pIFObjectPtr[uPhysicalEthernetId], 1);
 
         uFlagRunTask_ARP_Process[uPhysicalEthernetId] = 0;
+        perfmon_task_end(PERF_TASK_ARP, uPerfStart);
       }
 
       //----------------------------------------------------------------------------//
@@ -1529,6 +1601,9 @@ int main()
       //  Triggered on ARP request message reception                                //
       //----------------------------------------------------------------------------//
       if (uFlagRunTask_ARP_Respond[uPhysicalEthernetId]){
+        uPerfStart = perfmon_task_start();
+        /* the requester is about to talk to us - learn it now rather than resolving it later (RFC 826) */
+        ArpNeighbourLearn(pIFObjectPtr[uPhysicalEthernetId], 1);
         iStatus = uARPBuildMessage(pIFObjectPtr[uPhysicalEthernetId], ARP_OPCODE_REPLY, 0);
         if (iStatus != ARP_RETURN_OK){
           log_printf(LOG_SELECT_ARP, LOG_LEVEL_ERROR, "ARP  [%02x] Packet build error!\r\n", uPhysicalEthernetId);
@@ -1551,14 +1626,18 @@ int main()
           }
         }
         uFlagRunTask_ARP_Respond[uPhysicalEthernetId] = 0;
+        perfmon_task_end(PERF_TASK_ARP, uPerfStart);
       }
 
       //----------------------------------------------------------------------------//
       //  ARP REQUEST TASK                                                          //
+      //  Triggered on timer interrupt - runs the neighbour table                   //
       //----------------------------------------------------------------------------//
       if (uFlagRunTask_ARP_Requests[uPhysicalEthernetId] == ARP_REQUEST_UPDATE){
         uFlagRunTask_ARP_Requests[uPhysicalEthernetId] = ARP_REQUEST_DONT_UPDATE;
+        uPerfStart = perfmon_task_start();
         ArpRequestHandler(pIFObjectPtr[uPhysicalEthernetId]);
+        perfmon_task_end(PERF_TASK_ARP, uPerfStart);
       }
 
       //----------------------------------------------------------------------------//
@@ -1568,6 +1647,7 @@ int main()
       if(uFlagRunTask_LLDP[uPhysicalEthernetId]){
         /* only send lldp packets if the link is up */
         if (pIFObjectPtr[uPhysicalEthernetId]->uIFLinkStatus == LINK_UP){
+          uPerfStart = perfmon_task_start();
           iStatus = uLLDPBuildPacket(uPhysicalEthernetId, (u8*) uTransmitBuffer, &uResponsePacketLength);
           if(iStatus == XST_SUCCESS){
             uSize = uResponsePacketLength >> 1; /* 16 bit words */
@@ -1584,10 +1664,61 @@ int main()
               IFCounterIncr(pIFObjectPtr[uPhysicalEthernetId], TX_ETH_LLDP_OK);
             }
           }
+          perfmon_task_end(PERF_TASK_LLDP, uPerfStart);
         }
         uFlagRunTask_LLDP[uPhysicalEthernetId] = 0;
       }
 
+      //----------------------------------------------------------------------------//
+      //  STREAM TASK                                                               //
+      //  Runs while a streamed wishbone read has frames left to send               //
+      //----------------------------------------------------------------------------//
+      if (stream_pending(uPhysicalEthernetId)){
+        uPerfStart = perfmon_task_start();
+        stream_task(uPhysicalEthernetId);
+        perfmon_task_end(PERF_TASK_STREAM, uPerfStart);
+      }
+
+      //----------------------------------------------------------------------------//
+      //  POLL TASK                                                                 //
+      //  Runs while a poll-until-condition request is outstanding                  //
+      //----------------------------------------------------------------------------//
+      if (poll_pending(uPhysicalEthernetId)){
+        uPerfStart = perfmon_task_start();
+        poll_task(uPhysicalEthernetId);
+        perfmon_task_end(PERF_TASK_POLL, uPerfStart);
+      }
+
+      //----------------------------------------------------------------------------//
+      //  WATCH TASK                                                                //
+      //  Samples the register watch list and sends change notifications            //
+      //----------------------------------------------------------------------------//
+      if (watch_pending(uPhysicalEthernetId)){
+        uPerfStart = perfmon_task_start();
+        watch_task(uPhysicalEthernetId);
+        perfmon_task_end(PERF_TASK_WATCH, uPerfStart);
+      }
+
+      //----------------------------------------------------------------------------//
+      //  TELEMETRY TASK                                                            //
+      //  Sends the periodic telemetry report once the interval has elapsed         //
+      //----------------------------------------------------------------------------//
+      if (telemetry_pending(uPhysicalEthernetId)){
+        uPerfStart = perfmon_task_start();
+        telemetry_task(uPhysicalEthernetId);
+        perfmon_task_end(PERF_TASK_TELEMETRY, uPerfStart);
+      }
+
+      //----------------------------------------------------------------------------//
+      //  SESSION TASK                                                              //
+      //  Completes background operations of control sessions (flash block erase)   //
+      //----------------------------------------------------------------------------//
+      if (session_pending(uPhysicalEthernetId)){
+        uPerfStart = perfmon_task_start();
+        session_task(uPhysicalEthernetId);
+        perfmon_task_end(PERF_TASK_SESSION, uPerfStart);
+      }
+
     }   /* end network for-loop */
 
     //----------------------------------------------------------------------------//
@@ -1603,10 +1734,12 @@ int main()
     /* link monitor and recovery task */
     if (uFlagRunTask_LinkRecovery){
       uFlagRunTask_LinkRecovery = 0;
+      uPerfStart = perfmon_task_start();
       for (logical_link = 0; logical_link < num_links; logical_link++){
         uPhysicalEthernetId = get_physical_interface_id(logical_link);
         if_link_recovery_task(uPhysicalEthernetId, uDHCPTimeoutMax);
       }
+      perfmon_task_end(PERF_TASK_LINK_MON, uPerfStart);
     }
 #endif
 
@@ -1617,6 +1750,7 @@ int main()
     //----------------------------------------------------------------------------//
     if (uFlagRunTask_Diagnostics){
       uFlagRunTask_Diagnostics = 0;
+      uPerfStart = perfmon_task_start();
 
       /* also print some other useful info for debugging */
       log_printf(LOG_SELECT_GENERAL, LOG_LEVEL_INFO, "Register C_RD_ETH_IF_LINK_UP_ADDR: 0x%08x\r\n", ReadBoardRegister(C_RD_ETH_IF_LINK_UP_ADDR));
@@ -1626,6 +1760,7 @@ int main()
         uPhysicalEthernetId = get_physical_interface_id(logical_link);
         PrintInterfaceCounters(pIFObjectPtr[uPhysicalEthernetId]);
       }
+      perfmon_task_end(PERF_TASK_DIAG, uPerfStart);
     }
 
 
@@ -1724,6 +1859,9 @@ int main()
 
     /* Microblaze watchdog */
     XWdtTb_RestartWdt(& WatchdogTimer);
+
+    /* main loop utilisation instrumentation */
+    perfmon_loop_mark();
   }
 
   /* should never reach here */
@@ -1870,6 +2008,7 @@ static int vSetInterfaceConfig(struct sIFObject *pIFObjectPtr, void *pUserData){
   SetFabricGatewayARPCacheAddress(id, pDHCPObjectPtr->arrDHCPAddrRoute[3]);
 
   pIFObjectPtr->uIFEnableArpRequests = ARP_REQUESTS_ENABLE;
+  ArpNeighbourConfigure(pIFObjectPtr, uEthernetGatewayIPAddress[id]);
 
   /* legacy dhcp states */
   uDHCPState[id] = DHCP_STATE_COMPLETE;
@@ -1914,8 +2053,11 @@ static int vSetInterfaceConfig(struct sIFObject *pIFObjectPtr, void *pUserData){
    *  If we were previously part of a multicast group, try to resend igmp
    *  subscriptions as soon as we obtain a lease. This will allow us to rejoin
    *  the multicast group if the link "flaps" or the switch is rebooted.
+   *  After a link flap the re-announcement is sent straight away.
    */
-  if (XST_FAILURE == uIGMPRejoinPrevGroup(id)){
+  if (pIFObjectPtr->uIFRecoveryPending){
+    if_link_up_announce(pIFObjectPtr);
+  } else if (XST_FAILURE == uIGMPRejoinPrevGroup(id)){
     log_printf(LOG_SELECT_IGMP, LOG_LEVEL_ERROR, "IGMP [%02x] FAILED to rejoin multicast group\r\n", id);
   }
 
@@ -0,0 +1,104 @@
+/**----------------------------------------------------------------------------
+ *   FILE:       memmon.c
+ *   BRIEF:      Stack / heap high-water mark and BRAM usage report.
+ *
+ *   COMPANY:    SKA SA
+ *
+ *   NOTES:      vim settings: "set sw=2 ts=2 expandtab autoindent"
+ *
+ *   The unused part of the stack and the whole heap are filled with a known
+ *   pattern at startup. The stack grows downward from _stack towards
+ *   _stack_end and the heap (sbrk) grows upward from _heap_start, so the
+ *   high-water marks are found by scanning in from the far end of each region
+ *   for the first word which no longer holds the pattern.
+ *------------------------------------------------------------------------------*/
+
+#include <xil_types.h>
+#include <xil_printf.h>
+
+#include "memmon.h"
+
+/* see lscript.ld */
+extern u32 _text_section_end_;
+extern u32 __rodata_start;
+extern u32 __rodata_end;
+extern u32 __data_start;
+extern u32 __data_end;
+extern u32 __sdata_start;
+extern u32 __sdata_end;
+extern u32 __sbss_start;
+extern u32 __sbss_end;
+extern u32 __bss_start;
+extern u32 __bss_end;
+extern u32 _heap_start;
+extern u32 _heap_end;
+extern u32 _stack_end;
+extern u32 _stack;
+extern u32 _end;
+
+#define TEXT_SECTION_START  0x50    /* first address after the vectors */
+
+
+void memmon_paint(void){
+  u32 *p;
+  u32 uSP;
+
+  /* only the part of the stack below the current frame may be painted */
+  __asm__ __volatile__ ("or %0, r0, r1" : "=r" (uSP));
+
+  for (p = &_stack_end; p < (u32 *) (uSP & ~0x3); p++){
+    *p = MEMMON_PAINT_PATTERN;
+  }
+
+  for (p = &_heap_start; p < &_heap_end; p++){
+    *p = MEMMON_PAINT_PATTERN;
+  }
+}
+
+
+void memmon_get_usage(struct sMemUsage *pUsage){
+  u32 *p;
+
+  if (NULL == pUsage){
+    return;
+  }
+
+  pUsage->uTextSize = ((u32) &_text_section_end_) + 4 - TEXT_SECTION_START;
+  pUsage->uRodataSize = (u32) &__rodata_end - (u32) &__rodata_start;
+  pUsage->uDataSize = ((u32) &__data_end - (u32) &__data_start) + ((u32) &__sdata_end - (u32) &__sdata_start);
+  pUsage->uBssSize = ((u32) &__bss_end - (u32) &__bss_start) + ((u32) &__sbss_end - (u32) &__sbss_start);
+
+  pUsage->uStackSize = (u32) &_stack - (u32) &_stack_end;
+  for (p = &_stack_end; p < &_stack; p++){
+    if (*p != MEMMON_PAINT_PATTERN){
+      break;
+    }
+  }
+  pUsage->uStackHighWater = (u32) &_stack - (u32) p;
+
+  pUsage->uHeapSize = (u32) &_heap_end - (u32) &_heap_start;
+  for (p = &_heap_end; p > &_heap_start; p--){
+    if (*(p - 1) != MEMMON_PAINT_PATTERN){
+      break;
+    }
+  }
+  pUsage->uHeapHighWater = (u32) p - (u32) &_heap_start;
+
+  pUsage->uImageEnd = (u32) &_end;
+  pUsage->uBramFree = (pUsage->uImageEnd < MEMMON_BRAM_SIZE) ? (MEMMON_BRAM_SIZE - pUsage->uImageEnd) : 0;
+}
+
+
+void memmon_print_usage(void){
+  struct sMemUsage Usage;
+
+  memmon_get_usage(&Usage);
+
+  xil_printf("text:   %6u bytes\r\n", Usage.uTextSize);
+  xil_printf("rodata: %6u bytes\r\n", Usage.uRodataSize);
+  xil_printf("data:   %6u bytes\r\n", Usage.uDataSize);
+  xil_printf("bss:    %6u bytes\r\n", Usage.uBssSize);
+  xil_printf("heap:   %6u of %6u bytes used (high-water)\r\n", Usage.uHeapHighWater, Usage.uHeapSize);
+  xil_printf("stack:  %6u of %6u bytes used (high-water)\r\n", Usage.uStackHighWater, Usage.uStackSize);
+  xil_printf("bram:   %6u of %6u bytes free\r\n", Usage.uBramFree, MEMMON_BRAM_SIZE);
+}
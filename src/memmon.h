@@ -0,0 +1,43 @@
+/**----------------------------------------------------------------------------
+ *   FILE:       memmon.h
+ *   BRIEF:      API for the stack / heap high-water mark and BRAM usage report.
+ *
+ *   COMPANY:    SKA SA
+ *
+ *   NOTES:      vim settings: "set sw=2 ts=2 expandtab autoindent"
+ *------------------------------------------------------------------------------*/
+
+#ifndef _MEMMON_H_
+#define _MEMMON_H_
+
+#include <xil_types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MEMMON_PAINT_PATTERN  0xC0DEFACE
+#define MEMMON_BRAM_SIZE      0x40000     /* 256K BRAM - see lscript.ld */
+
+/* all values in bytes */
+struct sMemUsage {
+  u32 uTextSize;
+  u32 uRodataSize;
+  u32 uDataSize;          /* .data and .sdata */
+  u32 uBssSize;           /* .bss and .sbss */
+  u32 uHeapSize;
+  u32 uHeapHighWater;     /* highest heap offset ever written */
+  u32 uStackSize;
+  u32 uStackHighWater;    /* deepest stack usage seen */
+  u32 uImageEnd;          /* first address after the stack */
+  u32 uBramFree;          /* BRAM not claimed by the linker */
+};
+
+void memmon_paint(void);    /* call first thing in main() */
+void memmon_get_usage(struct sMemUsage *pUsage);
+void memmon_print_usage(void);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
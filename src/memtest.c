@@ -10,21 +10,39 @@
  *   NOTES:      vim settings: "set sw=2 ts=2 expandtab autoindent"
  *------------------------------------------------------------------------------*/
 
+#include <xparameters.h>
+#include <xtmrctr_l.h>
+
 #include "memtest.h"
 #include "logging.h"
 #include "delay.h"
+#include "perfmon.h"
+#include "constant_defs.h"
 
 #define HIGHEST_16BIT_PRIME 16321
 
 /* local function prototypes */
 static inline u8 uAdler32Calc(const u8 *pDataPtr, const u32 uDataSize, u32 *pChecksum);
 static u8 uDoMemoryTest(const u8 *pDataPtr, const u32 uDataSize, u32 *pChecksum);
+static u8 uMemTestTimerStart(u32 *pStart);
+static u32 uMemTestTimerStop(u8 uOwnTimer, u32 uStart);
 
 //=================================================================================
 //  uAdler32Calc
 //---------------------------------------------------------------------------------
 //  This method implements the Adler32 checksum algorithm over a given dataset.
 //
+//  NOTE: this variant must match utils/adler32 bit for bit. The host tool keeps
+//  the two sums in 16-bit variables (i.e. they wrap modulo 2^16) and only does
+//  the modulo-prime reduction once at the end. Wrapping is preserved by any
+//  wider unsigned accumulator, so the sums are kept in 32 bits and truncated
+//  once at the end - no per-byte masking or modulo.
+//
+//  The aligned middle of the dataset is consumed a word at a time. For the four
+//  bytes x0..x3 of a word (in memory order) the byte-wise recurrence unrolls to
+//    a' = a + x0 + x1 + x2 + x3
+//    b' = b + 4a + 4x0 + 3x1 + 2x2 + x3
+//
 //  Parameter       Dir   Description
 //  ---------       ---   -----------
 //  pDataPtr        IN    pointer to the base of the dataset
@@ -36,19 +54,53 @@ static u8 uDoMemoryTest(const u8 *pDataPtr, const u32 uDataSize, u32 *pChecksum)
 //  0 for success, -1 for error
 //=================================================================================
 static inline u8 uAdler32Calc(const u8 *pDataPtr, const u32 uDataSize, u32 *pChecksum){
-  u16 a = 1;
-  u16 b = 0;
+  u32 a = 1;
+  u32 b = 0;
+  u32 uWord;
+  u32 s1, s2, s3, s4;
+  u32 uNumWords;
+
+  const u8 *pCurrentBytePtr = pDataPtr;
+  const u8 *pEndPtr = pDataPtr + uDataSize;
+  const u32 *pCurrentWordPtr;
+
+  /* leading bytes up to the first word boundary */
+  while ((pCurrentBytePtr < pEndPtr) && (((u32) pCurrentBytePtr) & 0x3)){
+    a = a + (u32) *pCurrentBytePtr++;
+    b = b + a;
+  }
+
+  pCurrentWordPtr = (const u32 *) pCurrentBytePtr;
+  uNumWords = ((u32) (pEndPtr - pCurrentBytePtr)) >> 2;
+
+  while (uNumWords--){
+    uWord = *pCurrentWordPtr++;
+
+    /* running sums of the bytes in memory order */
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+    s1 = (uWord >> 24);
+    s2 = s1 + ((uWord >> 16) & 0xff);
+    s3 = s2 + ((uWord >> 8) & 0xff);
+    s4 = s3 + (uWord & 0xff);
+#else
+    s1 = (uWord & 0xff);
+    s2 = s1 + ((uWord >> 8) & 0xff);
+    s3 = s2 + ((uWord >> 16) & 0xff);
+    s4 = s3 + (uWord >> 24);
+#endif
 
-  u8 *pCurrentBytePtr = NULL;
+    b = b + (a << 2) + s1 + s2 + s3 + s4;
+    a = a + s4;
+  }
 
-  /* do the Adler32 calculation */
-  for (pCurrentBytePtr = (u8 *) pDataPtr; pCurrentBytePtr < ((u8 *) pDataPtr + uDataSize); pCurrentBytePtr++){
-    /* log_printf(LOG_SELECT_GENERAL, LOG_LEVEL_INFO, "@%08p  0x%02x\r\n", pCurrentBytePtr, *pCurrentBytePtr); */
-    a = a + (u16) *pCurrentBytePtr;
+  /* trailing bytes */
+  for (pCurrentBytePtr = (const u8 *) pCurrentWordPtr; pCurrentBytePtr < pEndPtr; pCurrentBytePtr++){
+    a = a + (u32) *pCurrentBytePtr;
     b = b + a;
   }
-  a = a % HIGHEST_16BIT_PRIME;
-  b = b % HIGHEST_16BIT_PRIME;
+
+  a = (a & 0xffff) % HIGHEST_16BIT_PRIME;
+  b = (b & 0xffff) % HIGHEST_16BIT_PRIME;
 
   *pChecksum = (b << 16) | a;
 
@@ -114,16 +166,23 @@ extern u32 _location_checksum_;
 
 void vRunMemoryTest(void){
   u32 uMemTest = 0;
+  u32 uTimerStart;
+  u32 uDuration;
+  u8 uOwnTimer;
+
+  uOwnTimer = uMemTestTimerStart(&uTimerStart);
 
   /* NOTE: &_text_section_end_ gives us the address of the last program 32bit word
      but we're looking for size in bytes - therefore add 3 to include lower 3 bytes as well
      and add another one to prevent off-by-one error*/
   if (0 == uDoMemoryTest((u8 *) 0x50, (((u32) &_text_section_end_) + 3 - 0x50 + 1), &uMemTest)){
+    uDuration = uMemTestTimerStop(uOwnTimer, uTimerStart);
     log_printf(LOG_SELECT_GENERAL, LOG_LEVEL_ALWAYS, "[Memory Test] from addr @0x%08x to @0x%08x...\r\n"\
                                  "[Memory Test] expected value {@0x%08x}: 0x%08x\r\n"\
-                                 "[Memory Test] computed value              : 0x%08x\r\n",\
+                                 "[Memory Test] computed value              : 0x%08x\r\n"\
+                                 "[Memory Test] duration                    : %uus\r\n",\
                                  0x50, &_text_section_end_, &_location_checksum_,\
-                                 _location_checksum_, uMemTest);
+                                 _location_checksum_, uMemTest, perfmon_cycles_to_us(uDuration));
     /* do not allow failure to go unnoticed - Assert()! */
     if (uMemTest != _location_checksum_){
       while(1){
@@ -135,6 +194,50 @@ void vRunMemoryTest(void){
       log_printf(LOG_SELECT_GENERAL, LOG_LEVEL_ALWAYS, "[Memory Test] ***PASSED***\r\n");
     }
   } else {
+    uMemTestTimerStop(uOwnTimer, uTimerStart);
     log_printf(LOG_SELECT_GENERAL, LOG_LEVEL_ALWAYS, "[Memory Test] Error - could not execute\r\n");
   }
 }
+
+
+//=================================================================================
+//  uMemTestTimerStart / uMemTestTimerStop
+//---------------------------------------------------------------------------------
+//  Time the memory test in timer cycles. At boot the memory test runs before the
+//  timer driver has been initialised, so timer 0 is run as a free running up
+//  counter through the low level driver and returned to its reset state
+//  afterwards. Once the 100ms task timer is running (e.g. the memtest cli
+//  command) the perfmon time base is used instead.
+//
+//  Return
+//  ------
+//  uMemTestTimerStart: 1 if the low level timer was started, else 0
+//  uMemTestTimerStop: elapsed timer cycles
+//=================================================================================
+static u8 uMemTestTimerStart(u32 *pStart){
+  if (XTmrCtr_GetControlStatusReg(XPAR_TMRCTR_0_BASEADDR, DHCP_RETRY_TIMER_ID) & XTC_CSR_ENABLE_TMR_MASK){
+    *pStart = perfmon_timestamp();
+    return 0;
+  }
+
+  XTmrCtr_SetLoadReg(XPAR_TMRCTR_0_BASEADDR, DHCP_RETRY_TIMER_ID, 0);
+  XTmrCtr_LoadTimerCounterReg(XPAR_TMRCTR_0_BASEADDR, DHCP_RETRY_TIMER_ID);
+  XTmrCtr_SetControlStatusReg(XPAR_TMRCTR_0_BASEADDR, DHCP_RETRY_TIMER_ID, XTC_CSR_ENABLE_TMR_MASK);
+  *pStart = 0;
+
+  return 1;
+}
+
+
+static u32 uMemTestTimerStop(u8 uOwnTimer, u32 uStart){
+  u32 uNow;
+
+  if (0 == uOwnTimer){
+    return perfmon_timestamp() - uStart;
+  }
+
+  uNow = XTmrCtr_GetTimerCounterReg(XPAR_TMRCTR_0_BASEADDR, DHCP_RETRY_TIMER_ID);
+  XTmrCtr_SetControlStatusReg(XPAR_TMRCTR_0_BASEADDR, DHCP_RETRY_TIMER_ID, 0);
+
+  return uNow - uStart;
+}
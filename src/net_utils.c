@@ -20,29 +20,48 @@
 #include "ipv4.h"
 #include "dhcp.h"
 
+/* the checksum is defined over big-endian (network order) 16-bit words */
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+#define CHK_NATIVE_IS_NETWORK   1
+#else
+#define CHK_NATIVE_IS_NETWORK   0
+#endif
+
+#define CHK_SWAP16(x)   ((u16) ((((x) >> 8) & 0x00ff) | (((x) << 8) & 0xff00)))
+
+/* local function prototypes */
+static u32 uChecksum16SumComplementNative(const u8 *pData, u32 uLength, u32 uSum);
+
 //=================================================================================
 //  uChecksum16Calc
 //---------------------------------------------------------------------------------
 //  This method calculates a 16-bit word checksum.
 //
+//  The 1's complement of each 16-bit word is added into a 32-bit accumulator and
+//  the carries are only folded back in once at the end. Folding once at the end
+//  yields exactly the same value as folding after every word. Halfword aligned
+//  data is summed a 32-bit word at a time in native byte order and the result
+//  is swapped into the requested order afterwards (the 1's complement sum is
+//  independent of byte order up to a final swap - RFC 1071).
+//
 //  Parameter       Dir   Description
 //  ---------       ---   -----------
 //  pDataPtr        IN    pointer to buffer with data to be "checksummed"
 //  uIndexStart     IN    starting index in the data buffer (zero indexed)
 //  uIndexEnd       IN    ending index in the data buffer
 //  pChecksumPtr    OUT   pointer to a buffer to store calculated checksum
+//  ByteSwap        IN    treat the data as little-endian 16-bit words
+//  uChecksumStartValue IN  checksum to continue from (e.g. pseudo header)
 //
 //  Return
 //  ------
 //  0 for success and -1 for error
 //=================================================================================
 int uChecksum16Calc(u8 *pDataPtr, u16 uIndexStart, u16 uIndexEnd, u16 *pChecksumPtr, u8 ByteSwap, u16 uChecksumStartValue){
-  u16 uChkIndex;
-  u16 uChkLength;
-  u16 uChkTmp = 0;
-  u32 uChecksumValue = 0;
-  u32 uChecksumCarry = 0;
-  u8 Offset = 0;
+  const u8 *pData;
+  u32 uLength;
+  u32 uChecksumValue;
+  u8 uSwap = 0;
 
   if (pDataPtr == NULL){
     return (-1);
@@ -53,42 +72,140 @@ int uChecksum16Calc(u8 *pDataPtr, u16 uIndexStart, u16 uIndexEnd, u16 *pChecksum
     return (-1);
   }
 
-  if (ByteSwap){
-    Offset = 1;
+  pData = pDataPtr + uIndexStart;
+  uLength = (u32) uIndexEnd - uIndexStart + 1;
+
+  if (((u32) pData) & 0x1){
+    /* odd address - no wide loads possible, sum byte pairs in the requested order */
+    uChecksumValue = uChecksumStartValue;
+    while (uLength >= 2){
+      if (ByteSwap){
+        uChecksumValue += (u16) ~((pData[1] << 8) | pData[0]);
+      } else {
+        uChecksumValue += (u16) ~((pData[0] << 8) | pData[1]);
+      }
+      pData += 2;
+      uLength -= 2;
+    }
   } else {
-    Offset = 0;
-  }
+    /* swap to and from native order if the requested order differs from it */
+    uSwap = (ByteSwap ? 1 : 0) ^ (CHK_NATIVE_IS_NETWORK ? 0 : 1);
 
-  uChecksumValue = ( (u32) uChecksumStartValue) & 0x0000FFFF;
+    uChecksumValue = uSwap ? CHK_SWAP16(uChecksumStartValue) : uChecksumStartValue;
+    uChecksumValue = uChecksum16SumComplementNative(pData, uLength & ~0x1, uChecksumValue);
+    pData += uLength & ~0x1;
+    uLength &= 0x1;
 
-  uChkLength = uIndexEnd - uIndexStart + 1;
+    uChecksumValue = (uChecksumValue & 0xffff) + (uChecksumValue >> 16);
+    uChecksumValue = (uChecksumValue & 0xffff) + (uChecksumValue >> 16);
 
-  for (uChkIndex = uIndexStart; uChkIndex < (uIndexStart + uChkLength); uChkIndex += 2){
-    uChkTmp = (u8) pDataPtr[uChkIndex + Offset];
-    uChkTmp = uChkTmp << 8;
-    if (uChkIndex == (uIndexStart + uChkLength - 1)){     //last iteration - only valid for (uChkLength%2 == 1)
-      uChkTmp = uChkTmp + 0;
-    }
-    else{
-      uChkTmp = uChkTmp + (u8) pDataPtr[uChkIndex + 1 - Offset];
+    if (uSwap){
+      uChecksumValue = CHK_SWAP16(uChecksumValue);
     }
+  }
+
+  /* an odd trailing byte is the first byte of a zero padded 16-bit word in the requested order */
+  if (uLength){
+    uChecksumValue += (u16) ~(ByteSwap ? pData[0] : (pData[0] << 8));
+  }
+
+  uChecksumValue = (uChecksumValue & 0xffff) + (uChecksumValue >> 16);
+  uChecksumValue = (uChecksumValue & 0xffff) + (uChecksumValue >> 16);
+
+  *pChecksumPtr = uChecksumValue;
+
+  return 0;
+}
 
-    /* get 1's complement of data */
-    uChkTmp = ~uChkTmp;
 
-    /* aggregate -> doing 16bit arithmetic within 32bit words to preserve overflow */
-    uChecksumValue = uChecksumValue + uChkTmp;
+//=================================================================================
+//  uChecksum16SumComplementNative
+//---------------------------------------------------------------------------------
+//  Add the 1's complement of each native order 16-bit word in the halfword
+//  aligned buffer to uSum without folding. uLength must be even - an odd trailing
+//  byte is left to the caller. Each 32-bit word adds at most 0x1fffe, so a 64K
+//  buffer cannot overflow the accumulator.
+//=================================================================================
+static u32 uChecksum16SumComplementNative(const u8 *pData, u32 uLength, u32 uSum){
+  const u32 *pWord;
+  u32 w0, w1, w2, w3;
+
+  if ((uLength >= 2) && (((u32) pData) & 0x2)){
+    uSum += (u16) ~(*(const u16 *) pData);
+    pData += 2;
+    uLength -= 2;
+  }
 
-    /* get overflow */
-    uChecksumCarry = (uChecksumValue >> 16) & 0xffff;
+  pWord = (const u32 *) pData;
+
+  while (uLength >= 16){
+    w0 = ~pWord[0];
+    w1 = ~pWord[1];
+    w2 = ~pWord[2];
+    w3 = ~pWord[3];
+    uSum += (w0 >> 16) + (w0 & 0xffff) + (w1 >> 16) + (w1 & 0xffff);
+    uSum += (w2 >> 16) + (w2 & 0xffff) + (w3 >> 16) + (w3 & 0xffff);
+    pWord += 4;
+    uLength -= 16;
+  }
 
-    /* add to checksum */
-    uChecksumValue = (0xffff & uChecksumValue) + uChecksumCarry;
+  while (uLength >= 4){
+    w0 = ~(*pWord++);
+    uSum += (w0 >> 16) + (w0 & 0xffff);
+    uLength -= 4;
   }
 
-  *pChecksumPtr = uChecksumValue;
+  pData = (const u8 *) pWord;
 
-  return 0;
+  if (uLength >= 2){
+    uSum += (u16) ~(*(const u16 *) pData);
+  }
+
+  return uSum;
+}
+
+
+//=================================================================================
+//  uChecksum16Update
+//---------------------------------------------------------------------------------
+//  Incrementally update an internet checksum after a 16-bit field covered by it
+//  has changed, without re-summing the data (RFC 1624, eqn. 3):
+//    HC' = ~(~HC + ~m + m')
+//  Values are in whatever order the checksum field itself is stored in.
+//
+//  Parameter       Dir   Description
+//  ---------       ---   -----------
+//  uChecksum       IN    checksum field value before the change
+//  uOldValue       IN    old value of the 16-bit field
+//  uNewValue       IN    new value of the 16-bit field
+//
+//  Return
+//  ------
+//  updated checksum field value
+//=================================================================================
+u16 uChecksum16Update(u16 uChecksum, u16 uOldValue, u16 uNewValue){
+  u32 uSum;
+
+  uSum = (u16) ~uChecksum;
+  uSum += (u16) ~uOldValue;
+  uSum += uNewValue;
+
+  uSum = (uSum & 0xffff) + (uSum >> 16);
+  uSum = (uSum & 0xffff) + (uSum >> 16);
+
+  return (u16) ~uSum;
+}
+
+
+//=================================================================================
+//  uChecksum16Update32
+//---------------------------------------------------------------------------------
+//  As uChecksum16Update, for a changed 32-bit field (e.g. an IP address) given as
+//  two consecutive 16-bit words - high word first.
+//=================================================================================
+u16 uChecksum16Update32(u16 uChecksum, u32 uOldValue, u32 uNewValue){
+  uChecksum = uChecksum16Update(uChecksum, (uOldValue >> 16) & 0xffff, (uNewValue >> 16) & 0xffff);
+  return uChecksum16Update(uChecksum, uOldValue & 0xffff, uNewValue & 0xffff);
 }
 
 //***********************************************************************************
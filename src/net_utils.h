@@ -38,6 +38,8 @@ extern "C" {
 #endif
 
 int uChecksum16Calc(u8 *pDataPtr, u16 uIndexStart, u16 uIndexEnd, u16 *pChecksumPtr, u8 ByteSwap, u16 uChecksumStartValue);
+u16 uChecksum16Update(u16 uChecksum, u16 uOldValue, u16 uNewValue);
+u16 uChecksum16Update32(u16 uChecksum, u32 uOldValue, u32 uNewValue);
 int uIPChecksumCalc(u8 *pDataPtr, u16 *pChecksumPtr);
 int uUDPChecksumCalc(u8 *pDataPtr, u16 *pChecksumPtr);
 
@@ -0,0 +1,257 @@
+/**----------------------------------------------------------------------------
+ *   FILE:       perfmon.c
+ *   BRIEF:      Main loop utilisation / cpu load instrumentation.
+ *
+ *   COMPANY:    SKA SA
+ *
+ *   NOTES:      vim settings: "set sw=2 ts=2 expandtab autoindent"
+ *
+ *   The 100ms task timer (DHCP_RETRY_TIMER_ID) is used as the time base. It
+ *   counts down from DHCP_TIMER_RESET_VALUE and auto-reloads, so a free
+ *   running timestamp is made up of the number of timer interrupts seen so
+ *   far and the current counter value. The timestamp wraps after 2^32 timer
+ *   cycles (~110s at 39.0625MHz) which is far longer than anything measured
+ *   here, so plain unsigned subtraction gives the elapsed cycles.
+ *------------------------------------------------------------------------------*/
+
+#include <xil_types.h>
+#include <xil_printf.h>
+#include <xtmrctr.h>
+
+#include "perfmon.h"
+#include "constant_defs.h"
+
+struct sPerfMon {
+  XTmrCtr *pTimer;
+  volatile u32 uTicks;          /* incremented by the 100ms timer interrupt */
+
+  u32 uLastLoopMark;
+  u32 uWindowStart;
+  u8 uTaskRanThisLoop;
+
+  u32 uLoopMaxEverCycles;
+
+  struct sPerfStats Current;    /* window being accumulated */
+  struct sPerfStats Last;       /* last completed window */
+};
+
+static struct sPerfMon PerfMon;
+
+static const char * const perf_task_names[] = {
+  [PERF_TASK_RX]        = "rx",
+  [PERF_TASK_DHCP]      = "dhcp",
+  [PERF_TASK_IGMP]      = "igmp",
+  [PERF_TASK_CTRL]      = "ctrl",
+  [PERF_TASK_ICMP]      = "icmp",
+  [PERF_TASK_ARP]       = "arp",
+  [PERF_TASK_LLDP]      = "lldp",
+  [PERF_TASK_QSFP]      = "qsfp",
+  [PERF_TASK_ADC]       = "adc",
+  [PERF_TASK_LINK_MON]  = "link-mon",
+  [PERF_TASK_DIAG]      = "diag",
+  [PERF_TASK_STREAM]    = "stream",
+  [PERF_TASK_POLL]      = "poll",
+  [PERF_TASK_WATCH]     = "watch",
+  [PERF_TASK_TELEMETRY] = "telemetry",
+  [PERF_TASK_SESSION]   = "session"
+};
+
+static void perfmon_clear_stats(struct sPerfStats *s);
+
+
+void perfmon_init(XTmrCtr *pTimer){
+  PerfMon.pTimer = pTimer;
+  PerfMon.uTicks = 0;
+  PerfMon.uTaskRanThisLoop = 0;
+  PerfMon.uLoopMaxEverCycles = 0;
+
+  perfmon_clear_stats(&PerfMon.Current);
+  perfmon_clear_stats(&PerfMon.Last);
+
+  PerfMon.uLastLoopMark = perfmon_timestamp();
+  PerfMon.uWindowStart = PerfMon.uLastLoopMark;
+}
+
+
+void perfmon_timer_tick(void){
+  PerfMon.uTicks++;
+}
+
+
+u32 perfmon_timestamp(void){
+  u32 uTicks;
+  u32 uCount;
+
+  if (NULL == PerfMon.pTimer){
+    return 0;
+  }
+
+  /* re-read if the timer interrupt fired in between the two reads */
+  do {
+    uTicks = PerfMon.uTicks;
+    uCount = XTmrCtr_GetValue(PerfMon.pTimer, DHCP_RETRY_TIMER_ID);
+  } while (uTicks != PerfMon.uTicks);
+
+  if (uCount > DHCP_TIMER_RESET_VALUE){
+    uCount = DHCP_TIMER_RESET_VALUE;
+  }
+
+  return (uTicks * DHCP_TIMER_RESET_VALUE) + (DHCP_TIMER_RESET_VALUE - uCount);
+}
+
+
+u32 perfmon_task_start(void){
+  return perfmon_timestamp();
+}
+
+
+void perfmon_task_end(tPerfTask task, u32 uStart){
+  u32 uElapsed;
+
+  if (task >= PERF_TASK_MAX){
+    return;
+  }
+
+  uElapsed = perfmon_timestamp() - uStart;
+
+  /* the counter may have reloaded before the tick interrupt was serviced,
+   * which makes the timestamp appear to step backwards - discard these */
+  if (uElapsed & 0x80000000){
+    uElapsed = 0;
+  }
+
+  PerfMon.Current.uTaskCycles[task] += uElapsed;
+  PerfMon.Current.uTaskRuns[task]++;
+  PerfMon.Current.uBusyCycles += uElapsed;
+
+  if (uElapsed > PerfMon.Current.uTaskMaxCycles[task]){
+    PerfMon.Current.uTaskMaxCycles[task] = uElapsed;
+  }
+
+  PerfMon.uTaskRanThisLoop = 1;
+}
+
+
+void perfmon_loop_mark(void){
+  u32 uNow;
+  u32 uElapsed;
+
+  uNow = perfmon_timestamp();
+  uElapsed = uNow - PerfMon.uLastLoopMark;
+  if (uElapsed & 0x80000000){
+    uElapsed = 0;
+  }
+  PerfMon.uLastLoopMark = uNow;
+
+  PerfMon.Current.uLoopCount++;
+  if (0 == PerfMon.uTaskRanThisLoop){
+    PerfMon.Current.uIdleLoopCount++;
+  }
+  PerfMon.uTaskRanThisLoop = 0;
+
+  if (uElapsed > PerfMon.Current.uLoopMaxCycles){
+    PerfMon.Current.uLoopMaxCycles = uElapsed;
+  }
+
+  if (uElapsed > PerfMon.uLoopMaxEverCycles){
+    PerfMon.uLoopMaxEverCycles = uElapsed;
+  }
+
+  /* publish the window once it is complete */
+  uElapsed = uNow - PerfMon.uWindowStart;
+  if ((uElapsed & 0x80000000) == 0){
+    if (uElapsed >= (PERF_WINDOW_TICKS * DHCP_TIMER_RESET_VALUE)){
+      PerfMon.Current.uWindowCycles = uElapsed;
+      PerfMon.Last = PerfMon.Current;
+      perfmon_clear_stats(&PerfMon.Current);
+      PerfMon.uWindowStart = uNow;
+    }
+  } else {
+    PerfMon.uWindowStart = uNow;
+  }
+}
+
+
+const struct sPerfStats *perfmon_get_stats(void){
+  return &PerfMon.Last;
+}
+
+
+u32 perfmon_get_loop_max_ever_cycles(void){
+  return PerfMon.uLoopMaxEverCycles;
+}
+
+
+void perfmon_reset_max_ever(void){
+  PerfMon.uLoopMaxEverCycles = 0;
+}
+
+
+/* DHCP_TIMER_RESET_VALUE timer cycles make up 100ms */
+u32 perfmon_cycles_to_us(u32 uCycles){
+  return (u32) (((u64) uCycles * 100000) / DHCP_TIMER_RESET_VALUE);
+}
+
+
+u32 perfmon_us_to_cycles(u32 uUs){
+  return (u32) (((u64) uUs * DHCP_TIMER_RESET_VALUE) / 100000);
+}
+
+
+u16 perfmon_cycles_to_percent_x100(u32 uCycles, u32 uTotalCycles){
+  if (0 == uTotalCycles){
+    return 0;
+  }
+
+  if (uCycles >= uTotalCycles){
+    return 10000;
+  }
+
+  return (u16) (((u64) uCycles * 10000) / uTotalCycles);
+}
+
+
+const char *perfmon_task_name(tPerfTask task){
+  if (task >= PERF_TASK_MAX){
+    return "?";
+  }
+
+  return perf_task_names[task];
+}
+
+
+void perfmon_print_top(void){
+  const struct sPerfStats *s = &PerfMon.Last;
+  u16 uLoad;
+  u8 t;
+
+  uLoad = perfmon_cycles_to_percent_x100(s->uBusyCycles, s->uWindowCycles);
+
+  xil_printf("load: %u.%02u%%  window: %ums\r\n", uLoad / 100, uLoad % 100, perfmon_cycles_to_us(s->uWindowCycles) / 1000);
+  xil_printf("loops: %u  idle: %u  max: %uus  max-ever: %uus\r\n", s->uLoopCount, s->uIdleLoopCount,
+      perfmon_cycles_to_us(s->uLoopMaxCycles), perfmon_cycles_to_us(PerfMon.uLoopMaxEverCycles));
+  xil_printf("%-10s %8s %8s %10s\r\n", "task", "load%", "runs", "max(us)");
+
+  for (t = 0; t < PERF_TASK_MAX; t++){
+    uLoad = perfmon_cycles_to_percent_x100(s->uTaskCycles[t], s->uWindowCycles);
+    xil_printf("%-10s %5u.%02u %8u %10u\r\n", perf_task_names[t], uLoad / 100, uLoad % 100, s->uTaskRuns[t],
+        perfmon_cycles_to_us(s->uTaskMaxCycles[t]));
+  }
+}
+
+
+static void perfmon_clear_stats(struct sPerfStats *s){
+  u8 t;
+
+  s->uWindowCycles = 0;
+  s->uBusyCycles = 0;
+  s->uLoopCount = 0;
+  s->uIdleLoopCount = 0;
+  s->uLoopMaxCycles = 0;
+
+  for (t = 0; t < PERF_TASK_MAX; t++){
+    s->uTaskCycles[t] = 0;
+    s->uTaskRuns[t] = 0;
+    s->uTaskMaxCycles[t] = 0;
+  }
+}
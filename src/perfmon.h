@@ -0,0 +1,85 @@
+/**----------------------------------------------------------------------------
+ *   FILE:       perfmon.h
+ *   BRIEF:      API for the main loop utilisation / cpu load instrumentation.
+ *
+ *   COMPANY:    SKA SA
+ *
+ *   NOTES:      vim settings: "set sw=2 ts=2 expandtab autoindent"
+ *------------------------------------------------------------------------------*/
+
+#ifndef _PERFMON_H_
+#define _PERFMON_H_
+
+#include <xil_types.h>
+#include <xtmrctr.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* the order of these is also the order of the tasks in the GET_CPU_LOAD_STATS
+ * response - only append new tasks before PERF_TASK_MAX */
+typedef enum {
+  PERF_TASK_RX = 0,   /* packet read, filter, verify and validate */
+  PERF_TASK_DHCP,
+  PERF_TASK_IGMP,
+  PERF_TASK_CTRL,
+  PERF_TASK_ICMP,
+  PERF_TASK_ARP,
+  PERF_TASK_LLDP,
+  PERF_TASK_QSFP,
+  PERF_TASK_ADC,
+  PERF_TASK_LINK_MON,
+  PERF_TASK_DIAG,
+  PERF_TASK_STREAM,
+  PERF_TASK_POLL,
+  PERF_TASK_WATCH,
+  PERF_TASK_TELEMETRY,
+  PERF_TASK_SESSION,
+  PERF_TASK_MAX       /* keep last */
+} tPerfTask;
+
+/* statistics are accumulated over a window of this many 100ms timer ticks */
+#define PERF_WINDOW_TICKS   10
+
+/*
+ * Longest interval (in ms) which can be timed with perfmon_timestamp(): the
+ * elapsed time checks treat differences of 2^31 cycles or more as a wrap.
+ * DHCP_TIMER_RESET_VALUE (constant_defs.h) cycles make up 100ms.
+ */
+#define PERF_INTERVAL_MAX_MS    ((u32) (0x80000000UL / (DHCP_TIMER_RESET_VALUE / 100)) - 1)
+
+struct sPerfStats {
+  u32 uWindowCycles;                    /* timer cycles spanned by the window */
+  u32 uBusyCycles;                      /* cycles spent inside instrumented tasks */
+  u32 uLoopCount;                       /* main loop iterations in window */
+  u32 uIdleLoopCount;                   /* iterations in which no task ran */
+  u32 uLoopMaxCycles;                   /* worst-case iteration time in window */
+  u32 uTaskCycles[PERF_TASK_MAX];
+  u32 uTaskRuns[PERF_TASK_MAX];
+  u32 uTaskMaxCycles[PERF_TASK_MAX];    /* worst-case single run in window */
+};
+
+void perfmon_init(XTmrCtr *pTimer);
+void perfmon_timer_tick(void);          /* call from the 100ms timer interrupt */
+
+u32 perfmon_timestamp(void);
+u32 perfmon_task_start(void);
+void perfmon_task_end(tPerfTask task, u32 uStart);
+void perfmon_loop_mark(void);           /* call once per main loop iteration */
+
+const struct sPerfStats *perfmon_get_stats(void);   /* last completed window */
+u32 perfmon_get_loop_max_ever_cycles(void);
+void perfmon_reset_max_ever(void);
+
+u32 perfmon_cycles_to_us(u32 uCycles);
+u32 perfmon_us_to_cycles(u32 uUs);
+u16 perfmon_cycles_to_percent_x100(u32 uCycles, u32 uTotalCycles);
+const char *perfmon_task_name(tPerfTask task);
+
+void perfmon_print_top(void);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
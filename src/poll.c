@@ -0,0 +1,234 @@
+/**----------------------------------------------------------------------------
+ *   FILE:       poll.c
+ *   BRIEF:      Firmware-side poll-until-condition of a wishbone register.
+ *
+ *   COMPANY:    SKA SA
+ *
+ *   NOTES:      vim settings: "set sw=2 ts=2 expandtab autoindent"
+ *
+ *   A POLL_WISHBONE request is checked once straight away. If the condition
+ *   is not met yet, the request is parked in a slot and re-checked from the
+ *   main loop at the requested interval - never by waiting in place - and the
+ *   single response is sent to the saved client once the condition is met,
+ *   the timeout expires or a bus error occurs. A repeat of a parked request
+ *   (host retry with the same sequence number) is absorbed by its slot, and
+ *   once the response has been sent a retry is answered from the response cache.
+ *------------------------------------------------------------------------------*/
+
+#include <xil_types.h>
+#include <xstatus.h>
+
+#include "poll.h"
+#include "constant_defs.h"
+#include "custom_constants.h"
+#include "eth_sorter.h"
+#include "if.h"
+#include "register.h"
+#include "error.h"
+#include "logging.h"
+#include "perfmon.h"
+#include "resp_cache.h"
+
+struct sPoll {
+  u8 uActive;
+  u8 uId;
+  struct sResponseClient Client;
+  u16 uSequenceNumber;
+  u32 uRequestLength;               /* keys the response cache entry once done */
+
+  u32 uAddress;
+  u32 uMask;
+  u32 uExpected;
+  u32 uIntervalCycles;
+  u32 uTimeoutCycles;
+
+  u32 uStartTime;
+  u32 uLastPollTime;
+  u32 uIterations;
+};
+
+static struct sPoll PollSlots[POLL_SLOTS_MAX];
+
+static u8 poll_check(struct sPoll *pPoll, sPollWishboneRespT *pResponse);
+static void poll_fill_response(const struct sPoll *pPoll, sPollWishboneRespT *pResponse, u16 uStatus, u8 uMet,
+    u32 uValue, u32 uElapsed);
+
+
+int poll_start(u8 uId, const sPollWishboneReqT *pRequest, u32 uRequestLength, sPollWishboneRespT *pResponse){
+  struct sPoll Poll;
+  struct sPoll *pSlot = NULL;
+  u8 uIndex;
+
+  SaveResponseClient(&Poll.Client);
+
+  /* a retry of a request which is still being polled */
+  for (uIndex = 0; uIndex < POLL_SLOTS_MAX; uIndex++){
+    if (PollSlots[uIndex].uActive &&
+        (PollSlots[uIndex].uSequenceNumber == pRequest->Header.uSequenceNumber) &&
+        (PollSlots[uIndex].Client.uIPAddr == Poll.Client.uIPAddr) &&
+        (PollSlots[uIndex].Client.uUDPPort == Poll.Client.uUDPPort)){
+      return POLL_RETURN_DEFERRED;
+    }
+  }
+
+  Poll.uActive = 1;
+  Poll.uId = uId;
+  Poll.uSequenceNumber = pRequest->Header.uSequenceNumber;
+  Poll.uRequestLength = uRequestLength;
+  Poll.uAddress = (pRequest->uAddressHigh << 16) | pRequest->uAddressLow;
+  Poll.uMask = (pRequest->uMaskHigh << 16) | pRequest->uMaskLow;
+  Poll.uExpected = (pRequest->uExpectedHigh << 16) | pRequest->uExpectedLow;
+  Poll.uIntervalCycles = perfmon_us_to_cycles(pRequest->uIntervalUs);
+  Poll.uStartTime = perfmon_timestamp();
+  Poll.uLastPollTime = Poll.uStartTime;
+  Poll.uIterations = 0;
+
+  if (pRequest->uTimeoutMs > PERF_INTERVAL_MAX_MS){
+    log_printf(LOG_SELECT_CTRL, LOG_LEVEL_ERROR, "POLL [%02x] timeout of %dms exceeds %dms\r\n", uId, pRequest->uTimeoutMs,
+        PERF_INTERVAL_MAX_MS);
+    poll_fill_response(&Poll, pResponse, CMD_STATUS_ERROR_GENERAL, 0, 0, 0);
+    return POLL_RETURN_DONE;
+  }
+  Poll.uTimeoutCycles = perfmon_us_to_cycles((u32) pRequest->uTimeoutMs * 1000);
+
+  if (poll_check(&Poll, pResponse)){
+    return POLL_RETURN_DONE;
+  }
+
+  for (uIndex = 0; uIndex < POLL_SLOTS_MAX; uIndex++){
+    if (0 == PollSlots[uIndex].uActive){
+      pSlot = &PollSlots[uIndex];
+      break;
+    }
+  }
+
+  if (NULL == pSlot){
+    log_printf(LOG_SELECT_CTRL, LOG_LEVEL_WARN, "POLL [%02x] no free poll slot for %08x\r\n", uId, Poll.uAddress);
+    poll_fill_response(&Poll, pResponse, CMD_STATUS_ERROR_GENERAL, 0, 0, 0);
+    return POLL_RETURN_DONE;
+  }
+
+  *pSlot = Poll;
+
+  return POLL_RETURN_DEFERRED;
+}
+
+
+u8 poll_pending(u8 uId){
+  u8 uIndex;
+
+  for (uIndex = 0; uIndex < POLL_SLOTS_MAX; uIndex++){
+    if (PollSlots[uIndex].uActive && (PollSlots[uIndex].uId == uId)){
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+
+void poll_task(u8 uId){
+  const u32 uHeaderLength = sizeof(sEthernetHeaderT) + sizeof(sIPV4HeaderT) + sizeof(sUDPHeaderT);
+  sPollWishboneRespT *Response = (sPollWishboneRespT *) ((u8 *) uTransmitBuffer + uHeaderLength);
+  struct sIFObject *pIF;
+  struct sPoll *pPoll;
+  u32 uElapsed;
+  u8 uIndex;
+
+  pIF = lookup_if_handle_by_id(uId);
+
+  for (uIndex = 0; uIndex < POLL_SLOTS_MAX; uIndex++){
+    pPoll = &PollSlots[uIndex];
+    if ((0 == pPoll->uActive) || (pPoll->uId != uId)){
+      continue;
+    }
+
+    /* nowhere to send the response to */
+    if ((NULL == pIF) || (pIF->uIFLinkStatus != LINK_UP)){
+      pPoll->uActive = 0;
+      continue;
+    }
+
+    uElapsed = perfmon_timestamp() - pPoll->uLastPollTime;
+    if (((uElapsed & 0x80000000) == 0) && (uElapsed < pPoll->uIntervalCycles)){
+      continue;
+    }
+
+    if (0 == poll_check(pPoll, Response)){
+      continue;
+    }
+
+    pPoll->uActive = 0;
+
+    resp_cache_store_client(uId, &pPoll->Client, pPoll->uSequenceNumber, POLL_WISHBONE, pPoll->uRequestLength,
+        (u8 *) Response, sizeof(sPollWishboneRespT));
+
+    if (SendResponseToClient(uId, &pPoll->Client, sizeof(sPollWishboneRespT)) != XST_SUCCESS){
+      log_printf(LOG_SELECT_CTRL, LOG_LEVEL_ERROR, "POLL [%02x] unable to send response\r\n", uId);
+    } else {
+      IFCounterIncr(pIF, TX_UDP_CTRL_OK);
+    }
+  }
+}
+
+
+/* returns 1 and fills in the response once the poll has completed */
+static u8 poll_check(struct sPoll *pPoll, sPollWishboneRespT *pResponse){
+  u32 uValue;
+  u32 uElapsed;
+
+  (void) read_and_clear_error_flag();
+
+  uValue = ReadWishboneRegister(pPoll->uAddress);
+  pPoll->uIterations++;
+  pPoll->uLastPollTime = perfmon_timestamp();
+
+  uElapsed = pPoll->uLastPollTime - pPoll->uStartTime;
+  if (uElapsed & 0x80000000){
+    uElapsed = 0;
+  }
+
+  if (read_and_clear_error_flag() == ERROR_AXI_DATA_BUS){
+    log_printf(LOG_SELECT_CTRL, LOG_LEVEL_ERROR, "POLL [%02x] AXI data bus error polling %08x\r\n", pPoll->uId, pPoll->uAddress);
+    poll_fill_response(pPoll, pResponse, CMD_STATUS_ERROR_BUS, 0, uValue, uElapsed);
+    return 1;
+  }
+
+  if ((uValue & pPoll->uMask) == pPoll->uExpected){
+    poll_fill_response(pPoll, pResponse, CMD_STATUS_SUCCESS, 1, uValue, uElapsed);
+    return 1;
+  }
+
+  if (uElapsed >= pPoll->uTimeoutCycles){
+    poll_fill_response(pPoll, pResponse, CMD_STATUS_ERROR_TIMEOUT, 0, uValue, uElapsed);
+    return 1;
+  }
+
+  return 0;
+}
+
+
+static void poll_fill_response(const struct sPoll *pPoll, sPollWishboneRespT *pResponse, u16 uStatus, u8 uMet,
+    u32 uValue, u32 uElapsed){
+  u32 uElapsedUs;
+  u8 uIndex;
+
+  uElapsedUs = perfmon_cycles_to_us(uElapsed);
+
+  pResponse->Header.uCommandType = POLL_WISHBONE + 1;
+  pResponse->Header.uSequenceNumber = pPoll->uSequenceNumber;
+  pResponse->uAddressHigh = (pPoll->uAddress >> 16) & 0xFFFF;
+  pResponse->uAddressLow = pPoll->uAddress & 0xFFFF;
+  pResponse->uStatus = uStatus;
+  pResponse->uConditionMet = uMet;
+  pResponse->uValueHigh = (uValue >> 16) & 0xFFFF;
+  pResponse->uValueLow = uValue & 0xFFFF;
+  pResponse->uElapsedUsHigh = (uElapsedUs >> 16) & 0xFFFF;
+  pResponse->uElapsedUsLow = uElapsedUs & 0xFFFF;
+  pResponse->uIterationsHigh = (pPoll->uIterations >> 16) & 0xFFFF;
+  pResponse->uIterationsLow = pPoll->uIterations & 0xFFFF;
+
+  for (uIndex = 0; uIndex < 3; uIndex++){
+    pResponse->uPadding[uIndex] = 0;
+  }
+}
@@ -0,0 +1,36 @@
+/**----------------------------------------------------------------------------
+ *   FILE:       poll.h
+ *   BRIEF:      API for the firmware-side poll-until-condition of a wishbone
+ *               register.
+ *
+ *   COMPANY:    SKA SA
+ *
+ *   NOTES:      vim settings: "set sw=2 ts=2 expandtab autoindent"
+ *------------------------------------------------------------------------------*/
+
+#ifndef _POLL_H_
+#define _POLL_H_
+
+#include <xil_types.h>
+
+#include "custom_constants.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define POLL_RETURN_DONE      (0)   /* response filled in, send it now */
+#define POLL_RETURN_DEFERRED  (1)   /* response will be sent by poll_task() */
+
+/* polls which may be outstanding at the same time (across all interfaces) */
+#define POLL_SLOTS_MAX    4
+
+int poll_start(u8 uId, const sPollWishboneReqT *pRequest, u32 uRequestLength, sPollWishboneRespT *pResponse);
+
+u8 poll_pending(u8 uId);
+void poll_task(u8 uId);       /* call from the main loop while poll_pending() */
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,191 @@
+/**----------------------------------------------------------------------------
+ *   FILE:       prof.c
+ *   BRIEF:      Statistical pc-sampling profiler.
+ *
+ *   COMPANY:    SKA SA
+ *
+ *   NOTES:      vim settings: "set sw=2 ts=2 expandtab autoindent"
+ *
+ *   When built with PROFILER defined, the aux timer channel (AUX_RETRY_TIMER_ID)
+ *   is reloaded at PROF_SAMPLE_RATE_HZ and every expiry records the address
+ *   the timer interrupt returns to - i.e. the interrupted program counter - in
+ *   a histogram held in BRAM. The histogram is fetched over the network with
+ *   the PROFILER_CONTROL opcode and mapped onto the elf symbol table on the
+ *   host by utils/profile/prof_symbols.py.
+ *
+ *   Without PROFILER only stubs are compiled in so that the callers need not
+ *   be wrapped in preprocessor conditionals.
+ *------------------------------------------------------------------------------*/
+
+#include <xil_types.h>
+#include <xtmrctr.h>
+
+#include "prof.h"
+#include "constant_defs.h"
+
+#ifdef PROFILER
+
+struct sProf {
+  XTmrCtr *pTimer;
+  volatile u8 uRunning;
+  volatile u32 uTotalSamples;
+  volatile u32 uOutOfRange;
+  volatile u16 uBucket[PROF_NUM_BUCKETS];
+};
+
+static struct sProf Prof;
+
+
+void prof_init(XTmrCtr *pTimer){
+  Prof.pTimer = pTimer;
+  Prof.uRunning = 0;
+  prof_clear();
+}
+
+
+int prof_start(void){
+  if (NULL == Prof.pTimer){
+    return PROF_RETURN_FAIL;
+  }
+
+  XTmrCtr_Stop(Prof.pTimer, AUX_RETRY_TIMER_ID);
+  prof_clear();
+
+  XTmrCtr_SetOptions(Prof.pTimer, AUX_RETRY_TIMER_ID, XTC_INT_MODE_OPTION | XTC_AUTO_RELOAD_OPTION | XTC_DOWN_COUNT_OPTION);
+  XTmrCtr_SetResetValue(Prof.pTimer, AUX_RETRY_TIMER_ID, PROF_TIMER_RESET_VALUE);
+
+  Prof.uRunning = 1;
+  XTmrCtr_Start(Prof.pTimer, AUX_RETRY_TIMER_ID);
+
+  return PROF_RETURN_OK;
+}
+
+
+int prof_stop(void){
+  if (NULL == Prof.pTimer){
+    return PROF_RETURN_FAIL;
+  }
+
+  XTmrCtr_Stop(Prof.pTimer, AUX_RETRY_TIMER_ID);
+  Prof.uRunning = 0;
+
+  /* leave the channel as main() configured it for the aux task */
+  XTmrCtr_SetResetValue(Prof.pTimer, AUX_RETRY_TIMER_ID, AUX_TIMER_RESET_VALUE);
+
+  return PROF_RETURN_OK;
+}
+
+
+void prof_clear(void){
+  u16 uIndex;
+
+  for (uIndex = 0; uIndex < PROF_NUM_BUCKETS; uIndex++){
+    Prof.uBucket[uIndex] = 0;
+  }
+
+  Prof.uTotalSamples = 0;
+  Prof.uOutOfRange = 0;
+}
+
+
+u8 prof_is_running(void){
+  return Prof.uRunning;
+}
+
+
+u8 prof_is_supported(void){
+  return 1;
+}
+
+
+void prof_sample_isr(void){
+  u32 uPC;
+
+  /*
+   * r14 holds the interrupt return address. The interrupt handler and the
+   * timer driver callbacks do not touch it, so it still points at the
+   * instruction which was interrupted.
+   */
+  __asm__ __volatile__ ("or %0, r0, r14" : "=r" (uPC));
+
+  Prof.uTotalSamples++;
+
+  if (uPC >= PROF_ADDR_SPAN){
+    Prof.uOutOfRange++;
+    return;
+  }
+
+  /* saturate rather than wrap */
+  if (Prof.uBucket[uPC >> PROF_BUCKET_SHIFT] != 0xffff){
+    Prof.uBucket[uPC >> PROF_BUCKET_SHIFT]++;
+  }
+}
+
+
+u32 prof_get_total_samples(void){
+  return Prof.uTotalSamples;
+}
+
+
+u32 prof_get_out_of_range_samples(void){
+  return Prof.uOutOfRange;
+}
+
+
+u16 prof_get_bucket(u16 uIndex){
+  if (uIndex >= PROF_NUM_BUCKETS){
+    return 0;
+  }
+
+  return Prof.uBucket[uIndex];
+}
+
+#else /* PROFILER */
+
+void prof_init(XTmrCtr *pTimer){
+}
+
+
+int prof_start(void){
+  return PROF_RETURN_FAIL;
+}
+
+
+int prof_stop(void){
+  return PROF_RETURN_FAIL;
+}
+
+
+void prof_clear(void){
+}
+
+
+u8 prof_is_running(void){
+  return 0;
+}
+
+
+u8 prof_is_supported(void){
+  return 0;
+}
+
+
+void prof_sample_isr(void){
+}
+
+
+u32 prof_get_total_samples(void){
+  return 0;
+}
+
+
+u32 prof_get_out_of_range_samples(void){
+  return 0;
+}
+
+
+u16 prof_get_bucket(u16 uIndex){
+  return 0;
+}
+
+#endif /* PROFILER */
@@ -0,0 +1,57 @@
+/**----------------------------------------------------------------------------
+ *   FILE:       prof.h
+ *   BRIEF:      API for the statistical pc-sampling profiler.
+ *
+ *   COMPANY:    SKA SA
+ *
+ *   NOTES:      vim settings: "set sw=2 ts=2 expandtab autoindent"
+ *------------------------------------------------------------------------------*/
+
+#ifndef _PROF_H_
+#define _PROF_H_
+
+#include <xil_types.h>
+#include <xtmrctr.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PROF_RETURN_OK    (0)
+#define PROF_RETURN_FAIL  (1)
+
+/*
+ * The histogram covers the whole local memory from address zero. Each bucket
+ * counts the samples which landed in a (1 << PROF_BUCKET_SHIFT) byte slice of
+ * the address space, i.e. 16 instructions per bucket.
+ */
+#define PROF_ADDR_SPAN      0x40000     /* 256K BRAM - see lscript.ld */
+#define PROF_BUCKET_SHIFT   6
+#define PROF_NUM_BUCKETS    (PROF_ADDR_SPAN >> PROF_BUCKET_SHIFT)
+
+/*
+ * The sampling period is not an integer fraction of the 100ms task tick so
+ * that the samples do not phase lock onto the periodic tasks.
+ */
+#define PROF_TIMER_DIVISOR      97
+#define PROF_TIMER_RESET_VALUE  (DHCP_TIMER_RESET_VALUE / PROF_TIMER_DIVISOR)
+#define PROF_SAMPLE_RATE_HZ     (10 * PROF_TIMER_DIVISOR)
+
+void prof_init(XTmrCtr *pTimer);
+
+int prof_start(void);   /* clears the histogram and starts sampling */
+int prof_stop(void);
+void prof_clear(void);
+u8 prof_is_running(void);
+u8 prof_is_supported(void);
+
+void prof_sample_isr(void);   /* call from the aux timer interrupt only */
+
+u32 prof_get_total_samples(void);
+u32 prof_get_out_of_range_samples(void);
+u16 prof_get_bucket(u16 uIndex);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
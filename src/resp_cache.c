@@ -0,0 +1,152 @@
+/**----------------------------------------------------------------------------
+ *   FILE:       resp_cache.c
+ *   BRIEF:      Control response cache which answers retransmitted requests
+ *               without executing them again.
+ *
+ *   COMPANY:    SKA SA
+ *
+ *   NOTES:      vim settings: "set sw=2 ts=2 expandtab autoindent"
+ *
+ *   When a response is lost the host sends the request again with the same
+ *   sequence number. Executing it again costs the full time of slow operations
+ *   (i2c, pmbus, flash erase / program) and repeats ones which are not
+ *   idempotent. The last few responses are therefore kept, keyed on the
+ *   interface, client ip and port, sequence number, opcode and request length,
+ *   and a matching request is answered with the kept response instead. The bulk
+ *   reads are executed again rather than kept, as they only read.
+ *   A deferred response (zero length at first) is kept once its module sends
+ *   it (see session.c and poll.c), keyed on the client saved with the request.
+ *   Until then a retry is matched by the module itself.
+ *------------------------------------------------------------------------------*/
+
+#include <xil_types.h>
+
+#include "resp_cache.h"
+#include "constant_defs.h"
+#include "custom_constants.h"
+#include "perfmon.h"
+
+struct sRespCacheEntry {
+  u8 uValid;
+  u8 uId;
+  u32 uIPAddr;
+  u32 uUDPPort;
+  u16 uSequenceNumber;
+  u16 uCommandType;
+  u32 uCommandLength;
+  u32 uStoreTime;
+
+  u32 uResponseLength;
+  u8 uResponse[RESP_CACHE_PAYLOAD_MAX];
+};
+
+static struct sRespCacheEntry RespCache[RESP_CACHE_ENTRIES];
+static u8 uRespCacheNext = 0;   /* entry to replace next */
+
+static void resp_cache_insert(u8 uId, u32 uIPAddr, u32 uUDPPort, u16 uSequenceNumber, u16 uCommandType,
+    u32 uCommandLength, const u8 *pResponse, u32 uResponseLength);
+
+
+/* reads without side effects whose responses are too large to keep */
+static u8 resp_cache_is_bulk_read(u16 uCommandType){
+  switch (uCommandType){
+    case READ_FLASH_WORDS:
+    case READ_SPI_PAGE:
+    case BIG_READ_WISHBONE:
+    case BIG_READ_WISHBONE_JUMBO:
+    case SCATTER_READ_WISHBONE:
+    case STREAM_READ_WISHBONE:
+      return 1;
+
+    default:
+      return 0;
+  }
+}
+
+
+u8 resp_cache_lookup(u8 uId, const u8 *pCommand, u32 uCommandLength, u8 *pResponse, u32 *pResponseLength){
+  const sCommandHeaderT *Command = (const sCommandHeaderT *) pCommand;
+  struct sRespCacheEntry *pEntry;
+  u32 uElapsed;
+  u32 uIndex;
+  u8 uEntry;
+
+  if (uCommandLength < sizeof(sCommandHeaderT)){
+    return RESP_CACHE_RETURN_MISS;
+  }
+
+  for (uEntry = 0; uEntry < RESP_CACHE_ENTRIES; uEntry++){
+    pEntry = &RespCache[uEntry];
+    if ((0 == pEntry->uValid) ||
+        (pEntry->uSequenceNumber != Command->uSequenceNumber) ||
+        (pEntry->uCommandType != Command->uCommandType) ||
+        (pEntry->uCommandLength != uCommandLength) ||
+        (pEntry->uIPAddr != uResponseIPAddr) ||
+        (pEntry->uUDPPort != uResponseUDPPort) ||
+        (pEntry->uId != uId)){
+      continue;
+    }
+
+    uElapsed = perfmon_timestamp() - pEntry->uStoreTime;
+    if ((uElapsed & 0x80000000) || (uElapsed >= perfmon_us_to_cycles((u32) RESP_CACHE_LIFETIME_MS * 1000))){
+      pEntry->uValid = 0;
+      return RESP_CACHE_RETURN_MISS;
+    }
+
+    for (uIndex = 0; uIndex < pEntry->uResponseLength; uIndex++){
+      pResponse[uIndex] = pEntry->uResponse[uIndex];
+    }
+    *pResponseLength = pEntry->uResponseLength;
+
+    return RESP_CACHE_RETURN_HIT;
+  }
+
+  return RESP_CACHE_RETURN_MISS;
+}
+
+
+void resp_cache_store(u8 uId, const u8 *pCommand, u32 uCommandLength, const u8 *pResponse, u32 uResponseLength){
+  const sCommandHeaderT *Command = (const sCommandHeaderT *) pCommand;
+
+  if (uCommandLength < sizeof(sCommandHeaderT)){
+    return;
+  }
+
+  resp_cache_insert(uId, uResponseIPAddr, uResponseUDPPort, Command->uSequenceNumber, Command->uCommandType,
+      uCommandLength, pResponse, uResponseLength);
+}
+
+
+void resp_cache_store_client(u8 uId, const struct sResponseClient *pClient, u16 uSequenceNumber, u16 uCommandType,
+    u32 uCommandLength, const u8 *pResponse, u32 uResponseLength){
+  resp_cache_insert(uId, pClient->uIPAddr, pClient->uUDPPort, uSequenceNumber, uCommandType, uCommandLength,
+      pResponse, uResponseLength);
+}
+
+
+static void resp_cache_insert(u8 uId, u32 uIPAddr, u32 uUDPPort, u16 uSequenceNumber, u16 uCommandType,
+    u32 uCommandLength, const u8 *pResponse, u32 uResponseLength){
+  struct sRespCacheEntry *pEntry;
+  u32 uIndex;
+
+  if ((0 == uResponseLength) || (uResponseLength > RESP_CACHE_PAYLOAD_MAX) || resp_cache_is_bulk_read(uCommandType)){
+    return;
+  }
+
+  pEntry = &RespCache[uRespCacheNext];
+  uRespCacheNext = (uRespCacheNext + 1) % RESP_CACHE_ENTRIES;
+
+  pEntry->uValid = 1;
+  pEntry->uId = uId;
+  pEntry->uIPAddr = uIPAddr;
+  pEntry->uUDPPort = uUDPPort;
+  pEntry->uSequenceNumber = uSequenceNumber;
+  pEntry->uCommandType = uCommandType;
+  pEntry->uCommandLength = uCommandLength;
+  pEntry->uStoreTime = perfmon_timestamp();
+
+  for (uIndex = 0; uIndex < uResponseLength; uIndex++){
+    pEntry->uResponse[uIndex] = pResponse[uIndex];
+  }
+  pEntry->uResponseLength = uResponseLength;
+}
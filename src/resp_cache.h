@@ -0,0 +1,47 @@
+/**----------------------------------------------------------------------------
+ *   FILE:       resp_cache.h
+ *   BRIEF:      API for the control response cache which answers retransmitted
+ *               requests without executing them again.
+ *
+ *   COMPANY:    SKA SA
+ *
+ *   NOTES:      vim settings: "set sw=2 ts=2 expandtab autoindent"
+ *------------------------------------------------------------------------------*/
+
+#ifndef _RESP_CACHE_H_
+#define _RESP_CACHE_H_
+
+#include <xil_types.h>
+
+#include "custom_constants.h"
+#include "eth_sorter.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RESP_CACHE_RETURN_MISS  (0)
+#define RESP_CACHE_RETURN_HIT   (1)
+
+/* responses kept - the oldest one is replaced. Each entry holds the largest
+   response cached, so keep the count down (about 8kB of bram) */
+#define RESP_CACHE_ENTRIES        4
+
+/* the bulk read responses are not cached (reading again has no side effects),
+   every other response fits - the largest is a full scatter write */
+#define RESP_CACHE_PAYLOAD_MAX    sizeof(sScatterWriteWishboneRespT)
+
+/* a request is only treated as a retransmission within this time of the
+   original response - hosts which reuse sequence numbers get fresh answers */
+#define RESP_CACHE_LIFETIME_MS    2000
+
+u8 resp_cache_lookup(u8 uId, const u8 *pCommand, u32 uCommandLength, u8 *pResponse, u32 *pResponseLength);
+void resp_cache_store(u8 uId, const u8 *pCommand, u32 uCommandLength, const u8 *pResponse, u32 uResponseLength);
+/* deferred responses - keyed on the client and request saved when it was handled */
+void resp_cache_store_client(u8 uId, const struct sResponseClient *pClient, u16 uSequenceNumber, u16 uCommandType,
+    u32 uCommandLength, const u8 *pResponse, u32 uResponseLength);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -40,7 +40,6 @@ int GetSensorDataHandler(u8 * pCommand, u32 uCommandLength, u8 * uResponsePacket
 
   sGetSensorDataReqT *Command = (sGetSensorDataReqT *) pCommand;
   sGetSensorDataRespT *Response = (sGetSensorDataRespT *) uResponsePacketPtr;
-  u8 i;
 
   if (uCommandLength < sizeof(sGetSensorDataReqT)){
     return XST_FAILURE;
@@ -50,6 +49,37 @@ int GetSensorDataHandler(u8 * pCommand, u32 uCommandLength, u8 * uResponsePacket
   Response->Header.uCommandType = Command->Header.uCommandType + 1;
   Response->Header.uSequenceNumber = Command->Header.uSequenceNumber;
 
+  GetAllSensorData(Response);
+
+#if 0   /* Now used for status bits */
+  // add padding to 64-bit boundary
+  for (uPaddingIndex = 0; uPaddingIndex < 2; uPaddingIndex++)
+    Response->uPadding[uPaddingIndex] = 0;
+#endif
+
+  *uResponseLength = sizeof(sGetSensorDataRespT);
+
+  return XST_SUCCESS;
+}
+
+//=================================================================================
+//  GetAllSensorData
+//--------------------------------------------------------------------------------
+//  This method polls all the various sensors on the SKARAB motherboard and fills
+//  in the sensor data and status bits of a GET_SENSOR_DATA response.
+//
+//  Parameter Dir   Description
+//  --------- ---   -----------
+//  Response        OUT Sensor data and status bits
+//
+//  Return
+//  ------
+//  None
+//=================================================================================
+void GetAllSensorData(sGetSensorDataRespT *Response){
+
+  u8 i;
+
   /* clear all status bits - will be set upon error */
   for (i = 0; i < 2; i++){
     Response->uStatusBits[i] = 0;
@@ -64,16 +94,6 @@ int GetSensorDataHandler(u8 * pCommand, u32 uCommandLength, u8 * uResponsePacket
 	GetAllCurrents(Response); // psu currents
 	GetAllMezzanineTempSensors(Response); // mezzanine temperatures
   GetAllHMCDieTemperatures(Response); // HMC Die Temperatures
-
-#if 0   /* Now used for status bits */
-  // add padding to 64-bit boundary
-  for (uPaddingIndex = 0; uPaddingIndex < 2; uPaddingIndex++)
-    Response->uPadding[uPaddingIndex] = 0;
-#endif
-
-  *uResponseLength = sizeof(sGetSensorDataRespT);
-
-  return XST_SUCCESS;
 }
 
 //=================================================================================
@@ -39,6 +39,7 @@ void SetFanSpeed(unsigned FanPage, float PWMPercentage, bool OpenSwitch);
 int ReadMezzanineTemperature(u16 * ReadBytes, unsigned MezzaninePage, bool OpenSwitch);
 void GetAllMezzanineTempSensors(sGetSensorDataRespT *Response);
 void GetAllHMCDieTemperatures(sGetSensorDataRespT *Response);
+void GetAllSensorData(sGetSensorDataRespT *Response);
 
 
 // auxiliary functions
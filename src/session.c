@@ -0,0 +1,243 @@
+/**----------------------------------------------------------------------------
+ *   FILE:       session.c
+ *   BRIEF:      Per-client control sessions.
+ *
+ *   COMPANY:    SKA SA
+ *
+ *   NOTES:      vim settings: "set sw=2 ts=2 expandtab autoindent"
+ *
+ *   Every control request is handled in the session of its client, keyed on
+ *   interface, ip address and udp port. The session carries the response
+ *   addressing and the state of operations which span several requests, so
+ *   one client's multi-packet operation is neither disturbed by nor blocks
+ *   another client's requests:
+ *     - sdram programming is owned by the session which sent chunk 0, chunks
+ *       from any other client are refused until it completes or goes idle
+ *     - a flash block erase (up to seconds) runs in the background, polled
+ *       from the main loop, and its response is sent to the session's client
+ *       once done - requests from other clients are handled in the meantime,
+ *       only other flash accesses are refused while it is in progress
+ *   When the table is full the least recently active idle session is reused.
+ *------------------------------------------------------------------------------*/
+
+#include <xil_types.h>
+#include <xstatus.h>
+
+#include "session.h"
+#include "constant_defs.h"
+#include "eth_sorter.h"
+#include "flash_sdram_controller.h"
+#include "if.h"
+#include "time.h"
+#include "logging.h"
+#include "perfmon.h"
+#include "resp_cache.h"
+
+/* the blocking erase allows FLASH_ERASE_TIMEOUT polls 100us apart */
+#define SESSION_ERASE_TIMEOUT_US  (FLASH_ERASE_TIMEOUT * 100)
+
+static struct sCtrlSession Sessions[SESSIONS_MAX];
+static struct sCtrlSession *pCurrentSession = NULL;   /* session of the request being handled */
+
+static struct sCtrlSession *pSdramOwner = NULL;
+static struct sCtrlSession *pEraseSession = NULL;
+
+static u8 session_idle(const struct sCtrlSession *pSession, u32 uNow);
+
+
+struct sCtrlSession *session_open(u8 uId){
+  struct sCtrlSession *pSession = NULL;
+  struct sCtrlSession *pFree = NULL;
+  struct sCtrlSession *pOldest = NULL;
+  u32 uNow;
+  u8 uIndex;
+
+  uNow = get_microblaze_uptime_seconds();
+
+  for (uIndex = 0; uIndex < SESSIONS_MAX; uIndex++){
+    if (0 == Sessions[uIndex].uValid){
+      if (NULL == pFree){
+        pFree = &Sessions[uIndex];
+      }
+      continue;
+    }
+
+    if ((Sessions[uIndex].uId == uId) &&
+        (Sessions[uIndex].Client.uIPAddr == uResponseIPAddr) &&
+        (Sessions[uIndex].Client.uUDPPort == uResponseUDPPort)){
+      pSession = &Sessions[uIndex];
+      break;
+    }
+
+    /* sessions holding a resource are never reused */
+    if ((&Sessions[uIndex] == pSdramOwner) || (&Sessions[uIndex] == pEraseSession)){
+      continue;
+    }
+
+    if ((NULL == pOldest) || (Sessions[uIndex].uLastActive < pOldest->uLastActive)){
+      pOldest = &Sessions[uIndex];
+    }
+  }
+
+  if (NULL == pSession){
+    pSession = (NULL != pFree) ? pFree : pOldest;
+    if (NULL == pSession){
+      log_printf(LOG_SELECT_CTRL, LOG_LEVEL_WARN, "SESS [%02x] no free session for %08x:%d\r\n", uId,
+          uResponseIPAddr, uResponseUDPPort);
+      pCurrentSession = NULL;
+      return NULL;
+    }
+
+    pSession->uValid = 1;
+    pSession->uId = uId;
+    pSession->uAsyncSdramReadSeq = 0;
+    pSession->uAsyncSdramReadData = 0;
+    pSession->uSdramChunkId = 0;
+    pSession->uSdramChunkSizeBytes = 0;
+    pSession->uEraseActive = 0;
+
+    log_printf(LOG_SELECT_CTRL, LOG_LEVEL_DEBUG, "SESS [%02x] new session for %08x:%d\r\n", uId,
+        uResponseIPAddr, uResponseUDPPort);
+  }
+
+  /* the client's mac address may have changed since */
+  SaveResponseClient(&pSession->Client);
+  pSession->uLastActive = uNow;
+
+  pCurrentSession = pSession;
+
+  return pSession;
+}
+
+
+struct sCtrlSession *session_current(void){
+  return pCurrentSession;
+}
+
+
+u8 session_sdram_claim(struct sCtrlSession *pSession){
+  if (NULL == pSession){
+    return SESSION_RETURN_BUSY;
+  }
+
+  if ((NULL != pSdramOwner) && (pSdramOwner != pSession) &&
+      (0 == session_idle(pSdramOwner, get_microblaze_uptime_seconds()))){
+    return SESSION_RETURN_BUSY;
+  }
+
+  if ((NULL != pSdramOwner) && (pSdramOwner != pSession)){
+    log_printf(LOG_SELECT_CTRL, LOG_LEVEL_WARN, "SESS [%02x] taking over sdram programming from idle client %08x:%d\r\n",
+        pSession->uId, pSdramOwner->Client.uIPAddr, pSdramOwner->Client.uUDPPort);
+  }
+
+  pSdramOwner = pSession;
+
+  return SESSION_RETURN_OK;
+}
+
+
+void session_sdram_release(struct sCtrlSession *pSession){
+  if (pSdramOwner == pSession){
+    pSdramOwner = NULL;
+  }
+}
+
+
+u8 session_sdram_owner(const struct sCtrlSession *pSession){
+  return ((NULL != pSession) && (pSdramOwner == pSession)) ? 1 : 0;
+}
+
+
+u8 session_flash_erase(struct sCtrlSession *pSession, u16 uSequenceNumber, u32 uCommandLength, u32 uBlockAddress){
+  if (NULL != pEraseSession){
+    /* a retry of the erase in progress */
+    if ((pEraseSession == pSession) && (pSession->uEraseSeq == uSequenceNumber) &&
+        (pSession->uEraseBlockAddress == uBlockAddress)){
+      return SESSION_RETURN_DEFERRED;
+    }
+    return SESSION_RETURN_BUSY;
+  }
+
+  StartEraseBlock(uBlockAddress);
+
+  pSession->uEraseActive = 1;
+  pSession->uEraseSeq = uSequenceNumber;
+  pSession->uEraseCommandLength = uCommandLength;
+  pSession->uEraseBlockAddress = uBlockAddress;
+  pSession->uEraseStartTime = perfmon_timestamp();
+  pEraseSession = pSession;
+
+  return SESSION_RETURN_DEFERRED;
+}
+
+
+u8 session_flash_busy(void){
+  return (NULL != pEraseSession) ? 1 : 0;
+}
+
+
+u8 session_pending(u8 uId){
+  return ((NULL != pEraseSession) && (pEraseSession->uId == uId)) ? 1 : 0;
+}
+
+
+void session_task(u8 uId){
+  const u32 uHeaderLength = sizeof(sEthernetHeaderT) + sizeof(sIPV4HeaderT) + sizeof(sUDPHeaderT);
+  sEraseFlashBlockRespT *Response = (sEraseFlashBlockRespT *) ((u8 *) uTransmitBuffer + uHeaderLength);
+  struct sCtrlSession *pSession;
+  struct sIFObject *pIF;
+  u32 uElapsed;
+  int iStatus;
+  u8 uIndex;
+
+  if (0 == session_pending(uId)){
+    return;
+  }
+
+  pSession = pEraseSession;
+
+  iStatus = CheckEraseBlock(pSession->uEraseBlockAddress);
+  if (iStatus == XST_DEVICE_BUSY){
+    uElapsed = perfmon_timestamp() - pSession->uEraseStartTime;
+    if (((uElapsed & 0x80000000) == 0) && (uElapsed < perfmon_us_to_cycles(SESSION_ERASE_TIMEOUT_US))){
+      return;
+    }
+    log_printf(LOG_SELECT_CTRL, LOG_LEVEL_ERROR, "SESS [%02x] erase timeout at %08x\r\n", uId, pSession->uEraseBlockAddress);
+    iStatus = XST_FAILURE;
+  }
+
+  pSession->uEraseActive = 0;
+  pEraseSession = NULL;
+
+  Response->Header.uCommandType = ERASE_FLASH_BLOCK + 1;
+  Response->Header.uSequenceNumber = pSession->uEraseSeq;
+  Response->uBlockAddressHigh = (pSession->uEraseBlockAddress >> 16) & 0xFFFF;
+  Response->uBlockAddressLow = pSession->uEraseBlockAddress & 0xFFFF;
+  Response->uEraseSuccess = (iStatus == XST_SUCCESS) ? 1 : 0;
+
+  for (uIndex = 0; uIndex < 6; uIndex++){
+    Response->uPadding[uIndex] = 0;
+  }
+
+  /* the erase is done - a retry must get this response rather than start another one */
+  resp_cache_store_client(uId, &pSession->Client, pSession->uEraseSeq, ERASE_FLASH_BLOCK, pSession->uEraseCommandLength,
+      (u8 *) Response, sizeof(sEraseFlashBlockRespT));
+
+  /* nowhere to send the response to - the host will find out from its retry */
+  pIF = lookup_if_handle_by_id(uId);
+  if ((NULL == pIF) || (pIF->uIFLinkStatus != LINK_UP)){
+    return;
+  }
+
+  if (SendResponseToClient(uId, &pSession->Client, sizeof(sEraseFlashBlockRespT)) != XST_SUCCESS){
+    log_printf(LOG_SELECT_CTRL, LOG_LEVEL_ERROR, "SESS [%02x] unable to send erase response\r\n", uId);
+  } else {
+    IFCounterIncr(pIF, TX_UDP_CTRL_OK);
+  }
+}
+
+
+/* a session which has not sent a request for SESSION_IDLE_TIMEOUT_S */
+static u8 session_idle(const struct sCtrlSession *pSession, u32 uNow){
+  return ((uNow - pSession->uLastActive) >= SESSION_IDLE_TIMEOUT_S) ? 1 : 0;
+}
@@ -0,0 +1,77 @@
+/**----------------------------------------------------------------------------
+ *   FILE:       session.h
+ *   BRIEF:      API for the per-client control sessions.
+ *
+ *   COMPANY:    SKA SA
+ *
+ *   NOTES:      vim settings: "set sw=2 ts=2 expandtab autoindent"
+ *------------------------------------------------------------------------------*/
+
+#ifndef _SESSION_H_
+#define _SESSION_H_
+
+#include <xil_types.h>
+
+#include "eth_sorter.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SESSION_RETURN_OK         (0)
+#define SESSION_RETURN_DEFERRED   (1)   /* response will be sent by session_task() */
+#define SESSION_RETURN_BUSY       (2)   /* resource in use by another session */
+
+/* clients which can hold control state at the same time (across all interfaces) */
+#define SESSIONS_MAX    8
+
+/* a session holding a resource (e.g. sdram programming) loses it after this
+   long without a request - lets another client take over from one which died */
+#define SESSION_IDLE_TIMEOUT_S    10
+
+/*
+ * Control state of one client (interface, ip address and udp port). The
+ * uResponse* globals are only the addressing of the request being handled -
+ * anything which spans requests lives here instead, so that clients on the
+ * 1GbE and 40GbE links can interleave their requests without disturbing one
+ * another.
+ */
+struct sCtrlSession {
+  u8 uValid;
+  u8 uId;                           /* interface the client is on */
+  struct sResponseClient Client;
+  u32 uLastActive;                  /* uptime in seconds of the last request */
+
+  /* SDRAM_RECONFIGURE asynchronous sdram read - repeated for a retransmission */
+  u16 uAsyncSdramReadSeq;
+  u32 uAsyncSdramReadData;
+
+  /* SDRAM_PROGRAM_OVER_WISHBONE progress - only while this session owns the sdram */
+  u32 uSdramChunkId;                /* the last chunk that has been successfully programmed */
+  u32 uSdramChunkSizeBytes;         /* chunk length, obtained from chunk 0 */
+
+  /* ERASE_FLASH_BLOCK completes in the background */
+  u8 uEraseActive;
+  u16 uEraseSeq;
+  u32 uEraseCommandLength;          /* keys the response cache entry of the completed erase */
+  u32 uEraseBlockAddress;
+  u32 uEraseStartTime;
+};
+
+struct sCtrlSession *session_open(u8 uId);
+struct sCtrlSession *session_current(void);
+
+u8 session_sdram_claim(struct sCtrlSession *pSession);
+void session_sdram_release(struct sCtrlSession *pSession);
+u8 session_sdram_owner(const struct sCtrlSession *pSession);
+
+u8 session_flash_erase(struct sCtrlSession *pSession, u16 uSequenceNumber, u32 uCommandLength, u32 uBlockAddress);
+u8 session_flash_busy(void);
+
+u8 session_pending(u8 uId);
+void session_task(u8 uId);    /* call from the main loop while session_pending() */
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,310 @@
+/**----------------------------------------------------------------------------
+ *   FILE:       stream.c
+ *   BRIEF:      Streamed (multi-frame) wishbone region read.
+ *
+ *   COMPANY:    SKA SA
+ *
+ *   NOTES:      vim settings: "set sw=2 ts=2 expandtab autoindent"
+ *
+ *   A single STREAM_READ_WISHBONE start request causes a region of up to
+ *   65535 frames to be read and sent back as numbered data frames. The frames
+ *   are sent from the main loop, a few per pass, whenever the mac's host
+ *   transmit buffer has drained (and, optionally, a minimum inter-frame gap
+ *   has elapsed) so the stream never busy-waits in TransmitHostPacket and the
+ *   other tasks keep running. Lost frames are requested again by the host with
+ *   their sequence numbers and are re-read from the bus when resent.
+ *
+ *   Only one stream exists at a time - a new start request replaces it.
+ *------------------------------------------------------------------------------*/
+
+#include <xil_types.h>
+#include <xstatus.h>
+
+#include "stream.h"
+#include "constant_defs.h"
+#include "custom_constants.h"
+#include "eth_mac.h"
+#include "eth_sorter.h"
+#include "if.h"
+#include "register.h"
+#include "error.h"
+#include "logging.h"
+#include "perfmon.h"
+
+struct sStream {
+  u8 uValid;                    /* parameters below describe a stream which can be (re)sent */
+  u8 uActive;                   /* frames still to be sent */
+  u8 uId;
+
+  struct sResponseClient Client;   /* captured from the start request */
+  u16 uRequestSeq;
+
+  u16 uStreamId;
+  u32 uStartAddr;
+  u32 uLength;                  /* 32-bit words */
+  u32 uStride;                  /* bytes */
+  u16 uWordsPerFrame;
+  u16 uTotalFrames;
+  u16 uNextFrame;
+
+  u32 uGapCycles;
+  u32 uLastTxTime;
+
+  u16 arrRetx[STREAM_RETX_QUEUE_MAX];
+  u16 uRetxHead;
+  u16 uRetxCount;
+
+  u16 uFramesRetransmitted;
+};
+
+static struct sStream Stream;
+
+static u8 stream_retx_queued(u16 uSeq);
+static int stream_send_frame(u16 uSeq);
+
+
+int stream_start(u8 uId, u16 uStreamId, u16 uRequestSeq, u32 uStartAddr, u32 uLength, u16 uStride,
+    u16 uWordsPerFrame, u16 uFrameGapUs){
+  u32 uTotalFrames;
+
+  if (uId >= NUM_ETHERNET_INTERFACES){
+    return STREAM_RETURN_FAIL;
+  }
+
+  if ((0 == uLength) || (0 == uWordsPerFrame) || (uWordsPerFrame > STREAM_WORDS_PER_FRAME_MAX) || (uStride & 0x3)){
+    return STREAM_RETURN_FAIL;
+  }
+
+  uTotalFrames = (uLength + uWordsPerFrame - 1) / uWordsPerFrame;
+  if (uTotalFrames > 0xFFFF){
+    return STREAM_RETURN_FAIL;
+  }
+
+  if (Stream.uActive){
+    log_printf(LOG_SELECT_CTRL, LOG_LEVEL_WARN, "STRM [%02x] stream %04x replaced by stream %04x\r\n", Stream.uId,
+        Stream.uStreamId, uStreamId);
+  }
+
+  SaveResponseClient(&Stream.Client);
+  Stream.uRequestSeq = uRequestSeq;
+
+  Stream.uId = uId;
+  Stream.uStreamId = uStreamId;
+  Stream.uStartAddr = uStartAddr;
+  Stream.uLength = uLength;
+  Stream.uStride = (0 == uStride) ? 4 : uStride;
+  Stream.uWordsPerFrame = uWordsPerFrame;
+  Stream.uTotalFrames = (u16) uTotalFrames;
+  Stream.uNextFrame = 0;
+
+  Stream.uGapCycles = perfmon_us_to_cycles(uFrameGapUs);
+  Stream.uLastTxTime = perfmon_timestamp() - Stream.uGapCycles;
+
+  Stream.uRetxHead = 0;
+  Stream.uRetxCount = 0;
+  Stream.uFramesRetransmitted = 0;
+
+  Stream.uValid = 1;
+  Stream.uActive = 1;
+
+  log_printf(LOG_SELECT_CTRL, LOG_LEVEL_INFO, "STRM [%02x] stream %04x: %u words from %08x, stride %u, %u frames\r\n",
+      uId, uStreamId, uLength, uStartAddr, Stream.uStride, Stream.uTotalFrames);
+
+  return STREAM_RETURN_OK;
+}
+
+
+int stream_nack(u16 uStreamId, const u16 *pSeq, u16 uCount){
+  u16 uIndex;
+  u16 uSeq;
+
+  if ((0 == Stream.uValid) || (uStreamId != Stream.uStreamId)){
+    return STREAM_RETURN_FAIL;
+  }
+
+  for (uIndex = 0; uIndex < uCount; uIndex++){
+    uSeq = pSeq[uIndex];
+
+    /* frames not yet sent in the first pass will go out anyway */
+    if ((uSeq >= Stream.uTotalFrames) || (uSeq >= Stream.uNextFrame)){
+      continue;
+    }
+
+    if (stream_retx_queued(uSeq)){
+      continue;
+    }
+
+    if (Stream.uRetxCount >= STREAM_RETX_QUEUE_MAX){
+      log_printf(LOG_SELECT_CTRL, LOG_LEVEL_WARN, "STRM [%02x] retransmit queue full\r\n", Stream.uId);
+      break;
+    }
+
+    Stream.arrRetx[(Stream.uRetxHead + Stream.uRetxCount) % STREAM_RETX_QUEUE_MAX] = uSeq;
+    Stream.uRetxCount++;
+  }
+
+  if (Stream.uRetxCount){
+    Stream.uActive = 1;
+  }
+
+  return STREAM_RETURN_OK;
+}
+
+
+int stream_abort(u16 uStreamId){
+  if ((0 == Stream.uValid) || (uStreamId != Stream.uStreamId)){
+    return STREAM_RETURN_FAIL;
+  }
+
+  log_printf(LOG_SELECT_CTRL, LOG_LEVEL_INFO, "STRM [%02x] stream %04x aborted at frame %u of %u\r\n", Stream.uId,
+      uStreamId, Stream.uNextFrame, Stream.uTotalFrames);
+
+  Stream.uValid = 0;
+  Stream.uActive = 0;
+  Stream.uRetxCount = 0;
+
+  return STREAM_RETURN_OK;
+}
+
+
+u8 stream_pending(u8 uId){
+  return (Stream.uActive && (Stream.uId == uId)) ? 1 : 0;
+}
+
+
+void stream_task(u8 uId){
+  struct sIFObject *pIF;
+  u32 uElapsed;
+  u16 uSeq;
+  u8 uRun;
+
+  if (0 == stream_pending(uId)){
+    return;
+  }
+
+  pIF = lookup_if_handle_by_id(uId);
+  if ((NULL == pIF) || (pIF->uIFLinkStatus != LINK_UP)){
+    log_printf(LOG_SELECT_CTRL, LOG_LEVEL_WARN, "STRM [%02x] link down - stream %04x aborted\r\n", uId, Stream.uStreamId);
+    stream_abort(Stream.uStreamId);
+    return;
+  }
+
+  for (uRun = 0; uRun < STREAM_FRAMES_PER_RUN; uRun++){
+    if (Stream.uGapCycles){
+      uElapsed = perfmon_timestamp() - Stream.uLastTxTime;
+      if ((uElapsed & 0x80000000) == 0){
+        if (uElapsed < Stream.uGapCycles){
+          return;
+        }
+      }
+    }
+
+    /* pace to the wire - rather come back on the next pass than wait here */
+    if (GetHostTransmitBufferLevel(uId) != 0){
+      return;
+    }
+
+    /* retransmissions go out ahead of the rest of the first pass */
+    if (Stream.uRetxCount){
+      uSeq = Stream.arrRetx[Stream.uRetxHead];
+      Stream.uRetxHead = (Stream.uRetxHead + 1) % STREAM_RETX_QUEUE_MAX;
+      Stream.uRetxCount--;
+      Stream.uFramesRetransmitted++;
+    } else if (Stream.uNextFrame < Stream.uTotalFrames){
+      uSeq = Stream.uNextFrame++;
+    } else {
+      Stream.uActive = 0;
+      log_printf(LOG_SELECT_CTRL, LOG_LEVEL_INFO, "STRM [%02x] stream %04x sent, %u frames retransmitted\r\n", uId,
+          Stream.uStreamId, Stream.uFramesRetransmitted);
+      return;
+    }
+
+    if (stream_send_frame(uSeq) != XST_SUCCESS){
+      log_printf(LOG_SELECT_CTRL, LOG_LEVEL_ERROR, "STRM [%02x] unable to send frame %u\r\n", uId, uSeq);
+    } else {
+      IFCounterIncr(pIF, TX_UDP_CTRL_OK);
+    }
+
+    Stream.uLastTxTime = perfmon_timestamp();
+  }
+}
+
+
+void stream_get_status(struct sStreamStatus *pStatus){
+  if (NULL == pStatus){
+    return;
+  }
+
+  pStatus->uActive = Stream.uActive;
+  pStatus->uId = Stream.uId;
+  pStatus->uStreamId = Stream.uStreamId;
+  pStatus->uTotalFrames = Stream.uValid ? Stream.uTotalFrames : 0;
+  pStatus->uNextFrame = Stream.uValid ? Stream.uNextFrame : 0;
+  pStatus->uWordsPerFrame = Stream.uValid ? Stream.uWordsPerFrame : 0;
+  pStatus->uRetransmitPending = Stream.uRetxCount;
+  pStatus->uFramesRetransmitted = Stream.uFramesRetransmitted;
+}
+
+
+static u8 stream_retx_queued(u16 uSeq){
+  u16 uIndex;
+
+  for (uIndex = 0; uIndex < Stream.uRetxCount; uIndex++){
+    if (Stream.arrRetx[(Stream.uRetxHead + uIndex) % STREAM_RETX_QUEUE_MAX] == uSeq){
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+
+static int stream_send_frame(u16 uSeq){
+  const u32 uHeaderLength = sizeof(sEthernetHeaderT) + sizeof(sIPV4HeaderT) + sizeof(sUDPHeaderT);
+  sStreamReadWishboneDataRespT *Frame = (sStreamReadWishboneDataRespT *) ((u8 *) uTransmitBuffer + uHeaderLength);
+  u32 uFirstWord;
+  u32 uNumWords;
+  u32 uAddress;
+  u32 uReadData;
+  u32 uLength;
+  u16 uDataIndex = 0;
+  u16 uIndex;
+
+  uFirstWord = (u32) uSeq * Stream.uWordsPerFrame;
+  uNumWords = Stream.uLength - uFirstWord;
+  if (uNumWords > Stream.uWordsPerFrame){
+    uNumWords = Stream.uWordsPerFrame;
+  }
+  uAddress = Stream.uStartAddr + (uFirstWord * Stream.uStride);
+
+  Frame->Header.uCommandType = STREAM_READ_WISHBONE + 1;
+  Frame->Header.uSequenceNumber = Stream.uRequestSeq;
+  Frame->uAction = STREAM_ACTION_DATA;
+  Frame->uStreamId = Stream.uStreamId;
+  Frame->uFrameSeq = uSeq;
+  Frame->uTotalFrames = Stream.uTotalFrames;
+  Frame->uStatus = CMD_STATUS_SUCCESS;
+  Frame->uAddressHigh = (uAddress >> 16) & 0xFFFF;
+  Frame->uAddressLow = uAddress & 0xFFFF;
+  Frame->uNumberOfReads = (u16) uNumWords;
+
+  /* discard any stale error so that only this frame's reads are reported */
+  (void) read_and_clear_error_flag();
+
+  for (uIndex = 0; uIndex < uNumWords; uIndex++){
+    uReadData = ReadWishboneRegister(uAddress);
+    Frame->uReadData[uDataIndex] = (uReadData >> 16) & 0xFFFF;
+    Frame->uReadData[uDataIndex + 1] = uReadData & 0xFFFF;
+    uDataIndex = uDataIndex + 2;
+    uAddress = uAddress + Stream.uStride;
+  }
+
+  if (read_and_clear_error_flag() == ERROR_AXI_DATA_BUS){
+    Frame->uStatus = CMD_STATUS_ERROR_BUS;
+  }
+
+  uLength = sizeof(sStreamReadWishboneDataRespT) - sizeof(Frame->uReadData) + (uDataIndex * 2);
+  uLength = PadResponse((u8 *) Frame, uLength);
+
+  return SendResponseToClient(Stream.uId, &Stream.Client, uLength);
+}
@@ -0,0 +1,52 @@
+/**----------------------------------------------------------------------------
+ *   FILE:       stream.h
+ *   BRIEF:      API for the streamed (multi-frame) wishbone region read.
+ *
+ *   COMPANY:    SKA SA
+ *
+ *   NOTES:      vim settings: "set sw=2 ts=2 expandtab autoindent"
+ *------------------------------------------------------------------------------*/
+
+#ifndef _STREAM_H_
+#define _STREAM_H_
+
+#include <xil_types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define STREAM_RETURN_OK    (0)
+#define STREAM_RETURN_FAIL  (1)
+
+/* frames sent per pass of the main loop, at most - keeps the other tasks running */
+#define STREAM_FRAMES_PER_RUN   4
+
+/* sequence numbers which can be queued for retransmission */
+#define STREAM_RETX_QUEUE_MAX   64
+
+struct sStreamStatus {
+  u8  uActive;              /* frames still to be sent (first pass or retransmissions) */
+  u8  uId;                  /* interface the stream is sent on */
+  u16 uStreamId;
+  u16 uTotalFrames;
+  u16 uNextFrame;           /* next frame of the first pass */
+  u16 uWordsPerFrame;
+  u16 uRetransmitPending;
+  u16 uFramesRetransmitted;
+};
+
+int stream_start(u8 uId, u16 uStreamId, u16 uRequestSeq, u32 uStartAddr, u32 uLength, u16 uStride,
+    u16 uWordsPerFrame, u16 uFrameGapUs);
+int stream_nack(u16 uStreamId, const u16 *pSeq, u16 uCount);
+int stream_abort(u16 uStreamId);
+
+u8 stream_pending(u8 uId);
+void stream_task(u8 uId);     /* call from the main loop while stream_pending() */
+
+void stream_get_status(struct sStreamStatus *pStatus);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
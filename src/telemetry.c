@@ -0,0 +1,248 @@
+/**----------------------------------------------------------------------------
+ *   FILE:       telemetry.c
+ *   BRIEF:      Periodic telemetry push to a unicast or multicast collector.
+ *
+ *   COMPANY:    SKA SA
+ *
+ *   NOTES:      vim settings: "set sw=2 ts=2 expandtab autoindent"
+ *
+ *   One compact report per interval carries what would otherwise take a
+ *   GET_SENSOR_DATA, GET_MICROBLAZE_UPTIME and a GET_IF_COUNTERS per interface
+ *   from every board. See TELEMETRY_CONTROL in constant_defs.h for the layout.
+ *   A report which cannot be sent (link down, destination not resolved yet)
+ *   is skipped and counted as dropped.
+ *------------------------------------------------------------------------------*/
+
+#include <xil_types.h>
+#include <xstatus.h>
+
+#include "telemetry.h"
+#include "constant_defs.h"
+#include "custom_constants.h"
+#include "eth_sorter.h"
+#include "if.h"
+#include "arp.h"
+#include "sensors.h"
+#include "time.h"
+#include "logging.h"
+#include "perfmon.h"
+
+struct sTelemetry {
+  u8 uRunning;
+  u8 uId;                       /* interface the reports are sent on */
+  u8 uDestResolved;             /* destination mac known */
+  struct sResponseClient Dest;
+
+  u16 uIntervalMs;
+  u32 uIntervalCycles;
+  u16 uContentMask;
+
+  u32 uLastReportTime;
+  u16 uReportSeq;
+  u32 uReportsSent;
+  u16 uReportsDropped;
+};
+
+static struct sTelemetry Telemetry;
+
+/* sensor values are gathered with the GET_SENSOR_DATA helpers */
+static sGetSensorDataRespT TelemetrySensors;
+
+static u32 telemetry_build_report(u16 *pReport);
+
+
+void telemetry_control(u8 uId, const sTelemetryControlReqT *pRequest, sTelemetryControlRespT *pResponse){
+  struct sResponseClient Dest;
+  u16 uStatus = CMD_STATUS_SUCCESS;
+  u8 uResolved = 1;
+  u8 uRet;
+
+  switch (pRequest->uAction){
+    case TELEMETRY_ACTION_QUERY:
+      break;
+
+    case TELEMETRY_ACTION_START:
+      if ((pRequest->uIntervalMs < TELEMETRY_INTERVAL_MIN_MS) || (pRequest->uIntervalMs > PERF_INTERVAL_MAX_MS) ||
+          (0 == (pRequest->uContentMask & TELEMETRY_CONTENT_ALL)) ||
+          ((pRequest->uContentMask & TELEMETRY_CONTENT_SENSORS) && (pRequest->uIntervalMs < TELEMETRY_SENSORS_INTERVAL_MIN_MS))){
+        uStatus = CMD_STATUS_ERROR_GENERAL;
+        break;
+      }
+
+      /* the client of the current request, unless another destination is given */
+      SaveResponseClient(&Dest);
+
+      Dest.uIPAddr = (pRequest->uDestIPHigh << 16) | pRequest->uDestIPLow;
+      if ((0 != Dest.uIPAddr) && (Dest.uIPAddr != uResponseIPAddr)){
+        uRet = ResolveResponseClient(uId, &Dest);
+        if ((ARP_RETURN_OK != uRet) && (ARP_RETURN_REQUEST != uRet)){
+          uStatus = CMD_STATUS_ERROR_GENERAL;
+          break;
+        }
+        uResolved = (ARP_RETURN_OK == uRet) ? 1 : 0;
+      } else {
+        Dest.uIPAddr = uResponseIPAddr;
+      }
+
+      if (0 != pRequest->uDestPort){
+        Dest.uUDPPort = pRequest->uDestPort;
+      }
+
+      Telemetry.Dest = Dest;
+      Telemetry.uDestResolved = uResolved;
+      Telemetry.uId = uId;
+      Telemetry.uIntervalMs = pRequest->uIntervalMs;
+      Telemetry.uIntervalCycles = perfmon_us_to_cycles((u32) pRequest->uIntervalMs * 1000);
+      Telemetry.uContentMask = pRequest->uContentMask & TELEMETRY_CONTENT_ALL;
+      Telemetry.uLastReportTime = perfmon_timestamp() - Telemetry.uIntervalCycles;   /* first one straight away */
+      Telemetry.uRunning = 1;
+
+      log_printf(LOG_SELECT_CTRL, LOG_LEVEL_INFO, "TLMT [%02x] reporting every %dms to %08x:%d\r\n", uId,
+          Telemetry.uIntervalMs, Telemetry.Dest.uIPAddr, Telemetry.Dest.uUDPPort);
+      break;
+
+    case TELEMETRY_ACTION_STOP:
+      Telemetry.uRunning = 0;
+      break;
+
+    default:
+      uStatus = CMD_STATUS_ERROR_GENERAL;
+      break;
+  }
+
+  pResponse->Header.uCommandType = pRequest->Header.uCommandType + 1;
+  pResponse->Header.uSequenceNumber = pRequest->Header.uSequenceNumber;
+  pResponse->uAction = pRequest->uAction;
+  pResponse->uStatus = uStatus;
+  pResponse->uRunning = Telemetry.uRunning;
+  pResponse->uId = Telemetry.uId;
+  pResponse->uIntervalMs = Telemetry.uIntervalMs;
+  pResponse->uContentMask = Telemetry.uContentMask;
+  pResponse->uDestIPHigh = (Telemetry.Dest.uIPAddr >> 16) & 0xFFFF;
+  pResponse->uDestIPLow = Telemetry.Dest.uIPAddr & 0xFFFF;
+  pResponse->uDestPort = Telemetry.Dest.uUDPPort;
+  pResponse->uReportsSentHigh = (Telemetry.uReportsSent >> 16) & 0xFFFF;
+  pResponse->uReportsSentLow = Telemetry.uReportsSent & 0xFFFF;
+  pResponse->uReportsDropped = Telemetry.uReportsDropped;
+  pResponse->uPadding = 0;
+}
+
+
+u8 telemetry_pending(u8 uId){
+  return (Telemetry.uRunning && (Telemetry.uId == uId)) ? 1 : 0;
+}
+
+
+void telemetry_task(u8 uId){
+  const u32 uHeaderLength = sizeof(sEthernetHeaderT) + sizeof(sIPV4HeaderT) + sizeof(sUDPHeaderT);
+  struct sIFObject *pIF;
+  u32 uNow;
+  u32 uElapsed;
+  u32 uLength;
+
+  if (0 == telemetry_pending(uId)){
+    return;
+  }
+
+  uNow = perfmon_timestamp();
+  uElapsed = uNow - Telemetry.uLastReportTime;
+  if (((uElapsed & 0x80000000) == 0) && (uElapsed < Telemetry.uIntervalCycles)){
+    return;
+  }
+  Telemetry.uLastReportTime = uNow;
+
+  pIF = lookup_if_handle_by_id(uId);
+  if ((NULL == pIF) || (pIF->uIFLinkStatus != LINK_UP)){
+    Telemetry.uReportsDropped++;
+    return;
+  }
+
+  if (0 == Telemetry.uDestResolved){
+    if (ResolveResponseClient(uId, &Telemetry.Dest) != ARP_RETURN_OK){
+      Telemetry.uReportsDropped++;
+      return;
+    }
+    Telemetry.uDestResolved = 1;
+  }
+
+  uLength = telemetry_build_report((u16 *) ((u8 *) uTransmitBuffer + uHeaderLength));
+
+  if (SendResponseToClient(uId, &Telemetry.Dest, uLength) != XST_SUCCESS){
+    Telemetry.uReportsDropped++;
+    return;
+  }
+
+  IFCounterIncr(pIF, TX_UDP_CTRL_OK);
+  Telemetry.uReportsSent++;
+}
+
+
+/* returns the report length in bytes */
+static u32 telemetry_build_report(u16 *pReport){
+  struct sIFObject *pIF;
+  u32 uUptime;
+  u32 uCount;
+  u16 uPresent = 0;
+  u16 uLinkUp = 0;
+  u16 uIndex = 0;
+  u8 uPhyId;
+  u8 c;
+
+  pReport[uIndex++] = TELEMETRY_CONTROL + 1;
+  pReport[uIndex++] = Telemetry.uReportSeq++;
+  pReport[uIndex++] = TELEMETRY_ACTION_REPORT;
+  pReport[uIndex++] = Telemetry.uContentMask;
+
+  if (Telemetry.uContentMask & TELEMETRY_CONTENT_UPTIME){
+    uUptime = get_microblaze_uptime_seconds();
+    pReport[uIndex++] = (uUptime >> 16) & 0xFFFF;
+    pReport[uIndex++] = uUptime & 0xFFFF;
+  }
+
+  if (Telemetry.uContentMask & TELEMETRY_CONTENT_LINK){
+    for (uPhyId = 0; uPhyId < NUM_ETHERNET_INTERFACES; uPhyId++){
+      if (check_interface_valid_quietly(uPhyId) != IF_ID_PRESENT){
+        continue;
+      }
+      uPresent |= (1 << uPhyId);
+      pIF = lookup_if_handle_by_id(uPhyId);
+      if ((NULL != pIF) && (pIF->uIFLinkStatus == LINK_UP)){
+        uLinkUp |= (1 << uPhyId);
+      }
+    }
+    pReport[uIndex++] = uPresent;
+    pReport[uIndex++] = uLinkUp;
+  }
+
+  if (Telemetry.uContentMask & TELEMETRY_CONTENT_COUNTERS){
+    for (uPhyId = 0; uPhyId < NUM_ETHERNET_INTERFACES; uPhyId++){
+      if (check_interface_valid_quietly(uPhyId) != IF_ID_PRESENT){
+        continue;
+      }
+      pIF = lookup_if_handle_by_id(uPhyId);
+      if (NULL == pIF){
+        continue;
+      }
+      pReport[uIndex++] = uPhyId;
+      pReport[uIndex++] = IF_COUNTER_MAX;
+      for (c = 0; c < IF_COUNTER_MAX; c++){
+        uCount = (u32) (pIF->uIFCounter[c] & 0xFFFFFFFF);
+        pReport[uIndex++] = (uCount >> 16) & 0xFFFF;
+        pReport[uIndex++] = uCount & 0xFFFF;
+      }
+    }
+  }
+
+  if (Telemetry.uContentMask & TELEMETRY_CONTENT_SENSORS){
+    GetAllSensorData(&TelemetrySensors);
+
+    for (c = 0; c < (sizeof(TelemetrySensors.uSensorData) / 2); c++){
+      pReport[uIndex++] = TelemetrySensors.uSensorData[c];
+    }
+    for (c = 0; c < (sizeof(TelemetrySensors.uStatusBits) / 2); c++){
+      pReport[uIndex++] = TelemetrySensors.uStatusBits[c];
+    }
+  }
+
+  return PadResponse((u8 *) pReport, uIndex * 2);
+}
@@ -0,0 +1,29 @@
+/**----------------------------------------------------------------------------
+ *   FILE:       telemetry.h
+ *   BRIEF:      API for the periodic telemetry push.
+ *
+ *   COMPANY:    SKA SA
+ *
+ *   NOTES:      vim settings: "set sw=2 ts=2 expandtab autoindent"
+ *------------------------------------------------------------------------------*/
+
+#ifndef _TELEMETRY_H_
+#define _TELEMETRY_H_
+
+#include <xil_types.h>
+
+#include "constant_defs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void telemetry_control(u8 uId, const sTelemetryControlReqT *pRequest, sTelemetryControlRespT *pResponse);
+
+u8 telemetry_pending(u8 uId);
+void telemetry_task(u8 uId);  /* call from the main loop while telemetry_pending() */
+
+#ifdef __cplusplus
+}
+#endif
+#endif
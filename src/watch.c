@@ -0,0 +1,334 @@
+/**----------------------------------------------------------------------------
+ *   FILE:       watch.c
+ *   BRIEF:      Register watch list with asynchronous udp change notifications.
+ *
+ *   COMPANY:    SKA SA
+ *
+ *   NOTES:      vim settings: "set sw=2 ts=2 expandtab autoindent"
+ *
+ *   The watched registers are sampled from the main loop every
+ *   WATCH_SAMPLE_PERIOD_US. An entry whose masked value differs from the last
+ *   one notified is reported once its minimum interval since its previous
+ *   notification has passed; all entries due are sent in one notification.
+ *   A change which cannot be sent (link down, destination not resolved yet)
+ *   stays pending and is sent on a later sample, with the value at that time.
+ *------------------------------------------------------------------------------*/
+
+#include <xil_types.h>
+#include <xstatus.h>
+
+#include "watch.h"
+#include "constant_defs.h"
+#include "custom_constants.h"
+#include "eth_sorter.h"
+#include "if.h"
+#include "arp.h"
+#include "register.h"
+#include "error.h"
+#include "logging.h"
+#include "perfmon.h"
+
+struct sWatchEntry {
+  u8 uRegSpace;                 /* 0 = free */
+  u32 uAddress;
+  u32 uMask;
+  u16 uMinIntervalMs;
+  u32 uMinIntervalCycles;
+  u32 uValue;                   /* last value notified */
+  u32 uLastNotifyTime;
+};
+
+struct sWatch {
+  u8 uId;                       /* interface the notifications are sent on */
+  u8 uDestValid;
+  u8 uDestResolved;             /* destination mac known */
+  struct sResponseClient Dest;
+
+  u8 uNumEntries;
+  struct sWatchEntry Entries[WATCH_ENTRIES_MAX];
+
+  u32 uLastSampleTime;
+  u16 uNotifySeq;
+  u32 uNotificationsSent;
+  u16 uNotificationsDropped;
+};
+
+static struct sWatch Watch;
+
+static u32 watch_read(const struct sWatchEntry *pEntry, u8 *pBusError);
+static u8 watch_set_dest(u8 uId, u32 uIPAddr, u16 uPort);
+static u8 watch_resolve_dest(void);
+
+
+void watch_control(u8 uId, const sWatchRegisterControlReqT *pRequest, sWatchRegisterControlRespT *pResponse){
+  struct sWatchEntry *pEntry;
+  u16 uStatus = CMD_STATUS_SUCCESS;
+  u8 uBusError;
+  u8 uIndex;
+
+  pResponse->uIndex = 0;
+
+  switch (pRequest->uAction){
+    case WATCH_ACTION_STATUS:
+      break;
+
+    case WATCH_ACTION_ADD:
+      if ((pRequest->uRegSpace != BOARD_REG) && (pRequest->uRegSpace != DSP_REG) && (pRequest->uRegSpace != WISHBONE_REG)){
+        uStatus = CMD_STATUS_ERROR_GENERAL;
+        break;
+      }
+
+      for (uIndex = 0; uIndex < WATCH_ENTRIES_MAX; uIndex++){
+        if (0 == Watch.Entries[uIndex].uRegSpace){
+          break;
+        }
+      }
+
+      if ((uIndex == WATCH_ENTRIES_MAX) || (pRequest->uMinIntervalMs > PERF_INTERVAL_MAX_MS)){
+        uStatus = CMD_STATUS_ERROR_GENERAL;
+        break;
+      }
+
+      /* notifications default to whoever set up the watch list */
+      if (0 == Watch.uDestValid){
+        if (watch_set_dest(uId, 0, 0) != XST_SUCCESS){
+          uStatus = CMD_STATUS_ERROR_GENERAL;
+          break;
+        }
+      }
+
+      pEntry = &Watch.Entries[uIndex];
+      pEntry->uRegSpace = pRequest->uRegSpace;
+      pEntry->uAddress = (pRequest->uRegAddressHigh << 16) | pRequest->uRegAddressLow;
+      pEntry->uMask = (pRequest->uMaskHigh << 16) | pRequest->uMaskLow;
+      pEntry->uMinIntervalMs = pRequest->uMinIntervalMs;
+      pEntry->uMinIntervalCycles = perfmon_us_to_cycles((u32) pEntry->uMinIntervalMs * 1000);
+      pEntry->uLastNotifyTime = perfmon_timestamp() - pEntry->uMinIntervalCycles;
+
+      (void) read_and_clear_error_flag();
+      pEntry->uValue = watch_read(pEntry, &uBusError);
+      if (uBusError){
+        pEntry->uRegSpace = 0;
+        uStatus = CMD_STATUS_ERROR_BUS;
+        break;
+      }
+
+      Watch.uNumEntries++;
+      pResponse->uIndex = uIndex;
+
+      log_printf(LOG_SELECT_CTRL, LOG_LEVEL_INFO, "WTCH [%02x] watching %08x mask %08x as entry %d\r\n", uId,
+          pEntry->uAddress, pEntry->uMask, uIndex);
+      break;
+
+    case WATCH_ACTION_REMOVE:
+      if ((pRequest->uIndex >= WATCH_ENTRIES_MAX) || (0 == Watch.Entries[pRequest->uIndex].uRegSpace)){
+        uStatus = CMD_STATUS_ERROR_GENERAL;
+        break;
+      }
+      Watch.Entries[pRequest->uIndex].uRegSpace = 0;
+      Watch.uNumEntries--;
+      break;
+
+    case WATCH_ACTION_CLEAR:
+      for (uIndex = 0; uIndex < WATCH_ENTRIES_MAX; uIndex++){
+        Watch.Entries[uIndex].uRegSpace = 0;
+      }
+      Watch.uNumEntries = 0;
+      Watch.uDestValid = 0;
+      break;
+
+    case WATCH_ACTION_DEST:
+      if (watch_set_dest(uId, (pRequest->uDestIPHigh << 16) | pRequest->uDestIPLow, pRequest->uDestPort) != XST_SUCCESS){
+        uStatus = CMD_STATUS_ERROR_GENERAL;
+      }
+      break;
+
+    default:
+      uStatus = CMD_STATUS_ERROR_GENERAL;
+      break;
+  }
+
+  pResponse->Header.uCommandType = pRequest->Header.uCommandType + 1;
+  pResponse->Header.uSequenceNumber = pRequest->Header.uSequenceNumber;
+  pResponse->uAction = pRequest->uAction;
+  pResponse->uStatus = uStatus;
+  pResponse->uNumEntries = Watch.uNumEntries;
+  pResponse->uDestIPHigh = Watch.uDestValid ? ((Watch.Dest.uIPAddr >> 16) & 0xFFFF) : 0;
+  pResponse->uDestIPLow = Watch.uDestValid ? (Watch.Dest.uIPAddr & 0xFFFF) : 0;
+  pResponse->uDestPort = Watch.uDestValid ? Watch.Dest.uUDPPort : 0;
+  pResponse->uNotificationsSentHigh = (Watch.uNotificationsSent >> 16) & 0xFFFF;
+  pResponse->uNotificationsSentLow = Watch.uNotificationsSent & 0xFFFF;
+  pResponse->uNotificationsDropped = Watch.uNotificationsDropped;
+
+  for (uIndex = 0; uIndex < WATCH_ENTRIES_MAX; uIndex++){
+    pEntry = &Watch.Entries[uIndex];
+    pResponse->Entries[uIndex].uRegSpace = pEntry->uRegSpace;
+    pResponse->Entries[uIndex].uRegAddressHigh = pEntry->uRegSpace ? ((pEntry->uAddress >> 16) & 0xFFFF) : 0;
+    pResponse->Entries[uIndex].uRegAddressLow = pEntry->uRegSpace ? (pEntry->uAddress & 0xFFFF) : 0;
+    pResponse->Entries[uIndex].uMaskHigh = pEntry->uRegSpace ? ((pEntry->uMask >> 16) & 0xFFFF) : 0;
+    pResponse->Entries[uIndex].uMaskLow = pEntry->uRegSpace ? (pEntry->uMask & 0xFFFF) : 0;
+    pResponse->Entries[uIndex].uMinIntervalMs = pEntry->uRegSpace ? pEntry->uMinIntervalMs : 0;
+    pResponse->Entries[uIndex].uValueHigh = pEntry->uRegSpace ? ((pEntry->uValue >> 16) & 0xFFFF) : 0;
+    pResponse->Entries[uIndex].uValueLow = pEntry->uRegSpace ? (pEntry->uValue & 0xFFFF) : 0;
+  }
+
+  for (uIndex = 0; uIndex < 3; uIndex++){
+    pResponse->uPadding[uIndex] = 0;
+  }
+}
+
+
+u8 watch_pending(u8 uId){
+  return (Watch.uNumEntries && Watch.uDestValid && (Watch.uId == uId)) ? 1 : 0;
+}
+
+
+void watch_task(u8 uId){
+  const u32 uHeaderLength = sizeof(sEthernetHeaderT) + sizeof(sIPV4HeaderT) + sizeof(sUDPHeaderT);
+  sWatchNotifyT *Notify = (sWatchNotifyT *) ((u8 *) uTransmitBuffer + uHeaderLength);
+  struct sIFObject *pIF;
+  struct sWatchEntry *pEntry;
+  u32 arrValue[WATCH_ENTRIES_MAX];
+  u32 uNow;
+  u32 uElapsed;
+  u32 uLength;
+  u16 uDue = 0;
+  u8 uBusError;
+  u8 uIndex;
+
+  if (0 == watch_pending(uId)){
+    return;
+  }
+
+  uNow = perfmon_timestamp();
+  uElapsed = uNow - Watch.uLastSampleTime;
+  if (((uElapsed & 0x80000000) == 0) && (uElapsed < perfmon_us_to_cycles(WATCH_SAMPLE_PERIOD_US))){
+    return;
+  }
+  Watch.uLastSampleTime = uNow;
+
+  (void) read_and_clear_error_flag();
+
+  for (uIndex = 0; uIndex < WATCH_ENTRIES_MAX; uIndex++){
+    pEntry = &Watch.Entries[uIndex];
+    if (0 == pEntry->uRegSpace){
+      continue;
+    }
+
+    arrValue[uIndex] = watch_read(pEntry, &uBusError);
+    if (uBusError){
+      continue;
+    }
+
+    if (((arrValue[uIndex] ^ pEntry->uValue) & pEntry->uMask) == 0){
+      continue;
+    }
+
+    uElapsed = uNow - pEntry->uLastNotifyTime;
+    if (((uElapsed & 0x80000000) == 0) && (uElapsed < pEntry->uMinIntervalCycles)){
+      continue;
+    }
+
+    Notify->Entries[uDue].uIndex = uIndex;
+    Notify->Entries[uDue].uRegAddressHigh = (pEntry->uAddress >> 16) & 0xFFFF;
+    Notify->Entries[uDue].uRegAddressLow = pEntry->uAddress & 0xFFFF;
+    Notify->Entries[uDue].uValueHigh = (arrValue[uIndex] >> 16) & 0xFFFF;
+    Notify->Entries[uDue].uValueLow = arrValue[uIndex] & 0xFFFF;
+    uDue++;
+  }
+
+  if (0 == uDue){
+    return;
+  }
+
+  /* leave the changes pending - they are picked up again on a later sample */
+  pIF = lookup_if_handle_by_id(uId);
+  if ((NULL == pIF) || (pIF->uIFLinkStatus != LINK_UP) || (watch_resolve_dest() != XST_SUCCESS)){
+    return;
+  }
+
+  Notify->Header.uCommandType = WATCH_REGISTER_CONTROL + 1;
+  Notify->Header.uSequenceNumber = Watch.uNotifySeq++;
+  Notify->uAction = WATCH_ACTION_NOTIFY;
+  Notify->uNumEntries = uDue;
+
+  uLength = sizeof(sWatchNotifyT) - sizeof(Notify->Entries) - sizeof(Notify->uPadding) + (uDue * sizeof(sWatchNotifyEntryT));
+  uLength = PadResponse((u8 *) Notify, uLength);
+
+  if (SendResponseToClient(uId, &Watch.Dest, uLength) != XST_SUCCESS){
+    Watch.uNotificationsDropped++;
+    return;
+  }
+
+  IFCounterIncr(pIF, TX_UDP_CTRL_OK);
+  Watch.uNotificationsSent++;
+
+  /* only now are the changes considered delivered */
+  for (uIndex = 0; uIndex < uDue; uIndex++){
+    pEntry = &Watch.Entries[Notify->Entries[uIndex].uIndex];
+    pEntry->uValue = arrValue[Notify->Entries[uIndex].uIndex];
+    pEntry->uLastNotifyTime = uNow;
+  }
+}
+
+
+static u32 watch_read(const struct sWatchEntry *pEntry, u8 *pBusError){
+  u32 uValue;
+
+  if (pEntry->uRegSpace == BOARD_REG){
+    uValue = ReadBoardRegister(pEntry->uAddress);
+  } else if (pEntry->uRegSpace == DSP_REG){
+    uValue = ReadDSPRegister(pEntry->uAddress);
+  } else {
+    uValue = ReadWishboneRegister(pEntry->uAddress);
+  }
+
+  *pBusError = (read_and_clear_error_flag() == ERROR_AXI_DATA_BUS) ? 1 : 0;
+
+  return uValue;
+}
+
+
+static u8 watch_set_dest(u8 uId, u32 uIPAddr, u16 uPort){
+  struct sResponseClient Dest;
+  u8 uResolved = 1;
+  u8 uRet;
+
+  /* the client of the current request */
+  SaveResponseClient(&Dest);
+
+  if (0 == uPort){
+    uPort = Dest.uUDPPort;
+  }
+
+  /* any other destination has to be resolved */
+  if ((0 != uIPAddr) && (uIPAddr != Dest.uIPAddr)){
+    Dest.uIPAddr = uIPAddr;
+    uRet = ResolveResponseClient(uId, &Dest);
+    if ((ARP_RETURN_OK != uRet) && (ARP_RETURN_REQUEST != uRet)){
+      return XST_FAILURE;
+    }
+    uResolved = (ARP_RETURN_OK == uRet) ? 1 : 0;
+  }
+
+  Dest.uUDPPort = uPort;
+
+  Watch.Dest = Dest;
+  Watch.uDestResolved = uResolved;
+  Watch.uId = uId;
+  Watch.uDestValid = 1;
+
+  return XST_SUCCESS;
+}
+
+
+static u8 watch_resolve_dest(void){
+  if (0 == Watch.uDestResolved){
+    if (ResolveResponseClient(Watch.uId, &Watch.Dest) != ARP_RETURN_OK){
+      return XST_FAILURE;
+    }
+    Watch.uDestResolved = 1;
+  }
+
+  return XST_SUCCESS;
+}
@@ -0,0 +1,32 @@
+/**----------------------------------------------------------------------------
+ *   FILE:       watch.h
+ *   BRIEF:      API for the register watch list and its change notifications.
+ *
+ *   COMPANY:    SKA SA
+ *
+ *   NOTES:      vim settings: "set sw=2 ts=2 expandtab autoindent"
+ *------------------------------------------------------------------------------*/
+
+#ifndef _WATCH_H_
+#define _WATCH_H_
+
+#include <xil_types.h>
+
+#include "custom_constants.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* the watch list is sampled at most this often */
+#define WATCH_SAMPLE_PERIOD_US    1000
+
+void watch_control(u8 uId, const sWatchRegisterControlReqT *pRequest, sWatchRegisterControlRespT *pResponse);
+
+u8 watch_pending(u8 uId);
+void watch_task(u8 uId);      /* call from the main loop while watch_pending() */
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,204 @@
+/*
+ * Host check and micro-benchmark of the firmware's uChecksum16Calc (src/net_utils.c)
+ * against the original per-halfword implementation it replaced.
+ *
+ * The results are compared over random buffers for every start alignment, length,
+ * start value and both byte orders, with the byte following the range changed
+ * between runs to catch reads past the end. The time per byte of both versions is
+ * then reported for a few buffer sizes.
+ */
+
+#include <sys/types.h>
+#include <string.h>
+#include <stdlib.h>
+#include <sysexits.h>
+#include <time.h>
+
+#include <stdio.h>
+#include <stdint.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_TSC 1
+#else
+#define HAVE_TSC 0
+#endif
+
+#include "net_utils.h"
+
+#define CHECK_LENGTH_MAX  300
+#define BUFFER_SIZE       (9000 + 16)
+
+static uint8_t buffer[BUFFER_SIZE];
+
+/*
+ * The firmware implementation before the word-at-a-time rewrite. An odd trailing
+ * byte is zero padded in the requested byte order - the original read the byte
+ * after the range for ByteSwap instead.
+ */
+static int uChecksum16CalcOld(u8 *pDataPtr, u16 uIndexStart, u16 uIndexEnd, u16 *pChecksumPtr, u8 ByteSwap, u16 uChecksumStartValue){
+  u16 uChkIndex;
+  u16 uChkLength;
+  u16 uChkTmp = 0;
+  u32 uChecksumValue = 0;
+  u32 uChecksumCarry = 0;
+  u8 Offset = 0;
+
+  if (pDataPtr == NULL){
+    return (-1);
+  }
+
+  if (uIndexStart > uIndexEnd){
+    return (-1);
+  }
+
+  if (ByteSwap){
+    Offset = 1;
+  } else {
+    Offset = 0;
+  }
+
+  uChecksumValue = ( (u32) uChecksumStartValue) & 0x0000FFFF;
+
+  uChkLength = uIndexEnd - uIndexStart + 1;
+
+  for (uChkIndex = uIndexStart; uChkIndex < (uIndexStart + uChkLength); uChkIndex += 2){
+    if (uChkIndex == (uIndexStart + uChkLength - 1)){     /* last iteration - only for an odd length */
+      uChkTmp = ByteSwap ? pDataPtr[uChkIndex] : (pDataPtr[uChkIndex] << 8);
+    } else {
+      uChkTmp = (u8) pDataPtr[uChkIndex + Offset];
+      uChkTmp = uChkTmp << 8;
+      uChkTmp = uChkTmp + (u8) pDataPtr[uChkIndex + 1 - Offset];
+    }
+
+    uChkTmp = ~uChkTmp;
+
+    uChecksumValue = uChecksumValue + uChkTmp;
+    uChecksumCarry = (uChecksumValue >> 16) & 0xffff;
+    uChecksumValue = (0xffff & uChecksumValue) + uChecksumCarry;
+  }
+
+  *pChecksumPtr = uChecksumValue;
+
+  return 0;
+}
+
+typedef int (*checksum_fn)(u8 *, u16, u16, u16 *, u8, u16);
+
+static void fill_random(uint8_t *p, size_t n)
+{
+  size_t i;
+
+  for (i = 0; i < n; i++){
+    p[i] = rand() & 0xff;
+  }
+}
+
+static int check(void)
+{
+  unsigned int offset, length, swap, run;
+  u16 start, sum_old, sum_new, sum_new_guard;
+  unsigned long checked = 0, failed = 0;
+
+  for (run = 0; run < 20; run++){
+    fill_random(buffer, BUFFER_SIZE);
+    for (offset = 0; offset < 4; offset++){
+      for (length = 1; length <= CHECK_LENGTH_MAX; length++){
+        for (swap = 0; swap < 2; swap++){
+          start = (run == 0) ? 0 : (rand() & 0xffff);
+
+          uChecksum16CalcOld(buffer, offset, offset + length - 1, &sum_old, swap, start);
+          uChecksum16Calc(buffer, offset, offset + length - 1, &sum_new, swap, start);
+
+          /* the byte after the range must not change the result */
+          buffer[offset + length] ^= 0xa5;
+          uChecksum16Calc(buffer, offset, offset + length - 1, &sum_new_guard, swap, start);
+          buffer[offset + length] ^= 0xa5;
+
+          checked++;
+          if ((sum_old != sum_new) || (sum_new != sum_new_guard)){
+            if (failed++ < 10){
+              printf("MISMATCH offset %u length %u swap %u start %04x: old %04x new %04x (past the end %04x)\n",
+                  offset, length, swap, start, sum_old, sum_new, sum_new_guard);
+            }
+          }
+        }
+      }
+    }
+  }
+
+  printf("checked %lu cases, %lu mismatches\n", checked, failed);
+
+  return failed ? -1 : 0;
+}
+
+static double now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double) ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void bench_one(const char *name, checksum_fn fn, unsigned int offset, unsigned int length, unsigned int iterations)
+{
+  volatile u16 sink = 0;
+  u16 sum;
+  double t0, t1;
+  unsigned int i;
+#if HAVE_TSC
+  uint64_t c0, c1;
+#endif
+
+#if HAVE_TSC
+  c0 = __rdtsc();
+#endif
+  t0 = now_ns();
+  for (i = 0; i < iterations; i++){
+    fn(buffer, offset, offset + length - 1, &sum, 0, sink);
+    sink = sum;
+  }
+  t1 = now_ns();
+#if HAVE_TSC
+  c1 = __rdtsc();
+  printf("  %-4s %8.3f ns/byte %8.3f tsc/byte\n", name, (t1 - t0) / ((double) iterations * length),
+      (double) (c1 - c0) / ((double) iterations * length));
+#else
+  printf("  %-4s %8.3f ns/byte\n", name, (t1 - t0) / ((double) iterations * length));
+#endif
+}
+
+static void bench(void)
+{
+  static const unsigned int lengths[] = {20, 60, 576, 1472, 8972};
+  unsigned int i, offset, iterations;
+
+  fill_random(buffer, BUFFER_SIZE);
+
+  for (i = 0; i < (sizeof(lengths) / sizeof(lengths[0])); i++){
+    iterations = 20000000 / lengths[i];
+    /* offset 14 is the ip header in a frame, offset 15 exercises the odd address path */
+    for (offset = 14; offset <= 15; offset++){
+      printf("%u bytes at offset %u:\n", lengths[i], offset);
+      bench_one("old", uChecksum16CalcOld, offset, lengths[i], iterations);
+      bench_one("new", uChecksum16Calc, offset, lengths[i], iterations);
+    }
+  }
+}
+
+int main(int argc, char **argv)
+{
+  srand(1);
+
+  if (check() != 0){
+    return EX_SOFTWARE;
+  }
+
+  if ((argc > 1) && (strcmp(argv[1], "-c") == 0)){
+    return EX_OK;   /* check only */
+  }
+
+  bench();
+
+  return EX_OK;
+}
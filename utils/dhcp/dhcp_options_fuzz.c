@@ -0,0 +1,451 @@
+/*
+ * Host fuzz and throughput harness for the firmware's DHCP option indexing
+ * (uDHCPIndexOptions / uDHCPOptionU32 in src/dhcp.c).
+ *
+ * dhcp.c is included directly so that its static helpers can be called. Each
+ * frame (built-in OFFER and ACK samples, plus any raw ethernet frames given on
+ * the command line, e.g. written with Wireshark's "Export Packet Bytes") is
+ *   - indexed as is and compared against a straightforward reference walk,
+ *   - indexed with the option area truncated at every length,
+ *   - indexed with randomly mutated option areas (option codes, oversized and
+ *     undersized lengths, missing end option),
+ * and the indexing throughput is then reported in lookups per second. The
+ * options are copied to a buffer which ends exactly at the limit, so building
+ * with "make asan" catches any read past it.
+ */
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <sysexits.h>
+#include <time.h>
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "dhcp.c"
+
+#define FRAME_MAX         1536
+#define FRAMES_MAX        16
+#define FUZZ_RUNS         200000
+#define BENCH_PASSES      2000000
+
+/* the options follow the magic cookie, for an ip header without options */
+#define OPTIONS_START     (DHCP_OPTIONS_BASE + 4)
+
+struct frame {
+  const char *name;
+  u8 data[FRAME_MAX];
+  u16 length;
+};
+
+static struct frame frames[FRAMES_MAX];
+static unsigned int num_frames = 0;
+
+static struct sIFObject IF;
+
+/*---------------------------------- firmware stubs ----------------------------------*/
+
+tLogLevel get_log_level(void)
+{
+  return LOG_LEVEL_OFF;
+}
+
+tLogSelect get_log_select(void)
+{
+  return LOG_SELECT_GENERAL;
+}
+
+void xil_printf(const char *ctrl1, ...)
+{
+  va_list args;
+
+  va_start(args, ctrl1);
+  vprintf(ctrl1, args);
+  va_end(args);
+}
+
+/*---------------------------------- sample frames -----------------------------------*/
+
+static u16 add_option(u8 *p, u16 i, u8 code, u8 len, const u8 *value)
+{
+  p[i++] = code;
+  p[i++] = len;
+  memcpy(&p[i], value, len);
+  return i + len;
+}
+
+/* a server reply in the layout of a captured frame: eth / ip / udp / bootp / cookie / options */
+static void build_reply(struct frame *f, const char *name, u8 msg_type, int with_timers)
+{
+  static const u8 server[4] = {10, 0, 0, 1};
+  static const u8 subnet[4] = {255, 255, 255, 0};
+  static const u8 lease[4] = {0x00, 0x01, 0x51, 0x80};   /* 86400s */
+  static const u8 t1[4] = {0x00, 0x00, 0xa8, 0xc0};      /* 43200s */
+  static const u8 t2[4] = {0x00, 0x01, 0x27, 0x50};      /* 75600s */
+  static const u8 dns[8] = {10, 0, 0, 2, 10, 0, 0, 3};
+  static const u8 domain[] = "kat.ac.za";
+  static const u8 ntp[4] = {10, 0, 0, 4};
+  u8 *p = f->data;
+  u8 type[1];
+  u16 i, udp_len, ip_len;
+
+  memset(f, 0, sizeof(*f));
+  f->name = name;
+
+  /* ethernet */
+  memset(&p[ETH_DST_OFFSET], 0xff, 6);
+  p[ETH_SRC_OFFSET] = 0x00; p[ETH_SRC_OFFSET + 1] = 0x50; p[ETH_SRC_OFFSET + 2] = 0x56;
+  p[ETH_FRAME_TYPE_OFFSET] = 0x08;
+
+  /* ip */
+  p[IP_FRAME_BASE] = 0x45;
+  p[IP_FRAME_BASE + IP_TTL_OFFSET] = 64;
+  p[IP_FRAME_BASE + IP_PROT_OFFSET] = 17;
+  memcpy(&p[IP_FRAME_BASE + IP_SRC_OFFSET], server, 4);
+  memset(&p[IP_FRAME_BASE + IP_DST_OFFSET], 0xff, 4);
+
+  /* udp 67 -> 68 */
+  p[UDP_FRAME_BASE + UDP_SRC_PORT_OFFSET + 1] = 67;
+  p[UDP_FRAME_BASE + UDP_DST_PORT_OFFSET + 1] = 68;
+
+  /* bootp reply */
+  p[BOOTP_FRAME_BASE + BOOTP_OPTYPE_OFFSET] = 2;
+  p[BOOTP_FRAME_BASE + BOOTP_HWTYPE_OFFSET] = 1;
+  p[BOOTP_FRAME_BASE + BOOTP_HWLEN_OFFSET] = 6;
+  p[BOOTP_FRAME_BASE + BOOTP_YIPADDR_OFFSET] = 10;
+  p[BOOTP_FRAME_BASE + BOOTP_YIPADDR_OFFSET + 3] = 42;
+
+  /* magic cookie */
+  p[DHCP_OPTIONS_BASE] = 99; p[DHCP_OPTIONS_BASE + 1] = 130;
+  p[DHCP_OPTIONS_BASE + 2] = 83; p[DHCP_OPTIONS_BASE + 3] = 99;
+
+  i = OPTIONS_START;
+  type[0] = msg_type;
+  i = add_option(p, i, 53, 1, type);
+  i = add_option(p, i, 54, 4, server);
+  i = add_option(p, i, 51, 4, lease);
+  if (with_timers){
+    i = add_option(p, i, 58, 4, t1);
+    i = add_option(p, i, 59, 4, t2);
+  }
+  i = add_option(p, i, 1, 4, subnet);
+  i = add_option(p, i, 3, 4, server);
+  i = add_option(p, i, 6, 8, dns);
+  i = add_option(p, i, 15, sizeof(domain) - 1, domain);
+  i = add_option(p, i, 42, 4, ntp);
+  p[i++] = 255;
+
+  /* servers pad the bootp message to the 300 byte minimum */
+  while (i < (BOOTP_FRAME_BASE + 300)){
+    p[i++] = 0;
+  }
+
+  udp_len = i - UDP_FRAME_BASE;
+  ip_len = i - IP_FRAME_BASE;
+  p[UDP_FRAME_BASE + UDP_ULEN_OFFSET] = udp_len >> 8;
+  p[UDP_FRAME_BASE + UDP_ULEN_OFFSET + 1] = udp_len & 0xff;
+  p[IP_FRAME_BASE + 2] = ip_len >> 8;
+  p[IP_FRAME_BASE + 3] = ip_len & 0xff;
+
+  f->length = i;
+}
+
+static int load_frame(const char *filename)
+{
+  struct frame *f;
+  FILE *fp;
+  size_t n;
+
+  if (num_frames >= FRAMES_MAX){
+    fprintf(stderr, "too many frames\n");
+    return -1;
+  }
+
+  fp = fopen(filename, "rb");
+  if (fp == NULL){
+    perror(filename);
+    return -1;
+  }
+
+  f = &frames[num_frames];
+  memset(f, 0, sizeof(*f));
+  n = fread(f->data, 1, FRAME_MAX, fp);
+  fclose(fp);
+
+  if ((n <= OPTIONS_START) || (f->data[IP_FRAME_BASE] != 0x45) || (f->data[BOOTP_FRAME_BASE + BOOTP_OPTYPE_OFFSET] != 2)){
+    fprintf(stderr, "%s: not a dhcp reply without ip options\n", filename);
+    return -1;
+  }
+
+  f->name = filename;
+  f->length = n;
+  num_frames++;
+
+  return 0;
+}
+
+/*------------------------------------ reference -------------------------------------*/
+
+/* the same rules as uDHCPIndexOptions, written for clarity rather than speed */
+static u8 reference_index(const u8 *p, u16 start, u16 limit, u16 *offsets)
+{
+  u16 i = start;
+  u8 code, len, slot;
+
+  memset(offsets, 0, DHCP_OPT_IDX_MAX * sizeof(u16));
+
+  for (;;){
+    if (i >= limit){
+      return DHCP_RETURN_INVALID;     /* no end option */
+    }
+
+    code = p[i];
+    if (code == 0){
+      i++;
+      continue;
+    }
+
+    if (code == 255){
+      if (offsets[DHCP_OPT_IDX_MSG_TYPE] == 0){
+        return DHCP_RETURN_INVALID;
+      }
+      if ((p[offsets[DHCP_OPT_IDX_MSG_TYPE]] < DHCPDISCOVER) || (p[offsets[DHCP_OPT_IDX_MSG_TYPE]] > DHCPINFORM)){
+        return DHCP_RETURN_INVALID;
+      }
+      return DHCP_RETURN_OK;
+    }
+
+    if ((i + 1) >= limit){
+      return DHCP_RETURN_INVALID;     /* length byte missing */
+    }
+
+    len = p[i + 1];
+    if ((i + 2 + len) > limit){
+      return DHCP_RETURN_INVALID;     /* value runs past the limit */
+    }
+
+    for (slot = 0; slot < DHCP_OPT_IDX_MAX; slot++){
+      if ((dhcp_option_index_codes[slot] == code) && (offsets[slot] == 0) && (len >= dhcp_option_index_min_len[slot])){
+        offsets[slot] = i + 2;
+      }
+    }
+
+    i = i + 2 + len;
+  }
+}
+
+/*-------------------------------------- checks --------------------------------------*/
+
+static unsigned long checked = 0;
+static unsigned long failed = 0;
+
+/* index p[0..limit) with the firmware and the reference, from a buffer ending at the limit */
+static void check_one(const char *name, const u8 *p, u16 limit)
+{
+  u16 expected[DHCP_OPT_IDX_MAX];
+  u8 *copy;
+  u8 ret, ref;
+  u8 slot;
+
+  copy = malloc(limit);
+  if (copy == NULL){
+    perror("malloc");
+    exit(EX_OSERR);
+  }
+  memcpy(copy, p, limit);
+
+  IF.pUserRxBufferPtr = copy;
+  IF.uUserRxBufferSize = limit;
+
+  ret = uDHCPIndexOptions(&IF, OPTIONS_START, limit);
+  ref = reference_index(copy, OPTIONS_START, limit, expected);
+
+  checked++;
+
+  if (ret != ref){
+    if (failed++ < 10){
+      printf("MISMATCH %s limit %u: returned %u, reference %u\n", name, limit, ret, ref);
+    }
+    free(copy);
+    return;
+  }
+
+  if (ret == DHCP_RETURN_OK){
+    for (slot = 0; slot < DHCP_OPT_IDX_MAX; slot++){
+      if ((IF.DHCPContextState.arrDHCPOptionOffset[slot] != expected[slot]) ||
+          ((expected[slot] != 0) && ((expected[slot] + dhcp_option_index_min_len[slot]) > limit))){
+        if (failed++ < 10){
+          printf("MISMATCH %s limit %u: option %u at %u, reference %u\n", name, limit, dhcp_option_index_codes[slot],
+              IF.DHCPContextState.arrDHCPOptionOffset[slot], expected[slot]);
+        }
+        break;
+      }
+    }
+  }
+
+  free(copy);
+}
+
+static void check_frames(void)
+{
+  struct frame *f;
+  unsigned int n;
+  u16 limit;
+  u32 lease;
+
+  for (n = 0; n < num_frames; n++){
+    f = &frames[n];
+
+    IF.pUserRxBufferPtr = f->data;
+    IF.uUserRxBufferSize = f->length;
+    if (uDHCPIndexOptions(&IF, OPTIONS_START, f->length) != DHCP_RETURN_OK){
+      printf("FAIL %s: not indexed\n", f->name);
+      failed++;
+      continue;
+    }
+
+    if (IF.DHCPContextState.arrDHCPOptionOffset[DHCP_OPT_IDX_LEASE_TIME] != 0){
+      lease = uDHCPOptionU32(f->data, IF.DHCPContextState.arrDHCPOptionOffset[DHCP_OPT_IDX_LEASE_TIME]);
+      printf("%s: message type %u, lease %us\n", f->name,
+          f->data[IF.DHCPContextState.arrDHCPOptionOffset[DHCP_OPT_IDX_MSG_TYPE]], lease);
+    }
+
+    /* truncated option areas */
+    for (limit = OPTIONS_START; limit <= f->length; limit++){
+      check_one(f->name, f->data, limit);
+    }
+  }
+}
+
+static void fuzz_frames(void)
+{
+  static const u8 codes[] = {0, 1, 3, 51, 53, 54, 58, 59, 255};
+  u8 buf[FRAME_MAX];
+  struct frame *f;
+  unsigned int run, m, mutations;
+  u16 pos, limit;
+
+  for (run = 0; run < FUZZ_RUNS; run++){
+    f = &frames[run % num_frames];
+    memcpy(buf, f->data, f->length);
+    limit = f->length;
+
+    mutations = 1 + (rand() % 4);
+    for (m = 0; m < mutations; m++){
+      pos = OPTIONS_START + (rand() % (limit - OPTIONS_START));
+      switch (rand() % 5){
+        case 0:   /* random byte */
+          buf[pos] = rand() & 0xff;
+          break;
+        case 1:   /* interesting option code */
+          buf[pos] = codes[rand() % sizeof(codes)];
+          break;
+        case 2:   /* oversized length */
+          buf[pos] = 0xff - (rand() % 8);
+          break;
+        case 3:   /* undersized length */
+          buf[pos] = rand() % 4;
+          break;
+        default:  /* truncate */
+          limit = pos + 1;
+          break;
+      }
+    }
+
+    check_one(f->name, buf, limit);
+  }
+}
+
+/*------------------------------------ throughput ------------------------------------*/
+
+static double now_s(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double) ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void bench(void)
+{
+  volatile u32 sink = 0;
+  struct frame *f;
+  struct sDHCPObject *d = &IF.DHCPContextState;
+  unsigned long pass, lookups = 0;
+  double t0, t1;
+
+  t0 = now_s();
+  for (pass = 0; pass < BENCH_PASSES; pass++){
+    f = &frames[pass % num_frames];
+    IF.pUserRxBufferPtr = f->data;
+    IF.uUserRxBufferSize = f->length;
+
+    if (uDHCPIndexOptions(&IF, OPTIONS_START, f->length) != DHCP_RETURN_OK){
+      continue;
+    }
+
+    /* the lookups done when a lease is bound */
+    sink += f->data[d->arrDHCPOptionOffset[DHCP_OPT_IDX_MSG_TYPE]];
+    if (d->arrDHCPOptionOffset[DHCP_OPT_IDX_LEASE_TIME]){
+      sink += uDHCPOptionU32(f->data, d->arrDHCPOptionOffset[DHCP_OPT_IDX_LEASE_TIME]);
+    }
+    if (d->arrDHCPOptionOffset[DHCP_OPT_IDX_T1]){
+      sink += uDHCPOptionU32(f->data, d->arrDHCPOptionOffset[DHCP_OPT_IDX_T1]);
+    }
+    if (d->arrDHCPOptionOffset[DHCP_OPT_IDX_T2]){
+      sink += uDHCPOptionU32(f->data, d->arrDHCPOptionOffset[DHCP_OPT_IDX_T2]);
+    }
+    lookups += 4;
+  }
+  t1 = now_s();
+
+  printf("%lu messages indexed in %.3fs: %.0f messages/s, %.0f option lookups/s\n", (unsigned long) BENCH_PASSES,
+      t1 - t0, BENCH_PASSES / (t1 - t0), lookups / (t1 - t0));
+}
+
+void usage(char *name)
+{
+  printf("usage: %s [-c] [frame ...]\n", name);
+  printf("-c       checks only, no throughput run\n");
+  printf("frame    raw ethernet frame of a dhcp reply (e.g. from Wireshark \"Export Packet Bytes\")\n");
+  printf("\n");
+}
+
+int main(int argc, char **argv)
+{
+  int check_only = 0;
+  int i;
+
+  build_reply(&frames[num_frames++], "sample-offer", DHCPOFFER, 0);
+  build_reply(&frames[num_frames++], "sample-ack", DHCPACK, 1);
+
+  for (i = 1; i < argc; i++){
+    if (strcmp(argv[i], "-c") == 0){
+      check_only = 1;
+    } else if (strcmp(argv[i], "-h") == 0){
+      usage(argv[0]);
+      return EX_OK;
+    } else if (load_frame(argv[i]) != 0){
+      return EX_DATAERR;
+    }
+  }
+
+  srand(1);
+
+  check_frames();
+  fuzz_frames();
+
+  printf("checked %lu option areas, %lu mismatches\n", checked, failed);
+  if (failed){
+    return EX_SOFTWARE;
+  }
+
+  if (check_only == 0){
+    bench();
+  }
+
+  return EX_OK;
+}
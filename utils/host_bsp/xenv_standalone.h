@@ -0,0 +1,7 @@
+/* host stand-in for the Xilinx BSP xenv_standalone.h */
+#ifndef XENV_STANDALONE_H
+#define XENV_STANDALONE_H
+
+#include <string.h>
+
+#endif
@@ -0,0 +1,7 @@
+/* host stand-in for the Xilinx BSP xil_printf.h - xil_printf() is provided by the host tool */
+#ifndef XIL_PRINTF_H
+#define XIL_PRINTF_H
+
+void xil_printf(const char *ctrl1, ...);
+
+#endif
@@ -0,0 +1,185 @@
+#!/usr/bin/env python3
+"""
+Host side of the microblaze pc-sampling profiler (firmware built with
+-DPROFILER, see src/prof.c).
+
+  prof_symbols.py start  -t <skarab ip>
+  prof_symbols.py stop   -t <skarab ip>
+  prof_symbols.py fetch  -t <skarab ip> -o hist.txt
+  prof_symbols.py report -e executable.elf -i hist.txt [-n 30]
+
+The histogram is fetched with the PROFILER_CONTROL opcode and saved as a text
+file ("# key value" header lines followed by "<bucket> <count>" lines). The
+report step maps every bucket onto the elf symbol table (via nm) and prints
+the functions which collected the most samples. A bucket spans
+(1 << bucket_shift) bytes so a bucket straddling two functions is attributed
+to the function containing its start address.
+"""
+
+import argparse
+import bisect
+import random
+import socket
+import struct
+import subprocess
+import sys
+
+CONTROL_PORT = 0x7778
+PROFILER_CONTROL = 0x006F
+
+ACTION_STOP = 0
+ACTION_START = 1
+ACTION_FETCH = 2
+ACTION_CLEAR = 3
+
+RESP_HDR_FMT = '>14H'   # header (2) + fixed fields (12)
+
+
+def transact(target, action, offset=0, timeout=1.0, retries=3):
+    seq = random.randint(0, 0xffff)
+    req = struct.pack('>4H', PROFILER_CONTROL, seq, action, offset)
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.settimeout(timeout)
+    try:
+        for _ in range(retries):
+            sock.sendto(req, (target, CONTROL_PORT))
+            try:
+                while True:
+                    data, _addr = sock.recvfrom(2048)
+                    if len(data) < struct.calcsize(RESP_HDR_FMT):
+                        continue
+                    hdr = struct.unpack_from(RESP_HDR_FMT, data)
+                    if hdr[0] == PROFILER_CONTROL + 1 and hdr[1] == seq:
+                        return parse_resp(data)
+            except socket.timeout:
+                continue
+    finally:
+        sock.close()
+    raise RuntimeError('no response from %s' % target)
+
+
+def parse_resp(data):
+    hdr = struct.unpack_from(RESP_HDR_FMT, data)
+    resp = {
+        'action': hdr[2],
+        'status': hdr[3],
+        'running': hdr[4],
+        'bucket_shift': hdr[5],
+        'num_buckets': hdr[6],
+        'sample_rate_hz': hdr[7],
+        'total_samples': (hdr[8] << 16) | hdr[9],
+        'out_of_range': (hdr[10] << 16) | hdr[11],
+        'offset': hdr[12],
+    }
+    count = hdr[13]
+    resp['buckets'] = list(struct.unpack_from('>%dH' % count, data, struct.calcsize(RESP_HDR_FMT)))
+    return resp
+
+
+def check(resp):
+    if resp['status'] != 0:
+        sys.exit('profiler command failed (status %d) - is the firmware built with PROFILER?' % resp['status'])
+    return resp
+
+
+def fetch(target):
+    resp = check(transact(target, ACTION_FETCH, 0))
+    if resp['running']:
+        print('warning: profiler still running - histogram may be inconsistent', file=sys.stderr)
+    hist = dict((k, v) for k, v in resp.items() if k != 'buckets')
+    buckets = resp['buckets']
+    while len(buckets) < resp['num_buckets']:
+        buckets += check(transact(target, ACTION_FETCH, len(buckets)))['buckets']
+    hist['buckets'] = buckets
+    return hist
+
+
+def save(hist, path):
+    with open(path, 'w') as f:
+        for k in ('bucket_shift', 'num_buckets', 'sample_rate_hz', 'total_samples', 'out_of_range'):
+            f.write('# %s %d\n' % (k, hist[k]))
+        for i, c in enumerate(hist['buckets']):
+            if c:
+                f.write('%d %d\n' % (i, c))
+
+
+def load(path):
+    hist = {'buckets': {}}
+    with open(path) as f:
+        for line in f:
+            fields = line.split()
+            if not fields:
+                continue
+            if fields[0] == '#':
+                hist[fields[1]] = int(fields[2])
+            else:
+                hist['buckets'][int(fields[0])] = int(fields[1])
+    return hist
+
+
+def read_symbols(elf, nm):
+    out = subprocess.check_output([nm, '-n', '-S', '--defined-only', elf]).decode()
+    syms = []
+    for line in out.splitlines():
+        fields = line.split()
+        if len(fields) == 4 and fields[2] in 'tTwW':
+            syms.append((int(fields[0], 16), int(fields[1], 16), fields[3]))
+        elif len(fields) == 3 and fields[1] in 'tTwW':
+            syms.append((int(fields[0], 16), 0, fields[2]))
+    syms.sort()
+    return syms
+
+
+def report(hist, syms, top):
+    addrs = [s[0] for s in syms]
+    per_sym = {}
+    shift = hist['bucket_shift']
+    for bucket, count in hist['buckets'].items():
+        addr = bucket << shift
+        i = bisect.bisect_right(addrs, addr) - 1
+        if i >= 0 and (syms[i][1] == 0 or addr < syms[i][0] + syms[i][1]):
+            name = syms[i][2]
+        elif i + 1 < len(syms) and syms[i + 1][0] < addr + (1 << shift):
+            name = syms[i + 1][2]
+        else:
+            name = '<0x%05x>' % addr
+        per_sym[name] = per_sym.get(name, 0) + count
+
+    total = sum(per_sym.values()) or 1
+    print('samples: %d (out of range: %d) at %d Hz, %d byte buckets' %
+          (hist.get('total_samples', total), hist.get('out_of_range', 0),
+           hist.get('sample_rate_hz', 0), 1 << shift))
+    print('%8s %7s  %s' % ('samples', '%', 'function'))
+    for name, count in sorted(per_sym.items(), key=lambda x: -x[1])[:top]:
+        print('%8d %6.2f%%  %s' % (count, 100.0 * count / total, name))
+
+
+def main():
+    parser = argparse.ArgumentParser(description='microblaze pc-sampling profiler')
+    parser.add_argument('cmd', choices=['start', 'stop', 'clear', 'fetch', 'report'])
+    parser.add_argument('-t', '--target', help='skarab ip address')
+    parser.add_argument('-o', '--output', default='prof_hist.txt', help='histogram file to write (fetch)')
+    parser.add_argument('-i', '--input', default='prof_hist.txt', help='histogram file to read (report)')
+    parser.add_argument('-e', '--elf', help='elf file the firmware was built from (report)')
+    parser.add_argument('-n', '--top', type=int, default=30, help='number of functions to list')
+    parser.add_argument('--nm', default='mb-nm', help='nm executable for the target')
+    args = parser.parse_args()
+
+    if args.cmd == 'report':
+        if not args.elf:
+            parser.error('report needs --elf')
+        report(load(args.input), read_symbols(args.elf, args.nm), args.top)
+        return
+
+    if not args.target:
+        parser.error('%s needs --target' % args.cmd)
+
+    if args.cmd == 'fetch':
+        save(fetch(args.target), args.output)
+    else:
+        action = {'start': ACTION_START, 'stop': ACTION_STOP, 'clear': ACTION_CLEAR}[args.cmd]
+        check(transact(args.target, action))
+
+
+if __name__ == '__main__':
+    main()